@@ -1,15 +1,22 @@
 #!/usr/bin/env python3
 from __future__ import annotations
 
+import asyncio
+import io
 import json
 import os
 import re
+import queue
+import struct
 import tempfile
+import time
+from concurrent.futures import Future
 from pathlib import Path
-from threading import Lock
+from threading import Lock, Thread
 from typing import Iterable
 
-from fastapi import FastAPI, File, Form, UploadFile
+import numpy as np
+from fastapi import FastAPI, File, Form, UploadFile, WebSocket, WebSocketDisconnect
 from fastapi.responses import JSONResponse, StreamingResponse
 from mlx_audio.stt import load as load_stt
 
@@ -18,6 +25,22 @@ MODEL_ID = os.getenv("ASR_MODEL_ID", "mlx-community/Qwen3-ASR-0.6B-8bit")
 HOST = os.getenv("HOST", "0.0.0.0")
 PORT = int(os.getenv("PORT", "8765"))
 
+# Streaming ingest (/api/v1/ingest)
+INGEST_SAMPLE_RATE = 16000
+PARTIAL_INTERVAL_MS = int(os.getenv("ASR_PARTIAL_INTERVAL_MS", "1000"))
+MIN_UTTERANCE_MS = int(os.getenv("ASR_MIN_UTTERANCE_MS", "1500"))
+MAX_UTTERANCE_MS = int(os.getenv("ASR_MAX_UTTERANCE_MS", "8000"))
+SILENCE_MS = int(os.getenv("ASR_SILENCE_MS", "600"))
+SILENCE_RMS = float(os.getenv("ASR_SILENCE_RMS", "0.01"))
+
+# Pooled mode: one model serves many channels, concurrent requests share forward passes
+BATCHING = os.getenv("ASR_BATCHING", "0") == "1"
+BATCH_MAX = int(os.getenv("ASR_BATCH_MAX", "8"))
+BATCH_WAIT_MS = int(os.getenv("ASR_BATCH_WAIT_MS", "20"))
+
+# Load the model in the background at startup instead of on the first request
+PRELOAD = os.getenv("ASR_PRELOAD", "0") == "1"
+
 app = FastAPI(title=APP_TITLE)
 
 _model = None
@@ -54,11 +77,38 @@ def sanitize_asr_text(text: str | None) -> str:
     return cleaned.strip()
 
 
+def _preload_model() -> None:
+    try:
+        get_model()
+    except Exception:  # noqa: BLE001
+        pass  # reported through /health via _model_error
+
+
+@app.on_event("startup")
+async def start_preload():
+    if PRELOAD:
+        Thread(target=_preload_model, name="asr-preload", daemon=True).start()
+
+
 @app.get("/health")
 async def health():
+    if PRELOAD and _model is None and _model_error is None:
+        # Still loading in the background; don't block the probe on the model lock
+        return JSONResponse(
+            {"ready": False, "model": MODEL_ID, "reason": "loading"},
+            status_code=503,
+        )
     try:
         get_model()
-        return {"ready": True, "model": MODEL_ID}
+        body = {"ready": True, "model": MODEL_ID, "batching": BATCHING}
+        if _batcher is not None:
+            body.update({
+                "batch_queue": _batcher.requests.qsize(),
+                "batches": _batcher.batches,
+                "batched_requests": _batcher.batched_requests,
+                "batch_supported": _batcher.batch_supported,
+            })
+        return body
     except Exception:  # noqa: BLE001
         return JSONResponse(
             {"ready": False, "model": MODEL_ID, "reason": _model_error or "model load failed"},
@@ -117,6 +167,19 @@ async def transcribe_stream(
     if not payload:
         return JSONResponse({"error": "Empty audio payload"}, status_code=400)
 
+    selected_language = language.strip() if isinstance(language, str) else None
+    if _batcher is not None:
+        # Batched path decodes in memory and returns one final line: token partials
+        # cannot be attributed per request inside a shared forward pass.
+        samples = await asyncio.to_thread(decode_file_samples, io.BytesIO(payload))
+        if samples.size == 0:
+            return JSONResponse({"error": "Empty audio payload"}, status_code=400)
+        text = await infer_samples(samples, selected_language or None)
+        return StreamingResponse(
+            iter([json.dumps({"type": "final", "text": text}) + "\n"]),
+            media_type="application/x-ndjson",
+        )
+
     suffix = Path(audio.filename or "audio.ogg").suffix or ".ogg"
     with tempfile.NamedTemporaryFile(prefix="soundcast-segment-", suffix=suffix, delete=False) as tmp:
         tmp_path = Path(tmp.name)
@@ -124,7 +187,6 @@ async def transcribe_stream(
 
     def _generator():
         try:
-            selected_language = language.strip() if isinstance(language, str) else None
             for line in stream_transcription_lines(tmp_path, selected_language or None):
                 yield line
         finally:
@@ -136,6 +198,321 @@ async def transcribe_stream(
     return StreamingResponse(_generator(), media_type="application/x-ndjson")
 
 
+def _chunk_text(chunk) -> str:
+    text = getattr(chunk, "text", None)
+    if text is None and isinstance(chunk, dict):
+        text = chunk.get("text", "")
+    if text is None:
+        text = str(chunk)
+    return str(text)
+
+
+def transcribe_samples(samples: np.ndarray, language: str | None) -> str:
+    """Run one inference over 16 kHz mono float32 samples already in memory."""
+    import mlx.core as mx
+
+    model = get_model()
+    kwargs = {"language": language} if language else {}
+    with _inference_lock:
+        result = model.generate(mx.array(samples), **kwargs)
+    return sanitize_asr_text(_chunk_text(result))
+
+
+class InferenceBatcher:
+    """
+    Continuous batching over one model instance.
+
+    Requests queue up; the worker thread takes whatever arrived within BATCH_WAIT_MS
+    (up to BATCH_MAX), groups it by language and runs each group as one batched
+    generate() call. If the loaded model rejects list input, it falls back to
+    back-to-back calls under a single lock hold.
+    """
+
+    def __init__(self, max_batch: int, wait_ms: int):
+        self.max_batch = max(1, max_batch)
+        self.wait_s = max(0, wait_ms) / 1000.0
+        self.requests: queue.Queue = queue.Queue()
+        self.batch_supported: bool | None = None
+        self.batches = 0
+        self.batched_requests = 0
+        self._thread = Thread(target=self._run, name="asr-batcher", daemon=True)
+        self._thread.start()
+
+    def submit(self, samples: np.ndarray, language: str | None) -> Future:
+        future: Future = Future()
+        self.requests.put((samples, language, future))
+        return future
+
+    def _collect(self) -> list:
+        batch = [self.requests.get()]
+        deadline = time.monotonic() + self.wait_s
+        while len(batch) < self.max_batch:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                break
+            try:
+                batch.append(self.requests.get(timeout=remaining))
+            except queue.Empty:
+                break
+        return batch
+
+    def _infer(self, samples_list: list[np.ndarray], language: str | None) -> list[str]:
+        import mlx.core as mx
+
+        model = get_model()
+        kwargs = {"language": language} if language else {}
+        with _inference_lock:
+            if len(samples_list) > 1 and self.batch_supported is not False:
+                try:
+                    results = model.generate([mx.array(samples) for samples in samples_list], **kwargs)
+                    if isinstance(results, (list, tuple)) and len(results) == len(samples_list):
+                        self.batch_supported = True
+                        return [sanitize_asr_text(_chunk_text(result)) for result in results]
+                except Exception:  # noqa: BLE001
+                    pass
+                self.batch_supported = False
+            return [
+                sanitize_asr_text(_chunk_text(model.generate(mx.array(samples), **kwargs)))
+                for samples in samples_list
+            ]
+
+    def _run(self) -> None:
+        while True:
+            batch = self._collect()
+            groups: dict[str | None, list] = {}
+            for item in batch:
+                groups.setdefault(item[1], []).append(item)
+            for language, items in groups.items():
+                try:
+                    texts = self._infer([item[0] for item in items], language)
+                    for item, text in zip(items, texts):
+                        item[2].set_result(text)
+                except Exception as exc:  # noqa: BLE001
+                    for item in items:
+                        if not item[2].done():
+                            item[2].set_exception(exc)
+                self.batches += 1
+                self.batched_requests += len(items)
+
+
+_batcher: InferenceBatcher | None = InferenceBatcher(BATCH_MAX, BATCH_WAIT_MS) if BATCHING else None
+
+
+async def infer_samples(samples: np.ndarray, language: str | None) -> str:
+    if _batcher is not None:
+        return await asyncio.wrap_future(_batcher.submit(samples, language))
+    return await asyncio.to_thread(transcribe_samples, samples, language)
+
+
+def decode_file_samples(source) -> np.ndarray:
+    """Decode a path or file object (any container/codec PyAV reads) to 16 kHz mono float32."""
+    import av
+
+    resampler = av.AudioResampler(format="flt", layout="mono", rate=INGEST_SAMPLE_RATE)
+    out = []
+    with av.open(str(source) if isinstance(source, Path) else source) as container:
+        for frame in container.decode(audio=0):
+            for resampled in resampler.resample(frame):
+                out.append(resampled.to_ndarray().reshape(-1))
+    if not out:
+        return np.zeros(0, dtype=np.float32)
+    return np.concatenate(out).astype(np.float32, copy=False)
+
+
+class OpusPcmDecoder:
+    """Persistent Opus packet decoder producing 16 kHz mono float32 PCM."""
+
+    def __init__(self, channels: int):
+        import av
+
+        self._av = av
+        self._codec = av.CodecContext.create("opus", "r")
+        self._codec.sample_rate = 48000
+        self._codec.layout = "stereo" if channels > 1 else "mono"
+        self._resampler = av.AudioResampler(format="flt", layout="mono", rate=INGEST_SAMPLE_RATE)
+
+    def decode(self, packet: bytes) -> np.ndarray:
+        out = []
+        for frame in self._codec.decode(self._av.Packet(packet)):
+            for resampled in self._resampler.resample(frame):
+                out.append(resampled.to_ndarray().reshape(-1))
+        if not out:
+            return np.zeros(0, dtype=np.float32)
+        return np.concatenate(out).astype(np.float32, copy=False)
+
+
+class IngestSession:
+    """
+    Rolling utterance buffer for one audio stream.
+
+    Audio accumulates until trailing silence, MAX_UTTERANCE_MS or an explicit flush
+    ends the utterance (a "final"). While it grows, the whole utterance is re-run
+    every PARTIAL_INTERVAL_MS of new audio to produce a "partial".
+    """
+
+    def __init__(self, session_id: str, language: str | None, encoding: str, channels: int):
+        self.session_id = session_id
+        self.language = language
+        self.encoding = encoding
+        self.decoder = OpusPcmDecoder(channels) if encoding == "opus" else None
+        self.chunks: list[np.ndarray] = []
+        self.samples = 0
+        self.start_ms: int | None = None
+        self.last_ms = 0
+        self.samples_at_partial = 0
+        self.silent_samples = 0
+
+    def append(self, timestamp_ms: int, payload: bytes) -> None:
+        if self.decoder is not None:
+            pcm = self.decoder.decode(payload)
+        else:
+            pcm = np.frombuffer(payload, dtype="<i2").astype(np.float32) / 32768.0
+        if pcm.size == 0:
+            return
+        if self.start_ms is None:
+            self.start_ms = timestamp_ms
+        self.last_ms = timestamp_ms + int(pcm.size * 1000 / INGEST_SAMPLE_RATE)
+        self.chunks.append(pcm)
+        self.samples += pcm.size
+
+        rms = float(np.sqrt(np.mean(pcm * pcm)))
+        self.silent_samples = self.silent_samples + pcm.size if rms < SILENCE_RMS else 0
+
+    @property
+    def duration_ms(self) -> int:
+        return int(self.samples * 1000 / INGEST_SAMPLE_RATE)
+
+    def wants_partial(self) -> bool:
+        return (self.samples - self.samples_at_partial) * 1000 >= PARTIAL_INTERVAL_MS * INGEST_SAMPLE_RATE
+
+    def wants_final(self) -> bool:
+        if self.duration_ms >= MAX_UTTERANCE_MS:
+            return True
+        silent_ms = self.silent_samples * 1000 / INGEST_SAMPLE_RATE
+        return self.duration_ms >= MIN_UTTERANCE_MS and silent_ms >= SILENCE_MS
+
+    def take(self) -> tuple[np.ndarray, int, int]:
+        samples = np.concatenate(self.chunks) if self.chunks else np.zeros(0, dtype=np.float32)
+        span = (self.start_ms or 0, self.last_ms)
+        self.chunks = []
+        self.samples = 0
+        self.start_ms = None
+        self.samples_at_partial = 0
+        self.silent_samples = 0
+        return samples, span[0], span[1]
+
+    def snapshot(self) -> np.ndarray:
+        self.samples_at_partial = self.samples
+        return np.concatenate(self.chunks) if self.chunks else np.zeros(0, dtype=np.float32)
+
+
+@app.websocket("/api/v1/ingest")
+async def ingest(websocket: WebSocket):
+    """
+    Streaming ingest: text frame {"type":"start", session_id, language, encoding, channels},
+    then binary frames of <u64 LE timestamp_ms><payload> where payload is one Opus packet
+    (encoding "opus") or 16 kHz mono s16le PCM (encoding "pcm_s16le").
+    {"type":"flush"} closes the current utterance, {"type":"stop"} ends the session.
+    Emits {"type":"partial"|"final", text, start_ms, end_ms}.
+    """
+    await websocket.accept()
+    session: IngestSession | None = None
+    pending_partial: asyncio.Task | None = None
+    # Finals are transcribed in order by final_worker, so audio intake never waits on the model
+    finals: asyncio.Queue = asyncio.Queue()
+
+    async def final_worker() -> None:
+        while True:
+            samples, language, start_ms, end_ms, partial = await finals.get()
+            try:
+                if partial is not None:
+                    # A partial for this utterance goes out before its final
+                    await asyncio.gather(partial, return_exceptions=True)
+                text = await infer_samples(samples, language)
+                await websocket.send_json({"type": "final", "text": text, "start_ms": start_ms, "end_ms": end_ms})
+            except Exception as exc:  # noqa: BLE001
+                try:
+                    await websocket.send_json({"type": "error", "message": str(exc)})
+                except Exception:  # noqa: BLE001
+                    pass  # socket already closed
+            finally:
+                finals.task_done()
+
+    finals_task = asyncio.create_task(final_worker())
+
+    def queue_final() -> None:
+        nonlocal pending_partial
+        samples, start_ms, end_ms = session.take()
+        partial, pending_partial = pending_partial, None
+        if samples.size == 0:
+            return
+        finals.put_nowait((samples, session.language, start_ms, end_ms, partial))
+
+    async def send_partial(samples: np.ndarray, start_ms: int, end_ms: int) -> None:
+        text = await infer_samples(samples, session.language)
+        if text:
+            await websocket.send_json({"type": "partial", "text": text, "start_ms": start_ms, "end_ms": end_ms})
+
+    try:
+        while True:
+            message = await websocket.receive()
+            if message.get("type") == "websocket.disconnect":
+                break
+
+            if message.get("text") is not None:
+                payload = json.loads(message["text"])
+                kind = payload.get("type")
+                if kind == "start":
+                    language = payload.get("language")
+                    language = language.strip() if isinstance(language, str) and language.strip() else None
+                    encoding = payload.get("encoding") or "pcm_s16le"
+                    if encoding not in ("opus", "pcm_s16le"):
+                        await websocket.send_json({"type": "error", "message": f"Unsupported encoding '{encoding}'"})
+                        continue
+                    try:
+                        get_model()
+                        session = IngestSession(
+                            str(payload.get("session_id") or ""),
+                            language,
+                            encoding,
+                            int(payload.get("channels") or 1),
+                        )
+                    except Exception as exc:  # noqa: BLE001
+                        await websocket.send_json({"type": "error", "message": str(exc)})
+                        continue
+                    await websocket.send_json({"type": "started", "session_id": session.session_id})
+                elif kind in ("flush", "stop") and session is not None:
+                    queue_final()
+                    if kind == "stop":
+                        await finals.join()
+                        await websocket.send_json({"type": "stopped", "session_id": session.session_id})
+                        break
+                elif kind == "ping":
+                    await websocket.send_json({"type": "pong"})
+                continue
+
+            data = message.get("bytes")
+            if session is None or not data or len(data) <= 8:
+                continue
+            (timestamp_ms,) = struct.unpack_from("<Q", data, 0)
+            session.append(int(timestamp_ms), data[8:])
+
+            if session.wants_final():
+                queue_final()
+            elif session.wants_partial() and (pending_partial is None or pending_partial.done()):
+                # Partials run in the background and are skipped while one is in flight,
+                # so a slow model never stalls audio intake.
+                pending_partial = asyncio.create_task(
+                    send_partial(session.snapshot(), session.start_ms or 0, session.last_ms)
+                )
+    except WebSocketDisconnect:
+        pass
+    finally:
+        if pending_partial is not None and not pending_partial.done():
+            pending_partial.cancel()
+        finals_task.cancel()
+
+
 @app.get("/")
 async def root():
     return {"name": APP_TITLE, "model": MODEL_ID, "health": "/health"}
@@ -0,0 +1,297 @@
+/* global mediasoupClient, signalingCodec */
+
+/**
+ * Browser side of the SFU benchmark (src/cli/bench-sfu.js).
+ *
+ * Injected into headless Chromium pages after the mediasoup-client bundle. Each page hosts
+ * many simulated clients; every client has its own signaling socket, Device and transport,
+ * so the server sees exactly what it sees from real listeners and publishers.
+ *
+ * Signaling has no request ids, so a request resolves on the next reply with an expected
+ * action (or 'error'). A request without a reply inside the timeout counts as dropped.
+ * With codec 'msgpack' requests go out as binary frames (src/signaling/codec.js).
+ */
+(() => {
+  const clients = new Set();
+  const pendingRtp = new Set(); // listeners waiting for their first RTP packet
+  let pollTimer = null;
+
+  class Signaling {
+    constructor(url, { timeoutMs, codec }) {
+      this.url = url;
+      this.timeoutMs = timeoutMs;
+      this.binary = codec === 'msgpack';
+      this.waiters = [];
+      this.handlers = new Map(); // action -> fn, for unsolicited messages
+      this.stats = { sent: 0, dropped: 0, errors: 0, unexpectedClose: false };
+      this.closing = false;
+    }
+
+    open() {
+      return new Promise((resolve, reject) => {
+        const socket = new WebSocket(this.url);
+        socket.binaryType = 'arraybuffer';
+        this.socket = socket;
+        const timer = setTimeout(() => reject(new Error('websocket open timeout')), this.timeoutMs);
+        socket.onopen = () => {
+          clearTimeout(timer);
+          resolve();
+        };
+        socket.onerror = () => {
+          clearTimeout(timer);
+          reject(new Error('websocket error'));
+        };
+        socket.onclose = () => {
+          if (!this.closing) this.stats.unexpectedClose = true;
+          for (const waiter of this.waiters.splice(0)) waiter.reject(new Error('socket closed'));
+        };
+        socket.onmessage = (event) => this.dispatch(event.data);
+      });
+    }
+
+    dispatch(raw) {
+      let message;
+      try {
+        message = raw instanceof ArrayBuffer ? signalingCodec.decodeMsgpack(new Uint8Array(raw)) : JSON.parse(raw);
+      } catch {
+        return;
+      }
+      // /ws uses `action`, /ws/room/... uses `type`
+      const action = message.action || message.type;
+      const waiter = this.waiters.find(w => w.actions.includes(action) || action === 'error');
+      if (waiter) {
+        this.waiters.splice(this.waiters.indexOf(waiter), 1);
+        clearTimeout(waiter.timer);
+        if (action === 'error') {
+          this.stats.errors += 1;
+          waiter.reject(new Error(message.data?.message || 'error reply'));
+        } else {
+          waiter.resolve({ action, data: message.data });
+        }
+        return;
+      }
+      this.handlers.get(action)?.(message.data);
+    }
+
+    /**
+     * @param {object} message - Sent as JSON or MessagePack
+     * @param {string[]} actions - Replies that complete the request
+     */
+    request(message, actions) {
+      return new Promise((resolve, reject) => {
+        const waiter = { actions, resolve, reject };
+        waiter.timer = setTimeout(() => {
+          this.waiters.splice(this.waiters.indexOf(waiter), 1);
+          this.stats.dropped += 1;
+          reject(new Error(`no ${actions.join('|')} reply`));
+        }, this.timeoutMs);
+        this.waiters.push(waiter);
+        this.stats.sent += 1;
+        this.socket.send(this.binary ? signalingCodec.encodeMsgpack(message) : JSON.stringify(message));
+      });
+    }
+
+    on(action, fn) {
+      this.handlers.set(action, fn);
+    }
+
+    close() {
+      this.closing = true;
+      try {
+        this.socket?.close();
+      } catch { }
+    }
+  }
+
+  async function loadDevice(signaling) {
+    const { data: routerRtpCapabilities } = await signaling.request({ action: 'get-rtpCapabilities' }, ['rtpCapabilities']);
+    const device = new mediasoupClient.Device();
+    await device.load({ routerRtpCapabilities });
+    return device;
+  }
+
+  function schedulePoll(pollMs) {
+    if (pollTimer) return;
+    pollTimer = setInterval(async () => {
+      if (pendingRtp.size === 0) {
+        clearInterval(pollTimer);
+        pollTimer = null;
+        return;
+      }
+      const now = performance.now();
+      await Promise.all([...pendingRtp].map(async (client) => {
+        for (const consumer of client.consumers) {
+          const stats = await consumer.getStats().catch(() => null);
+          if (!stats) continue;
+          for (const report of stats.values()) {
+            if (report.type === 'inbound-rtp' && report.packetsReceived > 0) {
+              if (pendingRtp.delete(client)) client.onFirstRtp(now);
+              return;
+            }
+          }
+        }
+      }));
+    }, pollMs);
+  }
+
+  async function consumeAll(client, consumersData) {
+    const list = Array.isArray(consumersData) ? consumersData : [consumersData];
+    for (const { id, producerId, kind, rtpParameters } of list) {
+      const consumer = await client.transport.consume({ id, producerId, kind, rtpParameters });
+      client.consumers.push(consumer);
+    }
+  }
+
+  async function runListener(options) {
+    const { sfuUrl, roomUrl, channelId, joinMode, codec, timeoutMs, pollMs } = options;
+    const client = { consumers: [], sockets: [], result: { channelId } };
+    clients.add(client);
+    const startedAt = performance.now();
+    const since = () => Math.round(performance.now() - startedAt);
+
+    try {
+      // Room listeners fetch their config first, as room-listen.html does
+      let channel = channelId;
+      if (roomUrl) {
+        const room = new Signaling(roomUrl, { timeoutMs, codec });
+        client.sockets.push(room);
+        await room.open();
+        const { data: config } = await room.request({ type: 'get-config' }, ['config']);
+        client.result.configMs = since();
+        if (!channel) {
+          const names = config.channels || [];
+          if (names.length === 0) throw new Error('room has no channels');
+          channel = `${config.roomSlug}:${names[options.index % names.length]}`;
+          client.result.channelId = channel;
+        }
+      }
+
+      const signaling = new Signaling(sfuUrl, { timeoutMs, codec });
+      client.sockets.push(signaling);
+      await signaling.open();
+      const device = await loadDevice(signaling);
+
+      const firstRtp = new Promise((resolve) => {
+        client.onFirstRtp = resolve;
+      });
+      const attachTransport = (params) => {
+        client.transport = device.createRecvTransport(params);
+        client.transport.on('connect', ({ dtlsParameters }, callback, errback) => {
+          signaling.request({ action: 'connect-listener-transport', data: { dtlsParameters } }, ['listener-transport-connected'])
+            .then(() => callback(), errback);
+        });
+        client.transport.on('connectionstatechange', (state) => {
+          if (state === 'connected' && client.result.connectedMs == null) client.result.connectedMs = since();
+        });
+      };
+      // Producers that start after the join arrive as unsolicited consumer-created messages
+      signaling.on('consumer-created', (data) => {
+        if (client.transport) consumeAll(client, data).catch(() => { });
+      });
+
+      if (joinMode === 'legacy') {
+        const { data: params } = await signaling.request(
+          { action: 'create-listener-transport', data: { channelId: channel, displayName: 'bench' } },
+          ['listener-transport-created']
+        );
+        attachTransport(params);
+        const reply = await signaling.request(
+          { action: 'consume-audio', data: { rtpCapabilities: device.rtpCapabilities } },
+          ['consumer-created', 'waiting-for-publisher']
+        );
+        client.result.signalingMs = since();
+        if (reply.action === 'consumer-created') await consumeAll(client, reply.data);
+      } else {
+        const { data: joined } = await signaling.request(
+          { action: 'join-listener', data: { channelId: channel, rtpCapabilities: device.rtpCapabilities, displayName: 'bench' } },
+          ['listener-joined']
+        );
+        client.result.signalingMs = since();
+        attachTransport(joined.transport);
+        await consumeAll(client, joined.consumers);
+      }
+
+      pendingRtp.add(client);
+      schedulePoll(pollMs);
+      const rtpTimeout = new Promise((resolve) => setTimeout(() => resolve(null), timeoutMs));
+      const firstRtpAt = await Promise.race([firstRtp, rtpTimeout]);
+      pendingRtp.delete(client);
+      if (firstRtpAt == null) throw new Error('no RTP');
+      client.result.firstRtpMs = Math.round(firstRtpAt - startedAt);
+      client.result.ok = true;
+    } catch (error) {
+      client.result.ok = false;
+      client.result.error = error.message;
+    }
+
+    client.result.signaling = client.sockets.reduce((total, { stats }) => ({
+      sent: total.sent + stats.sent,
+      dropped: total.dropped + stats.dropped,
+      errors: total.errors + stats.errors,
+      unexpectedClose: total.unexpectedClose || stats.unexpectedClose
+    }), { sent: 0, dropped: 0, errors: 0, unexpectedClose: false });
+    return client.result;
+  }
+
+  async function runPublisher({ sfuUrl, codec, channelId, index, timeoutMs, frequency }) {
+    const client = { consumers: [], sockets: [], result: { channelId } };
+    clients.add(client);
+    const signaling = new Signaling(sfuUrl, { timeoutMs, codec });
+    client.sockets.push(signaling);
+
+    try {
+      await signaling.open();
+      const device = await loadDevice(signaling);
+      const { data: params } = await signaling.request({
+        action: 'create-publisher-transport',
+        data: { channelId, publisherName: `bench-publisher-${index}`, publisherId: `bench-publisher-${index}` }
+      }, ['publisher-transport-created']);
+
+      client.transport = device.createSendTransport(params);
+      client.transport.on('connect', ({ dtlsParameters }, callback, errback) => {
+        signaling.request({ action: 'connect-publisher-transport', data: { dtlsParameters } }, ['publisher-transport-connected'])
+          .then(() => callback(), errback);
+      });
+      client.transport.on('produce', ({ kind, rtpParameters }, callback, errback) => {
+        signaling.request({ action: 'produce-audio', data: { kind, rtpParameters } }, ['produced'])
+          .then(({ data }) => callback({ id: data.id }), errback);
+      });
+
+      // A tone keeps Opus out of DTX so listeners see steady RTP
+      client.audioContext = new AudioContext();
+      const oscillator = client.audioContext.createOscillator();
+      oscillator.frequency.value = frequency;
+      const destination = client.audioContext.createMediaStreamDestination();
+      oscillator.connect(destination);
+      oscillator.start();
+      const [track] = destination.stream.getAudioTracks();
+
+      client.producer = await client.transport.produce({ track });
+      client.result.ok = true;
+    } catch (error) {
+      client.result.ok = false;
+      client.result.error = error.message;
+    }
+    client.result.signaling = { ...signaling.stats };
+    return client.result;
+  }
+
+  function closeAll() {
+    for (const client of clients) {
+      try {
+        client.producer?.close();
+        client.transport?.close();
+        client.audioContext?.close();
+      } catch { }
+      for (const socket of client.sockets) socket.close();
+    }
+    clients.clear();
+    pendingRtp.clear();
+  }
+
+  window.sfuBench = {
+    runListeners: (options, listeners) => Promise.all(listeners.map(listener => runListener({ ...options, ...listener }))),
+    runPublisher,
+    closeAll
+  };
+})();
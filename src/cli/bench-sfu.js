@@ -0,0 +1,291 @@
+#!/usr/bin/env node
+
+/**
+ * SFU load benchmark: N publishers and M listeners joining in bursts
+ *
+ * Clients run in headless Chromium (Playwright) with the same mediasoup-client bundle the
+ * web UI uses, so every listener does real ICE/DTLS and receives real RTP. Works against
+ * the main server (/ws, plus /ws/room/:slug/listen with --room) and the standalone SFU.
+ *
+ * Usage:
+ *   npm run bench:sfu -- --listeners 500 --burst 50 --server-pid $(pgrep -f src/server.js)
+ *   npm run bench:sfu -- --room demo --listeners 200
+ *   npm run bench:sfu -- --sfu ws://127.0.0.1:8080 --server-pid $(pgrep -f sfu-server.js)
+ *   npm run bench:sfu -- --codec msgpack --listeners 500
+ *
+ * Reports time-to-first-RTP percentiles, server CPU per 1k listeners, server memory per
+ * listener and dropped signaling messages. CPU and memory need --server-pid; the process
+ * and its children (mediasoup workers) are sampled.
+ */
+
+import fs from 'fs';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { describe, sampleProcessTree } from './process-stats.js';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const BUNDLE_PATH = path.join(__dirname, '..', 'public', 'js', 'bundles', 'mediasoup-client.js');
+const CLIENT_PATH = path.join(__dirname, 'bench-sfu-client.js');
+const CODEC_PATH = path.join(__dirname, '..', 'signaling', 'codec.js');
+
+const args = process.argv.slice(2);
+const config = {
+  // Media signaling endpoint: main server /ws or a standalone SFU
+  sfuUrl: getArg('--sfu') || process.env.BENCH_SFU_URL || 'ws://127.0.0.1:3000/ws',
+  // Main server, for /ws/room/:slug/listen when --room is set
+  serverUrl: getArg('--server') || process.env.BENCH_SERVER_URL || 'http://127.0.0.1:3000',
+  room: getArg('--room') || null,
+  channels: (getArg('--channels') || '').split(',').map(name => name.trim()).filter(Boolean),
+  publishers: parseInt(getArg('--publishers') || '1'),
+  listeners: parseInt(getArg('--listeners') || '100'),
+  // Listeners per burst and pause between bursts
+  burst: parseInt(getArg('--burst') || '50'),
+  burstIntervalMs: parseInt(getArg('--burst-interval-ms') || '1000'),
+  // 'join' = single join-listener round trip, 'legacy' = create/connect/consume
+  joinMode: getArg('--join-mode') || 'join',
+  // Signaling codec on the main server: 'json' or 'msgpack' (binary frames)
+  codec: getArg('--codec') || 'json',
+  // Clients per Chromium page (each is a renderer process)
+  perPage: parseInt(getArg('--per-page') || '100'),
+  timeoutMs: parseInt(getArg('--timeout-ms') || '15000'),
+  pollMs: parseInt(getArg('--poll-ms') || '50'),
+  // Seconds of publisher-only baseline and of steady state with every listener joined
+  baselineS: parseInt(getArg('--baseline-s') || '5'),
+  steadyS: parseInt(getArg('--steady-s') || '10'),
+  serverPid: parseInt(getArg('--server-pid') || '0') || null,
+  jsonOut: getArg('--json') || null,
+  headed: args.includes('--headed')
+};
+
+function withCodec(url) {
+  if (config.codec === 'json') return url;
+  return `${url}${url.includes('?') ? '&' : '?'}codec=${encodeURIComponent(config.codec)}`;
+}
+
+function getArg(name) {
+  const index = args.indexOf(name);
+  return index !== -1 && args[index + 1] ? args[index + 1] : null;
+}
+
+const sleep = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+async function measureWindow(seconds) {
+  if (!config.serverPid) {
+    await sleep(seconds * 1000);
+    return null;
+  }
+  const start = await sampleProcessTree(config.serverPid);
+  await sleep(seconds * 1000);
+  const end = await sampleProcessTree(config.serverPid);
+  const wallSeconds = (end.at - start.at) / 1000;
+  return {
+    cpuPercent: ((end.cpuSeconds - start.cpuSeconds) / wallSeconds) * 100,
+    rssBytes: end.rssBytes
+  };
+}
+
+function channelIdFor(index, channelNames) {
+  if (channelNames.length === 0) return null;
+  const name = channelNames[index % channelNames.length];
+  return config.room ? `${config.room}:${name}` : name;
+}
+
+async function loadPlaywright() {
+  try {
+    return await import('playwright');
+  } catch {
+    console.error('❌ playwright is required: npm install && npx playwright install chromium');
+    process.exit(1);
+  }
+}
+
+async function main() {
+  if (!fs.existsSync(BUNDLE_PATH)) {
+    console.error(`❌ ${BUNDLE_PATH} missing; run npm run bundle`);
+    process.exit(1);
+  }
+
+  // Room mode can take its channels from the room config; plain /ws needs a channel name
+  const channelNames = config.channels.length > 0 || config.room ? config.channels : ['bench'];
+  if (config.publishers > 0 && channelNames.length === 0) {
+    console.error('❌ --channels is required with --room when --publishers > 0');
+    process.exit(1);
+  }
+
+  const roomUrl = config.room
+    ? withCodec(`${config.serverUrl.replace(/^http/, 'ws')}/ws/room/${encodeURIComponent(config.room)}/listen`)
+    : null;
+  const sfuUrl = withCodec(config.sfuUrl);
+
+  console.log('🏁 Soundcast SFU benchmark');
+  console.log(`SFU: ${config.sfuUrl}${roomUrl ? ` (room config: ${roomUrl})` : ''}`);
+  console.log(`Publishers: ${config.publishers}, listeners: ${config.listeners} in bursts of ${config.burst} every ${config.burstIntervalMs} ms (${config.joinMode}, ${config.codec})`);
+  if (!config.serverPid) {
+    console.log('ℹ️  No --server-pid: CPU and memory are not reported');
+  }
+
+  const { chromium } = await loadPlaywright();
+  const browser = await chromium.launch({
+    headless: !config.headed,
+    args: ['--autoplay-policy=no-user-gesture-required', '--disable-features=WebRtcHideLocalIpsWithMdns']
+  });
+
+  const codecSource = fs.readFileSync(CODEC_PATH, 'utf8');
+  const pages = [];
+  const newPage = async () => {
+    const page = await browser.newPage();
+    await page.addScriptTag({ path: BUNDLE_PATH, type: 'module' });
+    await page.waitForFunction(() => window.mediasoupClient);
+    await page.addScriptTag({ content: `${codecSource}\nwindow.signalingCodec = { encodeMsgpack, decodeMsgpack };`, type: 'module' });
+    await page.waitForFunction(() => window.signalingCodec);
+    await page.addScriptTag({ path: CLIENT_PATH });
+    pages.push(page);
+    return page;
+  };
+
+  try {
+    // Publishers
+    const publisherPage = await newPage();
+    const publisherResults = [];
+    for (let index = 0; index < config.publishers; index++) {
+      publisherResults.push(await publisherPage.evaluate(
+        (options) => window.sfuBench.runPublisher(options),
+        {
+          sfuUrl,
+          codec: config.codec,
+          channelId: channelIdFor(index, channelNames),
+          index,
+          timeoutMs: config.timeoutMs,
+          frequency: 220 + index * 20
+        }
+      ));
+    }
+    const failedPublishers = publisherResults.filter(result => !result.ok);
+    console.log(`🎤 ${publisherResults.length - failedPublishers.length}/${publisherResults.length} publishers producing`);
+    for (const result of failedPublishers) console.log(`   ${result.channelId}: ${result.error}`);
+
+    const baseline = await measureWindow(config.baselineS);
+
+    // Listener bursts; each page takes up to perPage listeners
+    const listenerPages = [];
+    for (let i = 0; i < Math.ceil(config.listeners / config.perPage); i++) {
+      listenerPages.push(await newPage());
+    }
+
+    const storm = [];
+    const stormStartedAt = Date.now();
+    for (let start = 0; start < config.listeners; start += config.burst) {
+      const byPage = new Map();
+      for (let index = start; index < Math.min(start + config.burst, config.listeners); index++) {
+        const page = listenerPages[Math.floor(index / config.perPage)];
+        if (!byPage.has(page)) byPage.set(page, []);
+        byPage.get(page).push(index);
+      }
+      for (const [page, indexes] of byPage) {
+        storm.push(page.evaluate(
+          ({ options, listeners }) => window.sfuBench.runListeners(options, listeners),
+          {
+            options: {
+              sfuUrl,
+              roomUrl,
+              codec: config.codec,
+              joinMode: config.joinMode,
+              timeoutMs: config.timeoutMs,
+              pollMs: config.pollMs
+            },
+            // Without --channels, room listeners pick a channel from the room config by index
+            listeners: indexes.map(index => ({ index, channelId: channelIdFor(index, channelNames) }))
+          }
+        ));
+      }
+      if (start + config.burst < config.listeners) await sleep(config.burstIntervalMs);
+    }
+    const listenerResults = (await Promise.all(storm)).flat();
+    const stormSeconds = (Date.now() - stormStartedAt) / 1000;
+
+    const steady = await measureWindow(config.steadyS);
+    const report = buildReport({ publisherResults, listenerResults, baseline, steady, stormSeconds });
+    printReport(report);
+    if (config.jsonOut) {
+      fs.writeFileSync(config.jsonOut, JSON.stringify({ config, ...report }, null, 2));
+      console.log(`📝 Wrote ${config.jsonOut}`);
+    }
+  } finally {
+    await Promise.all(pages.map(page => page.evaluate(() => window.sfuBench?.closeAll()).catch(() => { })));
+    await browser.close();
+  }
+}
+
+function buildReport({ publisherResults, listenerResults, baseline, steady, stormSeconds }) {
+  const joined = listenerResults.filter(result => result.ok);
+  const signaling = listenerResults.concat(publisherResults).reduce((total, { signaling: stats }) => ({
+    sent: total.sent + (stats?.sent || 0),
+    dropped: total.dropped + (stats?.dropped || 0),
+    errors: total.errors + (stats?.errors || 0),
+    unexpectedCloses: total.unexpectedCloses + (stats?.unexpectedClose ? 1 : 0)
+  }), { sent: 0, dropped: 0, errors: 0, unexpectedCloses: 0 });
+
+  const failures = {};
+  for (const result of listenerResults) {
+    if (!result.ok) failures[result.error] = (failures[result.error] || 0) + 1;
+  }
+
+  let server = null;
+  if (baseline && steady) {
+    const cpuDelta = steady.cpuPercent - baseline.cpuPercent;
+    const rssDelta = steady.rssBytes - baseline.rssBytes;
+    server = {
+      baselineCpuPercent: baseline.cpuPercent,
+      steadyCpuPercent: steady.cpuPercent,
+      cpuPercentPer1kListeners: joined.length > 0 ? (cpuDelta / joined.length) * 1000 : null,
+      baselineRssBytes: baseline.rssBytes,
+      steadyRssBytes: steady.rssBytes,
+      rssBytesPerListener: joined.length > 0 ? rssDelta / joined.length : null
+    };
+  }
+
+  return {
+    publishers: { total: publisherResults.length, ok: publisherResults.filter(result => result.ok).length },
+    listeners: { total: listenerResults.length, ok: joined.length, failures, stormSeconds },
+    timeToFirstRtpMs: describe(joined.map(result => result.firstRtpMs)),
+    signalingMs: describe(listenerResults.map(result => result.signalingMs)),
+    iceDtlsConnectedMs: describe(listenerResults.map(result => result.connectedMs)),
+    roomConfigMs: describe(listenerResults.map(result => result.configMs)),
+    signaling,
+    server
+  };
+}
+
+function printReport(report) {
+  const row = (label, stats) => {
+    if (stats.count === 0) return;
+    console.log(`   ${label.padEnd(22)} p50 ${stats.p50} ms  p90 ${stats.p90} ms  p99 ${stats.p99} ms  max ${stats.max} ms  (n=${stats.count})`);
+  };
+  const mb = (bytes) => `${(bytes / 1024 / 1024).toFixed(1)} MB`;
+
+  console.log('\n📊 Results');
+  console.log(`   Listeners receiving RTP: ${report.listeners.ok}/${report.listeners.total} (storm ${report.listeners.stormSeconds.toFixed(1)} s)`);
+  for (const [reason, count] of Object.entries(report.listeners.failures)) {
+    console.log(`   ❌ ${count} × ${reason}`);
+  }
+  row('time to first RTP', report.timeToFirstRtpMs);
+  row('join signaling', report.signalingMs);
+  row('ICE+DTLS connected', report.iceDtlsConnectedMs);
+  row('room config', report.roomConfigMs);
+
+  const { signaling } = report;
+  console.log(`   Signaling: ${signaling.sent} requests, ${signaling.dropped} dropped, ${signaling.errors} error replies, ${signaling.unexpectedCloses} sockets closed by server`);
+
+  if (report.server) {
+    const { server } = report;
+    console.log(`   Server CPU: ${server.baselineCpuPercent.toFixed(1)}% baseline → ${server.steadyCpuPercent.toFixed(1)}% steady` +
+      (server.cpuPercentPer1kListeners != null ? ` (${server.cpuPercentPer1kListeners.toFixed(1)}% per 1k listeners)` : ''));
+    console.log(`   Server RSS: ${mb(server.baselineRssBytes)} → ${mb(server.steadyRssBytes)}` +
+      (server.rssBytesPerListener != null ? ` (${(server.rssBytesPerListener / 1024).toFixed(1)} KB per listener)` : ''));
+  }
+}
+
+main().catch((error) => {
+  console.error('❌ Benchmark failed:', error);
+  process.exit(1);
+});
@@ -0,0 +1,389 @@
+#!/usr/bin/env node
+
+/**
+ * Transcription replay benchmark
+ *
+ * Replays the Ogg segments of an existing recording folder through TranscriptionRuntime and
+ * its ASR sidecars, as if the recorder were closing them live, at 1× or faster. Runs on a
+ * scratch database and recording directory, so a production install is never touched.
+ *
+ * Usage:
+ *   npm run bench:transcription -- --recording recordings/<folder>
+ *   npm run bench:transcription -- --recording recordings/<folder> --speed 4 --concurrency 1,2,4,8
+ *   npm run bench:transcription -- --recording recordings/<folder> --ingest poll --poll-interval-ms 2000
+ *   npm run bench:transcription -- --recording recordings/<folder> --sidecar-mode pooled --pool-size 2
+ *
+ * For each concurrency level (number of channels replayed at once; the recording's tracks are
+ * reused round-robin) it reports caption latency from segment close, real-time factor per
+ * channel, sidecar memory, and how the backlog (queued + in-flight segments) grows.
+ */
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { EventEmitter } from 'events';
+import { performance } from 'perf_hooks';
+import { setTimeout as sleep } from 'timers/promises';
+import { getOggOpusDurationMs } from '../recording/ogg.js';
+import { describe, sampleProcessTrees } from './process-stats.js';
+
+const args = process.argv.slice(2);
+const config = {
+  recording: getArg('--recording'),
+  speed: parseFloat(getArg('--speed') || '1'),
+  concurrency: (getArg('--concurrency') || '1').split(',').map(value => parseInt(value)).filter(value => value > 0),
+  // 'push' emits segment-closed like the native muxer; 'poll' leaves discovery to the directory scan
+  ingest: getArg('--ingest') === 'poll' ? 'poll' : 'push',
+  maxSegments: parseInt(getArg('--max-segments') || '0') || Infinity,
+  drainTimeoutS: parseInt(getArg('--drain-timeout-s') || '120'),
+  sampleMs: parseInt(getArg('--sample-ms') || '1000'),
+  jsonOut: getArg('--json') || null,
+  verbose: args.includes('--verbose')
+};
+
+// Runtime knobs under test; runtime.js reads them from the environment when it is loaded
+const ENV_FLAGS = {
+  '--model': 'TRANSCRIPTION_MODEL',
+  '--poll-interval-ms': 'TRANSCRIPTION_POLL_INTERVAL_MS',
+  '--sidecar-mode': 'TRANSCRIPTION_SIDECAR_MODE',
+  '--pool-size': 'TRANSCRIPTION_SIDECAR_POOL_SIZE',
+  '--max-sidecars': 'TRANSCRIPTION_MAX_SIDECAR_INSTANCES',
+  '--max-inflight': 'TRANSCRIPTION_MAX_INFLIGHT_PER_SIDECAR',
+  '--max-backlog': 'TRANSCRIPTION_MAX_STREAM_BACKLOG'
+};
+
+function getArg(name) {
+  const index = args.indexOf(name);
+  return index !== -1 && args[index + 1] ? args[index + 1] : null;
+}
+
+// Least-squares slope of `value` over `at` (ms), per minute
+function slopePerMinute(samples) {
+  if (samples.length < 2) return 0;
+  const n = samples.length;
+  const meanX = samples.reduce((sum, s) => sum + s.at, 0) / n;
+  const meanY = samples.reduce((sum, s) => sum + s.value, 0) / n;
+  let num = 0;
+  let den = 0;
+  for (const s of samples) {
+    num += (s.at - meanX) * (s.value - meanY);
+    den += (s.at - meanX) ** 2;
+  }
+  return den === 0 ? 0 : (num / den) * 60000;
+}
+
+/**
+ * Source tracks of a recording folder: one per `<channel>/<base>_NNN.ogg` series.
+ */
+function loadSourceTracks(recordingPath) {
+  const tracks = [];
+  for (const channelDir of fs.readdirSync(recordingPath, { withFileTypes: true })) {
+    if (!channelDir.isDirectory()) continue;
+    const dir = path.join(recordingPath, channelDir.name);
+    const series = new Map(); // base -> [filename]
+    for (const file of fs.readdirSync(dir).sort()) {
+      const match = file.match(/^(.*)_(\d{3})\.ogg$/);
+      if (!match) continue;
+      if (!series.has(match[1])) series.set(match[1], []);
+      series.get(match[1]).push(file);
+    }
+    for (const [base, files] of series) {
+      const segments = files.slice(0, config.maxSegments).map((file) => {
+        const filePath = path.join(dir, file);
+        return { file, filePath, durationMs: getOggOpusDurationMs(fs.readFileSync(filePath)) };
+      }).filter(segment => segment.durationMs > 0);
+      if (segments.length > 0) tracks.push({ channelName: channelDir.name, base, segments });
+    }
+  }
+  return tracks;
+}
+
+const logger = {
+  debug() { },
+  info: (...items) => config.verbose && console.log(...items),
+  warn: (...items) => config.verbose && console.warn(...items),
+  error: (...items) => console.error(...items)
+};
+
+async function main() {
+  if (!config.recording || !fs.existsSync(config.recording)) {
+    console.error('Usage: npm run bench:transcription -- --recording recordings/<folder> [--speed 4] [--concurrency 1,2,4]');
+    process.exit(1);
+  }
+  const sourceTracks = loadSourceTracks(config.recording);
+  if (sourceTracks.length === 0) {
+    console.error(`❌ No <channel>/<name>_NNN.ogg segments in ${config.recording}`);
+    process.exit(1);
+  }
+
+  const scratchDir = fs.mkdtempSync(path.join(os.tmpdir(), 'soundcast-replay-'));
+  process.env.RECORDING_DIR = path.join(scratchDir, 'recordings');
+  for (const [flag, envName] of Object.entries(ENV_FLAGS)) {
+    const value = getArg(flag);
+    if (value) process.env[envName] = value;
+  }
+  fs.mkdirSync(process.env.RECORDING_DIR, { recursive: true });
+
+  // Loaded after the environment is set
+  const { initDatabase, closeDatabase } = await import('../db/database.js');
+  const { startDbWriter, stopDbWriter } = await import('../db/writer.js');
+  const { createTenant } = await import('../db/models/tenant.js');
+  const { createRoom, getRoomById, getRoomBySlug, listRoomsByTenant } = await import('../db/models/room.js');
+  const { createRecording } = await import('../db/models/recording.js');
+  const { TranscriptionRuntime } = await import('../transcription/runtime.js');
+
+  const dbPath = path.join(scratchDir, 'replay.db');
+  initDatabase(dbPath);
+  startDbWriter(dbPath, { logger });
+  const tenant = createTenant('replay', `replay-${Date.now()}`);
+  const room = createRoom({ tenant_id: tenant.id, name: 'Replay', slug: 'replay' });
+
+  const segmentEvents = config.ingest === 'push' ? new EventEmitter() : null;
+  const runtime = new TranscriptionRuntime({
+    fastify: { log: logger },
+    verifyPublisherToken: () => null,
+    verifyTenantApiKey: () => null,
+    getRoomBySlug,
+    getRoomById,
+    listRoomsByTenant,
+    segmentEvents
+  });
+
+  // Per segment file: { closedAt, sidecarMs, ok, completedAt, captionAt }
+  const timings = new Map();
+  const transcribeFile = runtime.transcribeFile.bind(runtime);
+  runtime.transcribeFile = async (filePath, options) => {
+    const timing = timings.get(filePath);
+    const startedAt = performance.now();
+    try {
+      const text = await transcribeFile(filePath, options);
+      if (timing) Object.assign(timing, { ok: true, sidecarMs: performance.now() - startedAt, completedAt: performance.now() });
+      return text;
+    } catch (error) {
+      if (timing) Object.assign(timing, { ok: false, error: error.message, completedAt: performance.now() });
+      throw error;
+    }
+  };
+  const recordTranscriptText = runtime.recordTranscriptText.bind(runtime);
+  runtime.recordTranscriptText = async (session, streamState, result) => {
+    const timing = result.segmentFile && timings.get(path.join(session.recordingFolderPath, result.segmentFile));
+    if (timing) timing.captionAt = performance.now();
+    return recordTranscriptText(session, streamState, result);
+  };
+
+  const mode = process.env.TRANSCRIPTION_SIDECAR_MODE === 'pooled' ? 'pooled' : 'per-channel';
+  console.log('🏁 Soundcast transcription replay');
+  console.log(`Recording: ${config.recording} (${sourceTracks.length} track(s))`);
+  console.log(`Speed: ${config.speed}×, ingest: ${config.ingest}, sidecars: ${mode}` +
+    (config.ingest === 'poll' ? `, poll every ${process.env.TRANSCRIPTION_POLL_INTERVAL_MS || 5000} ms` : ''));
+
+  const steps = [];
+  try {
+    for (const concurrency of config.concurrency) {
+      const step = await runStep({ runtime, room, segmentEvents, sourceTracks, concurrency, timings, createRecording });
+      printStep(step);
+      steps.push(step);
+    }
+  } finally {
+    await runtime.shutdown();
+    await stopDbWriter();
+    closeDatabase();
+    fs.rmSync(scratchDir, { recursive: true, force: true });
+  }
+
+  if (config.jsonOut) {
+    fs.writeFileSync(config.jsonOut, JSON.stringify({ config, env: Object.fromEntries(Object.values(ENV_FLAGS).map(name => [name, process.env[name] || null])), steps }, null, 2));
+    console.log(`📝 Wrote ${config.jsonOut}`);
+  }
+}
+
+async function runStep({ runtime, room, segmentEvents, sourceTracks, concurrency, timings, createRecording }) {
+  const folderName = `replay-${concurrency}-${Date.now()}`;
+  const folderPath = path.join(process.env.RECORDING_DIR, folderName);
+  const recording = createRecording(room.id, folderName);
+
+  // Channel k replays source track k mod n under its own name, so it gets its own sidecar slot
+  const streams = [];
+  for (let k = 0; k < concurrency; k++) {
+    const source = sourceTracks[k % sourceTracks.length];
+    const channelName = concurrency > 1 ? `${source.channelName}-${k + 1}` : source.channelName;
+    const dir = path.join(folderPath, channelName);
+    fs.mkdirSync(dir, { recursive: true });
+    streams.push({
+      channelName,
+      producerId: `replay-${k + 1}`,
+      segmentPattern: path.join(dir, `${source.base}_%03d.ogg`),
+      dir,
+      source
+    });
+  }
+
+  const setupStartedAt = performance.now();
+  await runtime.startRoomSession({
+    roomId: room.id,
+    roomSlug: room.slug,
+    recordingId: recording.id,
+    folderName,
+    eventName: `replay ×${concurrency}`,
+    modelName: process.env.TRANSCRIPTION_MODEL || undefined,
+    initialTracks: streams.map(stream => ({
+      producerId: stream.producerId,
+      channelName: stream.channelName,
+      producerName: stream.source.base,
+      segmentPattern: stream.segmentPattern
+    }))
+  });
+  const setupMs = performance.now() - setupStartedAt;
+  const session = runtime.sessions.get(room.id);
+
+  // Segment close schedule: each segment closes once its audio has "played" at the replay speed
+  const events = [];
+  for (const stream of streams) {
+    let offsetMs = 0;
+    for (const segment of stream.source.segments) {
+      offsetMs += segment.durationMs / config.speed;
+      events.push({ at: offsetMs, stream, segment });
+    }
+  }
+  events.sort((a, b) => a.at - b.at);
+
+  const sidecarPids = () => [...runtime.sidecarInstances.values()].map(instance => instance.process?.pid).filter(Boolean);
+  const backlog = [];
+  let peakSidecarRss = 0;
+  const peakRssByPid = new Map();
+  const expected = new Set();
+  const sampler = setInterval(async () => {
+    const { queueDepth, inFlight } = runtime.getMetricsSnapshot();
+    // Closed but not yet transcribed, dropped or failed
+    let pending = 0;
+    for (const filePath of expected) {
+      const timing = timings.get(filePath);
+      if (!timing.completedAt && !isAccounted(session, filePath)) pending += 1;
+    }
+    backlog.push({ at: performance.now(), queueDepth, inFlight, value: pending });
+
+    try {
+      const trees = await sampleProcessTrees(sidecarPids());
+      let total = 0;
+      for (const [pid, { rssBytes }] of trees) {
+        total += rssBytes;
+        peakRssByPid.set(pid, Math.max(peakRssByPid.get(pid) || 0, rssBytes));
+      }
+      peakSidecarRss = Math.max(peakSidecarRss, total);
+    } catch { }
+  }, config.sampleMs);
+
+  // Feed
+  const feedStartedAt = performance.now();
+  for (const event of events) {
+    const delay = feedStartedAt + event.at - performance.now();
+    if (delay > 0) await sleep(delay);
+    const { stream, segment } = event;
+    const filePath = path.join(stream.dir, segment.file);
+    await fs.promises.copyFile(segment.filePath, filePath);
+    timings.set(filePath, { channelName: stream.channelName, durationMs: segment.durationMs, closedAt: performance.now() });
+    expected.add(filePath);
+    if (segmentEvents) {
+      const index = parseInt(segment.file.match(/_(\d{3})\.ogg$/)[1]);
+      segmentEvents.emit('segment-closed', {
+        roomId: room.id,
+        producerId: stream.producerId,
+        segmentPattern: stream.segmentPattern,
+        filePath,
+        segmentIndex: index,
+        durationMs: Math.round(segment.durationMs)
+      });
+    }
+  }
+  const feedEndedAt = performance.now();
+
+  // Drain: every segment transcribed, failed or dropped
+  const drainDeadline = feedEndedAt + config.drainTimeoutS * 1000;
+  while (performance.now() < drainDeadline) {
+    if ([...expected].every(filePath => timings.get(filePath).completedAt || isAccounted(session, filePath))) break;
+    await sleep(200);
+  }
+  const drainMs = performance.now() - feedEndedAt;
+  clearInterval(sampler);
+
+  const dropped = new Map();
+  for (const stream of session.streams.values()) dropped.set(stream.channelName, stream.droppedSegments);
+  await runtime.stopRoomSession(room.id);
+
+  // Per-channel results
+  const channels = streams.map((stream) => {
+    const rows = [...expected].filter(filePath => timings.get(filePath).channelName === stream.channelName).map(filePath => timings.get(filePath));
+    const transcribed = rows.filter(row => row.ok);
+    const audioMs = transcribed.reduce((sum, row) => sum + row.durationMs, 0);
+    const sidecarMs = transcribed.reduce((sum, row) => sum + row.sidecarMs, 0);
+    return {
+      channelName: stream.channelName,
+      segments: rows.length,
+      transcribed: transcribed.length,
+      errors: rows.filter(row => row.ok === false).length,
+      dropped: dropped.get(stream.channelName) || 0,
+      unfinished: rows.filter(row => !row.completedAt).length - (dropped.get(stream.channelName) || 0),
+      realTimeFactor: audioMs > 0 ? sidecarMs / audioMs : null,
+      captionLatencyMs: describe(rows.map(row => (row.captionAt ? row.captionAt - row.closedAt : null)))
+    };
+  });
+
+  const rows = [...expected].map(filePath => timings.get(filePath));
+  const feedBacklog = backlog.filter(sample => sample.at <= feedEndedAt);
+  for (const filePath of expected) timings.delete(filePath);
+
+  return {
+    concurrency,
+    sidecarMode: process.env.TRANSCRIPTION_SIDECAR_MODE === 'pooled' ? 'pooled' : 'per-channel',
+    setupMs: Math.round(setupMs),
+    feedSeconds: (feedEndedAt - feedStartedAt) / 1000,
+    drainSeconds: drainMs / 1000,
+    captionLatencyMs: describe(rows.map(row => (row.captionAt ? Math.round(row.captionAt - row.closedAt) : null))),
+    completionLatencyMs: describe(rows.map(row => (row.completedAt ? Math.round(row.completedAt - row.closedAt) : null))),
+    channels,
+    backlog: {
+      maxPending: backlog.reduce((max, sample) => Math.max(max, sample.value), 0),
+      maxQueueDepth: backlog.reduce((max, sample) => Math.max(max, sample.queueDepth), 0),
+      growthPerMinute: slopePerMinute(feedBacklog),
+      pendingAtFeedEnd: feedBacklog.length > 0 ? feedBacklog[feedBacklog.length - 1].value : 0
+    },
+    sidecars: {
+      count: peakRssByPid.size,
+      peakTotalRssBytes: peakSidecarRss,
+      peakRssBytes: [...peakRssByPid.values()]
+    }
+  };
+}
+
+// Failed and dropped segments are marked processed without reaching the caption path
+function isAccounted(session, filePath) {
+  for (const stream of session.streams.values()) {
+    if (stream.matcher?.dir === path.dirname(filePath)) return stream.processedFiles.has(path.basename(filePath));
+  }
+  return true;
+}
+
+function printStep(step) {
+  const ms = (stats) => (stats.count === 0 ? 'n/a' : `p50 ${stats.p50} ms  p90 ${stats.p90} ms  p99 ${stats.p99} ms  max ${stats.max} ms`);
+  const mb = (bytes) => `${(bytes / 1024 / 1024).toFixed(0)} MB`;
+
+  console.log(`\n📊 ${step.concurrency} channel(s), ${step.sidecarMode} sidecars (setup ${step.setupMs} ms, feed ${step.feedSeconds.toFixed(1)} s, drain ${step.drainSeconds.toFixed(1)} s)`);
+  console.log(`   Caption latency from segment close: ${ms(step.captionLatencyMs)}`);
+  console.log(`   Sidecar done (incl. empty text):   ${ms(step.completionLatencyMs)}`);
+  for (const channel of step.channels) {
+    const rtf = channel.realTimeFactor == null ? 'n/a' : channel.realTimeFactor.toFixed(3);
+    console.log(`   ${channel.channelName.padEnd(24)} RTF ${rtf}  ${channel.transcribed}/${channel.segments} transcribed, ${channel.dropped} dropped, ${channel.errors} errors` +
+      (channel.unfinished > 0 ? `, ${channel.unfinished} unfinished` : '') +
+      (channel.captionLatencyMs.count > 0 ? `  latency p50 ${Math.round(channel.captionLatencyMs.p50)} ms` : ''));
+  }
+  const { backlog, sidecars } = step;
+  console.log(`   Backlog: max ${backlog.maxPending} pending (queue ${backlog.maxQueueDepth}), ${backlog.growthPerMinute >= 0 ? '+' : ''}${backlog.growthPerMinute.toFixed(1)} segments/min during feed, ${backlog.pendingAtFeedEnd} pending at feed end`);
+  if (sidecars.count > 0) {
+    console.log(`   Sidecars: ${sidecars.count}, peak RSS ${mb(sidecars.peakTotalRssBytes)} total (${sidecars.peakRssBytes.map(mb).join(', ')})`);
+  }
+}
+
+main().then(() => process.exit(0)).catch((error) => {
+  console.error('❌ Replay failed:', error);
+  process.exit(1);
+});
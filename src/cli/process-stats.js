@@ -0,0 +1,123 @@
+import fs from 'fs';
+import { execFile } from 'child_process';
+import { promisify } from 'util';
+
+/**
+ * CPU and memory sampling of local process trees, and latency summaries, for the benchmark tools.
+ */
+
+const execFileAsync = promisify(execFile);
+
+let procUnits = null;
+
+// pid -> { ppid, cpuSeconds, rssBytes } for every process
+async function listProcesses() {
+  const processes = new Map();
+
+  // Linux: /proc has CPU time in clock ticks; `ps` only has whole seconds
+  if (process.platform === 'linux') {
+    if (!procUnits) {
+      const [{ stdout: ticks }, { stdout: pageSize }] = await Promise.all([
+        execFileAsync('getconf', ['CLK_TCK']),
+        execFileAsync('getconf', ['PAGESIZE'])
+      ]);
+      procUnits = { ticks: parseInt(ticks), pageSize: parseInt(pageSize) };
+    }
+    for (const entry of fs.readdirSync('/proc')) {
+      if (!/^\d+$/.test(entry)) continue;
+      let stat;
+      try {
+        stat = fs.readFileSync(`/proc/${entry}/stat`, 'utf8');
+      } catch {
+        continue; // exited
+      }
+      // Fields after the parenthesised command name: state ppid ... utime(11) stime(12) ... rss(21)
+      const fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ');
+      processes.set(parseInt(entry), {
+        ppid: parseInt(fields[1]),
+        cpuSeconds: (parseInt(fields[11]) + parseInt(fields[12])) / procUnits.ticks,
+        rssBytes: parseInt(fields[21]) * procUnits.pageSize
+      });
+    }
+    return processes;
+  }
+
+  const { stdout } = await execFileAsync('ps', ['-A', '-o', 'pid=,ppid=,time=,rss=']);
+  for (const line of stdout.trim().split('\n')) {
+    const [pid, ppid, time, rss] = line.trim().split(/\s+/);
+    // [dd-][hh:]mm:ss[.ss]
+    const [days, clock] = time.includes('-') ? time.split('-') : ['0', time];
+    const seconds = clock.split(':').reduce((total, part) => total * 60 + parseFloat(part), 0);
+    processes.set(parseInt(pid), {
+      ppid: parseInt(ppid),
+      cpuSeconds: parseInt(days) * 86400 + seconds,
+      rssBytes: parseInt(rss) * 1024
+    });
+  }
+  return processes;
+}
+
+function sumTree(processes, rootPid) {
+  let cpuSeconds = 0;
+  let rssBytes = 0;
+  let found = false;
+  const queue = [rootPid];
+  while (queue.length > 0) {
+    const pid = queue.shift();
+    const proc = processes.get(pid);
+    if (!proc) continue;
+    found = true;
+    cpuSeconds += proc.cpuSeconds;
+    rssBytes += proc.rssBytes;
+    for (const [childPid, child] of processes) {
+      if (child.ppid === pid) queue.push(childPid);
+    }
+  }
+  return found ? { cpuSeconds, rssBytes } : null;
+}
+
+/**
+ * CPU seconds and RSS bytes of a process and all of its descendants (e.g. mediasoup workers).
+ */
+export async function sampleProcessTree(rootPid) {
+  const tree = sumTree(await listProcesses(), rootPid);
+  if (!tree) throw new Error(`Process ${rootPid} not found`);
+  return { at: Date.now(), ...tree };
+}
+
+/**
+ * Like sampleProcessTree() for several roots from one process listing; exited roots are left out.
+ * @returns {Promise<Map<number, { cpuSeconds: number, rssBytes: number }>>}
+ */
+export async function sampleProcessTrees(rootPids) {
+  const processes = await listProcesses();
+  const trees = new Map();
+  for (const pid of rootPids) {
+    const tree = sumTree(processes, pid);
+    if (tree) trees.set(pid, tree);
+  }
+  return trees;
+}
+
+/**
+ * Nearest-rank percentile of an ascending array
+ * @returns {number|null} null when empty
+ */
+export function percentile(sorted, p) {
+  if (sorted.length === 0) return null;
+  return sorted[Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1)];
+}
+
+/**
+ * count/p50/p90/p99/max of a sample, ignoring null entries
+ */
+export function describe(values) {
+  const sorted = values.filter(value => value != null).sort((a, b) => a - b);
+  return {
+    count: sorted.length,
+    p50: percentile(sorted, 50),
+    p90: percentile(sorted, 90),
+    p99: percentile(sorted, 99),
+    max: sorted.length > 0 ? sorted[sorted.length - 1] : null
+  };
+}
@@ -2,11 +2,40 @@ import Database from 'better-sqlite3';
 import { fileURLToPath } from 'url';
 import { dirname, join } from 'path';
 import { readFileSync, existsSync } from 'fs';
+import { performance } from 'perf_hooks';
+import { metrics } from '../metrics.js';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = dirname(__filename);
 
 let db = null;
+let statementCache = new Map(); // sql -> TimedStatement for the open connection
+
+/**
+ * Open a connection with the shared pragmas; also used by the writer worker (src/db/writer-worker.js)
+ * @param {string} dbPath - Database file path
+ * @returns {Database} Connection
+ */
+export function openConnection(dbPath) {
+  // Create database connection with optional custom native binding
+  // (used when running as a packaged executable)
+  const dbOptions = {};
+  if (process.env.BETTER_SQLITE3_BINDING && existsSync(process.env.BETTER_SQLITE3_BINDING)) {
+    dbOptions.nativeBinding = process.env.BETTER_SQLITE3_BINDING;
+  }
+
+  const connection = new Database(dbPath, dbOptions);
+
+  // Enable foreign keys
+  connection.pragma('foreign_keys = ON');
+
+  // WAL lets readers run alongside the writer, and with synchronous=NORMAL a commit no
+  // longer fsyncs (only checkpoints do). A crash can lose the last commits, never corrupt.
+  connection.pragma('journal_mode = WAL');
+  connection.pragma(`synchronous = ${process.env.DB_SYNCHRONOUS || 'NORMAL'}`);
+  connection.pragma(`busy_timeout = ${parseInt(process.env.DB_BUSY_TIMEOUT_MS || '5000', 10)}`);
+  return connection;
+}
 
 /**
  * Initialize the SQLite database connection and create tables
@@ -16,15 +45,10 @@ export function initDatabase(dbPath = './soundcast.db') {
     return db;
   }
 
-  // Create database connection with optional custom native binding
-  // (used when running as a packaged executable)
-  const dbOptions = {};
   if (process.env.BETTER_SQLITE3_BINDING && existsSync(process.env.BETTER_SQLITE3_BINDING)) {
-    dbOptions.nativeBinding = process.env.BETTER_SQLITE3_BINDING;
     console.log('Using custom SQLite binding:', process.env.BETTER_SQLITE3_BINDING);
   }
-
-  db = new Database(dbPath, dbOptions);
+  db = openConnection(dbPath);
 
   // Load sqlite-vec extension if available.
   const vectorExtensionPath = join(__dirname, '../../lib/vec0.so');
@@ -57,9 +81,6 @@ export function initDatabase(dbPath = './soundcast.db') {
     console.warn('[Database] sqlite-vec extension not loaded (continuing without vector search support).');
   }
 
-  // Enable foreign keys
-  db.pragma('foreign_keys = ON');
-
   // Read and execute schema
   // Try multiple locations for schema file (for packaged executable support)
   let schemaPath = join(__dirname, 'schema.sql');
@@ -95,6 +116,18 @@ export function initDatabase(dbPath = './soundcast.db') {
   return db;
 }
 
+/**
+ * Open the database from a worker thread (e.g. src/transcription/runtime-worker.js): same
+ * pragmas, no schema pass, since the main thread already ran initDatabase()
+ * @param {string} dbPath - Database file path
+ */
+export function attachDatabase(dbPath) {
+  if (!db) {
+    db = openConnection(dbPath);
+  }
+  return db;
+}
+
 /**
  * Get the database instance
  */
@@ -105,6 +138,57 @@ export function getDatabase() {
   return db;
 }
 
+// Label for soundcast_db_statement_seconds: leading keyword and first table, e.g. select/transcript_docs_v2
+function statementLabels(sql) {
+  const op = (/^\s*(\w+)/.exec(sql)?.[1] || 'other').toLowerCase();
+  const table = /\b(?:FROM|INTO|UPDATE)\s+(\w+)/i.exec(sql)?.[1] || 'unknown';
+  return { op, table };
+}
+
+/**
+ * Prepared statement whose run/get/all are timed into soundcast_db_statement_seconds
+ */
+class TimedStatement {
+  constructor(statement, labels) {
+    this.statement = statement;
+    this.labels = labels;
+  }
+
+  time(method, args) {
+    const startedAt = performance.now();
+    try {
+      return this.statement[method](...args);
+    } finally {
+      metrics.dbStatementSeconds.observe((performance.now() - startedAt) / 1000, this.labels);
+    }
+  }
+
+  run(...args) {
+    return this.time('run', args);
+  }
+
+  get(...args) {
+    return this.time('get', args);
+  }
+
+  all(...args) {
+    return this.time('all', args);
+  }
+}
+
+/**
+ * Get a prepared statement for `sql`, preparing it only on first use
+ * @param {string} sql - SQL text (use a constant; it is the cache key)
+ */
+export function prepareCached(sql) {
+  let stmt = statementCache.get(sql);
+  if (!stmt) {
+    stmt = new TimedStatement(getDatabase().prepare(sql), statementLabels(sql));
+    statementCache.set(sql, stmt);
+  }
+  return stmt;
+}
+
 /**
  * Close the database connection
  */
@@ -112,11 +196,15 @@ export function closeDatabase() {
   if (db) {
     db.close();
     db = null;
+    statementCache = new Map();
   }
 }
 
 export default {
+  openConnection,
   initDatabase,
+  attachDatabase,
   getDatabase,
+  prepareCached,
   closeDatabase
 };
@@ -0,0 +1,14 @@
+-- Migration: Add Yjs update log for incremental transcript doc persistence
+-- Date: 2026-10-14
+
+CREATE TABLE IF NOT EXISTS transcript_doc_updates_v2 (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    session_id INTEGER NOT NULL,
+    channel_name TEXT NOT NULL,
+    update_data BLOB NOT NULL,
+    created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    FOREIGN KEY (session_id) REFERENCES transcription_sessions_v2(id) ON DELETE CASCADE
+);
+
+CREATE INDEX IF NOT EXISTS idx_transcript_doc_updates_v2_session_channel
+ON transcript_doc_updates_v2(session_id, channel_name, id);
@@ -0,0 +1,4 @@
+-- Migration: Add room-level audio profile (Opus DTX/FEC and listener playout settings)
+-- Date: 2026-10-14
+
+ALTER TABLE rooms ADD COLUMN audio_profile TEXT NOT NULL DEFAULT 'resilient';
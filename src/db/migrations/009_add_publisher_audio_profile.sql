@@ -0,0 +1,5 @@
+-- Migration: Add per-publisher (channel) audio profile: mono speech vs stereo, target bitrate
+-- Date: 2026-10-14
+
+ALTER TABLE publishers ADD COLUMN audio_profile TEXT NOT NULL DEFAULT 'stereo';
+ALTER TABLE publishers ADD COLUMN audio_bitrate INTEGER;
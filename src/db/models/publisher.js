@@ -1,6 +1,8 @@
 import { getDatabase } from '../database.js';
 import bcryptjs from 'bcryptjs';
 import { randomBytes } from 'crypto';
+import { invalidateTopology } from './topology.js';
+import { DEFAULT_PUBLISHER_AUDIO_PROFILE } from '../../media/audio-profiles.js';
 
 const SALT_ROUNDS = 10;
 
@@ -19,9 +21,11 @@ function generateToken(length = 16) {
  * @param {number} publisherData.room_id - Room ID
  * @param {string} publisherData.name - Publisher name
  * @param {string} publisherData.channel_name - Channel to broadcast to
+ * @param {string} [publisherData.audio_profile] - 'mono-speech' or 'stereo'
+ * @param {number|null} [publisherData.audio_bitrate] - Opus target bitrate (bps)
  * @returns {object} Created publisher with join_token
  */
-export function createPublisher({ room_id, name, channel_name }) {
+export function createPublisher({ room_id, name, channel_name, audio_profile = DEFAULT_PUBLISHER_AUDIO_PROFILE, audio_bitrate = null }) {
   const db = getDatabase();
 
   // Generate unique join token
@@ -29,16 +33,19 @@ export function createPublisher({ room_id, name, channel_name }) {
   const joinTokenHash = bcryptjs.hashSync(joinToken, SALT_ROUNDS);
 
   const stmt = db.prepare(
-    'INSERT INTO publishers (room_id, name, channel_name, join_token, join_token_hash) VALUES (?, ?, ?, ?, ?)'
+    'INSERT INTO publishers (room_id, name, channel_name, audio_profile, audio_bitrate, join_token, join_token_hash) VALUES (?, ?, ?, ?, ?, ?, ?)'
   );
 
-  const result = stmt.run(room_id, name, channel_name, joinToken, joinTokenHash);
+  const result = stmt.run(room_id, name, channel_name, audio_profile, audio_bitrate, joinToken, joinTokenHash);
+  invalidateTopology();
 
   return {
     id: result.lastInsertRowid,
     room_id,
     name,
     channel_name,
+    audio_profile,
+    audio_bitrate,
     join_token: joinToken,
     created_at: new Date().toISOString()
   };
@@ -52,7 +59,7 @@ export function createPublisher({ room_id, name, channel_name }) {
 export function getPublisherById(id) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, room_id, name, channel_name, join_token, created_at FROM publishers WHERE id = ?'
+    'SELECT id, room_id, name, channel_name, audio_profile, audio_bitrate, join_token, created_at FROM publishers WHERE id = ?'
   );
   return stmt.get(id);
 }
@@ -65,7 +72,7 @@ export function getPublisherById(id) {
 export function verifyPublisherToken(joinToken) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, room_id, name, channel_name, join_token_hash, created_at FROM publishers'
+    'SELECT id, room_id, name, channel_name, audio_profile, audio_bitrate, join_token_hash, created_at FROM publishers'
   );
   const publishers = stmt.all();
 
@@ -88,7 +95,7 @@ export function verifyPublisherToken(joinToken) {
 export function listPublishersByRoom(room_id) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, room_id, name, channel_name, join_token, created_at FROM publishers WHERE room_id = ? ORDER BY created_at DESC'
+    'SELECT id, room_id, name, channel_name, audio_profile, audio_bitrate, join_token, created_at FROM publishers WHERE room_id = ? ORDER BY created_at DESC'
   );
   return stmt.all(room_id);
 }
@@ -102,6 +109,7 @@ export function deletePublisher(id) {
   const db = getDatabase();
   const stmt = db.prepare('DELETE FROM publishers WHERE id = ?');
   const result = stmt.run(id);
+  invalidateTopology();
   return result.changes > 0;
 }
 
@@ -111,9 +119,11 @@ export function deletePublisher(id) {
  * @param {object} updates - Updates to apply
  * @param {string} updates.name - Publisher name
  * @param {string} updates.channel_name - Channel name
+ * @param {string} updates.audio_profile - 'mono-speech' or 'stereo'
+ * @param {number|null} updates.audio_bitrate - Opus target bitrate (bps), null for the default
  * @returns {object|null} Updated publisher object or null if not found
  */
-export function updatePublisher(id, { name, channel_name }) {
+export function updatePublisher(id, { name, channel_name, audio_profile, audio_bitrate }) {
   const db = getDatabase();
 
   const updates = [];
@@ -129,6 +139,16 @@ export function updatePublisher(id, { name, channel_name }) {
     values.push(channel_name);
   }
 
+  if (audio_profile !== undefined) {
+    updates.push('audio_profile = ?');
+    values.push(audio_profile);
+  }
+
+  if (audio_bitrate !== undefined) {
+    updates.push('audio_bitrate = ?');
+    values.push(audio_bitrate);
+  }
+
   if (updates.length === 0) {
     return getPublisherById(id);
   }
@@ -137,6 +157,7 @@ export function updatePublisher(id, { name, channel_name }) {
 
   const stmt = db.prepare(`UPDATE publishers SET ${updates.join(', ')} WHERE id = ?`);
   stmt.run(...values);
+  invalidateTopology();
 
   return getPublisherById(id);
 }
@@ -150,6 +171,7 @@ export function deletePublishersByRoom(room_id) {
   const db = getDatabase();
   const stmt = db.prepare('DELETE FROM publishers WHERE room_id = ?');
   const result = stmt.run(room_id);
+  invalidateTopology();
   return result.changes;
 }
 
@@ -1,5 +1,7 @@
 import { getDatabase } from '../database.js';
 import { deletePublishersByRoom } from './publisher.js';
+import { invalidateTopology } from './topology.js';
+import { DEFAULT_AUDIO_PROFILE, isAudioProfile } from '../../media/audio-profiles.js';
 
 /**
  * Generate a URL-friendly slug from room name and ID
@@ -20,14 +22,19 @@ function generateSlug(name, id) {
  * @param {object} roomData - Room data
  * @param {number} roomData.tenant_id - Tenant ID
  * @param {string} roomData.name - Room name
+ * @param {string} [roomData.audio_profile] - 'low-latency' or 'resilient'
  * @returns {object} Created room
  */
-export function createRoom({ tenant_id, name, slug }) {
+export function createRoom({ tenant_id, name, slug, audio_profile = DEFAULT_AUDIO_PROFILE }) {
   const db = getDatabase();
 
+  if (!isAudioProfile(audio_profile)) {
+    throw new Error('Invalid audio profile');
+  }
+
   // First insert without slug to get the ID
   const stmt = db.prepare(
-    'INSERT INTO rooms (tenant_id, name, slug) VALUES (?, ?, ?)'
+    'INSERT INTO rooms (tenant_id, name, slug, audio_profile) VALUES (?, ?, ?, ?)'
   );
 
   // Temporary slug (will be updated)
@@ -36,7 +43,8 @@ export function createRoom({ tenant_id, name, slug }) {
   const result = stmt.run(
     tenant_id,
     name,
-    tempSlug
+    tempSlug,
+    audio_profile
   );
 
   const roomId = result.lastInsertRowid;
@@ -47,6 +55,7 @@ export function createRoom({ tenant_id, name, slug }) {
   // Update with final slug
   const updateStmt = db.prepare('UPDATE rooms SET slug = ? WHERE id = ?');
   updateStmt.run(finalSlug, roomId);
+  invalidateTopology();
 
   // Return the created room
   return getRoomById(roomId);
@@ -60,7 +69,7 @@ export function createRoom({ tenant_id, name, slug }) {
 export function getRoomById(id) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, tenant_id, name, slug, created_at FROM rooms WHERE id = ?'
+    'SELECT id, tenant_id, name, slug, audio_profile, created_at FROM rooms WHERE id = ?'
   );
   return stmt.get(id);
 }
@@ -73,7 +82,7 @@ export function getRoomById(id) {
 export function getRoomBySlug(slug) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, tenant_id, name, slug, created_at FROM rooms WHERE slug = ?'
+    'SELECT id, tenant_id, name, slug, audio_profile, created_at FROM rooms WHERE slug = ?'
   );
   return stmt.get(slug);
 }
@@ -92,7 +101,7 @@ export function updateRoom(slug, updates) {
     return null;
   }
 
-  const allowedFields = ['name', 'slug'];
+  const allowedFields = ['name', 'slug', 'audio_profile'];
   const updateFields = [];
   const values = [];
 
@@ -111,6 +120,12 @@ export function updateRoom(slug, updates) {
         }
         updateFields.push(`${field} = ?`);
         values.push(slugValue);
+      } else if (field === 'audio_profile') {
+        if (!isAudioProfile(updates[field])) {
+          throw new Error('Invalid audio profile');
+        }
+        updateFields.push(`${field} = ?`);
+        values.push(updates[field]);
       } else {
         updateFields.push(`${field} = ?`);
         values.push(updates[field]);
@@ -128,6 +143,7 @@ export function updateRoom(slug, updates) {
     `UPDATE rooms SET ${updateFields.join(', ')} WHERE id = ?`
   );
   stmt.run(...values);
+  invalidateTopology();
 
   return getRoomById(room.id);
 }
@@ -140,7 +156,7 @@ export function updateRoom(slug, updates) {
 export function listRoomsByTenant(tenant_id) {
   const db = getDatabase();
   const stmt = db.prepare(
-    'SELECT id, tenant_id, name, slug, created_at FROM rooms WHERE tenant_id = ? ORDER BY created_at DESC'
+    'SELECT id, tenant_id, name, slug, audio_profile, created_at FROM rooms WHERE tenant_id = ? ORDER BY created_at DESC'
   );
   return stmt.all(tenant_id);
 }
@@ -176,7 +192,9 @@ export function deleteRoom(slug) {
     return result.changes > 0;
   });
 
-  return deleteTxn();
+  const deleted = deleteTxn();
+  invalidateTopology();
+  return deleted;
 }
 
 export default {
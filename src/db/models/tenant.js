@@ -1,5 +1,6 @@
 import { getDatabase } from '../database.js';
 import bcryptjs from 'bcryptjs';
+import { invalidateTopology } from './topology.js';
 
 const SALT_ROUNDS = 10;
 
@@ -88,6 +89,7 @@ export function deleteTenant(id) {
   const db = getDatabase();
   const stmt = db.prepare('DELETE FROM tenants WHERE id = ?');
   const result = stmt.run(id);
+  invalidateTopology();
   return result.changes > 0;
 }
 
@@ -0,0 +1,79 @@
+import { getDatabase } from '../database.js';
+
+/**
+ * In-memory room/publisher topology for the signaling hot path (tenant channel stats,
+ * channel -> room lookups). Loaded with a single query on first use and dropped by the
+ * room, publisher and tenant writers, so reads between admin edits never touch SQLite.
+ */
+let topology = null;
+
+function loadTopology() {
+  const db = getDatabase();
+  const rows = db.prepare(`
+    SELECT r.id AS room_id, r.tenant_id, r.slug, r.audio_profile, p.channel_name
+    FROM rooms r
+    LEFT JOIN publishers p ON p.room_id = r.id
+    ORDER BY r.created_at DESC, r.id DESC, p.created_at DESC
+  `).all();
+
+  const roomsById = new Map(); // room_id -> { room_id, tenant_id, slug, audio_profile, channelNames }
+  const roomsByTenant = new Map(); // tenant_id -> room[] (newest first)
+  const roomsBySlug = new Map();
+  const roomsByChannel = new Map(); // channel_name -> first room with it (legacy ids)
+
+  for (const row of rows) {
+    let room = roomsById.get(row.room_id);
+    if (!room) {
+      room = { room_id: row.room_id, tenant_id: row.tenant_id, slug: row.slug, audio_profile: row.audio_profile, channelNames: [] };
+      roomsById.set(room.room_id, room);
+      roomsBySlug.set(room.slug, room);
+      if (!roomsByTenant.has(room.tenant_id)) roomsByTenant.set(room.tenant_id, []);
+      roomsByTenant.get(room.tenant_id).push(room);
+    }
+    if (row.channel_name == null || room.channelNames.includes(row.channel_name)) continue;
+    room.channelNames.push(row.channel_name);
+    if (!roomsByChannel.has(row.channel_name)) roomsByChannel.set(row.channel_name, room);
+  }
+
+  return { roomsByTenant, roomsBySlug, roomsByChannel };
+}
+
+function getTopology() {
+  if (!topology) topology = loadTopology();
+  return topology;
+}
+
+/**
+ * Drop the cached topology; the next read reloads it.
+ */
+export function invalidateTopology() {
+  topology = null;
+}
+
+/**
+ * Rooms of a tenant with their unique publisher channel names
+ * @param {number} tenant_id - Tenant ID
+ * @returns {array} Array of { room_id, tenant_id, slug, audio_profile, channelNames } (do not mutate)
+ */
+export function listRoomTopologyByTenant(tenant_id) {
+  return getTopology().roomsByTenant.get(tenant_id) || [];
+}
+
+/**
+ * Find the room serving a channel
+ * @param {string|null} roomSlug - Room slug, or null for legacy bare channel names
+ * @param {string} channelName - Channel name
+ * @returns {object|undefined} { room_id, slug, tenant_id, audio_profile } or undefined
+ */
+export function findRoomByChannel(roomSlug, channelName) {
+  const { roomsBySlug, roomsByChannel } = getTopology();
+  const room = roomSlug === null ? roomsByChannel.get(channelName) : roomsBySlug.get(roomSlug);
+  if (!room || !room.channelNames.includes(channelName)) return undefined;
+  return { room_id: room.room_id, slug: room.slug, tenant_id: room.tenant_id, audio_profile: room.audio_profile };
+}
+
+export default {
+  invalidateTopology,
+  listRoomTopologyByTenant,
+  findRoomByChannel
+};
@@ -1,12 +1,52 @@
-import { getDatabase } from '../database.js';
+import { prepareCached } from '../database.js';
+import { INSERT_SEGMENT_SQL, UPSERT_DOC_SQL } from '../write-ops.js';
+import { enqueueDbWrite } from '../writer.js';
+
+// Transcript segments and Yjs doc updates are handed to the DB writer in periodic batches
+// instead of one fsync'd statement per result; see queueTranscriptSegment / queueTranscriptDocUpdate.
+const WRITE_BATCH_INTERVAL_MS = parseInt(process.env.DB_WRITE_BATCH_INTERVAL_MS || '250', 10);
+
+const pendingSegments = [];
+const pendingDocUpdates = [];
+let writeFlushTimer = null;
 
 function nowIso() {
   return new Date().toISOString();
 }
 
+function segmentRow({
+  session_id,
+  stream_id,
+  room_id,
+  channel_name,
+  producer_id,
+  publisher_id = null,
+  segment_file = null,
+  text_content,
+  timestamp_start_ms = null,
+  timestamp_end_ms = null,
+  confidence_score = null,
+  language = null
+}) {
+  return {
+    session_id,
+    stream_id,
+    room_id,
+    channel_name,
+    producer_id,
+    publisher_id,
+    segment_file,
+    text_content,
+    timestamp_start_ms,
+    timestamp_end_ms,
+    confidence_score,
+    language,
+    created_at: nowIso()
+  };
+}
+
 export function createTranscriptionSession({ room_id, recording_id, event_name, model_name }) {
-  const db = getDatabase();
-  const stmt = db.prepare(`
+  const stmt = prepareCached(`
     INSERT INTO transcription_sessions_v2
       (room_id, recording_id, event_name, model_name, status, started_at)
     VALUES (?, ?, ?, ?, 'active', ?)
@@ -16,8 +56,7 @@ export function createTranscriptionSession({ room_id, recording_id, event_name,
 }
 
 export function getTranscriptionSessionById(id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, room_id, recording_id, event_name, model_name, status, started_at, stopped_at, error_message
     FROM transcription_sessions_v2
     WHERE id = ?
@@ -25,8 +64,7 @@ export function getTranscriptionSessionById(id) {
 }
 
 export function getTranscriptionSessionByRoomAndId(room_id, session_id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, room_id, recording_id, event_name, model_name, status, started_at, stopped_at, error_message
     FROM transcription_sessions_v2
     WHERE room_id = ? AND id = ?
@@ -35,8 +73,7 @@ export function getTranscriptionSessionByRoomAndId(room_id, session_id) {
 }
 
 export function listTranscriptionSessionsByRoom(room_id, limit = 20, offset = 0) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, room_id, recording_id, event_name, model_name, status, started_at, stopped_at, error_message
     FROM transcription_sessions_v2
     WHERE room_id = ?
@@ -46,8 +83,7 @@ export function listTranscriptionSessionsByRoom(room_id, limit = 20, offset = 0)
 }
 
 export function countTranscriptionSessionsByRoom(room_id) {
-  const db = getDatabase();
-  const row = db.prepare(`
+  const row = prepareCached(`
     SELECT COUNT(*) as total
     FROM transcription_sessions_v2
     WHERE room_id = ?
@@ -56,8 +92,7 @@ export function countTranscriptionSessionsByRoom(room_id) {
 }
 
 export function getActiveTranscriptionSessionByRoomId(room_id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, room_id, recording_id, event_name, model_name, status, started_at, stopped_at, error_message
     FROM transcription_sessions_v2
     WHERE room_id = ? AND status = 'active'
@@ -67,8 +102,7 @@ export function getActiveTranscriptionSessionByRoomId(room_id) {
 }
 
 export function listActiveTranscriptionSessions() {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, room_id, recording_id, event_name, model_name, status, started_at, stopped_at, error_message
     FROM transcription_sessions_v2
     WHERE status = 'active'
@@ -77,8 +111,7 @@ export function listActiveTranscriptionSessions() {
 }
 
 export function stopTranscriptionSession(session_id, status = 'stopped', error_message = null) {
-  const db = getDatabase();
-  db.prepare(`
+  prepareCached(`
     UPDATE transcription_sessions_v2
     SET status = ?, stopped_at = ?, error_message = ?
     WHERE id = ?
@@ -94,14 +127,13 @@ export function upsertTranscriptionStream({
   publisher_id = null,
   producer_name = null
 }) {
-  const db = getDatabase();
-  const existing = db.prepare(`
+  const existing = prepareCached(`
     SELECT id FROM transcription_streams_v2
     WHERE session_id = ? AND producer_id = ?
   `).get(session_id, producer_id);
 
   if (existing) {
-    db.prepare(`
+    prepareCached(`
       UPDATE transcription_streams_v2
       SET room_id = ?, channel_name = ?, publisher_id = ?, producer_name = ?, status = 'active', stopped_at = NULL
       WHERE id = ?
@@ -109,7 +141,7 @@ export function upsertTranscriptionStream({
     return getTranscriptionStreamById(existing.id);
   }
 
-  const result = db.prepare(`
+  const result = prepareCached(`
     INSERT INTO transcription_streams_v2
       (session_id, room_id, channel_name, producer_id, publisher_id, producer_name, status, started_at)
     VALUES (?, ?, ?, ?, ?, ?, 'active', ?)
@@ -118,8 +150,7 @@ export function upsertTranscriptionStream({
 }
 
 export function getTranscriptionStreamById(id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, session_id, room_id, channel_name, producer_id, publisher_id, producer_name, status, started_at, stopped_at
     FROM transcription_streams_v2
     WHERE id = ?
@@ -127,8 +158,7 @@ export function getTranscriptionStreamById(id) {
 }
 
 export function getActiveTranscriptionStreamsBySession(session_id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, session_id, room_id, channel_name, producer_id, publisher_id, producer_name, status, started_at, stopped_at
     FROM transcription_streams_v2
     WHERE session_id = ? AND status = 'active'
@@ -137,8 +167,7 @@ export function getActiveTranscriptionStreamsBySession(session_id) {
 }
 
 export function stopTranscriptionStream(session_id, producer_id, status = 'stopped') {
-  const db = getDatabase();
-  db.prepare(`
+  prepareCached(`
     UPDATE transcription_streams_v2
     SET status = ?, stopped_at = ?
     WHERE session_id = ? AND producer_id = ?
@@ -146,49 +175,16 @@ export function stopTranscriptionStream(session_id, producer_id, status = 'stopp
 }
 
 export function stopAllTranscriptionStreamsBySession(session_id, status = 'stopped') {
-  const db = getDatabase();
-  db.prepare(`
+  prepareCached(`
     UPDATE transcription_streams_v2
     SET status = ?, stopped_at = ?
     WHERE session_id = ? AND status = 'active'
   `).run(status, nowIso(), session_id);
 }
 
-export function createTranscriptSegment({
-  session_id,
-  stream_id,
-  room_id,
-  channel_name,
-  producer_id,
-  publisher_id = null,
-  segment_file = null,
-  text_content,
-  timestamp_start_ms = null,
-  timestamp_end_ms = null,
-  confidence_score = null,
-  language = null
-}) {
-  const db = getDatabase();
-  const result = db.prepare(`
-    INSERT INTO transcript_segments_v2
-      (session_id, stream_id, room_id, channel_name, producer_id, publisher_id, segment_file, text_content, timestamp_start_ms, timestamp_end_ms, confidence_score, language, created_at)
-    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-  `).run(
-    session_id,
-    stream_id,
-    room_id,
-    channel_name,
-    producer_id,
-    publisher_id,
-    segment_file,
-    text_content,
-    timestamp_start_ms,
-    timestamp_end_ms,
-    confidence_score,
-    language,
-    nowIso()
-  );
-  return db.prepare(`
+export function createTranscriptSegment(segment) {
+  const result = prepareCached(INSERT_SEGMENT_SQL).run(segmentRow(segment));
+  return prepareCached(`
     SELECT id, session_id, stream_id, room_id, channel_name, producer_id, publisher_id, segment_file, text_content, timestamp_start_ms, timestamp_end_ms, confidence_score, language, created_at
     FROM transcript_segments_v2
     WHERE id = ?
@@ -196,8 +192,7 @@ export function createTranscriptSegment({
 }
 
 export function listTranscriptDocsByRoom(room_id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT d.id, d.session_id, d.room_id, d.channel_name, d.text_content, d.revision, d.updated_at, d.created_at
     FROM transcript_docs_v2 d
     JOIN transcription_sessions_v2 s ON s.id = d.session_id
@@ -207,8 +202,7 @@ export function listTranscriptDocsByRoom(room_id) {
 }
 
 export function listTranscriptDocsBySession(room_id, session_id) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT d.id, d.session_id, d.room_id, d.channel_name, d.text_content, d.revision, d.updated_at, d.created_at
     FROM transcript_docs_v2 d
     WHERE d.room_id = ? AND d.session_id = ?
@@ -217,8 +211,7 @@ export function listTranscriptDocsBySession(room_id, session_id) {
 }
 
 export function getTranscriptDocByRoomChannel(room_id, channel_name) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT d.id, d.session_id, d.room_id, d.channel_name, d.text_content, d.revision, d.updated_at, d.created_at
     FROM transcript_docs_v2 d
     JOIN transcription_sessions_v2 s ON s.id = d.session_id
@@ -229,8 +222,7 @@ export function getTranscriptDocByRoomChannel(room_id, channel_name) {
 }
 
 export function getTranscriptDocBySessionChannel(room_id, session_id, channel_name) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT d.id, d.session_id, d.room_id, d.channel_name, d.text_content, d.revision, d.updated_at, d.created_at
     FROM transcript_docs_v2 d
     WHERE d.room_id = ? AND d.session_id = ? AND d.channel_name = ?
@@ -240,8 +232,7 @@ export function getTranscriptDocBySessionChannel(room_id, session_id, channel_na
 
 export function getLatestTranscriptDocByRoomEventChannel(room_id, event_name, channel_name) {
   if (!event_name) return null;
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT d.id, d.session_id, d.room_id, d.channel_name, d.text_content, d.revision, d.updated_at, d.created_at
     FROM transcript_docs_v2 d
     JOIN transcription_sessions_v2 s ON s.id = d.session_id
@@ -258,41 +249,96 @@ export function upsertTranscriptDoc({
   text_content,
   revision
 }) {
-  const db = getDatabase();
-  const existing = db.prepare(`
-    SELECT id, revision
+  prepareCached(UPSERT_DOC_SQL).run({ session_id, room_id, channel_name, text_content, revision, updated_at: nowIso() });
+  return prepareCached(`
+    SELECT id, session_id, room_id, channel_name, text_content, revision, updated_at, created_at
     FROM transcript_docs_v2
     WHERE session_id = ? AND channel_name = ?
   `).get(session_id, channel_name);
+}
 
-  if (existing) {
-    db.prepare(`
-      UPDATE transcript_docs_v2
-      SET text_content = ?, revision = ?, updated_at = ?
-      WHERE id = ?
-    `).run(text_content, revision, nowIso(), existing.id);
-    return db.prepare(`
-      SELECT id, session_id, room_id, channel_name, text_content, revision, updated_at, created_at
-      FROM transcript_docs_v2
-      WHERE id = ?
-    `).get(existing.id);
+function scheduleWriteFlush() {
+  if (writeFlushTimer) return;
+  writeFlushTimer = setTimeout(() => {
+    writeFlushTimer = null;
+    try {
+      flushTranscriptWrites();
+    } catch (error) {
+      console.error(`[Database] Failed to flush transcript writes: ${error.message}`);
+    }
+  }, Math.max(0, WRITE_BATCH_INTERVAL_MS));
+}
+
+/**
+ * Queue a segment row for the next batched transaction (same fields as createTranscriptSegment)
+ */
+export function queueTranscriptSegment(segment) {
+  pendingSegments.push(segmentRow(segment));
+  scheduleWriteFlush();
+}
+
+/**
+ * Queue one Yjs update (delta) for a transcript doc's update log
+ */
+export function queueTranscriptDocUpdate({ session_id, channel_name, update_data }) {
+  pendingDocUpdates.push({ session_id, channel_name, update_data, created_at: nowIso() });
+  scheduleWriteFlush();
+}
+
+/**
+ * Replace a doc's update log with `state` (Y.encodeStateAsUpdate) and store its text. Pending
+ * updates are flushed first so the writer drops exactly the ones `state` already contains.
+ */
+export function compactTranscriptDoc({ session_id, room_id, channel_name, text_content, revision, state }) {
+  flushTranscriptWrites();
+  enqueueDbWrite('compactTranscriptDoc', {
+    session_id,
+    room_id,
+    channel_name,
+    text_content,
+    revision,
+    state,
+    updated_at: nowIso()
+  });
+}
+
+/**
+ * Yjs updates for a doc, oldest first; applying them all rebuilds the doc
+ * @returns {Buffer[]}
+ */
+export function listTranscriptDocUpdates(session_id, channel_name) {
+  return prepareCached(`
+    SELECT update_data
+    FROM transcript_doc_updates_v2
+    WHERE session_id = ? AND channel_name = ?
+    ORDER BY id ASC
+  `).all(session_id, channel_name).map((row) => row.update_data);
+}
+
+/**
+ * Hand every queued segment and doc update to the DB writer as one batch. Await
+ * flushDbWrites() afterwards before reads that must see them (session stop, shutdown).
+ * @returns {{ segments: number, docUpdates: number }}
+ */
+export function flushTranscriptWrites() {
+  if (writeFlushTimer) {
+    clearTimeout(writeFlushTimer);
+    writeFlushTimer = null;
+  }
+  if (pendingSegments.length === 0 && pendingDocUpdates.length === 0) {
+    return { segments: 0, docUpdates: 0 };
   }
 
-  const result = db.prepare(`
-    INSERT INTO transcript_docs_v2
-      (session_id, room_id, channel_name, text_content, revision, updated_at, created_at)
-    VALUES (?, ?, ?, ?, ?, ?, ?)
-  `).run(session_id, room_id, channel_name, text_content, revision, nowIso(), nowIso());
-  return db.prepare(`
-    SELECT id, session_id, room_id, channel_name, text_content, revision, updated_at, created_at
-    FROM transcript_docs_v2
-    WHERE id = ?
-  `).get(result.lastInsertRowid);
+  const segments = pendingSegments.splice(0);
+  const docUpdates = pendingDocUpdates.splice(0);
+
+  if (segments.length > 0) enqueueDbWrite('insertTranscriptSegments', { rows: segments });
+  if (docUpdates.length > 0) enqueueDbWrite('appendTranscriptDocUpdates', { rows: docUpdates });
+  return { segments: segments.length, docUpdates: docUpdates.length };
 }
 
 export function listTranscriptSegmentsByRoomChannel(room_id, channel_name, limit = 200) {
-  const db = getDatabase();
-  return db.prepare(`
+  return prepareCached(`
     SELECT id, session_id, stream_id, room_id, channel_name, producer_id, publisher_id, segment_file, text_content, timestamp_start_ms, timestamp_end_ms, confidence_score, language, created_at
     FROM transcript_segments_v2
     WHERE room_id = ? AND channel_name = ?
@@ -316,6 +362,11 @@ export default {
   stopTranscriptionStream,
   stopAllTranscriptionStreamsBySession,
   createTranscriptSegment,
+  queueTranscriptSegment,
+  queueTranscriptDocUpdate,
+  compactTranscriptDoc,
+  listTranscriptDocUpdates,
+  flushTranscriptWrites,
   listTranscriptDocsByRoom,
   listTranscriptDocsBySession,
   getTranscriptDocByRoomChannel,
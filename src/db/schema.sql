@@ -15,6 +15,7 @@ CREATE TABLE IF NOT EXISTS rooms (
     tenant_id INTEGER NOT NULL,
     name TEXT NOT NULL,
     slug TEXT NOT NULL UNIQUE, -- URL-friendly identifier
+    audio_profile TEXT NOT NULL DEFAULT 'resilient', -- low-latency | resilient (src/media/audio-profiles.js)
     created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
     FOREIGN KEY (tenant_id) REFERENCES tenants(id),
     UNIQUE (tenant_id, name)
@@ -30,6 +31,8 @@ CREATE TABLE IF NOT EXISTS publishers (
     join_token TEXT NOT NULL, -- Plain text token for display in admin UI
     join_token_hash TEXT NOT NULL UNIQUE, -- Secure hash for verification
     transcription_language TEXT DEFAULT 'en', -- Legacy unused column (reserved for future features)
+    audio_profile TEXT NOT NULL DEFAULT 'stereo', -- mono-speech | stereo (src/media/audio-profiles.js)
+    audio_bitrate INTEGER, -- Opus target bitrate (bps); NULL uses the profile/room default
     created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
     FOREIGN KEY (room_id) REFERENCES rooms(id)
 );
@@ -172,6 +175,16 @@ CREATE TABLE IF NOT EXISTS transcript_docs_v2 (
     FOREIGN KEY (room_id) REFERENCES rooms(id) ON DELETE CASCADE
 );
 
+-- Yjs update log per transcript doc; compaction replaces it with one state update
+CREATE TABLE IF NOT EXISTS transcript_doc_updates_v2 (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    session_id INTEGER NOT NULL,
+    channel_name TEXT NOT NULL,
+    update_data BLOB NOT NULL,
+    created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    FOREIGN KEY (session_id) REFERENCES transcription_sessions_v2(id) ON DELETE CASCADE
+);
+
 CREATE INDEX IF NOT EXISTS idx_transcription_sessions_v2_room_status
 ON transcription_sessions_v2(room_id, status);
 
@@ -186,3 +199,6 @@ ON transcript_segments_v2(session_id, channel_name, created_at);
 
 CREATE INDEX IF NOT EXISTS idx_transcript_docs_v2_room_channel
 ON transcript_docs_v2(room_id, channel_name);
+
+CREATE INDEX IF NOT EXISTS idx_transcript_doc_updates_v2_session_channel
+ON transcript_doc_updates_v2(session_id, channel_name, id);
@@ -0,0 +1,124 @@
+import fs from 'fs';
+import path from 'path';
+
+/**
+ * Write operations run by the DB writer (src/db/writer.js), inside the writer worker or inline
+ * on the main connection when no worker is running. Params must be structured-cloneable.
+ */
+
+export const INSERT_SEGMENT_SQL = `
+  INSERT INTO transcript_segments_v2
+    (session_id, stream_id, room_id, channel_name, producer_id, publisher_id, segment_file, text_content, timestamp_start_ms, timestamp_end_ms, confidence_score, language, created_at)
+  VALUES (@session_id, @stream_id, @room_id, @channel_name, @producer_id, @publisher_id, @segment_file, @text_content, @timestamp_start_ms, @timestamp_end_ms, @confidence_score, @language, @created_at)
+`;
+
+export const UPSERT_DOC_SQL = `
+  INSERT INTO transcript_docs_v2
+    (session_id, room_id, channel_name, text_content, revision, updated_at, created_at)
+  VALUES (@session_id, @room_id, @channel_name, @text_content, @revision, @updated_at, @updated_at)
+  ON CONFLICT(session_id, channel_name) DO UPDATE SET
+    text_content = excluded.text_content,
+    revision = excluded.revision,
+    updated_at = excluded.updated_at
+`;
+
+export const INSERT_DOC_UPDATE_SQL = `
+  INSERT INTO transcript_doc_updates_v2 (session_id, channel_name, update_data, created_at)
+  VALUES (@session_id, @channel_name, @update_data, @created_at)
+`;
+
+/**
+ * @param {import('better-sqlite3').Database} db - Connection the ops write to
+ * @returns {object} op name -> (params) => void
+ */
+export function createWriteOps(db) {
+  const statements = new Map();
+  const prepare = (sql) => {
+    let stmt = statements.get(sql);
+    if (!stmt) {
+      stmt = db.prepare(sql);
+      statements.set(sql, stmt);
+    }
+    return stmt;
+  };
+
+  return {
+    updateRecordingTrackStatus({ id, status, stoppedAt = null }) {
+      if (stoppedAt) {
+        prepare('UPDATE recording_tracks SET status = ?, stopped_at = ? WHERE id = ?').run(status, stoppedAt, id);
+      } else {
+        prepare('UPDATE recording_tracks SET status = ? WHERE id = ?').run(status, id);
+      }
+    },
+
+    stopAllTracksForRecording({ recordingId, stoppedAt }) {
+      prepare('UPDATE recording_tracks SET status = ?, stopped_at = ? WHERE recording_id = ? AND status = ?')
+        .run('stopped', stoppedAt, recordingId, 'recording');
+    },
+
+    /**
+     * Rebuild a recording's metadata.json from its tracks. Queued after the track writes it
+     * depends on, so it always sees them.
+     */
+    writeRecordingMetadata({ recordingId, roomSlug, startedAt, stoppedAt = null, metadataPath }) {
+      const tracks = prepare(
+        'SELECT channel_name, producer_name, file_path, status, started_at, stopped_at FROM recording_tracks WHERE recording_id = ? ORDER BY started_at ASC'
+      ).all(recordingId);
+
+      // Organize tracks by channel
+      const channelTracks = {};
+      for (const track of tracks) {
+        if (!channelTracks[track.channel_name]) {
+          channelTracks[track.channel_name] = [];
+        }
+        channelTracks[track.channel_name].push({
+          producerName: track.producer_name,
+          fileName: path.basename(track.file_path),
+          status: track.status,
+          startedAt: track.started_at,
+          stoppedAt: track.stopped_at
+        });
+      }
+
+      const metadata = {
+        recordingId,
+        roomSlug,
+        startedAt,
+        stoppedAt,
+        status: stoppedAt ? 'stopped' : 'recording',
+        channels: channelTracks
+      };
+      fs.writeFileSync(metadataPath, JSON.stringify(metadata, null, 2));
+    },
+
+    insertTranscriptSegments({ rows }) {
+      const stmt = prepare(INSERT_SEGMENT_SQL);
+      for (const row of rows) stmt.run(row);
+    },
+
+    appendTranscriptDocUpdates({ rows }) {
+      const stmt = prepare(INSERT_DOC_UPDATE_SQL);
+      for (const row of rows) {
+        // Structured clone turns Buffers into Uint8Arrays; better-sqlite3 binds Buffers as BLOBs
+        stmt.run({ ...row, update_data: Buffer.from(row.update_data.buffer, row.update_data.byteOffset, row.update_data.byteLength) });
+      }
+    },
+
+    /**
+     * Replace a doc's update log with one state update and refresh its text snapshot. Updates
+     * queued after this op are kept, so the log stays complete.
+     */
+    compactTranscriptDoc({ session_id, room_id, channel_name, text_content, revision, state, updated_at }) {
+      prepare(UPSERT_DOC_SQL).run({ session_id, room_id, channel_name, text_content, revision, updated_at });
+      prepare('DELETE FROM transcript_doc_updates_v2 WHERE session_id = ? AND channel_name = ?').run(session_id, channel_name);
+      prepare(INSERT_DOC_UPDATE_SQL).run({
+        session_id,
+        channel_name,
+        update_data: Buffer.from(state.buffer, state.byteOffset, state.byteLength),
+        created_at: updated_at
+      });
+    }
+  };
+}
+
+export default createWriteOps;
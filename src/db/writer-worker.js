@@ -0,0 +1,69 @@
+import { parentPort, workerData } from 'worker_threads';
+import { performance } from 'perf_hooks';
+import { openConnection } from './database.js';
+import { createWriteOps } from './write-ops.js';
+
+/**
+ * DB writer thread: owns its own connection (WAL lets the main thread keep reading) and runs
+ * queued write ops in order, one transaction per drained batch.
+ *
+ * Messages in:  { type: 'write', op, params } | { type: 'flush', id } | { type: 'close', id }
+ * Messages out: { type: 'flushed', id } | { type: 'error', op, message } |
+ *               { type: 'timings', batchSeconds, ops: [[op, seconds], ...] } (one per batch)
+ */
+const db = openConnection(workerData.dbPath);
+const ops = createWriteOps(db);
+const queue = [];
+let draining = false;
+
+const runBatch = db.transaction((batch, timings) => {
+  for (const message of batch) {
+    if (message.type !== 'write') continue;
+    const op = ops[message.op];
+    try {
+      if (!op) throw new Error(`Unknown write op ${message.op}`);
+      const startedAt = performance.now();
+      op(message.params || {});
+      timings.push([message.op, (performance.now() - startedAt) / 1000]);
+    } catch (error) {
+      // One bad op must not roll back the rest of the batch
+      parentPort.postMessage({ type: 'error', op: message.op, message: error.message });
+    }
+  }
+});
+
+function drain() {
+  draining = false;
+  const batch = queue.splice(0);
+  if (batch.length === 0) return;
+  const timings = [];
+  const startedAt = performance.now();
+  try {
+    runBatch(batch, timings);
+  } catch (error) {
+    parentPort.postMessage({ type: 'error', op: 'transaction', message: error.message });
+  }
+  if (timings.length > 0) {
+    parentPort.postMessage({ type: 'timings', batchSeconds: (performance.now() - startedAt) / 1000, ops: timings });
+  }
+
+  // Barriers are answered only after everything queued before them is committed
+  for (const message of batch) {
+    if (message.type === 'flush') {
+      parentPort.postMessage({ type: 'flushed', id: message.id });
+    } else if (message.type === 'close') {
+      db.close();
+      parentPort.postMessage({ type: 'flushed', id: message.id });
+      parentPort.close();
+      return;
+    }
+  }
+}
+
+parentPort.on('message', (message) => {
+  queue.push(message);
+  if (!draining) {
+    draining = true;
+    setImmediate(drain);
+  }
+});
@@ -0,0 +1,124 @@
+import { Worker } from 'worker_threads';
+import { getDatabase } from './database.js';
+import { createWriteOps } from './write-ops.js';
+import { metrics } from '../metrics.js';
+
+/**
+ * Off-main-thread writer for recording and transcription metadata.
+ *
+ * `enqueueDbWrite()` posts an op (see write-ops.js) to the writer worker and returns
+ * immediately, so a slow disk never stalls signaling. Ops run in the order they were
+ * queued. `flushDbWrites()` is a barrier that resolves once everything queued before it is
+ * committed; call it before reading those rows back or before exit.
+ *
+ * With DB_WRITER=inline, or when the worker cannot start (e.g. packaged builds), ops run
+ * synchronously on the main connection instead.
+ */
+const DB_WRITER_MODE = process.env.DB_WRITER === 'inline' ? 'inline' : 'worker';
+
+let worker = null;
+let inlineOps = null;
+let nextFlushId = 1;
+const pendingFlushes = new Map(); // id -> resolve
+let log = console;
+
+function resolveAllFlushes() {
+  for (const resolve of pendingFlushes.values()) resolve();
+  pendingFlushes.clear();
+}
+
+/**
+ * Start the writer worker. Call after initDatabase() so the schema exists.
+ * @param {string} dbPath - Database file path
+ * @param {object} [options]
+ * @param {object} [options.logger] - Logger with warn/error (defaults to console)
+ */
+export function startDbWriter(dbPath, { logger = console } = {}) {
+  log = logger;
+  if (worker || DB_WRITER_MODE === 'inline') return;
+
+  try {
+    worker = new Worker(new URL('./writer-worker.js', import.meta.url), {
+      workerData: { dbPath }
+    });
+  } catch (error) {
+    log.warn(`DB writer worker unavailable, writing inline: ${error.message}`);
+    worker = null;
+    return;
+  }
+
+  worker.on('message', (message) => {
+    if (message.type === 'flushed') {
+      const resolve = pendingFlushes.get(message.id);
+      pendingFlushes.delete(message.id);
+      if (resolve) resolve();
+    } else if (message.type === 'timings') {
+      metrics.dbWriteBatchSeconds.observe(message.batchSeconds);
+      for (const [op, seconds] of message.ops) metrics.dbWriteOpSeconds.observe(seconds, { op });
+    } else if (message.type === 'error') {
+      log.error(`DB writer op ${message.op} failed: ${message.message}`);
+    }
+  });
+  worker.on('error', (error) => {
+    log.error(`DB writer worker failed, writing inline: ${error.message}`);
+  });
+  worker.on('exit', () => {
+    worker = null;
+    // Nothing left to wait for; barriers fall through to the inline path
+    resolveAllFlushes();
+  });
+  worker.unref();
+}
+
+/**
+ * Queue a write op; never blocks on disk when the worker is running
+ * @param {string} op - Name of an op in write-ops.js
+ * @param {object} params - Op parameters (structured-cloneable)
+ */
+export function enqueueDbWrite(op, params) {
+  if (worker) {
+    worker.postMessage({ type: 'write', op, params });
+    return;
+  }
+  if (!inlineOps) inlineOps = createWriteOps(getDatabase());
+  const endTimer = metrics.dbWriteOpSeconds.startTimer({ op });
+  try {
+    inlineOps[op](params);
+    endTimer();
+  } catch (error) {
+    log.error(`DB write op ${op} failed: ${error.message}`);
+  }
+}
+
+/**
+ * Resolve once every write queued so far has been committed.
+ * @returns {Promise<void>}
+ */
+export function flushDbWrites() {
+  if (!worker) return Promise.resolve();
+  const id = nextFlushId++;
+  return new Promise((resolve) => {
+    pendingFlushes.set(id, resolve);
+    worker.postMessage({ type: 'flush', id });
+  });
+}
+
+/**
+ * Flush and stop the worker; later writes run inline.
+ */
+export async function stopDbWriter() {
+  if (!worker) return;
+  const current = worker;
+  const id = nextFlushId++;
+  await new Promise((resolve) => {
+    pendingFlushes.set(id, resolve);
+    current.postMessage({ type: 'close', id });
+  });
+}
+
+export default {
+  startDbWriter,
+  enqueueDbWrite,
+  flushDbWrites,
+  stopDbWriter
+};
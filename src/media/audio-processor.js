@@ -0,0 +1,247 @@
+import { spawn } from 'child_process';
+import dgram from 'dgram';
+import { EventEmitter } from 'events';
+import { randomInt } from 'crypto';
+
+const FFMPEG_PATH = process.env.FFMPEG_PATH || 'ffmpeg';
+// RNNoise model for ffmpeg's arnndn filter; without one, denoise uses the built-in afftdn
+const RNNOISE_MODEL = process.env.AUDIO_PROCESSING_RNNOISE_MODEL || '';
+const START_TIMEOUT_MS = parseInt(process.env.AUDIO_PROCESSING_START_TIMEOUT_MS || '5000', 10);
+const MAX_RESTARTS = parseInt(process.env.AUDIO_PROCESSING_MAX_RESTARTS || '3', 10);
+// ffmpeg's RTP input binds a port pair (RTP, RTP + 1 for RTCP) from this range; keep it outside
+// the mediasoup RTC range and free of other services
+const INPUT_MIN_PORT = parseInt(process.env.AUDIO_PROCESSING_MIN_PORT || '39000', 10);
+const INPUT_MAX_PORT = parseInt(process.env.AUDIO_PROCESSING_MAX_PORT || '39999', 10);
+const RESTART_DELAY_MS = 1000;
+// An ffmpeg run this long resets the restart budget
+const STABLE_RUN_MS = 30000;
+const OUTPUT_PAYLOAD_TYPE = 100;
+
+export const PROCESSING_MODES = ['denoise', 'normalize', 'denoise-normalize'];
+
+function buildFilter(mode) {
+  const denoise = RNNOISE_MODEL ? `arnndn=m='${RNNOISE_MODEL.replace(/'/g, "\\'")}'` : 'afftdn=nr=12:nf=-40';
+  // speechnorm adapts per half-cycle, so it adds no lookahead latency (unlike loudnorm/dynaudnorm)
+  const normalize = 'speechnorm=e=12.5:r=0.0001:l=1';
+  if (mode === 'denoise') return denoise;
+  if (mode === 'normalize') return normalize;
+  return `${denoise},${normalize}`;
+}
+
+const reservedInputPorts = new Set(); // even RTP ports held by live stages (RTCP is port + 1)
+const firstInputPort = INPUT_MIN_PORT + (INPUT_MIN_PORT % 2);
+let nextInputPort = firstInputPort;
+
+function isUdpPortFree(port) {
+  return new Promise((resolve) => {
+    const socket = dgram.createSocket('udp4');
+    socket.once('error', () => resolve(false));
+    socket.bind(port, '127.0.0.1', () => socket.close(() => resolve(true)));
+  });
+}
+
+/**
+ * Reserve an RTP/RTCP port pair for ffmpeg's input. Pairs come from a dedicated range and are
+ * held in-process for the stage's lifetime (across ffmpeg restarts), so concurrent stages
+ * never share one; the bind probe skips pairs some other process already holds.
+ * @returns {Promise<number>} The even RTP port
+ */
+async function reserveInputPortPair() {
+  const pairs = Math.max(0, Math.floor((INPUT_MAX_PORT - firstInputPort + 1) / 2));
+  for (let attempt = 0; attempt < pairs; attempt++) {
+    const port = nextInputPort;
+    nextInputPort = port + 3 > INPUT_MAX_PORT ? firstInputPort : port + 2;
+    if (reservedInputPorts.has(port)) continue;
+    reservedInputPorts.add(port); // before probing, so a concurrent start skips it
+    if (await isUdpPortFree(port) && await isUdpPortFree(port + 1)) return port;
+    reservedInputPorts.delete(port);
+  }
+  throw new Error(`no free UDP port pair in ${INPUT_MIN_PORT}-${INPUT_MAX_PORT}`);
+}
+
+/**
+ * Server-side processing stage for one producer: mediasoup -> ffmpeg (decode, denoise and/or
+ * normalize, Opus re-encode) -> a processed producer on the same router.
+ *
+ * One stage per producer, however many listeners consume it. All DSP runs in the ffmpeg
+ * child process, so the signaling event loop only moves a few control messages. If ffmpeg
+ * exits, it is restarted into the same processed producer (same SSRC), so consumers stay
+ * attached; after MAX_RESTARTS quick failures the stage emits 'failed'.
+ *
+ * Events: 'failed' (Error)
+ */
+export class AudioProcessor extends EventEmitter {
+  /**
+   * @param {object} options
+   * @param {object} options.router - Router the source producer lives on
+   * @param {object} options.producer - Source mediasoup producer
+   * @param {string} options.mode - One of PROCESSING_MODES
+   * @param {number} [options.bitrate] - Opus output bitrate (bps)
+   * @param {number} [options.channels] - Output channels (1 for mono speech)
+   * @param {object} [options.log]
+   */
+  constructor({ router, producer, mode, bitrate = 32000, channels = 2, log = console }) {
+    super();
+    this.router = router;
+    this.source = producer;
+    this.mode = mode;
+    this.bitrate = bitrate;
+    this.channels = channels;
+    this.log = log;
+    this.inTransport = null;
+    this.outTransport = null;
+    this.consumer = null;
+    this.producer = null; // processed producer, set by start()
+    this.ffmpeg = null;
+    this.ssrc = randomInt(1, 0x7fffffff);
+    this.inputPort = null;
+    this.restarts = 0;
+    this.stopped = false;
+  }
+
+  async start() {
+    const listenInfo = { protocol: 'udp', ip: '127.0.0.1' };
+
+    // Source RTP -> ffmpeg input port
+    this.inputPort = await reserveInputPortPair();
+    if (this.stopped) {
+      reservedInputPorts.delete(this.inputPort);
+      throw new Error('stopped while starting');
+    }
+    this.inTransport = await this.router.createPlainTransport({ listenInfo, rtcpMux: true, comedia: false });
+    await this.inTransport.connect({ ip: '127.0.0.1', port: this.inputPort });
+    this.consumer = await this.inTransport.consume({
+      producerId: this.source.id,
+      rtpCapabilities: this.router.rtpCapabilities,
+      paused: true
+    });
+
+    // ffmpeg output -> processed producer; comedia learns ffmpeg's address from its first packet
+    this.outTransport = await this.router.createPlainTransport({ listenInfo, rtcpMux: false, comedia: true });
+    this.producer = await this.outTransport.produce({
+      kind: 'audio',
+      rtpParameters: {
+        codecs: [{
+          mimeType: 'audio/opus',
+          clockRate: 48000,
+          channels: 2,
+          payloadType: OUTPUT_PAYLOAD_TYPE,
+          parameters: { useinbandfec: 1 }
+        }],
+        encodings: [{ ssrc: this.ssrc }]
+      },
+      appData: { processedFrom: this.source.id, mode: this.mode }
+    });
+
+    const firstRtp = new Promise((resolve) => this.outTransport.once('tuple', resolve));
+    this.spawnFfmpeg();
+    await this.consumer.resume();
+
+    let timer;
+    const timeout = new Promise((resolve, reject) => {
+      timer = setTimeout(() => reject(new Error(`no processed audio within ${START_TIMEOUT_MS} ms`)), START_TIMEOUT_MS);
+    });
+    const spawnFailed = new Promise((resolve, reject) => this.once('failed', reject));
+    try {
+      await Promise.race([firstRtp, timeout, spawnFailed]);
+    } finally {
+      clearTimeout(timer);
+    }
+  }
+
+  generateSdp() {
+    const codec = this.consumer.rtpParameters.codecs[0];
+    const ssrc = this.consumer.rtpParameters.encodings?.[0]?.ssrc;
+    const lines = [
+      'v=0',
+      'o=- 0 0 IN IP4 127.0.0.1',
+      's=soundcast-processing',
+      'c=IN IP4 127.0.0.1',
+      't=0 0',
+      `m=audio ${this.inputPort} RTP/AVP ${codec.payloadType}`,
+      `a=rtpmap:${codec.payloadType} opus/48000/2`,
+      `a=fmtp:${codec.payloadType} sprop-stereo=1; stereo=1; useinbandfec=1`,
+      'a=recvonly'
+    ];
+    if (ssrc) lines.push(`a=ssrc:${ssrc} cname:processing`);
+    return lines.join('\r\n') + '\r\n';
+  }
+
+  spawnFfmpeg() {
+    const { localPort } = this.outTransport.tuple;
+    const rtcpPort = this.outTransport.rtcpTuple?.localPort;
+    const output = `rtp://127.0.0.1:${localPort}?pkt_size=1200${rtcpPort ? `&rtcpport=${rtcpPort}` : ''}`;
+
+    const ffmpeg = spawn(FFMPEG_PATH, [
+      '-hide_banner',
+      '-loglevel', 'error',
+      '-protocol_whitelist', 'pipe,rtp,udp',
+      // No probing or input buffering: the stage must not add playout delay
+      '-fflags', 'nobuffer',
+      '-flags', 'low_delay',
+      '-probesize', '32',
+      '-analyzeduration', '0',
+      '-f', 'sdp',
+      '-i', 'pipe:0',
+      '-af', buildFilter(this.mode),
+      '-c:a', 'libopus',
+      '-application', 'voip',
+      '-frame_duration', '20',
+      '-b:a', String(this.bitrate),
+      '-ac', String(this.channels),
+      '-f', 'rtp',
+      '-ssrc', String(this.ssrc),
+      '-payload_type', String(OUTPUT_PAYLOAD_TYPE),
+      output
+    ], { stdio: ['pipe', 'ignore', 'pipe'] });
+    this.ffmpeg = ffmpeg;
+    const startedAt = Date.now();
+
+    ffmpeg.stdin.end(this.generateSdp());
+    ffmpeg.stdin.on('error', () => { }); // ffmpeg died before reading the SDP; handled on exit
+    ffmpeg.stderr.on('data', (data) => {
+      this.log.warn(`Audio processing ffmpeg (${this.source.id}): ${data.toString().trim()}`);
+    });
+    ffmpeg.on('error', (err) => {
+      this.log.error(`Audio processing ffmpeg failed to start: ${err.message}`);
+    });
+    ffmpeg.on('close', (code) => {
+      if (this.ffmpeg === ffmpeg) this.ffmpeg = null;
+      if (this.stopped) return;
+
+      if (Date.now() - startedAt >= STABLE_RUN_MS) this.restarts = 0;
+      if (this.restarts >= MAX_RESTARTS) {
+        this.emit('failed', new Error(`ffmpeg exited with code ${code} after ${this.restarts} restarts`));
+        return;
+      }
+      this.restarts += 1;
+      this.log.warn(`Audio processing ffmpeg for producer ${this.source.id} exited with code ${code}; restarting (${this.restarts}/${MAX_RESTARTS})`);
+      setTimeout(() => {
+        if (!this.stopped) this.spawnFfmpeg();
+      }, RESTART_DELAY_MS);
+    });
+  }
+
+  /**
+   * Stop ffmpeg and close the transports (which closes the processed producer and its consumers)
+   */
+  stop() {
+    if (this.stopped) return;
+    this.stopped = true;
+    if (this.ffmpeg) {
+      try {
+        this.ffmpeg.kill('SIGKILL');
+      } catch { }
+    }
+    for (const transport of [this.inTransport, this.outTransport]) {
+      if (transport && !transport.closed) {
+        try {
+          transport.close();
+        } catch { }
+      }
+    }
+    if (this.inputPort !== null) reservedInputPorts.delete(this.inputPort);
+  }
+}
+
+export default AudioProcessor;
@@ -0,0 +1,126 @@
+/**
+ * Room-level audio profiles.
+ *
+ * A profile sets the Opus encoder options publishers pass to mediasoup-client `produce()`
+ * (`codecOptions`), whether the SFU forwards Opus DTX packets to listeners (`ignoreDtx`),
+ * and the listener's playout (jitter buffer) target range.
+ *
+ * - `low-latency`: DTX without FEC, and a small playout target that only grows when the
+ *   listener starts concealing lost audio. For good networks.
+ * - `resilient` (default): DTX plus in-band FEC at a higher bitrate, so one lost packet is
+ *   recovered from the next, with a larger playout target.
+ *
+ * Both use DTX: interpretation channels are silent much of the time and DTX cuts publisher
+ * bitrate to a trickle during silence. Under low-latency the SFU also drops those DTX
+ * packets, so listener egress is close to zero while a channel is silent.
+ *
+ * Each publisher (channel) also has a profile of its own: `mono-speech` encodes one Opus
+ * channel at a speech bitrate, which roughly halves what the SFU forwards per listener;
+ * `stereo` keeps two channels at the room bitrate. A publisher's `audio_bitrate` overrides
+ * either bitrate.
+ */
+export const AUDIO_PROFILES = {
+  'low-latency': {
+    codecOptions: { opusDtx: true, opusFec: false, opusMaxAverageBitrate: 32000 },
+    ignoreDtx: true,
+    jitterBufferTargetMs: 20,
+    jitterBufferMaxMs: 120
+  },
+  resilient: {
+    codecOptions: { opusDtx: true, opusFec: true, opusMaxAverageBitrate: 64000 },
+    ignoreDtx: false,
+    jitterBufferTargetMs: 150,
+    jitterBufferMaxMs: 400
+  }
+};
+
+export const DEFAULT_AUDIO_PROFILE = 'resilient';
+
+export const PUBLISHER_AUDIO_PROFILES = {
+  'mono-speech': { channelCount: 1, bitrate: 24000 },
+  stereo: { channelCount: 2, bitrate: null } // room profile bitrate
+};
+
+export const DEFAULT_PUBLISHER_AUDIO_PROFILE = 'stereo';
+
+// Opus target bitrate bounds for publisher overrides (bps)
+export const MIN_AUDIO_BITRATE = 6000;
+export const MAX_AUDIO_BITRATE = 128000;
+
+/**
+ * @param {string} name
+ * @returns {boolean}
+ */
+export function isAudioProfile(name) {
+  return Object.prototype.hasOwnProperty.call(AUDIO_PROFILES, name);
+}
+
+/**
+ * @param {string} name
+ * @returns {boolean}
+ */
+export function isPublisherAudioProfile(name) {
+  return Object.prototype.hasOwnProperty.call(PUBLISHER_AUDIO_PROFILES, name);
+}
+
+/**
+ * @param {*} bitrate
+ * @returns {boolean} True for an integer bps value inside the Opus bounds
+ */
+export function isValidAudioBitrate(bitrate) {
+  return Number.isInteger(bitrate) && bitrate >= MIN_AUDIO_BITRATE && bitrate <= MAX_AUDIO_BITRATE;
+}
+
+/**
+ * @param {string} [name] - Room audio_profile; unknown names fall back to the default
+ * @returns {object} Profile settings
+ */
+export function getAudioProfile(name) {
+  return AUDIO_PROFILES[isAudioProfile(name) ? name : DEFAULT_AUDIO_PROFILE];
+}
+
+/**
+ * Settings sent to publishers and listeners in the room config message
+ * @param {string} [name] - Room audio_profile
+ * @param {object} [publisher] - Publisher row ({ audio_profile, audio_bitrate }) for publisher configs
+ * @returns {object} { name, codecOptions, jitterBufferTargetMs, jitterBufferMaxMs }, plus
+ *   { publisherProfile, channelCount } with a publisher
+ */
+export function getClientAudioProfile(name, publisher = null) {
+  const profile = getAudioProfile(name);
+  const clientProfile = {
+    name: isAudioProfile(name) ? name : DEFAULT_AUDIO_PROFILE,
+    codecOptions: profile.codecOptions,
+    jitterBufferTargetMs: profile.jitterBufferTargetMs,
+    jitterBufferMaxMs: profile.jitterBufferMaxMs
+  };
+  if (!publisher) return clientProfile;
+
+  const publisherProfileName = isPublisherAudioProfile(publisher.audio_profile)
+    ? publisher.audio_profile
+    : DEFAULT_PUBLISHER_AUDIO_PROFILE;
+  const publisherProfile = PUBLISHER_AUDIO_PROFILES[publisherProfileName];
+  const bitrate = publisher.audio_bitrate || publisherProfile.bitrate || profile.codecOptions.opusMaxAverageBitrate;
+  return {
+    ...clientProfile,
+    publisherProfile: publisherProfileName,
+    channelCount: publisherProfile.channelCount,
+    codecOptions: {
+      ...profile.codecOptions,
+      opusStereo: publisherProfile.channelCount === 2,
+      opusMaxAverageBitrate: bitrate
+    }
+  };
+}
+
+export default {
+  AUDIO_PROFILES,
+  DEFAULT_AUDIO_PROFILE,
+  PUBLISHER_AUDIO_PROFILES,
+  DEFAULT_PUBLISHER_AUDIO_PROFILE,
+  isAudioProfile,
+  isPublisherAudioProfile,
+  isValidAudioBitrate,
+  getAudioProfile,
+  getClientAudioProfile
+};
@@ -0,0 +1,240 @@
+/**
+ * Origin side of SFU cascading.
+ *
+ * An edge SFU (standalone-sfu with `--origin`) opens one signaling socket to `/ws/relay`
+ * and subscribes to the channels its listeners ask for. Per subscribed channel the origin
+ * opens one PipeTransport on the channel's home router and consumes every producer of the
+ * channel into it, so the edge receives a single RTP copy of each producer and fans it
+ * out locally. Producers that join or leave later are announced on the same socket.
+ *
+ * Messages in:  relay-subscribe { channelId, ip, port } | relay-unsubscribe { channelId }
+ * Messages out: relay-subscribed { channelId, ip, port, producers } |
+ *               relay-producer-added { channelId, producer } |
+ *               relay-producer-removed { channelId, producerId } |
+ *               relay-producer-paused / relay-producer-resumed { channelId, producerId } |
+ *               relay-error { channelId, message }
+ */
+export class RelayOrigin {
+  /**
+   * @param {object} options
+   * @param {object} options.workerPool - MediasoupWorkerPool (pipes producers onto the home router)
+   * @param {function} options.getChannel - (channelId) => channel state, created on demand (null at the channel limit)
+   * @param {string} options.listenIp - Local IP the pipe transports bind to
+   * @param {string} [options.announcedIp] - IP edges send RTP to
+   * @param {object} [options.log] - Logger with info/warn/error
+   */
+  constructor({ workerPool, getChannel, listenIp, announcedIp = null, log = console }) {
+    this.workerPool = workerPool;
+    this.getChannel = getChannel;
+    this.listenIp = listenIp;
+    this.announcedIp = announcedIp;
+    this.log = log;
+
+    this.edges = new Set(); // { socket, name, relays: Map<channelId, relay> }
+    this.relaysByChannel = new Map(); // channelId -> Set<relay>
+  }
+
+  /**
+   * Serve one edge connection until it closes.
+   * @param {object} socket - Authenticated ws socket
+   * @param {string} [name] - Edge name for logs
+   */
+  attach(socket, name = 'edge') {
+    const edge = { socket, name, relays: new Map() };
+    this.edges.add(edge);
+    this.log.info(`Relay edge connected: ${name}`);
+
+    socket.on('message', async (message) => {
+      let payload;
+      try {
+        payload = JSON.parse(message.toString());
+      } catch {
+        return;
+      }
+      const { action, data = {} } = payload;
+      try {
+        if (action === 'relay-subscribe') {
+          await this.subscribe(edge, data);
+        } else if (action === 'relay-unsubscribe') {
+          this.unsubscribe(edge, data.channelId);
+        }
+      } catch (error) {
+        this.log.error(`Relay ${action} for ${data.channelId} from ${name} failed: ${error.message}`);
+        this.unsubscribe(edge, data.channelId);
+        this.send(edge, 'relay-error', { channelId: data.channelId, message: error.message });
+      }
+    });
+
+    socket.on('close', () => {
+      for (const channelId of [...edge.relays.keys()]) {
+        this.unsubscribe(edge, channelId);
+      }
+      this.edges.delete(edge);
+      this.log.info(`Relay edge disconnected: ${name}`);
+    });
+  }
+
+  send(edge, action, data) {
+    try {
+      edge.socket.send(JSON.stringify({ action, data }));
+    } catch { }
+  }
+
+  async subscribe(edge, { channelId, ip, port }) {
+    if (!channelId || !ip || !port) {
+      throw new Error('channelId, ip and port are required');
+    }
+    if (edge.relays.has(channelId)) {
+      this.unsubscribe(edge, channelId);
+    }
+
+    const channel = this.getChannel(channelId);
+    if (!channel) throw new Error('Channel limit reached');
+    const transport = await channel.router.createPipeTransport({
+      listenInfo: { protocol: 'udp', ip: this.listenIp, announcedAddress: this.announcedIp || undefined },
+      enableRtx: false,
+      enableSrtp: false
+    });
+    const relay = { edge, channelId, channel, transport, consumers: new Map() }; // producerId -> consumer
+    edge.relays.set(channelId, relay);
+
+    transport.observer.once('close', () => {
+      if (edge.relays.get(channelId) === relay) this.unsubscribe(edge, channelId);
+    });
+
+    await transport.connect({ ip, port });
+
+    // The edge ignores relay-producer-added until relay-subscribed, so addProducer() only sees
+    // this relay once the snapshot covers every producer, including ones added while it was built
+    const described = new Map(); // producerId -> description
+    const attempted = new Set();
+    for (;;) {
+      const pending = [...channel.producers].filter(([producerId]) => !attempted.has(producerId));
+      if (pending.length === 0) break;
+      for (const [producerId, producerInfo] of pending) {
+        attempted.add(producerId);
+        const description = await this.consumeProducer(relay, producerId, producerInfo);
+        if (description) described.set(producerId, description);
+      }
+    }
+    if (edge.relays.get(channelId) !== relay) return; // unsubscribed or re-subscribed meanwhile
+
+    // Producers that closed or left the channel meanwhile are not announced
+    for (const [producerId, consumer] of relay.consumers) {
+      if (channel.producers.has(producerId)) continue;
+      relay.consumers.delete(producerId);
+      consumer.close();
+    }
+    const producers = [];
+    for (const [producerId, consumer] of relay.consumers) {
+      producers.push({ ...described.get(producerId), paused: consumer.producerPaused });
+    }
+    if (!this.relaysByChannel.has(channelId)) this.relaysByChannel.set(channelId, new Set());
+    this.relaysByChannel.get(channelId).add(relay);
+
+    this.send(edge, 'relay-subscribed', {
+      channelId,
+      ip: this.announcedIp || transport.tuple.localAddress,
+      port: transport.tuple.localPort,
+      producers
+    });
+    this.log.info(`Relaying ${channelId} to ${edge.name} (${producers.length} producer(s))`);
+  }
+
+  unsubscribe(edge, channelId) {
+    const relay = edge.relays.get(channelId);
+    if (!relay) return;
+    edge.relays.delete(channelId);
+
+    const relays = this.relaysByChannel.get(channelId);
+    if (relays) {
+      relays.delete(relay);
+      if (relays.size === 0) this.relaysByChannel.delete(channelId);
+    }
+    if (!relay.transport.closed) {
+      try {
+        relay.transport.close();
+      } catch { }
+    }
+  }
+
+  async consumeProducer(relay, producerId, producerInfo) {
+    const { producer } = producerInfo;
+    if (!producer || producer.closed || relay.consumers.has(producerId)) return null;
+
+    await this.workerPool.ensureProducerOnRouter(producerInfo, relay.channel.router);
+    const consumer = await relay.transport.consume({ producerId: producer.id });
+    relay.consumers.set(producerId, consumer);
+
+    const { edge, channelId } = relay;
+    consumer.on('producerclose', () => {
+      relay.consumers.delete(producerId);
+      this.send(edge, 'relay-producer-removed', { channelId, producerId });
+    });
+    consumer.on('producerpause', () => this.send(edge, 'relay-producer-paused', { channelId, producerId }));
+    consumer.on('producerresume', () => this.send(edge, 'relay-producer-resumed', { channelId, producerId }));
+
+    return {
+      producerId,
+      kind: consumer.kind,
+      rtpParameters: consumer.rtpParameters,
+      paused: consumer.producerPaused,
+      publisherId: producerInfo.publisherId || null
+    };
+  }
+
+  /**
+   * Forward a new producer to every edge relaying its channel.
+   */
+  async addProducer(channelId, producerId, producerInfo) {
+    const relays = this.relaysByChannel.get(channelId);
+    if (!relays) return;
+    for (const relay of [...relays]) {
+      try {
+        const producer = await this.consumeProducer(relay, producerId, producerInfo);
+        if (producer) this.send(relay.edge, 'relay-producer-added', { channelId, producer });
+      } catch (error) {
+        this.log.error(`Relay of producer ${producerId} to ${relay.edge.name} failed: ${error.message}`);
+      }
+    }
+  }
+
+  /**
+   * Stop forwarding a producer that is still open but left the channel (e.g. moved).
+   */
+  removeProducer(channelId, producerId) {
+    const relays = this.relaysByChannel.get(channelId);
+    if (!relays) return;
+    for (const relay of relays) {
+      const consumer = relay.consumers.get(producerId);
+      if (!consumer) continue;
+      relay.consumers.delete(producerId);
+      consumer.close();
+      this.send(relay.edge, 'relay-producer-removed', { channelId, producerId });
+    }
+  }
+
+  getStats() {
+    return [...this.edges].map((edge) => ({
+      name: edge.name,
+      channels: [...edge.relays.values()].map((relay) => ({
+        channelId: relay.channelId,
+        producers: relay.consumers.size
+      }))
+    }));
+  }
+
+  close() {
+    for (const edge of this.edges) {
+      for (const channelId of [...edge.relays.keys()]) {
+        this.unsubscribe(edge, channelId);
+      }
+      try {
+        edge.socket.close();
+      } catch { }
+    }
+    this.edges.clear();
+  }
+}
+
+export default RelayOrigin;
@@ -0,0 +1,165 @@
+import { v4 as uuidv4 } from 'uuid';
+
+// Placement prefers an edge already relaying the channel unless it is this many CPU points busier
+const NEW_CHANNEL_CPU_PENALTY = 10;
+
+/**
+ * In-memory registry of standalone SFUs and their heartbeat load.
+ *
+ * SFUs register on start, report load (worker CPU, egress bitrate, free RTC ports, listeners)
+ * with every heartbeat and push per-channel stats over /ws/sfu-stats. `place()` hands a new
+ * listener the least-loaded healthy edge for its channel. A node is healthy while its
+ * heartbeats are fresh, it is not draining, it has a free port and its CPU is under the cap.
+ * The registry is rebuilt from heartbeats after a master restart: unknown ids get a 404
+ * and the SFU registers again.
+ */
+export class SfuRegistry {
+  /**
+   * @param {object} [options]
+   * @param {number} [options.maxCpuPercent] - Worker CPU above which a node gets no new listeners
+   * @param {number} [options.missedHeartbeats] - Heartbeat intervals without news before a node is stale
+   */
+  constructor({ maxCpuPercent = 85, missedHeartbeats = 3 } = {}) {
+    this.maxCpuPercent = maxCpuPercent;
+    this.missedHeartbeats = missedHeartbeats;
+    this.nodes = new Map(); // id -> node
+  }
+
+  /**
+   * Add an SFU, or refresh it when the same URL registers again.
+   * @returns {object} Node
+   */
+  register({ name, url, announced_ip = null, port = null, heartbeat_interval_ms = 30000, load = null }) {
+    let node = [...this.nodes.values()].find(existing => existing.url === url);
+    if (!node) {
+      node = {
+        id: uuidv4(),
+        url,
+        registeredAt: Date.now(),
+        draining: false,
+        load: {},
+        channels: {},
+        joinedSinceHeartbeat: 0
+      };
+      this.nodes.set(node.id, node);
+    }
+    // A restarted node comes back out of drain
+    node.draining = false;
+    node.name = name || url;
+    node.announcedIp = announced_ip;
+    node.port = port;
+    node.heartbeatIntervalMs = Math.max(1000, parseInt(heartbeat_interval_ms, 10) || 30000);
+    this.heartbeat(node.id, load);
+    return node;
+  }
+
+  get(id) {
+    return this.nodes.get(id) || null;
+  }
+
+  /**
+   * @returns {object|null} Node, or null if the id is unknown
+   */
+  heartbeat(id, load = null) {
+    const node = this.nodes.get(id);
+    if (!node) return null;
+    node.lastHeartbeatAt = Date.now();
+    if (load && typeof load === 'object') {
+      node.load = load;
+      node.joinedSinceHeartbeat = 0;
+      // The node's own drain (rolling restart) sticks until it re-registers
+      if (load.draining) node.draining = true;
+    }
+    return node;
+  }
+
+  /**
+   * Per-channel stats pushed by the node on every join and leave. `listeners` (its current
+   * listener total) tells place() how many joined since the heartbeat load was sampled.
+   */
+  updateChannels(id, channels, listeners = null) {
+    const node = this.nodes.get(id);
+    if (!node) return;
+    node.channels = channels && typeof channels === 'object' ? channels : {};
+    node.lastHeartbeatAt = Date.now();
+    if (Number.isFinite(listeners)) {
+      node.joinedSinceHeartbeat = Math.max(0, listeners - (node.load.listeners || 0));
+    }
+  }
+
+  setDraining(id, draining) {
+    const node = this.nodes.get(id);
+    if (!node) return null;
+    node.draining = Boolean(draining);
+    return node;
+  }
+
+  remove(id) {
+    return this.nodes.delete(id);
+  }
+
+  isHealthy(node, now = Date.now()) {
+    const { cpuPercent = 0, freePorts = 1 } = node.load;
+    return (
+      now - node.lastHeartbeatAt <= node.heartbeatIntervalMs * this.missedHeartbeats &&
+      !node.draining &&
+      freePorts > 0 &&
+      cpuPercent < this.maxCpuPercent
+    );
+  }
+
+  /**
+   * Pick the edge for a new listener of `channelId`. Listeners that joined a node since its
+   * last heartbeat (as the node reports them) count against it, so a burst of joins spreads
+   * out instead of piling onto one node. Placement itself changes nothing: the route is
+   * unauthenticated, and a lookup that never turns into a join must not add load.
+   * @returns {object|null} Node, or null when no edge can take the listener
+   */
+  place(channelId) {
+    const now = Date.now();
+    let best = null;
+    let bestScore = Infinity;
+    let bestListeners = Infinity;
+
+    for (const node of this.nodes.values()) {
+      // Only edges relay from the origin; other SFUs serve their own publishers
+      if (!node.load.origin || !this.isHealthy(node, now)) continue;
+
+      const { cpuPercent = 0, listeners = 0 } = node.load;
+      const cpuPerListener = listeners > 0 ? cpuPercent / listeners : 0;
+      let score = cpuPercent + node.joinedSinceHeartbeat * cpuPerListener;
+      if (!Object.hasOwn(node.channels, channelId)) score += NEW_CHANNEL_CPU_PENALTY;
+      if (score >= this.maxCpuPercent) continue;
+
+      // Ties (e.g. idle nodes) go to the node with fewer listeners, counting recent joins
+      const expectedListeners = listeners + node.joinedSinceHeartbeat;
+      if (score < bestScore || (score === bestScore && expectedListeners < bestListeners)) {
+        best = node;
+        bestScore = score;
+        bestListeners = expectedListeners;
+      }
+    }
+
+    return best;
+  }
+
+  toJSON(node, now = Date.now()) {
+    return {
+      id: node.id,
+      name: node.name,
+      url: node.url,
+      healthy: this.isHealthy(node, now),
+      draining: node.draining,
+      lastHeartbeatAt: node.lastHeartbeatAt,
+      load: node.load,
+      channels: node.channels
+    };
+  }
+
+  list() {
+    const now = Date.now();
+    return [...this.nodes.values()].map(node => this.toJSON(node, now));
+  }
+}
+
+export default SfuRegistry;
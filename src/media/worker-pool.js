@@ -0,0 +1,244 @@
+import os from 'os';
+import mediasoup from 'mediasoup';
+
+const DEFAULT_NUM_WORKERS = typeof os.availableParallelism === 'function'
+  ? os.availableParallelism()
+  : os.cpus().length;
+
+/**
+ * Pool of mediasoup workers, one router per worker.
+ *
+ * Load is tracked per router as the number of live transports and consumers,
+ * using mediasoup observer events so callers never have to report it manually.
+ * Channels are placed on the least-loaded router, and a busy channel's listeners
+ * spill onto other routers once its home router passes `maxListenersPerRouter`.
+ * Producers are piped to those routers on demand with `pipeToRouter()`; the pipe
+ * producer keeps the same id as the origin producer, so consumers can use it as-is.
+ *
+ * With `webRtcServer` set, each worker also opens one mediasoup WebRtcServer on
+ * `port + workerIndex` (UDP and TCP). WebRTC transports then share that socket,
+ * demuxed by ICE ufrag, instead of binding a port each from the RTC range.
+ */
+export class MediasoupWorkerPool {
+  constructor({
+    numWorkers = DEFAULT_NUM_WORKERS,
+    rtcMinPort = 40000,
+    rtcMaxPort = 49999,
+    maxListenersPerRouter = 500,
+    logLevel = 'warn',
+    logTags = [],
+    webRtcServer = null, // { listenIp, announcedIp, port }
+    log = console
+  } = {}) {
+    this.numWorkers = Math.max(1, numWorkers || 1);
+    this.rtcMinPort = rtcMinPort;
+    this.rtcMaxPort = rtcMaxPort;
+    this.maxListenersPerRouter = Math.max(1, maxListenersPerRouter);
+    this.logLevel = logLevel;
+    this.logTags = logTags;
+    this.webRtcServerConfig = webRtcServer;
+    this.log = log;
+
+    this.entries = []; // [{ worker, router, webRtcServer, webRtcServerPort, portRange, transports, consumers }]
+    this.entriesByRouterId = new Map(); // routerId -> entry
+  }
+
+  /**
+   * Split the RTC port range so each worker binds its own slice.
+   * @returns {Array<{ min: number, max: number }>}
+   */
+  splitPortRange() {
+    const totalPorts = this.rtcMaxPort - this.rtcMinPort + 1;
+    const workerCount = Math.max(1, Math.min(this.numWorkers, Math.floor(totalPorts / 2)));
+    const sliceSize = Math.floor(totalPorts / workerCount);
+    const ranges = [];
+    for (let i = 0; i < workerCount; i += 1) {
+      const min = this.rtcMinPort + i * sliceSize;
+      const max = i === workerCount - 1 ? this.rtcMaxPort : min + sliceSize - 1;
+      ranges.push({ min, max });
+    }
+    return ranges;
+  }
+
+  /**
+   * Create all workers and their routers.
+   * @param {object} options
+   * @param {Array} options.mediaCodecs - Router media codecs
+   * @param {function} [options.onWorkerDied] - Called with (worker, error) when a worker dies
+   */
+  async init({ mediaCodecs, onWorkerDied = null }) {
+    const ranges = this.splitPortRange();
+    if (ranges.length < this.numWorkers) {
+      this.log.warn(`RTC port range too small for ${this.numWorkers} workers, using ${ranges.length}`);
+    }
+
+    for (const [index, portRange] of ranges.entries()) {
+      const worker = await mediasoup.createWorker({
+        rtcMinPort: portRange.min,
+        rtcMaxPort: portRange.max,
+        logLevel: this.logLevel,
+        logTags: this.logTags
+      });
+      worker.on('died', (error) => {
+        if (onWorkerDied) onWorkerDied(worker, error);
+      });
+
+      const webRtcServerPort = this.webRtcServerConfig ? this.webRtcServerConfig.port + index : null;
+      const webRtcServer = webRtcServerPort ? await this.createWebRtcServer(worker, webRtcServerPort) : null;
+      const router = await worker.createRouter({ mediaCodecs });
+      const entry = { worker, router, webRtcServer, webRtcServerPort, portRange, transports: 0, consumers: 0 };
+      this.trackRouterLoad(entry);
+      this.entries.push(entry);
+      this.entriesByRouterId.set(router.id, entry);
+    }
+
+    this.log.info(`mediasoup worker pool ready: ${this.entries.length} worker(s)`);
+    return this;
+  }
+
+  async createWebRtcServer(worker, port) {
+    const { listenIp, announcedIp } = this.webRtcServerConfig;
+    const listenInfo = { ip: listenIp, announcedAddress: announcedIp || undefined, port };
+    const webRtcServer = await worker.createWebRtcServer({
+      listenInfos: [
+        { ...listenInfo, protocol: 'udp' },
+        { ...listenInfo, protocol: 'tcp' }
+      ]
+    });
+    this.log.info(`mediasoup WebRtcServer listening on ${listenIp}:${port} (udp+tcp) for worker ${worker.pid}`);
+    return webRtcServer;
+  }
+
+  trackRouterLoad(entry) {
+    entry.router.observer.on('newtransport', (transport) => {
+      entry.transports += 1;
+      transport.observer.once('close', () => {
+        entry.transports = Math.max(0, entry.transports - 1);
+      });
+      transport.observer.on('newconsumer', (consumer) => {
+        entry.consumers += 1;
+        consumer.observer.once('close', () => {
+          entry.consumers = Math.max(0, entry.consumers - 1);
+        });
+      });
+    });
+  }
+
+  get size() {
+    return this.entries.length;
+  }
+
+  /**
+   * Any router will do for capabilities: all routers share the same codecs.
+   */
+  get defaultRouter() {
+    return this.entries[0]?.router || null;
+  }
+
+  get rtpCapabilities() {
+    return this.defaultRouter?.rtpCapabilities || null;
+  }
+
+  /**
+   * WebRtcServer owned by the router's worker, or null when running with per-transport ports.
+   */
+  getWebRtcServer(router) {
+    const entry = router ? this.entriesByRouterId.get(router.id) : null;
+    return entry?.webRtcServer || null;
+  }
+
+  getRouterLoad(router) {
+    const entry = router ? this.entriesByRouterId.get(router.id) : null;
+    if (!entry) return 0;
+    return entry.transports + entry.consumers;
+  }
+
+  getLeastLoadedRouter(candidates = null) {
+    const pool = candidates
+      ? this.entries.filter((entry) => candidates.has(entry.router.id))
+      : this.entries;
+    let best = null;
+    for (const entry of pool) {
+      if (entry.worker.died || entry.router.closed) continue;
+      if (!best || entry.transports + entry.consumers < best.transports + best.consumers) {
+        best = entry;
+      }
+    }
+    return best?.router || null;
+  }
+
+  /**
+   * Pick the router a new listener of `channel` should attach to.
+   * Stays on the channel's home router until it is busy, then prefers routers the
+   * channel already spilled onto before opening a pipe to a fresh one.
+   * @param {object} channel - Channel state with `router` and `listenersByRouter` (routerId -> count)
+   */
+  pickListenerRouter(channel) {
+    const home = channel.router || this.getLeastLoadedRouter();
+    if ((channel.listenersByRouter.get(home.id) || 0) < this.maxListenersPerRouter) {
+      return home;
+    }
+
+    let spillRouter = null;
+    let spillCount = Infinity;
+    for (const [routerId, count] of channel.listenersByRouter) {
+      if (routerId === home.id) continue;
+      const entry = this.entriesByRouterId.get(routerId);
+      if (!entry || entry.worker.died || entry.router.closed) continue;
+      if (count < this.maxListenersPerRouter && count < spillCount) {
+        spillRouter = entry.router;
+        spillCount = count;
+      }
+    }
+    return spillRouter || this.getLeastLoadedRouter() || home;
+  }
+
+  /**
+   * Make sure `producerInfo.producer` is consumable on `targetRouter`.
+   * @param {object} producerInfo - Producer info with `producer` and the `router` it was produced on
+   * @param {object} targetRouter - Router the consumer lives on
+   */
+  async ensureProducerOnRouter(producerInfo, targetRouter) {
+    const sourceRouter = producerInfo.router;
+    if (!sourceRouter || !targetRouter || sourceRouter.id === targetRouter.id) return;
+    if (!producerInfo.pipes) {
+      producerInfo.pipes = new Map(); // routerId -> Promise<{ pipeConsumer, pipeProducer }>
+    }
+
+    let pending = producerInfo.pipes.get(targetRouter.id);
+    if (!pending) {
+      pending = sourceRouter.pipeToRouter({
+        producerId: producerInfo.producer.id,
+        router: targetRouter
+      });
+      producerInfo.pipes.set(targetRouter.id, pending);
+      pending.catch(() => {
+        producerInfo.pipes.delete(targetRouter.id);
+      });
+    }
+    await pending;
+  }
+
+  getStats() {
+    return this.entries.map((entry) => ({
+      pid: entry.worker.pid,
+      routerId: entry.router.id,
+      portRange: entry.portRange,
+      webRtcServerPort: entry.webRtcServerPort,
+      transports: entry.transports,
+      consumers: entry.consumers
+    }));
+  }
+
+  close() {
+    for (const entry of this.entries) {
+      try {
+        entry.worker.close();
+      } catch { }
+    }
+    this.entries = [];
+    this.entriesByRouterId.clear();
+  }
+}
+
+export default MediasoupWorkerPool;
@@ -0,0 +1,250 @@
+import { monitorEventLoopDelay, performance } from 'perf_hooks';
+
+/**
+ * Minimal Prometheus text-format registry for hot-path metrics (served at /metrics).
+ *
+ * Hot paths only touch in-memory counters (`observe`, `inc`); anything that needs an RPC or
+ * a scan (worker resource usage, queue depth) is gathered by collectors at scrape time.
+ * Metric names follow docs/ARCHITECTURE_REBUILD.md (Observability).
+ */
+
+const DEFAULT_BUCKETS = [0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10];
+
+function formatLabels(labels) {
+  const entries = Object.entries(labels);
+  if (entries.length === 0) return '';
+  const body = entries
+    .map(([key, value]) => `${key}="${String(value).replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n')}"`)
+    .join(',');
+  return `{${body}}`;
+}
+
+function labelKey(labels) {
+  return JSON.stringify(labels);
+}
+
+class Metric {
+  constructor(type, name, help) {
+    this.type = type;
+    this.name = name;
+    this.help = help;
+    this.series = new Map(); // labelKey -> { labels, ... }
+  }
+
+  header() {
+    return [`# HELP ${this.name} ${this.help}`, `# TYPE ${this.name} ${this.type}`];
+  }
+}
+
+export class Counter extends Metric {
+  constructor(name, help) {
+    super('counter', name, help);
+  }
+
+  inc(value = 1, labels = {}) {
+    const key = labelKey(labels);
+    const series = this.series.get(key);
+    if (series) {
+      series.value += value;
+    } else {
+      this.series.set(key, { labels, value });
+    }
+  }
+
+  // Collectors mirror cumulative values kept elsewhere (e.g. worker CPU time)
+  set(value, labels = {}) {
+    this.series.set(labelKey(labels), { labels, value });
+  }
+
+  render() {
+    const lines = this.header();
+    for (const { labels, value } of this.series.values()) {
+      lines.push(`${this.name}${formatLabels(labels)} ${value}`);
+    }
+    return lines;
+  }
+}
+
+export class Gauge extends Counter {
+  constructor(name, help) {
+    super(name, help);
+    this.type = 'gauge';
+  }
+
+  reset() {
+    this.series.clear();
+  }
+}
+
+export class Histogram extends Metric {
+  constructor(name, help, { buckets = DEFAULT_BUCKETS } = {}) {
+    super('histogram', name, help);
+    this.buckets = buckets;
+  }
+
+  observe(value, labels = {}) {
+    const key = labelKey(labels);
+    let series = this.series.get(key);
+    if (!series) {
+      series = { labels, counts: new Array(this.buckets.length).fill(0), sum: 0, count: 0 };
+      this.series.set(key, series);
+    }
+    for (let i = 0; i < this.buckets.length; i++) {
+      if (value <= this.buckets[i]) series.counts[i] += 1;
+    }
+    series.sum += value;
+    series.count += 1;
+  }
+
+  /**
+   * @returns {function} Call to observe the seconds elapsed since startTimer()
+   */
+  startTimer(labels = {}) {
+    const startedAt = performance.now();
+    return () => this.observe((performance.now() - startedAt) / 1000, labels);
+  }
+
+  render() {
+    const lines = this.header();
+    for (const { labels, counts, sum, count } of this.series.values()) {
+      for (let i = 0; i < this.buckets.length; i++) {
+        lines.push(`${this.name}_bucket${formatLabels({ ...labels, le: this.buckets[i] })} ${counts[i]}`);
+      }
+      lines.push(`${this.name}_bucket${formatLabels({ ...labels, le: '+Inf' })} ${count}`);
+      lines.push(`${this.name}_sum${formatLabels(labels)} ${sum}`);
+      lines.push(`${this.name}_count${formatLabels(labels)} ${count}`);
+    }
+    return lines;
+  }
+}
+
+// Event-loop delay as a summary over the window since the previous scrape
+class EventLoopDelaySummary extends Metric {
+  constructor(name, help) {
+    super('summary', name, help);
+    this.monitor = monitorEventLoopDelay({ resolution: 10 });
+    this.monitor.enable();
+  }
+
+  render() {
+    const lines = this.header();
+    const { monitor } = this;
+    for (const quantile of [0.5, 0.9, 0.99]) {
+      lines.push(`${this.name}${formatLabels({ quantile })} ${monitor.percentile(quantile * 100) / 1e9}`);
+    }
+    const count = monitor.count || 0;
+    lines.push(`${this.name}_sum ${count > 0 ? (monitor.mean * count) / 1e9 : 0}`);
+    lines.push(`${this.name}_count ${count}`);
+    monitor.reset();
+    return lines;
+  }
+}
+
+const registered = [];
+const collectors = [];
+
+function register(metric) {
+  registered.push(metric);
+  return metric;
+}
+
+/**
+ * Add a scrape-time collector; it may be async and should only `set` metrics.
+ */
+export function registerCollector(collector) {
+  collectors.push(collector);
+}
+
+/**
+ * @returns {Promise<string>} All metrics in Prometheus text exposition format
+ */
+export async function renderMetrics() {
+  await Promise.allSettled(collectors.map((collector) => collector()));
+  const lines = [];
+  for (const metric of registered) {
+    lines.push(...metric.render());
+  }
+  return `${lines.join('\n')}\n`;
+}
+
+export const metrics = {
+  // SFU
+  listenerJoinSeconds: register(new Histogram(
+    'soundcast_listener_join_seconds',
+    'Listener transport creation to first consumer created'
+  )),
+  consumeRpcSeconds: register(new Histogram(
+    'soundcast_consume_rpc_seconds',
+    'Duration of mediasoup transport.consume() calls'
+  )),
+  workerCpuSeconds: register(new Counter(
+    'soundcast_mediasoup_worker_cpu_seconds_total',
+    'mediasoup worker CPU time from getResourceUsage()'
+  )),
+  workerMaxRssBytes: register(new Gauge(
+    'soundcast_mediasoup_worker_max_rss_bytes',
+    'mediasoup worker peak resident set size from getResourceUsage()'
+  )),
+  workerUsageRpcSeconds: register(new Histogram(
+    'soundcast_mediasoup_worker_usage_rpc_seconds',
+    'Duration of mediasoup worker.getResourceUsage() calls'
+  )),
+  routerLoad: register(new Gauge(
+    'soundcast_mediasoup_router_load',
+    'Live transports and consumers per router'
+  )),
+  channels: register(new Gauge('soundcast_channels', 'Channels in memory')),
+  listeners: register(new Gauge('soundcast_listeners', 'Unique listeners across channels')),
+  stateEntries: register(new Gauge(
+    'soundcast_state_entries',
+    'Entries in each in-memory signaling structure'
+  )),
+  processMemoryBytes: register(new Gauge(
+    'soundcast_process_memory_bytes',
+    'Main process memory from process.memoryUsage()'
+  )),
+  eventLoopDelaySeconds: register(new EventLoopDelaySummary(
+    'soundcast_event_loop_delay_seconds',
+    'Main thread event-loop delay since the previous scrape'
+  )),
+
+  // Transcription
+  asrSessions: register(new Gauge('soundcast_asr_sessions', 'Active transcription sessions')),
+  asrQueueDepth: register(new Gauge('soundcast_asr_queue_depth', 'Segments waiting for transcription')),
+  asrInFlight: register(new Gauge('soundcast_asr_in_flight', 'Sidecar requests in flight')),
+  asrDroppedSegments: register(new Counter(
+    'soundcast_asr_dropped_segments_total',
+    'Segments dropped from full stream backlogs'
+  )),
+  asrSegmentSeconds: register(new Histogram(
+    'soundcast_asr_segment_seconds',
+    'Segment queued to transcript text (queue wait plus sidecar time)',
+    { buckets: [0.1, 0.25, 0.5, 1, 2, 4, 8, 15, 30, 60] }
+  )),
+  asrErrors: register(new Counter('soundcast_asr_errors_total', 'Failed segment transcriptions')),
+
+  // Recording
+  recordingBytesWritten: register(new Counter(
+    'soundcast_recording_bytes_written_total',
+    'Ogg bytes written by the native recording muxer'
+  )),
+
+  // Database
+  dbWriteOpSeconds: register(new Histogram(
+    'soundcast_db_write_op_seconds',
+    'Duration of DB writer ops'
+  )),
+  dbWriteBatchSeconds: register(new Histogram(
+    'soundcast_db_write_batch_seconds',
+    'Duration of DB writer transactions'
+  )),
+  // Statements from prepareCached() only; ad-hoc db.prepare() calls in the tenant, room,
+  // publisher and recording models are not timed
+  dbStatementSeconds: register(new Histogram(
+    'soundcast_db_statement_seconds',
+    'Duration of cached statement executions on the calling thread, by operation and table',
+    { buckets: [0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.1] }
+  ))
+};
+
+export default metrics;
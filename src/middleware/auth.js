@@ -38,6 +38,27 @@ export async function authenticateTenant(request, reply) {
   request.tenant = tenant;
 }
 
+/**
+ * Authenticate a standalone SFU by the shared SFU_SECRET_KEY Bearer token
+ */
+export async function authenticateSfu(request, reply) {
+  const secretKey = process.env.SFU_SECRET_KEY;
+  if (!secretKey) {
+    return reply.code(503).send({
+      error: 'Service Unavailable',
+      message: 'SFU registration is disabled (SFU_SECRET_KEY not set)'
+    });
+  }
+
+  const authHeader = request.headers.authorization || '';
+  if (authHeader !== `Bearer ${secretKey}`) {
+    return reply.code(401).send({
+      error: 'Unauthorized',
+      message: 'Invalid SFU secret key'
+    });
+  }
+}
+
 /**
  * Verify tenant owns the room (for routes with room_slug parameter)
  */
@@ -56,5 +77,6 @@ export async function verifyRoomOwnership(request, reply) {
 
 export default {
   authenticateTenant,
+  authenticateSfu,
   verifyRoomOwnership
 };
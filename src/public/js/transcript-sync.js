@@ -28,7 +28,7 @@
     }, 'local-input');
   }
 
-  async function createBinding({ wsUrl, textarea, onStatus }) {
+  async function createBinding({ wsUrl, textarea, onStatus, onPartial }) {
     const ydoc = new Y.Doc();
     const ytext = ydoc.getText('transcript');
     let socket = null;
@@ -104,6 +104,8 @@
           const payload = JSON.parse(event.data);
           if (payload.type === 'error') {
             if (onStatus) onStatus('error', payload.message || 'Transcript socket error');
+          } else if (payload.type === 'partial') {
+            if (onPartial) onPartial(payload);
           } else if (payload.type === 'pong') {
             // No-op
           }
@@ -0,0 +1,258 @@
+/**
+ * Minimal Ogg/Opus container helpers (RFC 3533, RFC 7845).
+ *
+ * Only what the recorder needs: building pages around already-encoded Opus
+ * packets, the two mandatory header packets, and Opus packet durations for
+ * granule positions, plus reading a file's audio duration back. No decoding
+ * happens here.
+ */
+
+const OPUS_SAMPLE_RATE = 48000;
+const OGG_MAX_LACING_VALUES = 255;
+
+const CRC_TABLE = (() => {
+  const table = new Uint32Array(256);
+  for (let i = 0; i < 256; i += 1) {
+    let r = i << 24;
+    for (let j = 0; j < 8; j += 1) {
+      r = (r & 0x80000000) ? ((r << 1) ^ 0x04c11db7) : (r << 1);
+    }
+    table[i] = r >>> 0;
+  }
+  return table;
+})();
+
+function oggCrc32(buffer) {
+  let crc = 0;
+  for (let i = 0; i < buffer.length; i += 1) {
+    crc = ((crc << 8) ^ CRC_TABLE[((crc >>> 24) ^ buffer[i]) & 0xff]) >>> 0;
+  }
+  return crc;
+}
+
+/**
+ * Build one Ogg page holding complete packets (no packet spans pages).
+ * @param {object} page
+ * @param {Buffer[]} page.packets - Packets to place in the page
+ * @param {bigint} page.granulePosition - Granule position after the last packet
+ * @param {number} page.serial - Bitstream serial number
+ * @param {number} page.sequence - Page sequence number
+ * @param {boolean} [page.bos] - Beginning of stream
+ * @param {boolean} [page.eos] - End of stream
+ * @returns {Buffer}
+ */
+export function buildOggPage({ packets, granulePosition, serial, sequence, bos = false, eos = false }) {
+  const lacing = [];
+  for (const packet of packets) {
+    let remaining = packet.length;
+    while (remaining >= 255) {
+      lacing.push(255);
+      remaining -= 255;
+    }
+    lacing.push(remaining);
+  }
+  if (lacing.length > OGG_MAX_LACING_VALUES) {
+    throw new Error(`Ogg page overflow: ${lacing.length} lacing values`);
+  }
+
+  const header = Buffer.alloc(27 + lacing.length);
+  header.write('OggS', 0, 'ascii');
+  header.writeUInt8(0, 4); // version
+  header.writeUInt8((bos ? 0x02 : 0) | (eos ? 0x04 : 0), 5);
+  header.writeBigInt64LE(BigInt(granulePosition), 6);
+  header.writeUInt32LE(serial >>> 0, 14);
+  header.writeUInt32LE(sequence >>> 0, 18);
+  header.writeUInt32LE(0, 22); // CRC placeholder
+  header.writeUInt8(lacing.length, 26);
+  for (let i = 0; i < lacing.length; i += 1) {
+    header.writeUInt8(lacing[i], 27 + i);
+  }
+
+  const page = Buffer.concat([header, ...packets]);
+  page.writeUInt32LE(oggCrc32(page), 22);
+  return page;
+}
+
+/**
+ * Number of lacing values a packet needs.
+ */
+export function lacingSize(packet) {
+  return Math.floor(packet.length / 255) + 1;
+}
+
+export function buildOpusHead({ channels = 2, preSkip = 0, inputSampleRate = OPUS_SAMPLE_RATE } = {}) {
+  const head = Buffer.alloc(19);
+  head.write('OpusHead', 0, 'ascii');
+  head.writeUInt8(1, 8); // version
+  head.writeUInt8(channels, 9);
+  head.writeUInt16LE(preSkip, 10);
+  head.writeUInt32LE(inputSampleRate, 12);
+  head.writeInt16LE(0, 16); // output gain
+  head.writeUInt8(0, 18); // channel mapping family 0 (mono/stereo)
+  return head;
+}
+
+export function buildOpusTags(vendor = 'soundcast') {
+  const vendorBuffer = Buffer.from(vendor, 'utf8');
+  const tags = Buffer.alloc(8 + 4 + vendorBuffer.length + 4);
+  tags.write('OpusTags', 0, 'ascii');
+  tags.writeUInt32LE(vendorBuffer.length, 8);
+  vendorBuffer.copy(tags, 12);
+  tags.writeUInt32LE(0, 12 + vendorBuffer.length); // no user comments
+  return tags;
+}
+
+/**
+ * Duration of an Opus packet in 48 kHz samples, from its TOC byte (RFC 6716 §3.1).
+ * @param {Buffer} packet - Opus packet
+ * @returns {number} Samples, or 0 for an empty/invalid packet
+ */
+export function getOpusPacketSamples(packet) {
+  if (!packet || packet.length < 1) return 0;
+  const toc = packet[0];
+  const config = toc >> 3;
+
+  let frameSamples;
+  if (config < 12) {
+    frameSamples = [480, 960, 1920, 2880][config & 3]; // SILK 10/20/40/60 ms
+  } else if (config < 16) {
+    frameSamples = [480, 960][config & 1]; // Hybrid 10/20 ms
+  } else {
+    frameSamples = [120, 240, 480, 960][config & 3]; // CELT 2.5/5/10/20 ms
+  }
+
+  let frameCount;
+  switch (toc & 3) {
+    case 0:
+      frameCount = 1;
+      break;
+    case 1:
+    case 2:
+      frameCount = 2;
+      break;
+    default:
+      if (packet.length < 2) return 0;
+      frameCount = packet[1] & 0x3f;
+  }
+  return frameSamples * frameCount;
+}
+
+/**
+ * Audio duration of an Ogg/Opus file: the summed duration of its audio packets, so it does not
+ * depend on where the stream's granule positions start (segment files may continue them).
+ * @param {Buffer} buffer - Whole file
+ * @returns {number} Milliseconds
+ */
+export function getOggOpusDurationMs(buffer) {
+  let offset = 0;
+  let packetIndex = 0;
+  let pending = [];
+  let samples = 0;
+
+  while (offset + 27 <= buffer.length && buffer.toString('latin1', offset, offset + 4) === 'OggS') {
+    const segmentCount = buffer[offset + 26];
+    const lacing = buffer.subarray(offset + 27, offset + 27 + segmentCount);
+    let dataOffset = offset + 27 + segmentCount;
+
+    for (const size of lacing) {
+      pending.push(buffer.subarray(dataOffset, dataOffset + size));
+      dataOffset += size;
+      if (size < OGG_MAX_LACING_VALUES) {
+        // Packets 0 and 1 are OpusHead and OpusTags
+        if (packetIndex >= 2) samples += getOpusPacketSamples(Buffer.concat(pending));
+        packetIndex += 1;
+        pending = [];
+      }
+    }
+    offset = dataOffset;
+  }
+  return (samples / OPUS_SAMPLE_RATE) * 1000;
+}
+
+/**
+ * Incremental Ogg/Opus bitstream: emits header pages on creation and groups
+ * audio packets into pages of at most `maxPageSamples` (or 255 lacing values).
+ * Output goes to `write(buffer)`; the caller owns the underlying file.
+ */
+export class OggOpusStream {
+  constructor({ write, channels = 2, serial = null, maxPageSamples = OPUS_SAMPLE_RATE, vendor = 'soundcast' }) {
+    this.write = write;
+    this.serial = serial ?? ((Math.random() * 0xffffffff) >>> 0);
+    this.sequence = 0;
+    this.granulePosition = 0n;
+    this.maxPageSamples = maxPageSamples;
+    this.pendingPackets = [];
+    this.pendingLacing = 0;
+    this.pendingSamples = 0;
+    this.ended = false;
+
+    this.writePage([buildOpusHead({ channels })], 0n, { bos: true });
+    this.writePage([buildOpusTags(vendor)], 0n);
+  }
+
+  writePage(packets, granulePosition, { bos = false, eos = false } = {}) {
+    this.write(buildOggPage({
+      packets,
+      granulePosition,
+      serial: this.serial,
+      sequence: this.sequence++,
+      bos,
+      eos
+    }));
+  }
+
+  /**
+   * Append one Opus packet.
+   * @param {Buffer} packet - Opus packet
+   * @param {number} [gapSamples] - Silence (e.g. DTX or loss) before this packet, in samples
+   */
+  addPacket(packet, gapSamples = 0) {
+    if (this.ended) return;
+    const samples = getOpusPacketSamples(packet);
+    if (gapSamples > 0) {
+      // Ogg/Opus has no gap marker: fold the gap into the granule so timing stays aligned.
+      this.granulePosition += BigInt(gapSamples);
+    }
+
+    if (this.pendingLacing + lacingSize(packet) > OGG_MAX_LACING_VALUES) {
+      this.flush();
+    }
+    this.pendingPackets.push(packet);
+    this.pendingLacing += lacingSize(packet);
+    this.pendingSamples += samples;
+    this.granulePosition += BigInt(samples);
+
+    if (this.pendingSamples >= this.maxPageSamples) {
+      this.flush();
+    }
+  }
+
+  flush({ eos = false } = {}) {
+    if (this.pendingPackets.length === 0) {
+      if (eos && !this.ended) {
+        this.writePage([], this.granulePosition, { eos: true });
+      }
+      return;
+    }
+    this.writePage(this.pendingPackets, this.granulePosition, { eos });
+    this.pendingPackets = [];
+    this.pendingLacing = 0;
+    this.pendingSamples = 0;
+  }
+
+  end() {
+    if (this.ended) return;
+    this.flush({ eos: true });
+    this.ended = true;
+  }
+}
+
+export default {
+  buildOggPage,
+  buildOpusHead,
+  buildOpusTags,
+  getOggOpusDurationMs,
+  getOpusPacketSamples,
+  lacingSize,
+  OggOpusStream
+};
@@ -1,7 +1,9 @@
 import { spawn } from 'child_process';
+import { EventEmitter } from 'events';
 import fs from 'fs';
 import path from 'path';
 import { fileURLToPath } from 'url';
+import { RtpRecordingSink } from './rtp-sink.js';
 import { getPublisherById } from '../db/models/publisher.js';
 import {
   createRecording,
@@ -10,10 +12,9 @@ import {
   getRecordingById,
   updateRecordingStatus,
   createRecordingTrack,
-  updateRecordingTrackStatus,
-  listTracksByRecordingId,
   stopAllTracksForRecording
 } from '../db/models/recording.js';
+import { enqueueDbWrite, flushDbWrites } from '../db/writer.js';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -26,6 +27,9 @@ const FFMPEG_PATH = process.env.FFMPEG_PATH || 'ffmpeg';
 const RECORDING_SEGMENT_SECONDS = parseInt(process.env.RECORDING_SEGMENT_SECONDS || '5');
 const RECORDING_MERGE_ON_STOP = process.env.RECORDING_MERGE_ON_STOP !== 'false';
 const RECORDING_DELETE_SEGMENTS_AFTER_MERGE = process.env.RECORDING_DELETE_SEGMENTS_AFTER_MERGE === 'true';
+// 'native' writes Ogg/Opus in-process from one shared RTP socket; 'ffmpeg' spawns one ffmpeg per track
+const RECORDING_MUXER = process.env.RECORDING_MUXER === 'ffmpeg' ? 'ffmpeg' : 'native';
+const RECORDING_SINK_PORT = parseInt(process.env.RECORDING_SINK_PORT || '0');
 const SESSION_LOCK_VERSION = 1;
 const SESSION_LOCK_FILENAME = 'session.lock.json';
 
@@ -43,10 +47,58 @@ const recordingFinalizations = new Map(); // id -> { label, startedAt, promise }
 // Port allocation tracking
 const usedPorts = new Set();
 
+/**
+ * Recorder events:
+ * - 'segment-closed' { roomId, producerId, segmentPattern, filePath, segmentIndex, startMs, durationMs }
+ *   Emitted by the native muxer once a segment file is complete on disk.
+ */
+export const recordingEvents = new EventEmitter();
+
+/**
+ * Whether 'segment-closed' events are emitted (the ffmpeg muxer gives no such signal).
+ */
+export function supportsSegmentEvents() {
+  return RECORDING_MUXER === 'native';
+}
+
+// Shared RTP receiver for the native muxer, created on first use
+let rtpSink = null;
+
+async function getRtpSink() {
+  if (!rtpSink) {
+    rtpSink = new RtpRecordingSink({ host: '127.0.0.1', port: RECORDING_SINK_PORT });
+  }
+  return rtpSink.listen();
+}
+
+/**
+ * Receive a recorded producer's Opus packets live (native muxer only).
+ * @param {string} producerId - Producer ID (our internal UUID)
+ * @param {function} listener - (opusPacket: Buffer, timestampMs: number) => void
+ * @returns {{ channels: number, unsubscribe: function }|null} null when the producer is not being recorded natively
+ */
+export function subscribeTrackAudio(producerId, listener) {
+  for (const session of activeRecordings.values()) {
+    const track = session.tracks.get(producerId);
+    const writer = track?.sinkWriter;
+    if (!writer || writer.ended) continue;
+    writer.audioListeners.add(listener);
+    return {
+      channels: writer.channels,
+      unsubscribe: () => writer.audioListeners.delete(listener)
+    };
+  }
+  return null;
+}
+
+export function getRecordingSinkStats() {
+  return rtpSink ? rtpSink.getStats() : null;
+}
+
 /**
  * Initialize the recorder module with dependencies from server.js
  * @param {object} deps - Dependencies
- * @param {object} deps.router - mediasoup router
+ * @param {object} deps.router - Default mediasoup router (used when a producer has no router of its own)
  * @param {Map} deps.channels - channels Map
  * @param {object} deps.fastify - fastify instance
  * @param {function} deps.onStatusChange - Callback when recording status changes (tenantId, roomSlug, status)
@@ -62,7 +114,7 @@ export function initRecorder(deps) {
     fs.mkdirSync(RECORDING_DIR, { recursive: true });
   }
 
-  console.log(`Recorder initialized. Recordings directory: ${RECORDING_DIR}`);
+  console.log(`Recorder initialized. Recordings directory: ${RECORDING_DIR}, muxer: ${RECORDING_MUXER}`);
 }
 
 function isPidAlive(pid) {
@@ -124,6 +176,8 @@ export async function waitForRecordingFinalization({ log = null } = {}) {
     }
     await Promise.allSettled(pending.map((entry) => entry.promise));
   }
+  // Track status and metadata writes from those finalizations are queued on the DB writer
+  await flushDbWrites();
 }
 
 function getSessionLockPath(folderPath) {
@@ -301,8 +355,9 @@ class RecordingSession {
  * Track recorder class - manages a single producer's recording
  */
 class TrackRecorder {
-  constructor(producerId, channelName, producerName, segmentPattern, mergedFilePath, trackId, publisherId = null) {
+  constructor(producerId, channelName, producerName, segmentPattern, mergedFilePath, trackId, publisherId = null, roomId = null) {
     this.producerId = producerId;
+    this.roomId = roomId;
     this.channelName = channelName;
     this.producerName = producerName;
     this.segmentPattern = segmentPattern;
@@ -314,6 +369,9 @@ class TrackRecorder {
     this.ffmpegProcess = null;
     this.rtpPort = null;
     this.sdpPath = null;
+    this.sinkSsrc = null;
+    this.sinkWriter = null;
+    this.mergedLive = false;
   }
 
   toMetadata() {
@@ -328,95 +386,19 @@ class TrackRecorder {
     };
   }
 
-  async start(producer) {
+  async start(producer, trackRouter = router) {
     try {
-      // Allocate RTP port for FFmpeg to receive on
-      this.rtpPort = allocatePort();
-
-      // Create PlainTransport for consuming the producer
-      // rtcpMux: true means RTP and RTCP on same port (simpler)
-      this.plainTransport = await router.createPlainTransport({
-        listenIp: { ip: '127.0.0.1', announcedIp: null },
-        rtcpMux: true,
-        comedia: false
-      });
-
-      console.log(`PlainTransport created, tuple: ${JSON.stringify(this.plainTransport.tuple)}`);
-
-      // Connect the transport - tells mediasoup where to SEND RTP
-      await this.plainTransport.connect({
-        ip: '127.0.0.1',
-        port: this.rtpPort
-      });
-
-      console.log(`PlainTransport connected to 127.0.0.1:${this.rtpPort}`);
-
-      // Create consumer on the PlainTransport
-      this.consumer = await this.plainTransport.consume({
-        producerId: producer.id,
-        rtpCapabilities: router.rtpCapabilities,
-        paused: false
-      });
-
-      console.log(`Consumer created: id=${this.consumer.id}, paused=${this.consumer.paused}, producerId=${producer.id}`);
-      console.log(`Producer state: id=${producer.id}, paused=${producer.paused}, closed=${producer.closed}`);
-
-      // Explicitly resume consumer to ensure RTP flows
-      if (this.consumer.paused) {
-        await this.consumer.resume();
-        console.log(`Consumer resumed`);
-      }
-
       // Ensure output directory exists BEFORE writing any files
       const outputDir = path.dirname(this.segmentPattern);
       if (!fs.existsSync(outputDir)) {
         fs.mkdirSync(outputDir, { recursive: true });
       }
 
-      // Generate SDP file for FFmpeg
-      const sdpContent = this.generateSdp();
-      this.sdpPath = this.segmentPattern.replace(/%03d\.ogg$/, 'sdp');
-      fs.writeFileSync(this.sdpPath, sdpContent);
-
-      // Log SDP for debugging
-      console.log(`SDP for ${this.producerName}:\n${sdpContent}`);
-
-      // Spawn FFmpeg process with segmented output to flush to disk continuously
-      this.ffmpegProcess = spawn(FFMPEG_PATH, [
-        '-protocol_whitelist', 'file,rtp,udp',
-        '-analyzeduration', '10000000',  // 10 seconds
-        '-probesize', '5000000',         // 5MB
-        '-fflags', '+genpts+discardcorrupt',
-        '-i', this.sdpPath,
-        '-c:a', 'copy',
-        '-f', 'segment',
-        '-segment_time', String(RECORDING_SEGMENT_SECONDS),
-        '-reset_timestamps', '1',
-        '-y',
-        this.segmentPattern
-      ], {
-        stdio: ['ignore', 'pipe', 'pipe']
-      });
-
-      this.ffmpegProcess.on('error', (err) => {
-        console.error(`FFmpeg error for ${this.producerName}: ${err.message}`);
-      });
-
-      this.ffmpegProcess.stderr.on('data', (data) => {
-        // Log FFmpeg output for debugging (can be verbose)
-        const output = data.toString();
-        if (output.includes('error') || output.includes('Error')) {
-          console.error(`FFmpeg stderr: ${output}`);
-        }
-      });
-
-      this.ffmpegProcess.on('close', (code) => {
-        console.log(`FFmpeg process exited with code ${code} for ${this.producerName}`);
-        // Cleanup SDP file
-        if (this.sdpPath && fs.existsSync(this.sdpPath)) {
-          fs.unlinkSync(this.sdpPath);
-        }
-      });
+      if (RECORDING_MUXER === 'native') {
+        await this.startNative(producer, trackRouter);
+      } else {
+        await this.startFfmpeg(producer, trackRouter);
+      }
 
       console.log(`Started recording track: ${this.producerName} -> ${this.segmentPattern}`);
       return true;
@@ -427,6 +409,140 @@ class TrackRecorder {
     }
   }
 
+  /**
+   * Feed the shared RTP sink: no extra process, no probe delay, one socket for all tracks.
+   */
+  async startNative(producer, trackRouter) {
+    const sink = await getRtpSink();
+
+    this.plainTransport = await trackRouter.createPlainTransport({
+      listenIp: { ip: '127.0.0.1', announcedIp: null },
+      rtcpMux: true,
+      comedia: false
+    });
+    await this.plainTransport.connect({ ip: '127.0.0.1', port: sink.port });
+
+    // Start paused so no RTP arrives before the sink knows this SSRC
+    this.consumer = await this.plainTransport.consume({
+      producerId: producer.id,
+      rtpCapabilities: trackRouter.rtpCapabilities,
+      paused: true
+    });
+
+    const ssrc = this.consumer.rtpParameters.encodings?.[0]?.ssrc;
+    if (!ssrc) {
+      throw new Error('Recording consumer has no SSRC');
+    }
+    const codec = this.consumer.rtpParameters.codecs[0];
+    this.sinkWriter = sink.addTrack(ssrc, {
+      segmentPattern: this.segmentPattern,
+      // Merged file grows alongside the segments, so stop needs no concat pass
+      mergedFilePath: RECORDING_MERGE_ON_STOP ? this.mergedFilePath : null,
+      channels: codec.channels || 2,
+      segmentSeconds: RECORDING_SEGMENT_SECONDS,
+      onError: (err) => {
+        console.error(`Recording write error for ${this.producerName}: ${err.message}`);
+      },
+      onSegmentClosed: (segment) => {
+        recordingEvents.emit('segment-closed', {
+          roomId: this.roomId,
+          producerId: this.producerId,
+          segmentPattern: this.segmentPattern,
+          ...segment
+        });
+      }
+    });
+    this.sinkSsrc = ssrc;
+    this.mergedLive = RECORDING_MERGE_ON_STOP;
+
+    await this.consumer.resume();
+    console.log(`Consumer created: id=${this.consumer.id}, ssrc=${ssrc}, producerId=${producer.id}, sink=127.0.0.1:${sink.port}`);
+  }
+
+  async startFfmpeg(producer, trackRouter) {
+    // Allocate RTP port for FFmpeg to receive on
+    this.rtpPort = allocatePort();
+
+    // Create PlainTransport for consuming the producer
+    // rtcpMux: true means RTP and RTCP on same port (simpler)
+    this.plainTransport = await trackRouter.createPlainTransport({
+      listenIp: { ip: '127.0.0.1', announcedIp: null },
+      rtcpMux: true,
+      comedia: false
+    });
+
+    console.log(`PlainTransport created, tuple: ${JSON.stringify(this.plainTransport.tuple)}`);
+
+    // Connect the transport - tells mediasoup where to SEND RTP
+    await this.plainTransport.connect({
+      ip: '127.0.0.1',
+      port: this.rtpPort
+    });
+
+    console.log(`PlainTransport connected to 127.0.0.1:${this.rtpPort}`);
+
+    // Create consumer on the PlainTransport
+    this.consumer = await this.plainTransport.consume({
+      producerId: producer.id,
+      rtpCapabilities: trackRouter.rtpCapabilities,
+      paused: false
+    });
+
+    console.log(`Consumer created: id=${this.consumer.id}, paused=${this.consumer.paused}, producerId=${producer.id}`);
+    console.log(`Producer state: id=${producer.id}, paused=${producer.paused}, closed=${producer.closed}`);
+
+    // Explicitly resume consumer to ensure RTP flows
+    if (this.consumer.paused) {
+      await this.consumer.resume();
+      console.log(`Consumer resumed`);
+    }
+
+    // Generate SDP file for FFmpeg
+    const sdpContent = this.generateSdp();
+    this.sdpPath = this.segmentPattern.replace(/%03d\.ogg$/, 'sdp');
+    fs.writeFileSync(this.sdpPath, sdpContent);
+
+    // Log SDP for debugging
+    console.log(`SDP for ${this.producerName}:\n${sdpContent}`);
+
+    // Spawn FFmpeg process with segmented output to flush to disk continuously
+    this.ffmpegProcess = spawn(FFMPEG_PATH, [
+      '-protocol_whitelist', 'file,rtp,udp',
+      '-analyzeduration', '10000000',  // 10 seconds
+      '-probesize', '5000000',         // 5MB
+      '-fflags', '+genpts+discardcorrupt',
+      '-i', this.sdpPath,
+      '-c:a', 'copy',
+      '-f', 'segment',
+      '-segment_time', String(RECORDING_SEGMENT_SECONDS),
+      '-reset_timestamps', '1',
+      '-y',
+      this.segmentPattern
+    ], {
+      stdio: ['ignore', 'pipe', 'pipe']
+    });
+
+    this.ffmpegProcess.on('error', (err) => {
+      console.error(`FFmpeg error for ${this.producerName}: ${err.message}`);
+    });
+
+    this.ffmpegProcess.stderr.on('data', (data) => {
+      // Log FFmpeg output for debugging (can be verbose)
+      const output = data.toString();
+      if (output.includes('error') || output.includes('Error')) {
+        console.error(`FFmpeg stderr: ${output}`);
+      }
+    });
+
+    this.ffmpegProcess.on('close', (code) => {
+      console.log(`FFmpeg process exited with code ${code} for ${this.producerName}`);
+      // Cleanup SDP file
+      if (this.sdpPath && fs.existsSync(this.sdpPath)) {
+        fs.unlinkSync(this.sdpPath);
+      }
+    });
+  }
+
   generateSdp() {
     const rtpParams = this.consumer.rtpParameters;
     const codec = rtpParams.codecs[0];
@@ -460,6 +576,16 @@ class TrackRecorder {
   async stop() {
     const now = new Date().toISOString();
 
+    // Stop RTP first so the sink's last page is final, then flush segment files
+    if (this.consumer && !this.consumer.closed) {
+      this.consumer.close();
+    }
+    if (this.sinkSsrc !== null && rtpSink) {
+      await rtpSink.removeTrack(this.sinkSsrc);
+      this.sinkSsrc = null;
+      this.sinkWriter = null;
+    }
+
     // Stop FFmpeg gracefully
     if (this.ffmpegProcess && !this.ffmpegProcess.killed) {
       this.ffmpegProcess.stdin?.end();
@@ -499,21 +625,23 @@ class TrackRecorder {
       releasePort(this.rtpPort + 1); // RTCP port
     }
 
-    // Update database
+    // Update database (off the signaling thread)
     if (this.trackId) {
-      updateRecordingTrackStatus(this.trackId, mergedOk ? 'stopped' : 'error', now);
+      enqueueDbWrite('updateRecordingTrackStatus', { id: this.trackId, status: mergedOk ? 'stopped' : 'error', stoppedAt: now });
     }
 
     console.log(`Stopped recording track: ${this.producerName}`);
   }
 
-  async mergeSegments() {
+  listSegmentFiles() {
     const outputDir = path.dirname(this.segmentPattern);
     const baseName = path.basename(this.segmentPattern).replace(/_%03d\.ogg$/, '');
-    const segmentRegex = new RegExp(`^${baseName}_(\\d{3})\\.ogg$`);
-    const entries = fs.readdirSync(outputDir)
-      .filter(name => segmentRegex.test(name))
-      .sort()
+    const segmentRegex = new RegExp(`^${baseName}_(\\d{3,})\\.ogg$`);
+    return fs.readdirSync(outputDir)
+      .map(name => ({ name, match: segmentRegex.exec(name) }))
+      .filter(({ match }) => match)
+      .sort((a, b) => Number(a.match[1]) - Number(b.match[1]))
+      .map(({ name }) => name)
       .filter(name => {
         const filePath = path.join(outputDir, name);
         try {
@@ -523,6 +651,38 @@ class TrackRecorder {
           return false;
         }
       });
+  }
+
+  deleteSegmentFiles(entries) {
+    const outputDir = path.dirname(this.segmentPattern);
+    for (const name of entries) {
+      const segmentPath = path.join(outputDir, name);
+      if (fs.existsSync(segmentPath)) {
+        fs.unlinkSync(segmentPath);
+      }
+    }
+  }
+
+  async mergeSegments() {
+    // Native muxer already wrote the merged stream while recording
+    if (this.mergedLive) {
+      let mergedOk = false;
+      try {
+        mergedOk = fs.statSync(this.mergedFilePath).size > 0;
+      } catch { }
+      if (!mergedOk) {
+        console.warn(`No audio recorded for ${this.producerName}`);
+        return false;
+      }
+      if (RECORDING_DELETE_SEGMENTS_AFTER_MERGE) {
+        this.deleteSegmentFiles(this.listSegmentFiles());
+      }
+      return true;
+    }
+
+    const outputDir = path.dirname(this.segmentPattern);
+    const baseName = path.basename(this.segmentPattern).replace(/_%03d\.ogg$/, '');
+    const entries = this.listSegmentFiles();
 
     if (entries.length === 0) {
       console.warn(`No segments found for ${this.producerName}, skip merge`);
@@ -560,12 +720,7 @@ class TrackRecorder {
     }
 
     if (RECORDING_DELETE_SEGMENTS_AFTER_MERGE) {
-      for (const name of entries) {
-        const segmentPath = path.join(outputDir, name);
-        if (fs.existsSync(segmentPath)) {
-          fs.unlinkSync(segmentPath);
-        }
-      }
+      this.deleteSegmentFiles(entries);
     }
 
     return true;
@@ -662,7 +817,7 @@ export async function startRecording(roomSlug, roomId, tenantId) {
  * @param {number} roomId - Room ID
  * @param {string} producerId - Producer ID (our internal UUID)
  * @param {string} channelName - Channel name
- * @param {object} producerInfo - Producer info with { transport, producer, clientId }
+ * @param {object} producerInfo - Producer info with { transport, producer, router, clientId }
  * @param {RecordingSession} session - Optional session (if not provided, will look up)
  */
 export async function addProducerToRecording(roomId, producerId, channelName, producerInfo, session = null) {
@@ -716,11 +871,13 @@ export async function addProducerToRecording(roomId, producerId, channelName, pr
     segmentPattern,
     mergedFilePath,
     track.id,
-    producerInfo.publisherId || null
+    producerInfo.publisherId || null,
+    roomId
   );
 
   try {
-    await trackRecorder.start(producer);
+    // Record on the producer's own router; with a worker pool that may not be the default one
+    await trackRecorder.start(producer, producerInfo.router || router);
     session.tracks.set(producerId, trackRecorder);
 
     // Update metadata
@@ -728,7 +885,7 @@ export async function addProducerToRecording(roomId, producerId, channelName, pr
     persistSessionLock(session, 'recording');
     return trackRecorder.toMetadata();
   } catch (err) {
-    updateRecordingTrackStatus(track.id, 'error', new Date().toISOString());
+    enqueueDbWrite('updateRecordingTrackStatus', { id: track.id, status: 'error', stoppedAt: new Date().toISOString() });
     throw err;
   }
 }
@@ -784,7 +941,7 @@ export async function stopRecording(roomSlug, roomId) {
 
     // Update database
     const now = new Date().toISOString();
-    stopAllTracksForRecording(session.recordingId);
+    enqueueDbWrite('stopAllTracksForRecording', { recordingId: session.recordingId, stoppedAt: now });
     const recording = updateRecordingStatus(session.recordingId, 'stopped', now);
 
     // Final metadata update
@@ -819,39 +976,19 @@ export async function stopRecording(roomSlug, roomId) {
 }
 
 /**
- * Write metadata JSON file for a recording session
+ * Write metadata JSON file for a recording session. Built by the DB writer from the track
+ * rows, after any track writes queued before it.
  * @param {RecordingSession} session - Recording session
  * @param {boolean} final - Is this the final write (recording stopped)
  */
 function writeMetadata(session, final = false) {
-  const tracks = listTracksByRecordingId(session.recordingId);
-
-  // Organize tracks by channel
-  const channelTracks = {};
-  for (const track of tracks) {
-    if (!channelTracks[track.channel_name]) {
-      channelTracks[track.channel_name] = [];
-    }
-    channelTracks[track.channel_name].push({
-      producerName: track.producer_name,
-      fileName: path.basename(track.file_path),
-      status: track.status,
-      startedAt: track.started_at,
-      stoppedAt: track.stopped_at
-    });
-  }
-
-  const metadata = {
+  enqueueDbWrite('writeRecordingMetadata', {
     recordingId: session.recordingId,
     roomSlug: session.roomSlug,
     startedAt: session.startedAt.toISOString(),
     stoppedAt: final ? new Date().toISOString() : null,
-    status: final ? 'stopped' : 'recording',
-    channels: channelTracks
-  };
-
-  const metadataPath = path.join(session.folderPath, 'metadata.json');
-  fs.writeFileSync(metadataPath, JSON.stringify(metadata, null, 2));
+    metadataPath: path.join(session.folderPath, 'metadata.json')
+  });
 }
 
 /**
@@ -908,6 +1045,59 @@ export function getRecordingStatus(roomId) {
   };
 }
 
+/**
+ * Locate the on-disk audio of a recording track for download/playback.
+ *
+ * Tracks are served from the merged file when it is complete (or, with the native muxer,
+ * written live alongside the segments); otherwise from the segment files in order, which
+ * read back as one chained Ogg stream without a merge pass.
+ *
+ * @param {object} recording - Recording row ({ id, room_id, folder_name })
+ * @param {object} track - Track row ({ id, producer_id, file_path })
+ * @returns {object|null} { live, listFiles(), isLive() }, or null if the path escapes the recording folder
+ */
+export function getTrackFileSource(recording, track) {
+  const folderPath = path.resolve(RECORDING_DIR, recording.folder_name);
+  const mergedFilePath = path.resolve(folderPath, track.file_path);
+  if (!mergedFilePath.startsWith(folderPath + path.sep)) return null;
+
+  const session = activeRecordings.get(recording.room_id);
+  const trackRecorder = session?.recordingId === recording.id ? session.tracks.get(track.producer_id) : null;
+  const live = Boolean(trackRecorder && trackRecorder.trackId === track.id);
+  const isLive = () => live &&
+    activeRecordings.get(recording.room_id) === session &&
+    session.tracks.get(track.producer_id) === trackRecorder;
+
+  let useMerged = live ? trackRecorder.mergedLive : false;
+  if (!live) {
+    try {
+      useMerged = fs.statSync(mergedFilePath).size > 0;
+    } catch { }
+  }
+
+  if (useMerged) {
+    return { live, isLive, listFiles: () => (fs.existsSync(mergedFilePath) ? [mergedFilePath] : []) };
+  }
+
+  const outputDir = path.dirname(mergedFilePath);
+  const baseName = path.basename(mergedFilePath, '.ogg');
+  const segmentRegex = new RegExp(`^${baseName}_(\\d{3,})\\.ogg$`);
+  const listFiles = () => {
+    let names;
+    try {
+      names = fs.readdirSync(outputDir);
+    } catch {
+      return [];
+    }
+    return names
+      .map(name => ({ name, match: segmentRegex.exec(name) }))
+      .filter(({ match }) => match)
+      .sort((a, b) => Number(a.match[1]) - Number(b.match[1]))
+      .map(({ name }) => path.join(outputDir, name));
+  };
+  return { live, isLive, listFiles };
+}
+
 /**
  * Get all active recordings mapped by roomId
  * @returns {Map} Active recordings map
@@ -927,5 +1117,10 @@ export default {
   getRecordingFinalizationStatus,
   isRecording,
   getRecordingStatus,
-  getActiveRecordings
+  getActiveRecordings,
+  getTrackFileSource,
+  getRecordingSinkStats,
+  supportsSegmentEvents,
+  subscribeTrackAudio,
+  recordingEvents
 };
@@ -0,0 +1,346 @@
+import dgram from 'dgram';
+import fs from 'fs';
+import { OggOpusStream, getOpusPacketSamples } from './ogg.js';
+import { metrics } from '../metrics.js';
+
+const OPUS_SAMPLE_RATE = 48000;
+const RTP_HEADER_SIZE = 12;
+
+/**
+ * Parse an RTP packet (RFC 3550) and return its header fields and payload.
+ * Returns null for RTCP (which shares the socket with rtcpMux) and malformed packets.
+ * @param {Buffer} packet
+ */
+export function parseRtpPacket(packet) {
+  if (packet.length < RTP_HEADER_SIZE) return null;
+  const first = packet[0];
+  if ((first >> 6) !== 2) return null;
+
+  // RTCP packet types 192-223 land in the marker+PT byte (RFC 5761 §4)
+  const second = packet[1];
+  if (second >= 192 && second <= 223) return null;
+
+  const csrcCount = first & 0x0f;
+  const hasExtension = (first & 0x10) !== 0;
+  const hasPadding = (first & 0x20) !== 0;
+
+  let offset = RTP_HEADER_SIZE + csrcCount * 4;
+  if (hasExtension) {
+    if (packet.length < offset + 4) return null;
+    offset += 4 + packet.readUInt16BE(offset + 2) * 4;
+  }
+
+  let end = packet.length;
+  if (hasPadding) {
+    end -= packet[packet.length - 1];
+  }
+  if (end <= offset) return null;
+
+  return {
+    payloadType: second & 0x7f,
+    sequenceNumber: packet.readUInt16BE(2),
+    timestamp: packet.readUInt32BE(4),
+    ssrc: packet.readUInt32BE(8),
+    payload: packet.subarray(offset, end)
+  };
+}
+
+/**
+ * One recorded track: turns its RTP stream into rotating Ogg/Opus segment files
+ * named after `segmentPattern` (`..._%03d.ogg`), each a standalone Ogg stream
+ * starting at granule 0, matching what the ffmpeg segment muxer used to produce.
+ *
+ * With `mergedFilePath` set, the same packets are also appended to one continuous
+ * Ogg stream, so the merged file is complete as soon as the writer ends and
+ * stopping never needs a concat pass over the segments.
+ *
+ * `onSegmentClosed` fires once a segment file is flushed and closed, so consumers
+ * such as the transcription runtime can pick it up without polling the directory.
+ * `audioListeners` receive every Opus packet live, for streaming consumers.
+ */
+export class SegmentedOggOpusWriter {
+  constructor({ segmentPattern, mergedFilePath = null, channels = 2, segmentSeconds = 5, onError = null, onSegmentClosed = null }) {
+    this.segmentPattern = segmentPattern;
+    this.mergedFilePath = mergedFilePath;
+    this.channels = channels;
+    this.segmentSamples = Math.max(1, segmentSeconds) * OPUS_SAMPLE_RATE;
+    this.onError = onError;
+    this.onSegmentClosed = onSegmentClosed;
+
+    this.segmentIndex = -1;
+    this.fileStream = null;
+    this.oggStream = null;
+    this.segmentStartTs = 0;
+    this.closing = new Set(); // pending file closes
+    this.audioListeners = new Set(); // (payload, timestampMs) => void
+    this.mergedFileStream = null;
+    this.mergedOggStream = null;
+
+    this.lastSeq = null;
+    this.firstTs = null;
+    this.nextTs = null; // unwrapped RTP timestamp expected for the next packet
+    this.tsCycles = 0;
+    this.lastRawTs = null;
+    this.packets = 0;
+    this.bytes = 0;
+    this.ended = false;
+  }
+
+  segmentPath(index) {
+    return this.segmentPattern.replace('%03d', String(index).padStart(3, '0'));
+  }
+
+  unwrapTimestamp(rawTs) {
+    if (this.lastRawTs !== null) {
+      const delta = rawTs - this.lastRawTs;
+      if (delta < -0x80000000) this.tsCycles += 1;
+      else if (delta > 0x80000000) this.tsCycles -= 1;
+    }
+    this.lastRawTs = rawTs;
+    return this.tsCycles * 0x100000000 + rawTs;
+  }
+
+  /**
+   * Drop duplicates and late packets: the sink sits on loopback, so real
+   * reordering is rare and not worth a jitter buffer.
+   */
+  acceptSequence(seq) {
+    if (this.lastSeq === null) {
+      this.lastSeq = seq;
+      return true;
+    }
+    const delta = (seq - this.lastSeq) & 0xffff;
+    if (delta === 0 || delta >= 0x8000) return false;
+    this.lastSeq = seq;
+    return true;
+  }
+
+  createFileStream(filePath) {
+    const fileStream = fs.createWriteStream(filePath);
+    fileStream.on('error', (err) => {
+      if (this.onError) this.onError(err);
+    });
+    return fileStream;
+  }
+
+  endFileStream(oggStream, fileStream, onClosed = null) {
+    oggStream.end();
+    const closed = new Promise((resolve) => {
+      // 'close' fires after 'finish' and also after a write error
+      fileStream.once('close', resolve);
+      fileStream.end();
+    });
+    this.closing.add(closed);
+    closed.then(() => {
+      this.closing.delete(closed);
+      if (onClosed) onClosed();
+    });
+  }
+
+  openMerged() {
+    const fileStream = this.createFileStream(this.mergedFilePath);
+    this.mergedFileStream = fileStream;
+    this.mergedOggStream = new OggOpusStream({
+      channels: this.channels,
+      write: (page) => {
+        metrics.recordingBytesWritten.inc(page.length);
+        fileStream.write(page);
+      }
+    });
+  }
+
+  openSegment(startTs) {
+    this.closeSegment();
+    this.segmentIndex += 1;
+    this.segmentStartTs = startTs;
+
+    const fileStream = this.createFileStream(this.segmentPath(this.segmentIndex));
+    this.fileStream = fileStream;
+    this.oggStream = new OggOpusStream({
+      channels: this.channels,
+      write: (page) => {
+        metrics.recordingBytesWritten.inc(page.length);
+        fileStream.write(page);
+      }
+    });
+  }
+
+  closeSegment() {
+    if (!this.oggStream) return;
+    const segment = {
+      filePath: this.segmentPath(this.segmentIndex),
+      segmentIndex: this.segmentIndex,
+      startMs: Math.round((this.segmentStartTs - this.firstTs) / (OPUS_SAMPLE_RATE / 1000)),
+      durationMs: Math.round(Number(this.oggStream.granulePosition) / (OPUS_SAMPLE_RATE / 1000))
+    };
+    this.endFileStream(this.oggStream, this.fileStream, () => {
+      if (!this.onSegmentClosed) return;
+      try {
+        this.onSegmentClosed(segment);
+      } catch (err) {
+        if (this.onError) this.onError(err);
+      }
+    });
+    this.oggStream = null;
+    this.fileStream = null;
+  }
+
+  addPacket(packet) {
+    this.oggStream.addPacket(packet);
+    if (this.mergedOggStream) {
+      this.mergedOggStream.addPacket(packet);
+    }
+  }
+
+  handleRtp(rtp) {
+    if (this.ended || !this.acceptSequence(rtp.sequenceNumber)) return;
+
+    const ts = this.unwrapTimestamp(rtp.timestamp);
+    if (this.firstTs === null) {
+      this.firstTs = ts;
+    }
+    if (this.mergedFilePath && !this.mergedOggStream) {
+      this.openMerged();
+    }
+    if (!this.oggStream || ts - this.segmentStartTs >= this.segmentSamples) {
+      this.openSegment(ts);
+      this.nextTs = ts;
+    }
+
+    // Fill short gaps (DTX, loss) with TOC-only packets, which decoders treat as
+    // concealment, so segment duration follows the RTP clock. Longer gaps such as
+    // a paused producer are not filled.
+    const gap = ts - this.nextTs;
+    if (gap > 0 && gap < this.segmentSamples) {
+      const fillerToc = 0xf8 | (this.channels > 1 ? 0x04 : 0); // CELT FB 20 ms
+      const filler = Buffer.from([fillerToc]);
+      const fillerSamples = getOpusPacketSamples(filler);
+      for (let filled = 0; filled + fillerSamples <= gap; filled += fillerSamples) {
+        this.addPacket(filler);
+      }
+    }
+
+    const samples = getOpusPacketSamples(rtp.payload);
+    // Copy out of the datagram buffer: pages hold packets until the next flush
+    const packet = Buffer.from(rtp.payload);
+    this.addPacket(packet);
+    if (this.audioListeners.size > 0) {
+      const timestampMs = (ts - this.firstTs) / (OPUS_SAMPLE_RATE / 1000);
+      for (const listener of this.audioListeners) {
+        try {
+          listener(packet, timestampMs);
+        } catch (err) {
+          if (this.onError) this.onError(err);
+        }
+      }
+    }
+    this.nextTs = ts + samples;
+    this.packets += 1;
+    this.bytes += rtp.payload.length;
+  }
+
+  /**
+   * Finish the current segment (and the merged stream) and wait until every file is on disk.
+   */
+  async end() {
+    if (this.ended) return;
+    this.ended = true;
+    this.audioListeners.clear();
+    this.closeSegment();
+    if (this.mergedOggStream) {
+      this.endFileStream(this.mergedOggStream, this.mergedFileStream);
+      this.mergedOggStream = null;
+      this.mergedFileStream = null;
+    }
+    await Promise.all(Array.from(this.closing));
+  }
+}
+
+/**
+ * Single loopback UDP socket that receives RTP for every recorded track.
+ * All recording PlainTransports connect to the same port; packets are
+ * demultiplexed by SSRC, which mediasoup assigns uniquely per consumer.
+ */
+export class RtpRecordingSink {
+  constructor({ host = '127.0.0.1', port = 0, log = console } = {}) {
+    this.host = host;
+    this.requestedPort = port;
+    this.log = log;
+    this.socket = null;
+    this.port = null;
+    this.tracks = new Map(); // ssrc -> SegmentedOggOpusWriter
+    this.unknownSsrcPackets = 0;
+    this.readyPromise = null;
+  }
+
+  async listen() {
+    if (this.readyPromise) return this.readyPromise;
+    this.readyPromise = new Promise((resolve, reject) => {
+      const socket = dgram.createSocket('udp4');
+      socket.once('error', reject);
+      socket.on('message', (message) => this.handleMessage(message));
+      socket.bind(this.requestedPort, this.host, () => {
+        socket.off('error', reject);
+        socket.on('error', (err) => {
+          this.log.error(`Recording RTP sink socket error: ${err.message}`);
+        });
+        // Bursts from many tracks arrive between event loop turns
+        try {
+          socket.setRecvBufferSize(4 * 1024 * 1024);
+        } catch { }
+        this.socket = socket;
+        this.port = socket.address().port;
+        this.log.log(`Recording RTP sink listening on ${this.host}:${this.port}`);
+        resolve(this);
+      });
+    });
+    return this.readyPromise;
+  }
+
+  handleMessage(message) {
+    const rtp = parseRtpPacket(message);
+    if (!rtp) return;
+    const writer = this.tracks.get(rtp.ssrc);
+    if (!writer) {
+      this.unknownSsrcPackets += 1;
+      return;
+    }
+    writer.handleRtp(rtp);
+  }
+
+  addTrack(ssrc, options) {
+    if (this.tracks.has(ssrc)) {
+      throw new Error(`Recording sink already has a track for SSRC ${ssrc}`);
+    }
+    const writer = new SegmentedOggOpusWriter(options);
+    this.tracks.set(ssrc, writer);
+    return writer;
+  }
+
+  async removeTrack(ssrc) {
+    const writer = this.tracks.get(ssrc);
+    if (!writer) return;
+    this.tracks.delete(ssrc);
+    await writer.end();
+  }
+
+  getStats() {
+    return {
+      port: this.port,
+      tracks: this.tracks.size,
+      unknownSsrcPackets: this.unknownSsrcPackets
+    };
+  }
+
+  close() {
+    if (this.socket) {
+      try {
+        this.socket.close();
+      } catch { }
+    }
+    this.socket = null;
+    this.readyPromise = null;
+  }
+}
+
+export default RtpRecordingSink;
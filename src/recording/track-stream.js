@@ -0,0 +1,128 @@
+import fs from 'fs';
+import { Readable } from 'stream';
+
+// Read size per chunk; backpressure keeps at most a few of these in memory per response
+const CHUNK_SIZE = 64 * 1024;
+// How often a live stream checks for new bytes or segments
+const FOLLOW_POLL_MS = parseInt(process.env.RECORDING_FOLLOW_POLL_MS || '250', 10);
+
+function delay(ms, signal) {
+  return new Promise((resolve) => {
+    if (signal?.aborted) return resolve();
+    const timer = setTimeout(done, ms);
+    function done() {
+      clearTimeout(timer);
+      signal?.removeEventListener('abort', done);
+      resolve();
+    }
+    signal?.addEventListener('abort', done, { once: true });
+  });
+}
+
+/**
+ * Current byte size of a track source (sum of its files)
+ * @param {object} source - From getTrackFileSource()
+ * @returns {Promise<number>}
+ */
+export async function getTrackSize(source) {
+  let total = 0;
+  for (const filePath of source.listFiles()) {
+    try {
+      total += (await fs.promises.stat(filePath)).size;
+    } catch { }
+  }
+  return total;
+}
+
+async function* readTrackChunks(source, { start, end, follow, signal }) {
+  let position = start;
+  let base = 0; // offset of the current file within the track
+
+  for (let index = 0; ; index++) {
+    let files = source.listFiles();
+    while (index >= files.length) {
+      if (!follow || !source.isLive() || signal?.aborted) return;
+      await delay(FOLLOW_POLL_MS, signal);
+      files = source.listFiles();
+    }
+
+    const handle = await fs.promises.open(files[index], 'r');
+    try {
+      let finished = false;
+      for (;;) {
+        if (position > end || signal?.aborted) return;
+        const { size } = await handle.stat();
+        if (position < base + size) {
+          const length = Math.min(CHUNK_SIZE, base + size - position, end - position + 1);
+          const chunk = Buffer.allocUnsafe(length);
+          const { bytesRead } = await handle.read(chunk, 0, length, position - base);
+          position += bytesRead;
+          if (bytesRead > 0) yield chunk.subarray(0, bytesRead);
+          continue;
+        }
+        if (finished) {
+          base += size;
+          break;
+        }
+        // A file is complete once a later segment exists or the track stopped; stat once more
+        // so bytes flushed in between are not lost
+        if (!follow || !source.isLive() || source.listFiles().length > index + 1) {
+          finished = true;
+          continue;
+        }
+        await delay(FOLLOW_POLL_MS, signal);
+      }
+    } finally {
+      await handle.close();
+    }
+  }
+}
+
+/**
+ * Stream a byte range of a track's files, reading CHUNK_SIZE at a time on demand, so no
+ * file is ever held in memory. With `follow`, the stream tails a live track (growing merged
+ * file or newly closed segments) until recording stops or `signal` aborts.
+ *
+ * @param {object} source - From getTrackFileSource()
+ * @param {object} [options]
+ * @param {number} [options.start] - First byte (inclusive)
+ * @param {number} [options.end] - Last byte (inclusive)
+ * @param {boolean} [options.follow]
+ * @param {AbortSignal} [options.signal]
+ * @returns {Readable}
+ */
+export function createTrackReadStream(source, { start = 0, end = Infinity, follow = false, signal = null } = {}) {
+  return Readable.from(readTrackChunks(source, { start, end, follow, signal }), { objectMode: false });
+}
+
+/**
+ * Parse a single-range `Range: bytes=` header against a known size.
+ * @returns {{start: number, end: number}|null|'unsatisfiable'} null when absent or not a single
+ *   byte range (serve the whole file), 'unsatisfiable' for a range outside the file
+ */
+export function parseRangeHeader(header, size) {
+  if (!header) return null;
+  const match = /^bytes=(\d*)-(\d*)$/.exec(header.trim());
+  if (!match || (match[1] === '' && match[2] === '')) return null;
+
+  let start;
+  let end;
+  if (match[1] === '') {
+    // Suffix range: last N bytes
+    const suffix = parseInt(match[2], 10);
+    if (suffix === 0) return 'unsatisfiable';
+    start = Math.max(0, size - suffix);
+    end = size - 1;
+  } else {
+    start = parseInt(match[1], 10);
+    end = match[2] === '' ? size - 1 : Math.min(parseInt(match[2], 10), size - 1);
+  }
+  if (start >= size || start > end) return 'unsatisfiable';
+  return { start, end };
+}
+
+export default {
+  getTrackSize,
+  createTrackReadStream,
+  parseRangeHeader
+};
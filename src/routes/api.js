@@ -1,9 +1,55 @@
 import { authenticateTenant } from '../middleware/auth.js';
 import { createRoom, getRoomBySlug, updateRoom, listRoomsByTenant, deleteRoom } from '../db/models/room.js';
 import { createPublisher, listPublishersByRoom, deletePublisher, getPublisherById, updatePublisher } from '../db/models/publisher.js';
-import { startRecording, stopRecording, getRecordingStatus, isRecording } from '../recording/recorder.js';
-import { listRecordingsByRoomId } from '../db/models/recording.js';
+import { startRecording, stopRecording, getRecordingStatus, isRecording, getTrackFileSource } from '../recording/recorder.js';
+import { getTrackSize, createTrackReadStream, parseRangeHeader } from '../recording/track-stream.js';
+import { listRecordingsByRoomId, getRecordingById, getRecordingTrackById, listTracksByRecordingId } from '../db/models/recording.js';
 import { listTranscriptionSessionsByRoom, countTranscriptionSessionsByRoom } from '../db/models/transcription.js';
+import {
+  AUDIO_PROFILES,
+  PUBLISHER_AUDIO_PROFILES,
+  MIN_AUDIO_BITRATE,
+  MAX_AUDIO_BITRATE,
+  isAudioProfile,
+  isPublisherAudioProfile,
+  isValidAudioBitrate
+} from '../media/audio-profiles.js';
+
+/**
+ * Validate publisher audio_profile/audio_bitrate from a request body
+ * @returns {string|null} Error message, or null when valid (absent fields are valid)
+ */
+function validatePublisherAudio({ audio_profile, audio_bitrate }) {
+  if (audio_profile !== undefined && !isPublisherAudioProfile(audio_profile)) {
+    return `audio_profile must be one of: ${Object.keys(PUBLISHER_AUDIO_PROFILES).join(', ')}`;
+  }
+  if (audio_bitrate !== undefined && audio_bitrate !== null && !isValidAudioBitrate(audio_bitrate)) {
+    return `audio_bitrate must be an integer between ${MIN_AUDIO_BITRATE} and ${MAX_AUDIO_BITRATE}, or null`;
+  }
+  return null;
+}
+
+/**
+ * Look up a room's recording for the tenant, replying 404/403 when it cannot be served
+ * @returns {object|null} Recording row, or null after an error reply
+ */
+function findTenantRecording(request, reply) {
+  const room = getRoomBySlug(request.params.room_slug);
+  if (!room) {
+    reply.code(404).send({ error: 'Not Found', message: 'Room not found' });
+    return null;
+  }
+  if (room.tenant_id !== request.tenant.id) {
+    reply.code(403).send({ error: 'Forbidden', message: 'You do not have permission to view this room' });
+    return null;
+  }
+  const recording = getRecordingById(parseInt(request.params.recording_id, 10));
+  if (!recording || recording.room_id !== room.id) {
+    reply.code(404).send({ error: 'Not Found', message: 'Recording not found' });
+    return null;
+  }
+  return recording;
+}
 
 /**
  * Register REST API routes
@@ -21,7 +67,7 @@ export async function registerApiRoutes(fastify) {
   fastify.post('/api/rooms', {
     preHandler: authenticateTenant,
     handler: async (request, reply) => {
-      const { name, slug } = request.body;
+      const { name, slug, audio_profile } = request.body;
 
       // Validate required fields
       if (!name) {
@@ -31,17 +77,26 @@ export async function registerApiRoutes(fastify) {
         });
       }
 
+      if (audio_profile !== undefined && !isAudioProfile(audio_profile)) {
+        return reply.code(400).send({
+          error: 'Bad Request',
+          message: `audio_profile must be one of: ${Object.keys(AUDIO_PROFILES).join(', ')}`
+        });
+      }
+
       try {
         const room = createRoom({
           tenant_id: request.tenant.id,
           name,
-          slug
+          slug,
+          audio_profile
         });
 
         return reply.code(201).send({
           id: room.id,
           name: room.name,
-          slug: room.slug
+          slug: room.slug,
+          audio_profile: room.audio_profile
         });
       } catch (error) {
         // Check for unique constraint violation
@@ -66,16 +121,23 @@ export async function registerApiRoutes(fastify) {
     preHandler: authenticateTenant,
     handler: async (request, reply) => {
       const { room_slug } = request.params;
-      const { name, slug } = request.body;
+      const { name, slug, audio_profile } = request.body;
 
       // Validate at least one field is provided
-      if (!name && !slug) {
+      if (!name && !slug && !audio_profile) {
         return reply.code(400).send({
           error: 'Bad Request',
           message: 'At least one field must be provided for update'
         });
       }
 
+      if (audio_profile !== undefined && !isAudioProfile(audio_profile)) {
+        return reply.code(400).send({
+          error: 'Bad Request',
+          message: `audio_profile must be one of: ${Object.keys(AUDIO_PROFILES).join(', ')}`
+        });
+      }
+
       try {
         // Check if room exists and belongs to tenant
         const existingRoom = getRoomBySlug(room_slug);
@@ -98,13 +160,15 @@ export async function registerApiRoutes(fastify) {
         const updates = {};
         if (name !== undefined) updates.name = name;
         if (slug !== undefined) updates.slug = slug;
+        if (audio_profile !== undefined) updates.audio_profile = audio_profile;
 
         const updatedRoom = updateRoom(room_slug, updates);
 
         return reply.code(200).send({
           id: updatedRoom.id,
           name: updatedRoom.name,
-          slug: updatedRoom.slug
+          slug: updatedRoom.slug,
+          audio_profile: updatedRoom.audio_profile
         });
       } catch (error) {
         console.error('Error updating room:', error);
@@ -128,6 +192,7 @@ export async function registerApiRoutes(fastify) {
             id: room.id,
             name: room.name,
             slug: room.slug,
+            audio_profile: room.audio_profile,
             created_at: room.created_at
           }))
         });
@@ -168,6 +233,7 @@ export async function registerApiRoutes(fastify) {
           id: room.id,
           name: room.name,
           slug: room.slug,
+          audio_profile: room.audio_profile,
           created_at: room.created_at
         });
       } catch (error) {
@@ -185,7 +251,7 @@ export async function registerApiRoutes(fastify) {
     preHandler: authenticateTenant,
     handler: async (request, reply) => {
       const { room_slug } = request.params;
-      const { name, channel_name } = request.body;
+      const { name, channel_name, audio_profile, audio_bitrate } = request.body;
 
       // Validate required fields
       if (!name || !channel_name) {
@@ -195,6 +261,14 @@ export async function registerApiRoutes(fastify) {
         });
       }
 
+      const audioError = validatePublisherAudio(request.body);
+      if (audioError) {
+        return reply.code(400).send({
+          error: 'Bad Request',
+          message: audioError
+        });
+      }
+
       try {
         // Check if room exists and belongs to tenant
         const room = getRoomBySlug(room_slug);
@@ -217,7 +291,9 @@ export async function registerApiRoutes(fastify) {
         const publisher = createPublisher({
           room_id: room.id,
           name,
-          channel_name
+          channel_name,
+          audio_profile,
+          audio_bitrate
         });
 
         return reply.code(201).send({
@@ -225,6 +301,8 @@ export async function registerApiRoutes(fastify) {
           room_slug: room.slug,
           name: publisher.name,
           channel_name: publisher.channel_name,
+          audio_profile: publisher.audio_profile,
+          audio_bitrate: publisher.audio_bitrate,
           join_token: publisher.join_token
         });
       } catch (error) {
@@ -267,6 +345,8 @@ export async function registerApiRoutes(fastify) {
             id: publisher.id,
             name: publisher.name,
             channel_name: publisher.channel_name,
+            audio_profile: publisher.audio_profile,
+            audio_bitrate: publisher.audio_bitrate,
             join_token: publisher.join_token,
             created_at: publisher.created_at
           }))
@@ -286,7 +366,15 @@ export async function registerApiRoutes(fastify) {
     preHandler: authenticateTenant,
     handler: async (request, reply) => {
       const { room_slug, id } = request.params;
-      const { name, channel_name } = request.body;
+      const { name, channel_name, audio_profile, audio_bitrate } = request.body;
+
+      const audioError = validatePublisherAudio(request.body);
+      if (audioError) {
+        return reply.code(400).send({
+          error: 'Bad Request',
+          message: audioError
+        });
+      }
 
       try {
         // Check if room exists and belongs to tenant
@@ -326,7 +414,9 @@ export async function registerApiRoutes(fastify) {
         // Update publisher
         const updatedPublisher = updatePublisher(parseInt(id), {
           name,
-          channel_name
+          channel_name,
+          audio_profile,
+          audio_bitrate
         });
 
         return reply.code(200).send({
@@ -334,6 +424,8 @@ export async function registerApiRoutes(fastify) {
           room_slug: room.slug,
           name: updatedPublisher.name,
           channel_name: updatedPublisher.channel_name,
+          audio_profile: updatedPublisher.audio_profile,
+          audio_bitrate: updatedPublisher.audio_bitrate,
           message: 'Publisher updated successfully'
         });
       } catch (error) {
@@ -736,6 +828,103 @@ export async function registerApiRoutes(fastify) {
     }
   });
 
+  // GET /api/rooms/:room_slug/recordings/:recording_id/tracks - List tracks with their audio URLs
+  fastify.get('/api/rooms/:room_slug/recordings/:recording_id/tracks', {
+    preHandler: authenticateTenant,
+    handler: async (request, reply) => {
+      try {
+        const recording = findTenantRecording(request, reply);
+        if (!recording) return reply;
+
+        const tracks = [];
+        for (const track of listTracksByRecordingId(recording.id)) {
+          const source = getTrackFileSource(recording, track);
+          tracks.push({
+            id: track.id,
+            channelName: track.channel_name,
+            producerName: track.producer_name,
+            status: track.status,
+            live: Boolean(source?.live),
+            size: source ? await getTrackSize(source) : 0,
+            startedAt: track.started_at,
+            stoppedAt: track.stopped_at,
+            audioUrl: `/api/rooms/${request.params.room_slug}/recordings/${recording.id}/tracks/${track.id}/audio`
+          });
+        }
+
+        return reply.code(200).send({ recordingId: recording.id, status: recording.status, tracks });
+      } catch (error) {
+        console.error('Error listing recording tracks:', error);
+        return reply.code(500).send({
+          error: 'Internal Server Error',
+          message: 'Failed to list recording tracks'
+        });
+      }
+    }
+  });
+
+  // GET /api/rooms/:room_slug/recordings/:recording_id/tracks/:track_id/audio - Stream track audio
+  // Completed tracks honour Range. A live track without a Range (or with `bytes=0-`) is streamed
+  // continuously until recording stops; `?follow=false` returns what is on disk so far.
+  // `?download=true` sets an attachment disposition.
+  fastify.get('/api/rooms/:room_slug/recordings/:recording_id/tracks/:track_id/audio', {
+    preHandler: authenticateTenant,
+    handler: async (request, reply) => {
+      try {
+        const recording = findTenantRecording(request, reply);
+        if (!recording) return reply;
+
+        const track = getRecordingTrackById(parseInt(request.params.track_id, 10));
+        const source = track && track.recording_id === recording.id ? getTrackFileSource(recording, track) : null;
+        if (!source) {
+          return reply.code(404).send({ error: 'Not Found', message: 'Track not found' });
+        }
+
+        const size = await getTrackSize(source);
+        if (size === 0 && !source.live) {
+          return reply.code(404).send({ error: 'Not Found', message: 'No audio recorded for this track' });
+        }
+
+        const fileName = track.file_path.split(/[\\/]/).pop() || `track_${track.id}.ogg`;
+        reply.header('Content-Type', 'audio/ogg');
+        reply.header('Accept-Ranges', 'bytes');
+        reply.header('Content-Disposition', `${request.query?.download === 'true' ? 'attachment' : 'inline'}; filename="${fileName}"`);
+        reply.header('Cache-Control', source.live ? 'no-store' : 'private, max-age=0, must-revalidate');
+
+        // Closing the response stops a live tail instead of waiting for its next poll
+        const abort = new AbortController();
+        reply.raw.on('close', () => abort.abort());
+
+        const rangeHeader = request.headers.range;
+        const follow = source.live && request.query?.follow !== 'false' &&
+          (!rangeHeader || /^bytes=0-$/.test(rangeHeader.trim()));
+        if (follow) {
+          return reply.code(200).send(createTrackReadStream(source, { follow: true, signal: abort.signal }));
+        }
+
+        const range = parseRangeHeader(rangeHeader, size);
+        if (range === 'unsatisfiable') {
+          reply.header('Content-Range', `bytes */${size}`);
+          return reply.code(416).send({ error: 'Range Not Satisfiable', message: `Track is ${size} bytes` });
+        }
+        if (range) {
+          reply.header('Content-Range', `bytes ${range.start}-${range.end}/${size}`);
+          reply.header('Content-Length', range.end - range.start + 1);
+          return reply.code(206).send(createTrackReadStream(source, { ...range, signal: abort.signal }));
+        }
+
+        reply.header('Content-Length', size);
+        return reply.code(200).send(createTrackReadStream(source, { end: size - 1, signal: abort.signal }));
+      } catch (error) {
+        console.error('Error streaming recording track:', error);
+        return reply.code(500).send({
+          error: 'Internal Server Error',
+          message: 'Failed to stream recording track'
+        });
+      }
+    }
+  });
+
   // GET /api/rooms/:room_slug/transcriptions/current - Get active room transcription docs
   fastify.get('/api/rooms/:room_slug/transcriptions/current', {
     preHandler: authenticateTenant,
@@ -755,7 +944,7 @@ export async function registerApiRoutes(fastify) {
           return reply.code(503).send({ error: 'Service Unavailable', message: 'Transcription runtime is not configured' });
         }
 
-        const payload = transcriptionRuntime.getCurrentRoomDocs(room.id);
+        const payload = await transcriptionRuntime.getCurrentRoomDocs(room.id);
         if (!payload) {
           return reply.code(404).send({ error: 'Not Found', message: 'No active transcription session for this room' });
         }
@@ -840,7 +1029,7 @@ export async function registerApiRoutes(fastify) {
           return reply.code(503).send({ error: 'Service Unavailable', message: 'Transcription runtime is not configured' });
         }
 
-        const payload = transcriptionRuntime.getSessionDocs(room.id, room.slug, sessionId);
+        const payload = await transcriptionRuntime.getSessionDocs(room.id, room.slug, sessionId);
         if (!payload) {
           return reply.code(404).send({ error: 'Not Found', message: 'Transcription session not found for this room' });
         }
@@ -877,7 +1066,7 @@ export async function registerApiRoutes(fastify) {
           return reply.code(503).send({ error: 'Service Unavailable', message: 'Transcription runtime is not configured' });
         }
 
-        const payload = transcriptionRuntime.getSessionChannelDoc(room.id, room.slug, sessionId, channel_name);
+        const payload = await transcriptionRuntime.getSessionChannelDoc(room.id, room.slug, sessionId, channel_name);
         if (!payload) {
           return reply.code(404).send({ error: 'Not Found', message: 'Transcription session not found for this room' });
         }
@@ -1004,7 +1193,7 @@ export async function registerApiRoutes(fastify) {
           return reply.code(503).send({ error: 'Service Unavailable', message: 'Transcription runtime is not configured' });
         }
 
-        const payload = transcriptionRuntime.getChannelDoc(room.id, channel_name);
+        const payload = await transcriptionRuntime.getChannelDoc(room.id, channel_name);
         if (!payload) {
           return reply.code(404).send({ error: 'Not Found', message: 'No active transcription session for this room' });
         }
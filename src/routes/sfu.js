@@ -0,0 +1,109 @@
+import { authenticateSfu } from '../middleware/auth.js';
+
+/**
+ * Register standalone SFU routes: registration, heartbeat, drain and listener placement
+ * @param {object} fastify - Fastify instance
+ * @param {object} options
+ * @param {object} options.registry - SfuRegistry
+ */
+export async function registerSfuRoutes(fastify, { registry }) {
+  // POST /api/sfu/register - Register a standalone SFU (authenticated by secret_key in the body)
+  fastify.post('/api/sfu/register', async (request, reply) => {
+    const { name, url, announced_ip, port, secret_key, heartbeat_interval_ms, load } = request.body || {};
+
+    if (!process.env.SFU_SECRET_KEY) {
+      return reply.code(503).send({
+        error: 'Service Unavailable',
+        message: 'SFU registration is disabled (SFU_SECRET_KEY not set)'
+      });
+    }
+    if (secret_key !== process.env.SFU_SECRET_KEY) {
+      return reply.code(401).send({
+        error: 'Unauthorized',
+        message: 'Invalid SFU secret key'
+      });
+    }
+    if (!url) {
+      return reply.code(400).send({
+        error: 'Bad Request',
+        message: 'Missing required field: url'
+      });
+    }
+
+    const node = registry.register({ name, url, announced_ip, port, heartbeat_interval_ms, load });
+    fastify.log.info(`SFU registered: ${node.name} (${node.url}, ID: ${node.id})`);
+    return reply.code(201).send({ id: node.id });
+  });
+
+  // POST /api/sfu/:id/heartbeat - Refresh an SFU and its load; 404 tells it to register again
+  fastify.post('/api/sfu/:id/heartbeat', {
+    preHandler: authenticateSfu,
+    handler: async (request, reply) => {
+      const node = registry.heartbeat(request.params.id, request.body?.load || null);
+      if (!node) {
+        return reply.code(404).send({
+          error: 'Not Found',
+          message: 'SFU not registered'
+        });
+      }
+      return { ok: true, draining: node.draining };
+    }
+  });
+
+  // POST /api/sfu/:id/drain - Stop (or resume) placing new listeners on an SFU
+  fastify.post('/api/sfu/:id/drain', {
+    preHandler: authenticateSfu,
+    handler: async (request, reply) => {
+      const draining = request.body?.draining !== false;
+      const node = registry.setDraining(request.params.id, draining);
+      if (!node) {
+        return reply.code(404).send({
+          error: 'Not Found',
+          message: 'SFU not registered'
+        });
+      }
+      fastify.log.info(`SFU ${node.name} ${draining ? 'draining' : 'accepting listeners'}`);
+      return { ok: true, draining: node.draining };
+    }
+  });
+
+  // POST /api/sfu/:id/disconnect - Remove an SFU that is shutting down
+  fastify.post('/api/sfu/:id/disconnect', {
+    preHandler: authenticateSfu,
+    handler: async (request, reply) => {
+      if (!registry.remove(request.params.id)) {
+        return reply.code(404).send({
+          error: 'Not Found',
+          message: 'SFU not registered'
+        });
+      }
+      fastify.log.info(`SFU disconnected: ${request.params.id}`);
+      return { ok: true };
+    }
+  });
+
+  // GET /api/sfu - List registered SFUs with health and load
+  fastify.get('/api/sfu', {
+    preHandler: authenticateSfu,
+    handler: async () => {
+      return { sfus: registry.list() };
+    }
+  });
+
+  // GET /api/sfu/placement?channelId=room:channel - SFU a new listener should connect to.
+  // A null url means no edge can take the listener; use the embedded SFU.
+  fastify.get('/api/sfu/placement', async (request, reply) => {
+    const { channelId } = request.query;
+    if (!channelId) {
+      return reply.code(400).send({
+        error: 'Bad Request',
+        message: 'Missing required query parameter: channelId'
+      });
+    }
+
+    const node = registry.place(channelId);
+    return node ? { sfuId: node.id, url: node.url } : { sfuId: null, url: null };
+  });
+}
+
+export default registerSfuRoutes;
@@ -3,19 +3,33 @@ import path from 'path';
 import fs from 'fs';
 import https from 'https';
 import os from 'os';
+import { performance } from 'perf_hooks';
 import { fileURLToPath } from 'url';
 import { v4 as uuidv4 } from 'uuid';
-import mediasoup from 'mediasoup';
 import Fastify from 'fastify';
 import fastifyStatic from '@fastify/static';
 import fastifyWebsocket from '@fastify/websocket';
 import { initDatabase, getDatabase } from './db/database.js';
+import { startDbWriter, stopDbWriter } from './db/writer.js';
 import { registerApiRoutes } from './routes/api.js';
+import { registerSfuRoutes } from './routes/sfu.js';
 import { getRoomBySlug, getRoomById, listRoomsByTenant, createRoom } from './db/models/room.js';
-import { verifyPublisherToken, getChannelsByRoom, listPublishersByRoom } from './db/models/publisher.js';
+import { verifyPublisherToken, getChannelsByRoom, getPublisherById } from './db/models/publisher.js';
 import { verifyTenantApiKey, getTenantByName, createTenant } from './db/models/tenant.js';
-import { initRecorder, recoverRecordingSessions, isRecording, addProducerToRecording, removeProducerFromRecording, getRecordingStatus, getActiveRecordings, waitForRecordingFinalization } from './recording/recorder.js';
+import { listRoomTopologyByTenant, findRoomByChannel } from './db/models/topology.js';
+import { initRecorder, recoverRecordingSessions, isRecording, addProducerToRecording, removeProducerFromRecording, getRecordingStatus, getActiveRecordings, waitForRecordingFinalization, recordingEvents, supportsSegmentEvents, subscribeTrackAudio } from './recording/recorder.js';
 import TranscriptionRuntime from './transcription/runtime.js';
+import TranscriptionRuntimeClient from './transcription/runtime-client.js';
+import MediasoupWorkerPool from './media/worker-pool.js';
+import RelayOrigin from './media/relay-origin.js';
+import SfuRegistry from './media/sfu-registry.js';
+import { metrics, registerCollector, renderMetrics } from './metrics.js';
+import { decodeFrame, sendMessage, negotiateCodec } from './signaling/codec.js';
+import { createDispatcher } from './signaling/dispatch.js';
+import { PublisherChatHistory, getOrCreateChannel } from './signaling/state-limits.js';
+import { createListenerIndex, countChannelListeners } from './signaling/listener-index.js';
+import { getAudioProfile, getClientAudioProfile } from './media/audio-profiles.js';
+import AudioProcessor, { PROCESSING_MODES } from './media/audio-processor.js';
 
 // ES module equivalent for __dirname
 const __filename = fileURLToPath(import.meta.url);
@@ -187,6 +201,7 @@ function registerCaptivePortalRoutes(fastifyInstance) {
 // Initialize database
 const dbPath = process.env.DB_PATH || './soundcast.db';
 initDatabase(dbPath);
+startDbWriter(dbPath);
 console.log('Database initialized');
 
 // Single-tenant mode: auto-create default tenant and room
@@ -221,14 +236,26 @@ if (singleTenantMode) {
 const DEFAULT_ICE_SERVERS = [];
 
 // Transcription runtime (sidecar + Yjs) is shared across HTTP/HTTPS servers.
-transcriptionRuntime = new TranscriptionRuntime({
-  fastify,
-  verifyPublisherToken,
-  verifyTenantApiKey,
-  getRoomBySlug,
-  getRoomById,
-  listRoomsByTenant
-});
+// TRANSCRIPTION_RUNTIME=worker runs it on its own thread so caption load cannot delay signaling.
+if (process.env.TRANSCRIPTION_RUNTIME === 'worker') {
+  transcriptionRuntime = new TranscriptionRuntimeClient({
+    fastify,
+    dbPath,
+    segmentEvents: supportsSegmentEvents() ? recordingEvents : null,
+    subscribeTrackAudio: supportsSegmentEvents() ? subscribeTrackAudio : null
+  });
+} else {
+  transcriptionRuntime = new TranscriptionRuntime({
+    fastify,
+    verifyPublisherToken,
+    verifyTenantApiKey,
+    getRoomBySlug,
+    getRoomById,
+    listRoomsByTenant,
+    segmentEvents: supportsSegmentEvents() ? recordingEvents : null,
+    subscribeTrackAudio: supportsSegmentEvents() ? subscribeTrackAudio : null
+  });
+}
 
 // Fastify setup - serve static files
 const publicDir = getPublicDir();
@@ -257,8 +284,14 @@ fastify.register(fastifyWebsocket, {
   }
 });
 
+// Standalone SFUs register here; listeners are placed on the least-loaded healthy edge
+const sfuRegistry = new SfuRegistry({
+  maxCpuPercent: parseInt(process.env.SFU_PLACEMENT_MAX_CPU_PERCENT || '85', 10)
+});
+
 // Register REST API routes
 fastify.register(registerApiRoutes);
+fastify.register(registerSfuRoutes, { registry: sfuRegistry });
 
 // Room-specific HTML routes
 fastify.get('/room/:slug/publish', async (request, reply) => {
@@ -290,18 +323,78 @@ fastify.get('/tenant-admin', async (request, reply) => {
   return reply.sendFile('tenant-admin.html');
 });
 
+// Prometheus scrape endpoint; set METRICS_TOKEN to require `Authorization: Bearer <token>`
+const METRICS_TOKEN = process.env.METRICS_TOKEN || '';
+fastify.get('/metrics', async (request, reply) => {
+  if (METRICS_TOKEN && request.headers.authorization !== `Bearer ${METRICS_TOKEN}`) {
+    return reply.code(401).send('Unauthorized');
+  }
+  reply.header('Content-Type', 'text/plain; version=0.0.4; charset=utf-8');
+  return renderMetrics();
+});
+
+// Scrape-time gauges: worker resource usage needs an RPC per worker, the rest a map walk
+registerCollector(async () => {
+  if (!workerPool) return;
+  metrics.routerLoad.reset();
+  metrics.workerMaxRssBytes.reset();
+  await Promise.all(workerPool.entries.map(async (entry) => {
+    const labels = { pid: entry.worker.pid };
+    const endTimer = metrics.workerUsageRpcSeconds.startTimer();
+    const usage = await entry.worker.getResourceUsage();
+    endTimer();
+    metrics.workerCpuSeconds.set(usage.ru_utime / 1000, { ...labels, mode: 'user' });
+    metrics.workerCpuSeconds.set(usage.ru_stime / 1000, { ...labels, mode: 'system' });
+    metrics.workerMaxRssBytes.set(usage.ru_maxrss * 1024, labels);
+    metrics.routerLoad.set(entry.transports + entry.consumers, { router: entry.router.id });
+  }));
+});
+
+registerCollector(() => {
+  let listeners = 0;
+  for (const channel of channels.values()) listeners += countChannelListeners(channel);
+  metrics.channels.set(channels.size);
+  metrics.listeners.set(listeners);
+  for (const [structure, entries] of Object.entries(getStateSizes())) {
+    metrics.stateEntries.set(entries, { structure });
+  }
+  for (const [type, bytes] of Object.entries(process.memoryUsage())) {
+    metrics.processMemoryBytes.set(bytes, { type });
+  }
+
+  if (transcriptionRuntime) {
+    const { sessions, queueDepth, inFlight } = transcriptionRuntime.getMetricsSnapshot();
+    metrics.asrSessions.set(sessions);
+    metrics.asrQueueDepth.set(queueDepth);
+    metrics.asrInFlight.set(inFlight);
+  }
+});
+
 // mediasoup configuration
 const mediasoupConfig = {
   listenIp: process.env.LISTEN_IP || '0.0.0.0',
   announcedIp: process.env.ANNOUNCED_IP || '127.0.0.1',
   rtcMinPort: parseInt(process.env.RTC_MIN_PORT || process.env.MEDIASOUP_MIN_PORT || '40000'),
-  rtcMaxPort: parseInt(process.env.RTC_MAX_PORT || process.env.MEDIASOUP_MAX_PORT || '49999')
+  rtcMaxPort: parseInt(process.env.RTC_MAX_PORT || process.env.MEDIASOUP_MAX_PORT || '49999'),
+  // 0 = one worker per CPU core
+  numWorkers: parseInt(process.env.MEDIASOUP_NUM_WORKERS || '0') || os.availableParallelism?.() || os.cpus().length,
+  // Listeners of one channel per router before spilling onto another worker via pipeToRouter
+  maxListenersPerRouter: parseInt(process.env.MEDIASOUP_MAX_LISTENERS_PER_ROUTER || '500'),
+  // When set, each worker serves all WebRTC transports from one UDP+TCP port (port + worker index)
+  webRtcServerPort: parseInt(process.env.MEDIASOUP_WEBRTC_SERVER_PORT || '0') || null
 };
 
 console.log('mediasoup configuration:');
 console.log(`  Listen IP:    ${mediasoupConfig.listenIp}`);
 console.log(`  Announced IP: ${mediasoupConfig.announcedIp}`);
 console.log(`  RTC Ports:    ${mediasoupConfig.rtcMinPort}-${mediasoupConfig.rtcMaxPort}`);
+console.log(`  Workers:      ${mediasoupConfig.numWorkers}`);
+if (mediasoupConfig.webRtcServerPort) {
+  console.log(`  WebRtcServer: ${mediasoupConfig.webRtcServerPort}-${mediasoupConfig.webRtcServerPort + mediasoupConfig.numWorkers - 1} (udp+tcp)`);
+}
+
+// Optional server-side processing stage (one ffmpeg per producer); publishers opt in per produce
+const audioProcessingEnabled = process.env.AUDIO_PROCESSING_ENABLED === 'true';
 
 function getLocalInterfaceIps() {
   const interfaces = os.networkInterfaces();
@@ -330,44 +423,131 @@ if (mediasoupConfig.announcedIp === '127.0.0.1') {
 }
 
 // Router: audio only
+// useinbandfec/usedtx are advertised to consumers so listeners decode FEC and accept DTX;
+// whether a publisher actually sends either is set by the room's audio profile
 const mediaCodecs = [{
   kind: 'audio',
   mimeType: 'audio/opus',
   clockRate: 48000,
-  channels: 2
+  channels: 2,
+  parameters: { useinbandfec: 1, usedtx: 1 }
 }];
 
-// These will be initialized in main()
-let worker;
-let router;
+// This will be initialized in main()
+let workerPool;
+
+// Edge SFUs (standalone-sfu --origin) authenticate to /ws/relay with this key; unset disables relaying
+const SFU_RELAY_SECRET = process.env.SFU_RELAY_SECRET || process.env.SFU_SECRET_KEY || '';
+let relayOrigin = null;
+
+// Capacity limits for in-memory signaling state (0 disables a limit)
+const MAX_SIGNALING_CLIENTS = parseInt(process.env.MAX_SIGNALING_CLIENTS || '20000', 10);
+const MAX_CHANNELS = parseInt(process.env.MAX_CHANNELS || '5000', 10);
+const MAX_TENANT_ADMIN_SOCKETS = parseInt(process.env.MAX_TENANT_ADMIN_SOCKETS || '20', 10);
+const PUBLISHER_CHAT_HISTORY_LIMIT = parseInt(process.env.PUBLISHER_CHAT_HISTORY_LIMIT || '100', 10);
+const MAX_CHAT_HISTORY_PUBLISHERS = parseInt(process.env.MAX_CHAT_HISTORY_PUBLISHERS || '1000', 10);
+// Log state sizes and process memory this often (0 disables; /metrics is always available)
+const STATE_REPORT_INTERVAL_MS = parseInt(process.env.STATE_REPORT_INTERVAL_MS || '300000', 10);
 
 // In-memory channel store
-// channelId -> { producers: Map<producerId, { transport, producer, clientId }>, consumers: Map }
+// channelId -> {
+//   producers: Map<producerId, { transport, producer, router, clientId, processor?, processed? }>,
+//                                            // processed: { producer, router } listeners consume instead
+//   consumers: Map,                          // mutate via add/removeChannelConsumer
+//   listenerRefs: Map<clientId, count>,      // consumers per listener; size = unique listeners
+//   router,                                  // home router, where publishers produce
+//   listenersByRouter: Map<routerId, count>  // listener transports per router
+// }
 const channels = new Map();
 
-// Store active connections
+function createChannelState() {
+  return {
+    producers: new Map(),
+    consumers: new Map(),
+    listenerRefs: new Map(),
+    router: workerPool.getLeastLoadedRouter(),
+    listenersByRouter: new Map()
+  };
+}
+
+// Get or create a channel. At MAX_CHANNELS the oldest idle channel is evicted to make room;
+// null when every channel is in use.
+function ensureChannel(channelId) {
+  return getOrCreateChannel(channels, channelId, {
+    maxChannels: MAX_CHANNELS,
+    createChannel: createChannelState,
+    clients: clients.values(),
+    isRelayed: (id) => Boolean(relayOrigin?.relaysByChannel.has(id)),
+    onEvict: (id) => fastify.log.info(`Evicted idle channel ${id} (channel limit ${MAX_CHANNELS})`)
+  });
+}
+
+function sendChannelLimitError(connection) {
+  sendMessage(connection, {
+    action: 'error',
+    data: { message: 'Channel limit reached' }
+  });
+}
+
+// Store active connections: clientId -> clientInfo (see createClientInfo)
 const clients = new Map();
+const {
+  addChannelListenerRouter,
+  removeChannelListenerRouter,
+  addChannelConsumer,
+  removeChannelConsumer,
+  removeListenerConsumers,
+  releaseListener
+} = createListenerIndex(clients);
+
+// Every signaling client has the same fields from the start, so all clientInfo objects share
+// one shape and handlers never grow them with new properties
+function createClientInfo(clientId, socket) {
+  return {
+    id: clientId,
+    socket,  // In newer versions, connection is the socket
+    isAdmin: false,
+    isPublisher: false,
+    isListener: false,
+    channelId: null,
+    displayName: null,
+    publisherId: null,
+    publisherName: null,
+    transport: null,
+    router: null,
+    producer: null,
+    consumers: new Map(), // consumerId -> channel consumer entry; mutate via add/removeChannelConsumer
+    rtpCapabilities: null,
+    joinStartedAt: null
+  };
+}
 
-// Tenant admin WebSocket connections: tenantId -> Set<socket>
+// Tenant admin WebSocket connections: tenantId -> Set<socket>, oldest first
 const tenantAdminClients = new Map();
 // Active room publisher sockets keyed by publisher DB id
 const roomPublisherClients = new Map();
-// In-memory chat history by publisher id
-const publisherChatHistory = new Map();
-
-function pushPublisherChatMessage(publisherId, message) {
-  if (!publisherChatHistory.has(publisherId)) {
-    publisherChatHistory.set(publisherId, []);
-  }
-  const history = publisherChatHistory.get(publisherId);
-  history.push(message);
-  if (history.length > 100) {
-    history.splice(0, history.length - 100);
-  }
-}
+// In-memory chat history by publisher id, least recently used first
+const publisherChatHistory = new PublisherChatHistory({
+  perPublisherLimit: PUBLISHER_CHAT_HISTORY_LIMIT,
+  maxPublishers: MAX_CHAT_HISTORY_PUBLISHERS
+});
 
-function getPublisherChatHistory(publisherId) {
-  return publisherChatHistory.get(publisherId) || [];
+// Entry counts for each in-memory structure, for /metrics and the periodic state report
+function getStateSizes() {
+  let channelConsumers = 0;
+  for (const channel of channels.values()) channelConsumers += channel.consumers.size;
+  let tenantAdminSockets = 0;
+  for (const sockets of tenantAdminClients.values()) tenantAdminSockets += sockets.size;
+  return {
+    clients: clients.size,
+    channels: channels.size,
+    channelConsumers,
+    tenantAdminSockets,
+    roomPublisherClients: roomPublisherClients.size,
+    chatHistoryPublishers: publisherChatHistory.publisherCount,
+    chatHistoryMessages: publisherChatHistory.messageCount,
+    chatHistoryTextChars: publisherChatHistory.textChars
+  };
 }
 
 function broadcastTenantAdminMessage(tenantId, payload) {
@@ -375,7 +555,7 @@ function broadcastTenantAdminMessage(tenantId, payload) {
   if (!adminSockets || adminSockets.size === 0) return;
   for (const socket of adminSockets) {
     try {
-      socket.send(JSON.stringify(payload));
+      sendMessage(socket, payload);
     } catch (e) {
       fastify.log.error(`Failed sending tenant admin message: ${e.message}`);
     }
@@ -384,56 +564,40 @@ function broadcastTenantAdminMessage(tenantId, payload) {
 
 // Broadcast updated channel list to all clients
 function broadcastChannelList() {
-  const list = Array.from(channels.keys());
+  const message = { action: 'channel-list', data: Array.from(channels.keys()) };
+  const frames = {}; // encoded once per codec
   for (const [clientId, client] of clients.entries()) {
     // In newer versions of fastify-websocket, the connection is the socket
-    client.socket.send(JSON.stringify({
-      action: 'channel-list',
-      data: list
-    }));
+    sendMessage(client.socket, message, frames);
   }
 }
 
 // Get channel stats for a specific tenant.
 function getChannelStatsForTenant(tenantId) {
   const stats = {};
-  const rooms = listRoomsByTenant(tenantId);
+  // Served from the in-memory topology cache, not SQLite
+  const rooms = listRoomTopologyByTenant(tenantId);
 
   for (const room of rooms) {
     stats[room.slug] = {};
-    const publishers = listPublishersByRoom(room.id);
-    const channelNames = [...new Set(publishers.map(p => p.channel_name))];
 
-    for (const channelName of channelNames) {
+    for (const channelName of room.channelNames) {
       // Full channel ID format used by SFU: "roomSlug:channelName"
       const fullChannelId = `${room.slug}:${channelName}`;
 
-      // Helper to count unique listeners in a channel
-      function countUniqueListeners(ch) {
-        const uniqueListeners = new Set();
-        if (ch.consumers) {
-          for (const [consumerId, consumer] of ch.consumers) {
-            if (consumer.clientId) {
-              uniqueListeners.add(consumer.clientId);
-            }
-          }
-        }
-        return uniqueListeners.size;
-      }
-
       // Check channels Map (try both full and legacy formats)
       if (channels.has(fullChannelId)) {
         const ch = channels.get(fullChannelId);
         stats[room.slug][channelName] = {
           publishers: countActivePublishers(ch),
-          subscribers: countUniqueListeners(ch)
+          subscribers: countChannelListeners(ch)
         };
       } else if (channels.has(channelName)) {
         // Fallback to legacy format
         const ch = channels.get(channelName);
         stats[room.slug][channelName] = {
           publishers: countActivePublishers(ch),
-          subscribers: countUniqueListeners(ch)
+          subscribers: countChannelListeners(ch)
         };
       } else {
         stats[room.slug][channelName] = { publishers: 0, subscribers: 0 };
@@ -446,11 +610,11 @@ function getChannelStatsForTenant(tenantId) {
 // Get recording status for all rooms in a tenant
 function getRecordingStatusForTenant(tenantId) {
   const recordingStats = {};
-  const rooms = listRoomsByTenant(tenantId);
+  const rooms = listRoomTopologyByTenant(tenantId);
 
   for (const room of rooms) {
-    const status = getRecordingStatus(room.id);
-    const transcriptionStatus = transcriptionRuntime ? transcriptionRuntime.getRoomTranscriptionStatus(room.id) : null;
+    const status = getRecordingStatus(room.room_id);
+    const transcriptionStatus = transcriptionRuntime ? transcriptionRuntime.getRoomTranscriptionStatus(room.room_id) : null;
     if (status) {
       recordingStats[room.slug] = {
         ...status,
@@ -482,16 +646,17 @@ function getRecordingStatusForTenant(tenantId) {
 
 // Notify publishers in a room about recording status change
 function notifyPublishersRecordingStatus(roomSlug, payload) {
-  const message = JSON.stringify({
+  const message = {
     type: 'recording-status',
     ...payload
-  });
+  };
+  const frames = {};
 
   // Find all publishers in this room
   for (const [clientId, client] of clients) {
     if (client.isPublisher && client.channelId && client.channelId.startsWith(roomSlug + ':')) {
       try {
-        client.socket.send(message);
+        sendMessage(client.socket, message, frames);
       } catch (e) {
         fastify.log.error(`Failed to send recording status to publisher: ${e.message}`);
       }
@@ -520,15 +685,16 @@ function notifyRecordingStatusChange(tenantId, roomSlug, status) {
     sidecarOverflow: Boolean(transcriptionStatus?.sidecarOverflow)
   };
 
-  const message = JSON.stringify({
+  const message = {
     type: 'recording-status',
     roomSlug,
     ...normalizedStatus
-  });
+  };
+  const frames = {};
 
   for (const socket of adminClients) {
     try {
-      socket.send(message);
+      sendMessage(socket, message, frames);
     } catch (e) {
       fastify.log.error(`Failed to send recording status to admin: ${e.message}`);
     }
@@ -541,35 +707,19 @@ function notifyRecordingStatusChange(tenantId, roomSlug, status) {
 // Find room and tenant for a channel name
 // channelId format can be "roomSlug:channelName" (e.g., "sjh2:English") or just "channelName"
 function findRoomForChannel(channelId) {
-  const db = getDatabase();
-
   // Check if channelId has the "roomSlug:channelName" format
   const colonIndex = channelId.indexOf(':');
   if (colonIndex !== -1) {
-    // Parse roomSlug and channelName
-    const roomSlug = channelId.substring(0, colonIndex);
-    const channelName = channelId.substring(colonIndex + 1);
-
-    // Look up by room slug and channel name
-    const stmt = db.prepare(`
-      SELECT r.id as room_id, r.slug, r.tenant_id
-      FROM rooms r
-      JOIN publishers p ON p.room_id = r.id
-      WHERE r.slug = ? AND p.channel_name = ?
-      LIMIT 1
-    `);
-    return stmt.get(roomSlug, channelName);
-  }
-
-  // Fallback: query by channel_name directly (legacy format)
-  const stmt = db.prepare(`
-    SELECT r.id as room_id, r.slug, r.tenant_id
-    FROM rooms r
-    JOIN publishers p ON p.room_id = r.id
-    WHERE p.channel_name = ?
-    LIMIT 1
-  `);
-  return stmt.get(channelId);
+    return findRoomByChannel(channelId.substring(0, colonIndex), channelId.substring(colonIndex + 1));
+  }
+
+  // Fallback: look up by channel_name directly (legacy format)
+  return findRoomByChannel(null, channelId);
+}
+
+// Audio profile of the room serving a channel (default profile for unknown channels)
+function getChannelAudioProfile(channelId) {
+  return getAudioProfile(findRoomForChannel(channelId)?.audio_profile);
 }
 
 // Extract short channel name from full channel ID
@@ -579,6 +729,11 @@ function getShortChannelName(channelId) {
   return colonIndex !== -1 ? channelId.substring(colonIndex + 1) : channelId;
 }
 
+// Producer that listeners consume: the processed producer while a processing stage runs
+function listenerSource(producerInfo) {
+  return producerInfo.processed || producerInfo;
+}
+
 // Remove a producer and any linked consumers from a channel
 function removeChannelProducer(channel, producerId) {
   const producerInfo = channel?.producers?.get(producerId);
@@ -589,10 +744,19 @@ function removeChannelProducer(channel, producerId) {
       producerInfo.producer.close();
     } catch { }
   }
+  if (producerInfo.processor) producerInfo.processor.stop();
 
   channel.producers.delete(producerId);
+  removeProducerConsumers(channel, producerId);
 
-  // Remove consumers linked to this producer and notify listeners
+  return {
+    producerId,
+    mediasoupProducerId: producerInfo.producer?.id
+  };
+}
+
+// Close consumers linked to a producer and notify their listeners
+function removeProducerConsumers(channel, producerId) {
   for (const [consumerId, consumer] of [...channel.consumers.entries()]) {
     if (consumer.producerId !== producerId) continue;
 
@@ -601,21 +765,15 @@ function removeChannelProducer(channel, producerId) {
         consumer.consumer.close();
       } catch { }
     }
-    channel.consumers.delete(consumerId);
+    removeChannelConsumer(channel, consumerId);
 
     if (consumer.clientId && clients.has(consumer.clientId)) {
       const listenerClient = clients.get(consumer.clientId);
-      listenerClient.consumers = listenerClient.consumers.filter(c => c.id !== consumerId);
       try {
-        listenerClient.socket.send(JSON.stringify({ action: 'producer-stopped', data: { producerId } }));
+        sendMessage(listenerClient.socket, { action: 'producer-stopped', data: { producerId } });
       } catch { }
     }
   }
-
-  return {
-    producerId,
-    mediasoupProducerId: producerInfo.producer?.id
-  };
 }
 
 // Remove all producers for the same publisher identity (or same socket client)
@@ -674,92 +832,131 @@ function countActivePublishers(channel) {
   return count;
 }
 
-// Notify tenant admins about channel updates
-function notifyTenantAdmins(channelId, source = 'main') {
-  const roomInfo = findRoomForChannel(channelId);
-  if (!roomInfo) return;
+// Stats fan-out is coalesced: join/leave only marks the channel dirty, and one flush per
+// STATS_FLUSH_INTERVAL_MS sends each tenant one batched delta and each channel's publishers
+// one listener count. Payloads are stringified once per batch, not once per socket.
+const STATS_FLUSH_INTERVAL_MS = Number.parseInt(process.env.STATS_FLUSH_INTERVAL_MS || '250', 10);
+const dirtyAdminChannels = new Map(); // channelId -> source
+const dirtyListenerCountChannels = new Set();
+const lastChannelUpdates = new Map(); // channelId -> "publishers:subscribers" last sent to admins
+let statsFlushTimer = null;
+
+function scheduleStatsFlush() {
+  if (statsFlushTimer) return;
+  statsFlushTimer = setTimeout(flushStats, Math.max(0, STATS_FLUSH_INTERVAL_MS));
+}
 
-  const tenantId = roomInfo.tenant_id;
-  const adminSockets = tenantAdminClients.get(tenantId);
-  if (!adminSockets || adminSockets.size === 0) return;
+function flushStats() {
+  statsFlushTimer = null;
+  flushTenantAdminUpdates();
+  flushPublisherListenerCounts();
+}
 
-  // Get current stats for this channel
-  let channelStats;
-  if (source === 'main' && channels.has(channelId)) {
-    const ch = channels.get(channelId);
-    // Count unique listeners (by clientId) to match what publishers see
-    const uniqueListeners = new Set();
-    if (ch.consumers) {
-      for (const [consumerId, consumer] of ch.consumers) {
-        if (consumer.clientId) {
-          uniqueListeners.add(consumer.clientId);
-        }
-      }
+function sendToSockets(sockets, message, label) {
+  const frames = {};
+  for (const socket of sockets) {
+    try {
+      sendMessage(socket, message, frames);
+    } catch (e) {
+      fastify.log.error(`Failed to send update to ${label}: ${e.message}`);
     }
-    channelStats = {
-      publishers: countActivePublishers(ch),
-      subscribers: uniqueListeners.size
-    };
-  } else {
-    channelStats = { publishers: 0, subscribers: 0 };
   }
+}
 
-  // Use short channel name for the update (frontend expects "English", not "sjh2:English")
-  const shortChannelName = getShortChannelName(channelId);
+// Notify tenant admins about channel updates
+function notifyTenantAdmins(channelId, source = 'main') {
+  dirtyAdminChannels.set(channelId, source);
+  scheduleStatsFlush();
+}
 
-  const update = {
-    type: 'channel-update',
-    roomSlug: roomInfo.slug,
-    channelName: shortChannelName,
-    publishers: channelStats.publishers,
-    subscribers: channelStats.subscribers
-  };
+function flushTenantAdminUpdates() {
+  if (dirtyAdminChannels.size === 0) return;
+  const updatesByTenant = new Map(); // tenantId -> update[]
+
+  for (const [channelId, source] of dirtyAdminChannels) {
+    const roomInfo = findRoomForChannel(channelId);
+    if (!roomInfo) continue;
+
+    const tenantId = roomInfo.tenant_id;
+    const adminSockets = tenantAdminClients.get(tenantId);
+    if (!adminSockets || adminSockets.size === 0) continue;
+
+    // Get current stats for this channel
+    let channelStats;
+    if (source === 'main' && channels.has(channelId)) {
+      const ch = channels.get(channelId);
+      channelStats = {
+        publishers: countActivePublishers(ch),
+        subscribers: countChannelListeners(ch)
+      };
+    } else {
+      channelStats = { publishers: 0, subscribers: 0 };
+    }
 
-  for (const socket of adminSockets) {
-    try {
-      socket.send(JSON.stringify(update));
-    } catch (e) {
-      fastify.log.error(`Failed to send update to tenant admin: ${e.message}`);
+    // A join and leave within one tick cancel out; skip channels admins already have
+    const fingerprint = `${channelStats.publishers}:${channelStats.subscribers}`;
+    if (lastChannelUpdates.get(channelId) === fingerprint) continue;
+    if (fingerprint === '0:0') {
+      lastChannelUpdates.delete(channelId);
+    } else {
+      lastChannelUpdates.set(channelId, fingerprint);
+    }
+
+    let updates = updatesByTenant.get(tenantId);
+    if (!updates) {
+      updates = [];
+      updatesByTenant.set(tenantId, updates);
     }
+    // Use short channel name for the update (frontend expects "English", not "sjh2:English")
+    updates.push({
+      roomSlug: roomInfo.slug,
+      channelName: getShortChannelName(channelId),
+      publishers: channelStats.publishers,
+      subscribers: channelStats.subscribers
+    });
+  }
+  dirtyAdminChannels.clear();
+
+  for (const [tenantId, updates] of updatesByTenant) {
+    sendToSockets(tenantAdminClients.get(tenantId) || [], { type: 'channel-updates', updates }, 'tenant admin');
   }
 }
 
 // Notify publishers in a channel about listener count changes
 function notifyPublishersListenerCount(channelId) {
-  const channel = channels.get(channelId);
-  if (!channel) return;
+  dirtyListenerCountChannels.add(channelId);
+  scheduleStatsFlush();
+}
 
-  // Count unique listeners (consumers with unique clientIds)
-  const uniqueListeners = new Set();
-  for (const [consumerId, consumer] of channel.consumers) {
-    if (consumer.clientId) {
-      uniqueListeners.add(consumer.clientId);
-    }
-  }
-  const listenerCount = uniqueListeners.size;
+function flushPublisherListenerCounts() {
+  for (const channelId of dirtyListenerCountChannels) {
+    const channel = channels.get(channelId);
+    if (!channel) continue;
 
-  // Notify all publishers in this channel
-  for (const [producerId, producerInfo] of channel.producers) {
-    if (producerInfo.clientId && clients.has(producerInfo.clientId)) {
-      const publisherClient = clients.get(producerInfo.clientId);
-      try {
-        publisherClient.socket.send(JSON.stringify({
-          action: 'listener-count',
-          data: { count: listenerCount, channelId }
-        }));
-      } catch (e) {
-        // Client may have disconnected
+    const sockets = [];
+    for (const [producerId, producerInfo] of channel.producers) {
+      if (producerInfo.clientId && clients.has(producerInfo.clientId)) {
+        sockets.push(clients.get(producerInfo.clientId).socket);
       }
     }
+    if (sockets.length === 0) continue;
+
+    // Client may have disconnected
+    sendToSockets(sockets, {
+      action: 'listener-count',
+      data: { count: countChannelListeners(channel), channelId }
+    }, 'publisher');
   }
+  dirtyListenerCountChannels.clear();
 }
 
-// Helper to create WebRTC transport
-async function createWebRtcTransport() {
+// Helper to create WebRTC transport on the given router
+async function createWebRtcTransport(router) {
+  const webRtcServer = workerPool.getWebRtcServer(router);
   const transport = await router.createWebRtcTransport({
-    listenIps: [
-      { ip: mediasoupConfig.listenIp, announcedIp: mediasoupConfig.announcedIp }
-    ],
+    ...(webRtcServer
+      ? { webRtcServer }
+      : { listenIps: [{ ip: mediasoupConfig.listenIp, announcedIp: mediasoupConfig.announcedIp }] }),
     enableUdp: true,
     enableTcp: true,
     preferUdp: true
@@ -795,811 +992,1041 @@ async function createWebRtcTransport() {
   };
 }
 
-// WebSocket route handler - extracted as a plugin for reuse
-async function registerMainWsRoutes(fastify) {
-  fastify.get('/ws', { websocket: true }, (connection, req) => {
-    const clientId = uuidv4();
-    fastify.log.info(`New connection: ${clientId}`);
-
-    // Store client info
-    const clientInfo = {
-      id: clientId,
-      socket: connection,  // In newer versions, connection is the socket
-      isAdmin: false,
-      isPublisher: false,
-      isListener: false,
-      channelId: null,
-      displayName: null,
-      publisherId: null,
-      transport: null,
-      producer: null,
-      consumers: [],
-      rtpCapabilities: null
-    };
+// Consume every open producer of a channel on the listener's transport.
+// consume() calls are issued concurrently so a join costs one worker round trip, not one per producer.
+async function consumeChannelProducers(clientInfo, channel, rtpCapabilities, { paused = false } = {}) {
+  const producerEntries = [...channel.producers.entries()]
+    .filter(([, prodInfo]) => prodInfo.producer && !prodInfo.producer.closed);
+  const { ignoreDtx } = getChannelAudioProfile(clientInfo.channelId);
+
+  const results = await Promise.allSettled(producerEntries.map(async ([prodId, prodInfo]) => {
+    const source = listenerSource(prodInfo);
+    await workerPool.ensureProducerOnRouter(source, clientInfo.router);
+    if (!clientInfo.router.canConsume({ producerId: source.producer.id, rtpCapabilities })) {
+      fastify.log.warn(`Client ${clientInfo.id} cannot consume producer ${prodId} due to RTP capabilities mismatch`);
+      return null;
+    }
 
-    // Add to clients map
-    clients.set(clientId, clientInfo);
+    const endConsumeTimer = metrics.consumeRpcSeconds.startTimer();
+    const consumerObj = await clientInfo.transport.consume({
+      producerId: source.producer.id,
+      rtpCapabilities,
+      paused,
+      ignoreDtx
+    });
+    endConsumeTimer();
+    return { prodId, consumerObj };
+  }));
+
+  const consumersData = [];
+  for (const result of results) {
+    if (result.status === 'rejected') {
+      fastify.log.error(`Error creating consumer for client ${clientInfo.id}: ${result.reason?.message}`);
+      continue;
+    }
+    if (!result.value) continue;
+
+    const { prodId, consumerObj } = result.value;
+    const consumerId = uuidv4();
+    addChannelConsumer(channel, consumerId, {
+      transport: clientInfo.transport,
+      consumer: consumerObj,
+      clientId: clientInfo.id,
+      displayName: clientInfo.displayName,
+      producerId: prodId
+    });
 
-    connection.on('message', async (message) => {
-      let payload;
-      try {
-        payload = JSON.parse(message.toString());
-      } catch (e) {
-        fastify.log.error('Invalid JSON', e);
-        return;
+    consumersData.push({
+      id: consumerId,
+      producerId: prodId,
+      kind: consumerObj.kind,
+      rtpParameters: consumerObj.rtpParameters,
+      paused: consumerObj.paused
+    });
+  }
+
+  // Join latency only counts listeners served right away, not ones waiting for a publisher
+  if (clientInfo.joinStartedAt != null && consumersData.length > 0) {
+    metrics.listenerJoinSeconds.observe((performance.now() - clientInfo.joinStartedAt) / 1000);
+  }
+  clientInfo.joinStartedAt = null;
+  return consumersData;
+}
+
+async function handleGetRtpCapabilities({ connection }) {
+  sendMessage(connection, {
+    action: 'rtpCapabilities',
+    data: workerPool.rtpCapabilities
+  });
+}
+
+async function handleGetChannels({ connection }) {
+  sendMessage(connection, {
+    action: 'channel-list',
+    data: Array.from(channels.keys())
+  });
+}
+
+async function handleAdminCreateChannel({ connection, clientInfo }, data) {
+  if (!data.channelId || typeof data.channelId !== 'string') {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Invalid channel ID' }
+    });
+    return;
+  }
+
+  // Create new channel
+  if (!ensureChannel(data.channelId)) {
+    sendChannelLimitError(connection);
+    return;
+  }
+
+  clientInfo.isAdmin = true;
+  sendMessage(connection, {
+    action: 'channel-created',
+    data: { channelId: data.channelId }
+  });
+
+  // Broadcast updated channel list
+  broadcastChannelList();
+}
+
+async function handleAdminDeleteChannel({ fastify, connection, clientId, clientInfo }, data) {
+  if (!data.channelId || !channels.has(data.channelId)) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Channel does not exist' }
+    });
+    return;
+  }
+
+  const channel = channels.get(data.channelId);
+
+  // Close all producer transports
+  for (const [prodId, prodInfo] of channel.producers) {
+    if (prodInfo.transport) {
+      prodInfo.transport.close();
+    }
+    if (prodInfo.producer) {
+      prodInfo.producer.close();
+    }
+  }
+
+  // Close all consumer transports
+  for (const [consumerId, consumer] of channel.consumers) {
+    if (consumer.transport) {
+      consumer.transport.close();
+    }
+
+    // Notify listener about forced disconnect
+    if (consumer.clientId && clients.has(consumer.clientId)) {
+      const listenerClient = clients.get(consumer.clientId);
+      // In newer versions of fastify-websocket, the connection is the socket
+      sendMessage(listenerClient.socket, {
+        action: 'forced-disconnect',
+        data: { reason: 'Channel deleted by admin' }
+      });
+    }
+  }
+
+  // Remove channel
+  channels.delete(data.channelId);
+
+  clientInfo.isAdmin = true;
+  sendMessage(connection, {
+    action: 'channel-deleted',
+    data: { channelId: data.channelId }
+  });
+
+  // Broadcast updated channel list
+  broadcastChannelList();
+}
+
+async function handleAdminGetChannelsSubscribers({ connection, clientInfo }) {
+  const channelsData = {};
+
+  for (const [channelId, channel] of channels.entries()) {
+    channelsData[channelId] = Array.from(channel.consumers.entries()).map(([id, consumer]) => ({
+      id,
+      name: consumer.displayName
+    }));
+  }
+
+  clientInfo.isAdmin = true;
+  sendMessage(connection, {
+    action: 'channels-subscribers',
+    data: channelsData
+  });
+}
+
+async function handleAdminRemoveSubscriber({ fastify, connection, clientId, clientInfo }, data) {
+  if (!data.channelId || !data.consumerId ||
+    !channels.has(data.channelId) ||
+    !channels.get(data.channelId).consumers.has(data.consumerId)) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Invalid channel or consumer ID' }
+    });
+    return;
+  }
+
+  const targetChannel = channels.get(data.channelId);
+  const consumer = targetChannel.consumers.get(data.consumerId);
+
+  // Close consumer transport
+  if (consumer.transport) {
+    consumer.transport.close();
+  }
+
+  // Notify listener about forced disconnect
+  if (consumer.clientId && clients.has(consumer.clientId)) {
+    const listenerClient = clients.get(consumer.clientId);
+    // In newer versions of fastify-websocket, the connection is the socket directly
+    sendMessage(listenerClient.socket, {
+      action: 'forced-disconnect',
+      data: { reason: 'Removed by admin' }
+    });
+  }
+
+  // Remove consumer from channel
+  removeChannelConsumer(targetChannel, data.consumerId);
+
+  clientInfo.isAdmin = true;
+  sendMessage(connection, {
+    action: 'subscriber-removed',
+    data: {
+      channelId: data.channelId,
+      consumerId: data.consumerId
+    }
+  });
+}
+
+async function handleAdminGetPublishers({ connection, clientInfo }) {
+  const publishers = [];
+  for (const [id, c] of clients.entries()) {
+    if (c.isPublisher) {
+      publishers.push({ id, channelId: c.channelId });
+    }
+  }
+
+  clientInfo.isAdmin = true;
+  sendMessage(connection, {
+    action: 'publishers-list',
+    data: publishers
+  });
+}
+
+async function handleAdminChangePublisherChannel({ connection, clientId }, data) {
+  if (!data.publisherId || !data.newChannelId ||
+    !clients.has(data.publisherId) ||
+    !channels.has(data.newChannelId)) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Invalid publisher or channel ID' }
+    });
+    return;
+  }
+
+  const publisherClient = clients.get(data.publisherId);
+  if (!publisherClient.isPublisher) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Target client is not a publisher' }
+    });
+    return;
+  }
+
+  if (publisherClient.channelId === data.newChannelId) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Publisher already in that channel' }
+    });
+    return;
+  }
+
+  const oldChannelId = publisherClient.channelId;
+  const oldChannel = channels.get(oldChannelId);
+  const newChannel = channels.get(data.newChannelId);
+
+  if (publisherClient.producer) {
+    const { id: prodId, producer } = publisherClient.producer;
+
+    // Remove consumers of this producer from old channel
+    for (const [consumerId, consumer] of oldChannel.consumers) {
+      if (consumer.producerId === prodId) {
+        if (consumer.consumer) consumer.consumer.close();
+        removeChannelConsumer(oldChannel, consumerId);
+
+        if (consumer.clientId && clients.has(consumer.clientId)) {
+          const listener = clients.get(consumer.clientId);
+          sendMessage(listener.socket, { action: 'producer-stopped', data: { producerId: prodId } });
+        }
       }
+    }
 
-      const { action, data } = payload;
-      fastify.log.info(`Received action: ${action} from ${clientId}`);
-
-      switch (action) {
-        case 'get-rtpCapabilities':
-          connection.send(JSON.stringify({
-            action: 'rtpCapabilities',
-            data: router.rtpCapabilities
-          }));
-          break;
-
-        case 'get-channels':
-          connection.send(JSON.stringify({
-            action: 'channel-list',
-            data: Array.from(channels.keys())
-          }));
-          break;
-
-        case 'admin-create-channel':
-          if (!data.channelId || typeof data.channelId !== 'string') {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Invalid channel ID' }
-            }));
-            break;
-          }
+    // Move producer map entry
+    const movedProducerInfo = oldChannel.producers.get(prodId) || {
+      transport: publisherClient.transport,
+      producer,
+      router: publisherClient.router,
+      clientId: data.publisherId
+    };
+    oldChannel.producers.delete(prodId);
+    newChannel.producers.set(prodId, movedProducerInfo);
+    if (relayOrigin) {
+      relayOrigin.removeProducer(oldChannelId, prodId);
+      relayOrigin.addProducer(data.newChannelId, prodId, movedProducerInfo);
+    }
 
-          // Create new channel
-          channels.set(data.channelId, {
-            producers: new Map(),
-            consumers: new Map()
+    // Create consumers for listeners in the new channel
+    const { ignoreDtx } = getChannelAudioProfile(data.newChannelId);
+    const source = listenerSource(movedProducerInfo);
+    for (const [otherId, otherClient] of clients.entries()) {
+      if (otherClient.isListener && otherClient.channelId === data.newChannelId && otherClient.transport && otherClient.rtpCapabilities) {
+        await workerPool.ensureProducerOnRouter(source, otherClient.router);
+        if (otherClient.router.canConsume({ producerId: source.producer.id, rtpCapabilities: otherClient.rtpCapabilities })) {
+          const endConsumeTimer = metrics.consumeRpcSeconds.startTimer();
+          const newConsumer = await otherClient.transport.consume({ producerId: source.producer.id, rtpCapabilities: otherClient.rtpCapabilities, paused: false, ignoreDtx });
+          endConsumeTimer();
+          const newConsumerId = uuidv4();
+          addChannelConsumer(newChannel, newConsumerId, { transport: otherClient.transport, consumer: newConsumer, clientId: otherId, displayName: otherClient.displayName, producerId: prodId });
+
+          sendMessage(otherClient.socket, {
+            action: 'consumer-created',
+            data: [{ id: newConsumerId, producerId: prodId, kind: newConsumer.kind, rtpParameters: newConsumer.rtpParameters }]
           });
+        }
+      }
+    }
+  }
 
-          clientInfo.isAdmin = true;
-          connection.send(JSON.stringify({
-            action: 'channel-created',
-            data: { channelId: data.channelId }
-          }));
-
-          // Broadcast updated channel list
-          broadcastChannelList();
-          break;
-
-        case 'admin-delete-channel':
-          if (!data.channelId || !channels.has(data.channelId)) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Channel does not exist' }
-            }));
-            break;
-          }
+  publisherClient.channelId = data.newChannelId;
 
-          const channel = channels.get(data.channelId);
+  sendMessage(connection, {
+    action: 'publisher-channel-changed',
+    data: { publisherId: data.publisherId, newChannelId: data.newChannelId }
+  });
 
-          // Close all producer transports
-          for (const [prodId, prodInfo] of channel.producers) {
-            if (prodInfo.transport) {
-              prodInfo.transport.close();
-            }
-            if (prodInfo.producer) {
-              prodInfo.producer.close();
-            }
-          }
+  if (clients.has(data.publisherId)) {
+    const pubSocket = clients.get(data.publisherId).socket;
+    sendMessage(pubSocket, { action: 'admin-channel-changed', data: { channelId: data.newChannelId } });
+  }
 
-          // Close all consumer transports
-          for (const [consumerId, consumer] of channel.consumers) {
-            if (consumer.transport) {
-              consumer.transport.close();
-            }
+  // Broadcast updated channel list
+  broadcastChannelList();
+}
+
+async function handleCreatePublisherTransport({ fastify, connection, clientInfo }, data) {
+  if (!data.channelId) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Channel ID required' }
+    });
+    return;
+  }
+
+  // Auto-create channel if it doesn't exist
+  if (!channels.has(data.channelId)) {
+    if (!ensureChannel(data.channelId)) {
+      sendChannelLimitError(connection);
+      return;
+    }
+    fastify.log.info(`Auto-created channel: ${data.channelId}`);
+    broadcastChannelList();
+  }
 
-            // Notify listener about forced disconnect
-            if (consumer.clientId && clients.has(consumer.clientId)) {
-              const listenerClient = clients.get(consumer.clientId);
-              // In newer versions of fastify-websocket, the connection is the socket
-              listenerClient.socket.send(JSON.stringify({
-                action: 'forced-disconnect',
-                data: { reason: 'Channel deleted by admin' }
-              }));
+  const publisherChannel = channels.get(data.channelId);
+
+  // Publishers always produce on the channel's home router
+  const { transport, params } = await createWebRtcTransport(publisherChannel.router);
+
+  // Store transport and publisher name (for recording)
+  clientInfo.transport = transport;
+  clientInfo.router = publisherChannel.router;
+  clientInfo.isPublisher = true;
+  clientInfo.channelId = data.channelId;
+  clientInfo.publisherName = data.publisherName || null;
+  clientInfo.publisherId = data.publisherId || null;
+
+
+
+  sendMessage(connection, {
+    action: 'publisher-transport-created',
+    data: params
+  });
+}
+
+async function handleConnectPublisherTransport({ fastify, connection, clientId, clientInfo }, data) {
+  if (!clientInfo.transport || !clientInfo.isPublisher || !clientInfo.channelId) {
+    fastify.log.warn(`Client ${clientId} attempted to connect publisher transport without proper setup`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'No publisher transport created' }
+    });
+    return;
+  }
+
+  try {
+    fastify.log.info(`Connecting publisher transport for client ${clientId}`);
+    await clientInfo.transport.connect({ dtlsParameters: data.dtlsParameters });
+
+    fastify.log.info(`Publisher transport connected successfully for client ${clientId}`);
+    sendMessage(connection, {
+      action: 'publisher-transport-connected',
+      data: { connected: true, transportId: clientInfo.transport.id }
+    });
+  } catch (error) {
+    fastify.log.error(`Error connecting publisher transport: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error connecting transport: ${error.message}` }
+    });
+  }
+}
+
+// Create consumers of one producer for every listener already in the channel
+async function consumeProducerForChannelListeners(channelId, channel, producerId, producerInfo) {
+  const source = listenerSource(producerInfo);
+  const { ignoreDtx } = getChannelAudioProfile(channelId);
+  for (const [otherId, otherClient] of clients) {
+    if (
+      otherClient.isListener &&
+      otherClient.channelId === channelId &&
+      otherClient.transport &&
+      otherClient.rtpCapabilities
+    ) {
+      try {
+        await workerPool.ensureProducerOnRouter(source, otherClient.router);
+        if (
+          otherClient.router.canConsume({
+            producerId: source.producer.id,
+            rtpCapabilities: otherClient.rtpCapabilities
+          })
+        ) {
+          const endConsumeTimer = metrics.consumeRpcSeconds.startTimer();
+          const newConsumer = await otherClient.transport.consume({
+            producerId: source.producer.id,
+            rtpCapabilities: otherClient.rtpCapabilities,
+            paused: false,
+            ignoreDtx
+          });
+          endConsumeTimer();
+          const newConsumerId = uuidv4();
+          addChannelConsumer(channel, newConsumerId, {
+            transport: otherClient.transport,
+            consumer: newConsumer,
+            clientId: otherId,
+            displayName: otherClient.displayName,
+            producerId
+          });
+          sendMessage(otherClient.socket, {
+            action: 'consumer-created',
+            data: {
+              id: newConsumerId,
+              producerId,
+              kind: newConsumer.kind,
+              rtpParameters: newConsumer.rtpParameters
             }
-          }
+          });
+        }
+      } catch (err) {
+        fastify.log.error(
+          `Error creating consumer for listener ${otherId}: ${err.message}`
+        );
+      }
+    }
+  }
+}
 
-          // Remove channel
-          channels.delete(data.channelId);
+// Start a processing stage for a published producer. Listeners consume the raw producer until
+// the stage is ready and are then moved onto its output; on failure the producer stays raw.
+async function startProducerProcessing(producerInfo, mode, producerId) {
+  const channelId = findChannelIdForProducer(producerId, producerInfo);
+  const room = channelId ? findRoomForChannel(channelId) : null;
+  const publisher = producerInfo.publisherId ? getPublisherById(producerInfo.publisherId) : null;
+  const { codecOptions, channelCount } = getClientAudioProfile(room?.audio_profile, publisher || {});
+
+  const processor = new AudioProcessor({
+    router: producerInfo.router,
+    producer: producerInfo.producer,
+    mode,
+    bitrate: codecOptions.opusMaxAverageBitrate,
+    channels: channelCount,
+    log: fastify.log
+  });
+  producerInfo.producer.observer.once('close', () => processor.stop());
+  try {
+    await processor.start();
+  } catch (err) {
+    processor.stop();
+    fastify.log.error(`Audio processing (${mode}) failed to start for producer ${producerId}, serving raw audio: ${err.message}`);
+    return;
+  }
 
-          clientInfo.isAdmin = true;
-          connection.send(JSON.stringify({
-            action: 'channel-deleted',
-            data: { channelId: data.channelId }
-          }));
+  // The producer may have been closed or replaced while the stage started
+  const currentChannelId = findChannelIdForProducer(producerId);
+  const channel = currentChannelId ? channels.get(currentChannelId) : null;
+  if (producerInfo.producer.closed || channel?.producers.get(producerId) !== producerInfo) {
+    processor.stop();
+    return;
+  }
 
-          // Broadcast updated channel list
-          broadcastChannelList();
-          break;
+  producerInfo.processor = processor;
+  producerInfo.processed = { producer: processor.producer, router: producerInfo.router };
+  processor.once('failed', (err) => {
+    fastify.log.error(`Audio processing for producer ${producerId} failed, falling back to raw audio: ${err.message}`);
+    fallbackToRawProducer(producerId).catch((fallbackErr) => {
+      fastify.log.error(`Raw audio fallback failed for producer ${producerId}: ${fallbackErr.message}`);
+    });
+  });
+  fastify.log.info(`Audio processing (${mode}) started for producer ${producerId}`);
 
-        case 'admin-get-channels-subscribers':
-          const channelsData = {};
+  // Listeners that joined while the stage started are on the raw producer
+  removeProducerConsumers(channel, producerId);
+  await consumeProducerForChannelListeners(currentChannelId, channel, producerId, producerInfo);
+  notifyPublishersListenerCount(currentChannelId);
+}
 
-          for (const [channelId, channel] of channels.entries()) {
-            channelsData[channelId] = Array.from(channel.consumers.entries()).map(([id, consumer]) => ({
-              id,
-              name: consumer.displayName
-            }));
-          }
+function findChannelIdForProducer(producerId, producerInfo = null) {
+  for (const [channelId, channel] of channels) {
+    if (channel.producers.has(producerId)) return channelId;
+  }
+  if (producerInfo?.clientId && clients.has(producerInfo.clientId)) {
+    return clients.get(producerInfo.clientId).channelId;
+  }
+  return null;
+}
 
-          clientInfo.isAdmin = true;
-          connection.send(JSON.stringify({
-            action: 'channels-subscribers',
-            data: channelsData
-          }));
-          break;
-
-        case 'admin-remove-subscriber':
-          if (!data.channelId || !data.consumerId ||
-            !channels.has(data.channelId) ||
-            !channels.get(data.channelId).consumers.has(data.consumerId)) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Invalid channel or consumer ID' }
-            }));
-            break;
-          }
+// A processing stage died: move its listeners back onto the raw producer
+async function fallbackToRawProducer(producerId) {
+  const channelId = findChannelIdForProducer(producerId);
+  const channel = channelId ? channels.get(channelId) : null;
+  const producerInfo = channel?.producers.get(producerId);
+  if (!producerInfo?.processed) return;
+
+  producerInfo.processor.stop();
+  producerInfo.processor = null;
+  producerInfo.processed = null;
+  if (producerInfo.producer.closed) return;
+
+  removeProducerConsumers(channel, producerId);
+  await consumeProducerForChannelListeners(channelId, channel, producerId, producerInfo);
+  notifyPublishersListenerCount(channelId);
+}
 
-          const targetChannel = channels.get(data.channelId);
-          const consumer = targetChannel.consumers.get(data.consumerId);
+async function handleProduceAudio({ fastify, connection, clientId, clientInfo }, data) {
+  if (!clientInfo.transport || !clientInfo.isPublisher || !clientInfo.channelId) {
+    fastify.log.warn(`Client ${clientId} attempted to produce audio without proper transport setup`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'No publisher transport connected' }
+    });
+    return;
+  }
 
-          // Close consumer transport
-          if (consumer.transport) {
-            consumer.transport.close();
-          }
+  const processing = data.processing || null;
+  if (processing && (!audioProcessingEnabled || !PROCESSING_MODES.includes(processing))) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Unsupported audio processing mode: ${processing}` }
+    });
+    return;
+  }
 
-          // Notify listener about forced disconnect
-          if (consumer.clientId && clients.has(consumer.clientId)) {
-            const listenerClient = clients.get(consumer.clientId);
-            // In newer versions of fastify-websocket, the connection is the socket directly
-            listenerClient.socket.send(JSON.stringify({
-              action: 'forced-disconnect',
-              data: { reason: 'Removed by admin' }
-            }));
-          }
+  try {
+    fastify.log.info(`Creating audio producer for client ${clientId}`);
 
-          // Remove consumer from channel
-          targetChannel.consumers.delete(data.consumerId);
+    // Create producer
+    const producer = await clientInfo.transport.produce({
+      kind: 'audio',
+      rtpParameters: data.rtpParameters
+    });
 
-          clientInfo.isAdmin = true;
-          connection.send(JSON.stringify({
-            action: 'subscriber-removed',
-            data: {
-              channelId: data.channelId,
-              consumerId: data.consumerId
-            }
-          }));
-          break;
-
-        case 'admin-get-publishers':
-          const publishers = [];
-          for (const [id, c] of clients.entries()) {
-            if (c.isPublisher) {
-              publishers.push({ id, channelId: c.channelId });
-            }
-          }
+    // Set up producer event handlers
+    producer.on('transportclose', () => {
+      fastify.log.info(`Producer transport closed for producer ${producer.id}`);
+      producer.close();
+    });
 
-          clientInfo.isAdmin = true;
-          connection.send(JSON.stringify({
-            action: 'publishers-list',
-            data: publishers
-          }));
-          break;
-
-        case 'admin-change-publisher-channel':
-          if (!data.publisherId || !data.newChannelId ||
-            !clients.has(data.publisherId) ||
-            !channels.has(data.newChannelId)) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Invalid publisher or channel ID' }
-            }));
-            break;
-          }
+    producer.on('score', (score) => {
+      fastify.log.debug(`Producer score update for ${producer.id}:`, score);
+    });
 
-          const publisherClient = clients.get(data.publisherId);
-          if (!publisherClient.isPublisher) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Target client is not a publisher' }
-            }));
-            break;
-          }
+    // Store producer with name for recording
+    const publishChannel = channels.get(clientInfo.channelId);
+    if (!publishChannel) {
+      throw new Error(`Channel ${clientInfo.channelId} does not exist`);
+    }
 
-          if (publisherClient.channelId === data.newChannelId) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Publisher already in that channel' }
-            }));
-            break;
-          }
+    // De-duplicate stale producer(s) from the same publisher identity.
+    // This prevents publisher count inflation on refresh/reconnect.
+    const removedProducers = removeProducersForPublisher(publishChannel, {
+      clientId,
+      publisherId: clientInfo.publisherId
+    });
+    if (removedProducers.length > 0) {
+      fastify.log.info(`Removed ${removedProducers.length} stale producer(s) before creating new producer for client ${clientId}`);
+      await cleanupProducerSideEffects(clientInfo.channelId, removedProducers);
+    }
 
-          const oldChannelId = publisherClient.channelId;
-          const oldChannel = channels.get(oldChannelId);
-          const newChannel = channels.get(data.newChannelId);
+    const producerId = uuidv4();
+    clientInfo.producer = { id: producerId, producer };
+    const producerInfo = {
+      transport: clientInfo.transport,
+      producer,
+      router: clientInfo.router,
+      clientId,
+      publisherId: clientInfo.publisherId,
+      name: clientInfo.publisherName || `producer_${Date.now()}`
+    };
+    publishChannel.producers.set(producerId, producerInfo);
+    if (relayOrigin) relayOrigin.addProducer(clientInfo.channelId, producerId, producerInfo);
 
-          if (publisherClient.producer) {
-            const { id: prodId, producer } = publisherClient.producer;
+    fastify.log.info(`Audio producer created successfully with id ${producer.id}`);
+    sendMessage(connection, {
+      action: 'produced',
+      data: { id: producerId }
+    });
 
-            // Remove consumers of this producer from old channel
-            for (const [consumerId, consumer] of oldChannel.consumers) {
-              if (consumer.producerId === prodId) {
-                if (consumer.consumer) consumer.consumer.close();
-                oldChannel.consumers.delete(consumerId);
+    // Notify all clients that the channel list has changed
+    broadcastChannelList();
 
-                if (consumer.clientId && clients.has(consumer.clientId)) {
-                  const listener = clients.get(consumer.clientId);
-                  listener.consumers = listener.consumers.filter(c => c.id !== consumerId);
-                  listener.socket.send(JSON.stringify({ action: 'producer-stopped', data: { producerId: prodId } }));
-                }
-              }
-            }
+    // Notify tenant admins about the new publisher
+    notifyTenantAdmins(clientInfo.channelId);
 
-            // Move producer map entry
-            oldChannel.producers.delete(prodId);
-            newChannel.producers.set(prodId, { transport: publisherClient.transport, producer, clientId: data.publisherId });
-
-            // Create consumers for listeners in the new channel
-            for (const [otherId, otherClient] of clients.entries()) {
-              if (otherClient.isListener && otherClient.channelId === data.newChannelId && otherClient.transport && otherClient.rtpCapabilities) {
-                if (router.canConsume({ producerId: producer.id, rtpCapabilities: otherClient.rtpCapabilities })) {
-                  const newConsumer = await otherClient.transport.consume({ producerId: producer.id, rtpCapabilities: otherClient.rtpCapabilities, paused: false });
-                  const newConsumerId = uuidv4();
-                  otherClient.consumers.push({ id: newConsumerId, consumer: newConsumer, producerId: prodId });
-                  newChannel.consumers.set(newConsumerId, { transport: otherClient.transport, consumer: newConsumer, clientId: otherId, displayName: otherClient.displayName, producerId: prodId });
-
-                  otherClient.socket.send(JSON.stringify({
-                    action: 'consumer-created',
-                    data: [{ id: newConsumerId, producerId: prodId, kind: newConsumer.kind, rtpParameters: newConsumer.rtpParameters }]
-                  }));
-                }
-              }
-            }
+    // Check if recording is active for this room and add producer if so
+    const channelParts = clientInfo.channelId.split(':');
+    if (channelParts.length >= 2) {
+      const roomSlug = channelParts[0];
+      const channelName = channelParts.slice(1).join(':');
+      const room = getRoomBySlug(roomSlug);
+      if (room && isRecording(room.id)) {
+        try {
+          const trackInfo = await addProducerToRecording(room.id, producerId, channelName, producerInfo);
+          if (transcriptionRuntime && trackInfo && transcriptionRuntime.getRoomSession(room.id)) {
+            await transcriptionRuntime.registerProducerStream(room.id, trackInfo);
           }
+          fastify.log.info(`Added producer ${producerId} to active recording for room ${roomSlug}`);
+        } catch (err) {
+          fastify.log.error(`Failed to add producer to recording: ${err.message}`);
+        }
+      }
 
-          publisherClient.channelId = data.newChannelId;
-
-          connection.send(JSON.stringify({
-            action: 'publisher-channel-changed',
-            data: { publisherId: data.publisherId, newChannelId: data.newChannelId }
-          }));
-
-          if (clients.has(data.publisherId)) {
-            const pubSocket = clients.get(data.publisherId).socket;
-            pubSocket.send(JSON.stringify({ action: 'admin-channel-changed', data: { channelId: data.newChannelId } }));
-          }
+    }
 
-          // Broadcast updated channel list
-          broadcastChannelList();
-          break;
-
-        case 'create-publisher-transport':
-          if (!data.channelId) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Channel ID required' }
-            }));
-            break;
-          }
+    // Create consumers for existing listeners in the same channel
+    await consumeProducerForChannelListeners(clientInfo.channelId, publishChannel, producerId, producerInfo);
 
-          // Auto-create channel if it doesn't exist
-          if (!channels.has(data.channelId)) {
-            channels.set(data.channelId, {
-              producers: new Map(),
-              consumers: new Map()
-            });
-            fastify.log.info(`Auto-created channel: ${data.channelId}`);
-            broadcastChannelList();
-          }
+    // Send listener count after consumers are created for existing listeners
+    notifyPublishersListenerCount(clientInfo.channelId);
 
-          const publisherChannel = channels.get(data.channelId);
+    if (processing) {
+      // Listeners move to the processed producer once it is up; recording and edge relays keep
+      // the raw one. Started after the reply so a slow ffmpeg start does not hold up `produced`.
+      startProducerProcessing(producerInfo, processing, producerId).catch((err) => {
+        fastify.log.error(`Audio processing (${processing}) failed for producer ${producerId}: ${err.message}`);
+      });
+    }
+  } catch (error) {
+    fastify.log.error(`Error creating producer: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error creating producer: ${error.message}` }
+    });
+  }
+}
 
-          // Create transport
-          const { transport, params } = await createWebRtcTransport();
+async function handleCreateListenerTransport({ fastify, connection, clientId, clientInfo }, data) {
+  if (!data.channelId) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Channel ID required' }
+    });
+    return;
+  }
 
-          // Store transport and publisher name (for recording)
-          clientInfo.transport = transport;
-          clientInfo.isPublisher = true;
-          clientInfo.channelId = data.channelId;
-          clientInfo.publisherName = data.publisherName || null;
-          clientInfo.publisherId = data.publisherId || null;
+  // Auto-create channel if it doesn't exist (listener will wait for publisher)
+  if (!channels.has(data.channelId)) {
+    if (!ensureChannel(data.channelId)) {
+      sendChannelLimitError(connection);
+      return;
+    }
+    fastify.log.info(`Auto-created channel for listener: ${data.channelId}`);
+    broadcastChannelList();
+  }
 
+  const listenerChannel = channels.get(data.channelId);
 
+  try {
+    // Create transport on the channel's home router, or spill onto another worker when busy
+    if (clientInfo.isListener && clientInfo.router && channels.has(clientInfo.channelId)) {
+      removeChannelListenerRouter(channels.get(clientInfo.channelId), clientInfo.router);
+    }
+    const listenerRouter = workerPool.pickListenerRouter(listenerChannel);
+    clientInfo.joinStartedAt = performance.now();
+    const listenerTransport = await createWebRtcTransport(listenerRouter);
+    addChannelListenerRouter(listenerChannel, listenerRouter);
+
+    // Store transport
+    clientInfo.transport = listenerTransport.transport;
+    clientInfo.router = listenerRouter;
+    clientInfo.isListener = true;
+    clientInfo.channelId = data.channelId;
+    clientInfo.displayName = data.displayName || 'Anonymous';
+
+    fastify.log.debug({ clientId, transportId: listenerTransport.transport.id }, 'Listener transport created');
+    sendMessage(connection, {
+      action: 'listener-transport-created',
+      data: listenerTransport.params
+    });
+  } catch (error) {
+    fastify.log.error(`Error creating listener transport: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error creating listener transport: ${error.message}` }
+    });
+  }
+}
 
-          connection.send(JSON.stringify({
-            action: 'publisher-transport-created',
-            data: params
-          }));
-          break;
+async function handleConnectListenerTransport({ fastify, connection, clientId, clientInfo }, data) {
+  if (!clientInfo.transport || !clientInfo.isListener || !clientInfo.channelId) {
+    fastify.log.warn(`Client ${clientId} attempted to connect listener transport without proper setup`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'No listener transport created' }
+    });
+    return;
+  }
 
-        case 'connect-publisher-transport':
-          if (!clientInfo.transport || !clientInfo.isPublisher || !clientInfo.channelId) {
-            fastify.log.warn(`Client ${clientId} attempted to connect publisher transport without proper setup`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'No publisher transport created' }
-            }));
-            break;
-          }
+  try {
+    await clientInfo.transport.connect({ dtlsParameters: data.dtlsParameters });
+    fastify.log.debug({ clientId }, 'Listener transport connected');
+    sendMessage(connection, {
+      action: 'listener-transport-connected',
+      data: {
+        connected: true,
+        channelId: clientInfo.channelId,
+        transportId: clientInfo.transport.id
+      }
+    });
+  } catch (error) {
+    fastify.log.error(`Error connecting listener transport: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error connecting transport: ${error.message}` }
+    });
+  }
+}
 
-          try {
-            fastify.log.info(`Connecting publisher transport for client ${clientId}`);
-            await clientInfo.transport.connect({ dtlsParameters: data.dtlsParameters });
-
-            fastify.log.info(`Publisher transport connected successfully for client ${clientId}`);
-            connection.send(JSON.stringify({
-              action: 'publisher-transport-connected',
-              data: { connected: true, transportId: clientInfo.transport.id }
-            }));
-          } catch (error) {
-            fastify.log.error(`Error connecting publisher transport: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error connecting transport: ${error.message}` }
-            }));
-          }
-          break;
-
-        case 'produce-audio':
-          if (!clientInfo.transport || !clientInfo.isPublisher || !clientInfo.channelId) {
-            fastify.log.warn(`Client ${clientId} attempted to produce audio without proper transport setup`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'No publisher transport connected' }
-            }));
-            break;
-          }
+async function handleConsumeAudio({ fastify, connection, clientId, clientInfo }, data) {
+  if (!clientInfo.transport || !clientInfo.isListener || !clientInfo.channelId) {
+    fastify.log.warn(`Client ${clientId} has no valid transport or is not a listener`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'No listener transport connected' }
+    });
+    return;
+  }
 
-          try {
-            fastify.log.info(`Creating audio producer for client ${clientId}`);
-
-            // Create producer
-            const producer = await clientInfo.transport.produce({
-              kind: 'audio',
-              rtpParameters: data.rtpParameters
-            });
-
-            // Set up producer event handlers
-            producer.on('transportclose', () => {
-              fastify.log.info(`Producer transport closed for producer ${producer.id}`);
-              producer.close();
-            });
-
-            producer.on('score', (score) => {
-              fastify.log.debug(`Producer score update for ${producer.id}:`, score);
-            });
-
-            // Store producer with name for recording
-            const publishChannel = channels.get(clientInfo.channelId);
-            if (!publishChannel) {
-              throw new Error(`Channel ${clientInfo.channelId} does not exist`);
-            }
+  const consumerChannel = channels.get(clientInfo.channelId);
 
-            // De-duplicate stale producer(s) from the same publisher identity.
-            // This prevents publisher count inflation on refresh/reconnect.
-            const removedProducers = removeProducersForPublisher(publishChannel, {
-              clientId,
-              publisherId: clientInfo.publisherId
-            });
-            if (removedProducers.length > 0) {
-              fastify.log.info(`Removed ${removedProducers.length} stale producer(s) before creating new producer for client ${clientId}`);
-              await cleanupProducerSideEffects(clientInfo.channelId, removedProducers);
-            }
+  if (!consumerChannel) {
+    fastify.log.warn(`Channel ${clientInfo.channelId} no longer exists`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Channel no longer exists' }
+    });
+    return;
+  }
 
-            const producerId = uuidv4();
-            clientInfo.producer = { id: producerId, producer };
-            const producerInfo = {
-              transport: clientInfo.transport,
-              producer,
-              clientId,
-              publisherId: clientInfo.publisherId,
-              name: clientInfo.publisherName || `producer_${Date.now()}`
-            };
-            publishChannel.producers.set(producerId, producerInfo);
-
-            fastify.log.info(`Audio producer created successfully with id ${producer.id}`);
-            connection.send(JSON.stringify({
-              action: 'produced',
-              data: { id: producerId }
-            }));
-
-            // Notify all clients that the channel list has changed
-            broadcastChannelList();
-
-            // Notify tenant admins about the new publisher
-            notifyTenantAdmins(clientInfo.channelId);
-
-            // Check if recording is active for this room and add producer if so
-            const channelParts = clientInfo.channelId.split(':');
-            if (channelParts.length >= 2) {
-              const roomSlug = channelParts[0];
-              const channelName = channelParts.slice(1).join(':');
-              const room = getRoomBySlug(roomSlug);
-              if (room && isRecording(room.id)) {
-                try {
-                  const trackInfo = await addProducerToRecording(room.id, producerId, channelName, producerInfo);
-                  if (transcriptionRuntime && trackInfo && transcriptionRuntime.getRoomSession(room.id)) {
-                    await transcriptionRuntime.registerProducerStream(room.id, trackInfo);
-                  }
-                  fastify.log.info(`Added producer ${producerId} to active recording for room ${roomSlug}`);
-                } catch (err) {
-                  fastify.log.error(`Failed to add producer to recording: ${err.message}`);
-                }
-              }
+  if (consumerChannel.producers.size === 0) {
+    fastify.log.debug({ clientId, channelId: clientInfo.channelId }, 'Listener waiting for publisher');
+    clientInfo.rtpCapabilities = data.rtpCapabilities;
+    sendMessage(connection, { action: 'waiting-for-publisher' });
+    return;
+  }
 
-            }
+  try {
+    clientInfo.rtpCapabilities = data.rtpCapabilities;
+    const consumersData = await consumeChannelProducers(clientInfo, consumerChannel, data.rtpCapabilities);
 
-            // Create consumers for existing listeners in the same channel
-            for (const [otherId, otherClient] of clients) {
-              if (
-                otherClient.isListener &&
-                otherClient.channelId === clientInfo.channelId &&
-                otherClient.transport &&
-                otherClient.rtpCapabilities
-              ) {
-                try {
-                  if (
-                    router.canConsume({
-                      producerId: producer.id,
-                      rtpCapabilities: otherClient.rtpCapabilities
-                    })
-                  ) {
-                    const newConsumer = await otherClient.transport.consume({
-                      producerId: producer.id,
-                      rtpCapabilities: otherClient.rtpCapabilities,
-                      paused: false
-                    });
-                    const newConsumerId = uuidv4();
-                    otherClient.consumers.push({
-                      id: newConsumerId,
-                      consumer: newConsumer,
-                      producerId
-                    });
-                    publishChannel.consumers.set(newConsumerId, {
-                      transport: otherClient.transport,
-                      consumer: newConsumer,
-                      clientId: otherId,
-                      displayName: otherClient.displayName,
-                      producerId
-                    });
-                    otherClient.socket.send(
-                      JSON.stringify({
-                        action: 'consumer-created',
-                        data: {
-                          id: newConsumerId,
-                          producerId,
-                          kind: newConsumer.kind,
-                          rtpParameters: newConsumer.rtpParameters
-                        }
-                      })
-                    );
-                  }
-                } catch (err) {
-                  fastify.log.error(
-                    `Error creating consumer for listener ${otherId}: ${err.message}`
-                  );
-                }
-              }
-            }
+    sendMessage(connection, {
+      action: 'consumer-created',
+      data: consumersData
+    });
+    fastify.log.debug({ clientId, consumers: consumersData.length }, 'Listener consumers created');
 
-            // Send listener count after consumers are created for existing listeners
-            notifyPublishersListenerCount(clientInfo.channelId);
-          } catch (error) {
-            fastify.log.error(`Error creating producer: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error creating producer: ${error.message}` }
-            }));
-          }
-          break;
+    // Notify tenant admins about the new subscriber
+    if (consumersData.length > 0) {
+      notifyTenantAdmins(clientInfo.channelId);
+      notifyPublishersListenerCount(clientInfo.channelId);
+    }
+  } catch (error) {
+    fastify.log.error(`Error creating consumer for client ${clientId}: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error creating consumer: ${error.message}` }
+    });
+  }
+}
 
-        case 'create-listener-transport':
-          fastify.log.info(`Client ${clientId} requesting listener transport for channel ${data.channelId}`);
+async function handleJoinListener({ fastify, connection, clientId, clientInfo }, data) {
+  // Single round trip join: create transport + consume every producer, reply once.
+  // The client still sends 'connect-listener-transport' from its transport 'connect' event.
+  if (!data?.channelId || !data.rtpCapabilities) {
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: 'Channel ID and RTP capabilities required' }
+    });
+    return;
+  }
 
-          if (!data.channelId) {
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Channel ID required' }
-            }));
-            break;
-          }
+  if (!channels.has(data.channelId)) {
+    if (!ensureChannel(data.channelId)) {
+      sendChannelLimitError(connection);
+      return;
+    }
+    fastify.log.info(`Auto-created channel for listener: ${data.channelId}`);
+    broadcastChannelList();
+  }
 
-          // Auto-create channel if it doesn't exist (listener will wait for publisher)
-          if (!channels.has(data.channelId)) {
-            channels.set(data.channelId, {
-              producers: new Map(),
-              consumers: new Map()
-            });
-            fastify.log.info(`Auto-created channel for listener: ${data.channelId}`);
-            broadcastChannelList();
-          }
+  try {
+    const joinChannel = channels.get(data.channelId);
+    if (clientInfo.isListener) {
+      // Re-join on the same socket: tear the previous join down as leave-channel does
+      const previousChannelId = clientInfo.channelId;
+      releaseListener(channels.get(previousChannelId) || null, clientInfo);
+      if (channels.has(previousChannelId)) {
+        notifyTenantAdmins(previousChannelId);
+        notifyPublishersListenerCount(previousChannelId);
+      }
+    }
+    const joinRouter = workerPool.pickListenerRouter(joinChannel);
+    const joinStartedAt = performance.now();
+    clientInfo.joinStartedAt = joinStartedAt;
+    const joinTransport = await createWebRtcTransport(joinRouter);
+    if (clientInfo.joinStartedAt !== joinStartedAt) {
+      // A later join on this socket superseded this one while the transport was created
+      joinTransport.transport.close();
+      return;
+    }
+    addChannelListenerRouter(joinChannel, joinRouter);
 
-          const listenerChannel = channels.get(data.channelId);
-
-          try {
-            // Create transport
-            fastify.log.info(`Creating listener transport for client ${clientId}`);
-            const listenerTransport = await createWebRtcTransport();
-
-            // Store transport
-            clientInfo.transport = listenerTransport.transport;
-            clientInfo.isListener = true;
-            clientInfo.channelId = data.channelId;
-            clientInfo.displayName = data.displayName || 'Anonymous';
-
-            fastify.log.info(`Listener transport created for client ${clientId} with id ${listenerTransport.transport.id}`);
-            connection.send(JSON.stringify({
-              action: 'listener-transport-created',
-              data: listenerTransport.params
-            }));
-          } catch (error) {
-            fastify.log.error(`Error creating listener transport: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error creating listener transport: ${error.message}` }
-            }));
-          }
-          break;
-
-        case 'connect-listener-transport':
-          if (!clientInfo.transport || !clientInfo.isListener || !clientInfo.channelId) {
-            fastify.log.warn(`Client ${clientId} attempted to connect listener transport without proper setup`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'No listener transport created' }
-            }));
-            break;
-          }
+    clientInfo.transport = joinTransport.transport;
+    clientInfo.router = joinRouter;
+    clientInfo.isListener = true;
+    clientInfo.channelId = data.channelId;
+    clientInfo.displayName = data.displayName || 'Anonymous';
+    clientInfo.rtpCapabilities = data.rtpCapabilities;
 
-          try {
-            fastify.log.info(`Connecting listener transport for client ${clientId}`);
-            await clientInfo.transport.connect({ dtlsParameters: data.dtlsParameters });
-
-            fastify.log.info(`Listener transport connected successfully for client ${clientId}`);
-            connection.send(JSON.stringify({
-              action: 'listener-transport-connected',
-              data: {
-                connected: true,
-                channelId: clientInfo.channelId,
-                transportId: clientInfo.transport.id
-              }
-            }));
-          } catch (error) {
-            fastify.log.error(`Error connecting listener transport: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error connecting transport: ${error.message}` }
-            }));
-          }
-          break;
-
-        case 'consume-audio':
-          fastify.log.info(`Consume audio request from client ${clientId}`);
-
-          if (!clientInfo.transport || !clientInfo.isListener || !clientInfo.channelId) {
-            fastify.log.warn(`Client ${clientId} has no valid transport or is not a listener`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'No listener transport connected' }
-            }));
-            break;
-          }
+    const joinConsumers = await consumeChannelProducers(clientInfo, joinChannel, data.rtpCapabilities, {
+      paused: data.paused === true
+    });
 
-          const consumerChannel = channels.get(clientInfo.channelId);
-          fastify.log.info(`Client ${clientId} requesting to consume from channel ${clientInfo.channelId}`);
+    sendMessage(connection, {
+      action: 'listener-joined',
+      data: {
+        channelId: data.channelId,
+        transport: joinTransport.params,
+        consumers: joinConsumers,
+        waitingForPublisher: joinConsumers.length === 0
+      }
+    });
+    fastify.log.debug({ clientId, channelId: data.channelId, consumers: joinConsumers.length }, 'Listener joined');
 
-          if (!consumerChannel) {
-            fastify.log.warn(`Channel ${clientInfo.channelId} no longer exists`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: 'Channel no longer exists' }
-            }));
-            break;
-          }
+    if (joinConsumers.length > 0) {
+      notifyTenantAdmins(clientInfo.channelId);
+      notifyPublishersListenerCount(clientInfo.channelId);
+    }
+  } catch (error) {
+    fastify.log.error(`Error joining listener ${clientId}: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error joining channel: ${error.message}` }
+    });
+  }
+}
 
-          if (consumerChannel.producers.size === 0) {
-            fastify.log.info(`Listener ${clientId} waiting for publisher in channel ${clientInfo.channelId}`);
-            clientInfo.rtpCapabilities = data.rtpCapabilities;
-            connection.send(JSON.stringify({ action: 'waiting-for-publisher' }));
-            break;
-          }
+async function handleResumeConsumers({ connection, clientInfo }, data) {
+  // Resume paused consumers as one batch; all of them when no ids are given
+  const ids = Array.isArray(data?.consumerIds) ? new Set(data.consumerIds) : clientInfo.consumers.keys();
+  const toResume = [];
+  for (const id of ids) {
+    const entry = clientInfo.consumers.get(id);
+    if (entry?.consumer && !entry.consumer.closed && entry.consumer.paused) toResume.push([id, entry.consumer]);
+  }
+  const resumeResults = await Promise.allSettled(toResume.map(([, consumer]) => consumer.resume()));
+  const resumedIds = toResume
+    .filter((c, index) => resumeResults[index].status === 'fulfilled')
+    .map(([id]) => id);
+  sendMessage(connection, {
+    action: 'consumers-resumed',
+    data: { consumerIds: resumedIds }
+  });
+}
 
-          try {
-            clientInfo.rtpCapabilities = data.rtpCapabilities;
-            const consumersData = [];
+async function handleStopBroadcasting({ fastify, connection, clientId, clientInfo }, data) {
+  fastify.log.info(`Client ${clientId} stopping broadcasting in channel ${data.channelId}`);
 
-            for (const [prodId, prodInfo] of consumerChannel.producers) {
-              if (prodInfo.producer.closed) continue;
+  if (!data.channelId || !channels.has(data.channelId)) {
+    fastify.log.warn(`Channel ${data.channelId} does not exist`);
+    return;
+  }
 
-              if (!router.canConsume({ producerId: prodInfo.producer.id, rtpCapabilities: data.rtpCapabilities })) {
-                fastify.log.warn(`Client ${clientId} cannot consume producer ${prodId} due to RTP capabilities mismatch`);
-                continue;
-              }
+  const stopBroadcastChannel = channels.get(data.channelId);
 
-              const consumerObj = await clientInfo.transport.consume({
-                producerId: prodInfo.producer.id,
-                rtpCapabilities: data.rtpCapabilities,
-                paused: false
-              });
+  try {
+    fastify.log.info(`Cleaning up publisher resources for channel ${data.channelId}`);
 
-              const consumerId = uuidv4();
-              clientInfo.consumers.push({ id: consumerId, consumer: consumerObj, producerId: prodId });
-              consumerChannel.consumers.set(consumerId, {
-                transport: clientInfo.transport,
-                consumer: consumerObj,
-                clientId,
-                displayName: clientInfo.displayName,
-                producerId: prodId
-              });
+    if (clientInfo.isPublisher && clientInfo.producer) {
+      const { id: prodId, producer } = clientInfo.producer;
+      if (producer) {
+        try {
+          producer.close();
+        } catch (error) {
+          fastify.log.error(`Error closing producer: ${error.message}`);
+        }
+      }
 
-              consumersData.push({
-                id: consumerId,
-                producerId: prodId,
-                kind: consumerObj.kind,
-                rtpParameters: consumerObj.rtpParameters
-              });
-            }
+      if (clientInfo.transport) {
+        try {
+          clientInfo.transport.close();
+        } catch { }
+      }
 
-            connection.send(JSON.stringify({
-              action: 'consumer-created',
-              data: consumersData
-            }));
-            fastify.log.info(`Created ${consumersData.length} consumers for listener ${clientId}`);
+      stopBroadcastChannel.producers.delete(prodId);
 
-            // Notify tenant admins about the new subscriber
-            if (consumersData.length > 0) {
-              notifyTenantAdmins(clientInfo.channelId);
-              notifyPublishersListenerCount(clientInfo.channelId);
-            }
-          } catch (error) {
-            fastify.log.error(`Error creating consumer for client ${clientId}: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error creating consumer: ${error.message}` }
-            }));
+      // Stop recording for this producer if recording is active
+      const stopChannelParts = data.channelId.split(':');
+      if (stopChannelParts.length >= 2) {
+        const stopRoomSlug = stopChannelParts[0];
+        const stopRoom = getRoomBySlug(stopRoomSlug);
+        if (stopRoom && isRecording(stopRoom.id)) {
+          removeProducerFromRecording(stopRoom.id, prodId).catch(err => {
+            fastify.log.error(`Failed to remove producer from recording: ${err.message}`);
+          });
+          if (transcriptionRuntime && transcriptionRuntime.getRoomSession(stopRoom.id)) {
+            transcriptionRuntime.unregisterProducerStream(stopRoom.id, prodId);
           }
-          break;
-
-        case 'stop-broadcasting':
-          fastify.log.info(`Client ${clientId} stopping broadcasting in channel ${data.channelId}`);
+        }
+      }
 
-          if (!data.channelId || !channels.has(data.channelId)) {
-            fastify.log.warn(`Channel ${data.channelId} does not exist`);
-            break;
+      // Remove related consumers
+      for (const [consumerId, consumer] of stopBroadcastChannel.consumers) {
+        if (consumer.producerId === prodId) {
+          if (consumer.consumer) consumer.consumer.close();
+          removeChannelConsumer(stopBroadcastChannel, consumerId);
+          if (consumer.clientId && clients.has(consumer.clientId)) {
+            const listenerClient = clients.get(consumer.clientId);
+            sendMessage(listenerClient.socket, { action: 'producer-stopped', data: { producerId: prodId } });
           }
+        }
+      }
 
-          const stopBroadcastChannel = channels.get(data.channelId);
+      clientInfo.isPublisher = false;
+      clientInfo.producer = null;
+      clientInfo.transport = null;
+    }
 
-          try {
-            fastify.log.info(`Cleaning up publisher resources for channel ${data.channelId}`);
+    // Notify all clients that the channel list has changed
+    broadcastChannelList();
 
-            if (clientInfo.isPublisher && clientInfo.producer) {
-              const { id: prodId, producer } = clientInfo.producer;
-              if (producer) {
-                try {
-                  producer.close();
-                } catch (error) {
-                  fastify.log.error(`Error closing producer: ${error.message}`);
-                }
-              }
+    // Notify tenant admins about the publisher leaving
+    notifyTenantAdmins(data.channelId);
 
-              if (clientInfo.transport) {
-                try {
-                  clientInfo.transport.close();
-                } catch { }
-              }
+    // Send confirmation to the client
+    sendMessage(connection, {
+      action: 'broadcasting-stopped',
+      data: { channelId: data.channelId }
+    });
 
-              stopBroadcastChannel.producers.delete(prodId);
-
-              // Stop recording for this producer if recording is active
-              const stopChannelParts = data.channelId.split(':');
-              if (stopChannelParts.length >= 2) {
-                const stopRoomSlug = stopChannelParts[0];
-                const stopRoom = getRoomBySlug(stopRoomSlug);
-                if (stopRoom && isRecording(stopRoom.id)) {
-                  removeProducerFromRecording(stopRoom.id, prodId).catch(err => {
-                    fastify.log.error(`Failed to remove producer from recording: ${err.message}`);
-                  });
-                  if (transcriptionRuntime && transcriptionRuntime.getRoomSession(stopRoom.id)) {
-                    transcriptionRuntime.unregisterProducerStream(stopRoom.id, prodId);
-                  }
-                }
-              }
+    fastify.log.info(`Publisher resources cleaned up for channel ${data.channelId}`);
+  } catch (error) {
+    fastify.log.error(`Error cleaning up publisher resources: ${error.message}`);
+    sendMessage(connection, {
+      action: 'error',
+      data: { message: `Error stopping broadcast: ${error.message}` }
+    });
+  }
+}
 
-              // Remove related consumers
-              for (const [consumerId, consumer] of stopBroadcastChannel.consumers) {
-                if (consumer.producerId === prodId) {
-                  if (consumer.consumer) consumer.consumer.close();
-                  stopBroadcastChannel.consumers.delete(consumerId);
-                  if (consumer.clientId && clients.has(consumer.clientId)) {
-                    const listenerClient = clients.get(consumer.clientId);
-                    listenerClient.consumers = listenerClient.consumers.filter(c => c.id !== consumerId);
-                    listenerClient.socket.send(JSON.stringify({ action: 'producer-stopped', data: { producerId: prodId } }));
-                  }
-                }
-              }
+async function handleLeaveChannel({ fastify, clientId, clientInfo }) {
+  if (clientInfo.isListener && clientInfo.channelId && channels.has(clientInfo.channelId)) {
+    const channel = channels.get(clientInfo.channelId);
+    fastify.log.debug({ clientId, channelId: clientInfo.channelId }, 'Listener leaving channel');
 
-              clientInfo.isPublisher = false;
-              clientInfo.producer = null;
-              clientInfo.transport = null;
-            }
+    const channelId = clientInfo.channelId;
+    releaseListener(channel, clientInfo);
 
-            // Notify all clients that the channel list has changed
-            broadcastChannelList();
-
-            // Notify tenant admins about the publisher leaving
-            notifyTenantAdmins(data.channelId);
-
-            // Send confirmation to the client
-            connection.send(JSON.stringify({
-              action: 'broadcasting-stopped',
-              data: { channelId: data.channelId }
-            }));
-
-            fastify.log.info(`Publisher resources cleaned up for channel ${data.channelId}`);
-          } catch (error) {
-            fastify.log.error(`Error cleaning up publisher resources: ${error.message}`);
-            connection.send(JSON.stringify({
-              action: 'error',
-              data: { message: `Error stopping broadcast: ${error.message}` }
-            }));
-          }
-          break;
-
-        case 'leave-channel':
-          fastify.log.info(`Client ${clientId} leaving channel`);
-
-          if (clientInfo.isListener && clientInfo.channelId && channels.has(clientInfo.channelId)) {
-            const channel = channels.get(clientInfo.channelId);
-            fastify.log.info(`Removing listener from channel ${clientInfo.channelId}`);
-
-            // Remove all consumers for this listener
-            for (const [consumerId, consumer] of channel.consumers) {
-              if (consumer.clientId === clientId) {
-                if (consumer.consumer) {
-                  try { consumer.consumer.close(); } catch { }
-                }
-                channel.consumers.delete(consumerId);
-              }
-            }
+    // Notify tenant admins about the subscriber leaving
+    notifyTenantAdmins(channelId);
+    notifyPublishersListenerCount(channelId);
+  }
+}
 
-            if (clientInfo.transport) {
-              try { clientInfo.transport.close(); } catch { }
-            }
+// /ws route table. Schemas reject malformed messages before a handler runs; fields the
+// handlers already check themselves stay optional so their error replies are unchanged.
+// Hot routes are the listener join path and skip the per-message debug log.
+const mainWsRoutes = {
+  'get-rtpCapabilities': { hot: true, handler: handleGetRtpCapabilities },
+  'get-channels': { handler: handleGetChannels },
+  'admin-create-channel': { schema: { 'channelId?': 'string' }, handler: handleAdminCreateChannel },
+  'admin-delete-channel': { schema: { 'channelId?': 'string' }, handler: handleAdminDeleteChannel },
+  'admin-get-channels-subscribers': { handler: handleAdminGetChannelsSubscribers },
+  'admin-remove-subscriber': { schema: { 'channelId?': 'string', 'consumerId?': 'string' }, handler: handleAdminRemoveSubscriber },
+  'admin-get-publishers': { handler: handleAdminGetPublishers },
+  'admin-change-publisher-channel': { schema: { 'publisherId?': 'string', 'newChannelId?': 'string' }, handler: handleAdminChangePublisherChannel },
+  'create-publisher-transport': { schema: { 'channelId?': 'string', 'publisherName?': 'string' }, handler: handleCreatePublisherTransport },
+  'connect-publisher-transport': { schema: { dtlsParameters: 'object' }, handler: handleConnectPublisherTransport },
+  'produce-audio': { schema: { rtpParameters: 'object', 'processing?': 'string' }, handler: handleProduceAudio },
+  'create-listener-transport': { hot: true, schema: { 'channelId?': 'string', 'displayName?': 'string' }, handler: handleCreateListenerTransport },
+  'connect-listener-transport': { hot: true, schema: { dtlsParameters: 'object' }, handler: handleConnectListenerTransport },
+  'consume-audio': { hot: true, schema: { rtpCapabilities: 'object' }, handler: handleConsumeAudio },
+  'join-listener': { hot: true, schema: { 'channelId?': 'string', 'rtpCapabilities?': 'object', 'displayName?': 'string', 'paused?': 'boolean' }, handler: handleJoinListener },
+  'resume-consumers': { hot: true, handler: handleResumeConsumers },
+  'stop-broadcasting': { schema: { 'channelId?': 'string' }, handler: handleStopBroadcasting },
+  'leave-channel': { hot: true, handler: handleLeaveChannel }
+};
+
+const dispatchMainWs = createDispatcher(mainWsRoutes, {
+  reply: (ctx, message) => sendMessage(ctx.connection, message)
+});
 
-            clientInfo.consumers = [];
+// WebSocket route handler - extracted as a plugin for reuse
+async function registerMainWsRoutes(fastify) {
+  fastify.get('/ws', { websocket: true }, (connection, req) => {
+    // Live sessions are never evicted; past the limit new connections are turned away
+    if (MAX_SIGNALING_CLIENTS > 0 && clients.size >= MAX_SIGNALING_CLIENTS) {
+      fastify.log.warn(`Rejecting signaling connection: ${clients.size} clients (limit ${MAX_SIGNALING_CLIENTS})`);
+      connection.close(1013, 'Server at capacity');
+      return;
+    }
 
-            // Notify tenant admins about the subscriber leaving
-            notifyTenantAdmins(clientInfo.channelId);
-            notifyPublishersListenerCount(clientInfo.channelId);
+    const clientId = uuidv4();
+    connection.signalingCodec = negotiateCodec(req.query?.codec);
+    fastify.log.debug({ clientId, codec: connection.signalingCodec }, 'New signaling connection');
 
-            // Reset client info
-            clientInfo.isListener = false;
-            clientInfo.channelId = null;
-            clientInfo.transport = null;
-            clientInfo.consumers = [];
-          }
-          break;
+    // Add to clients map
+    const clientInfo = createClientInfo(clientId, connection);
+    clients.set(clientId, clientInfo);
 
-        default:
-          fastify.log.warn('Unknown action', action);
+    // Decoded frames go straight to the route table; see mainWsRoutes
+    const ctx = { fastify, log: fastify.log, connection, clientId, clientInfo };
+    connection.on('message', (message, isBinary) => {
+      let payload;
+      try {
+        payload = decodeFrame(message, isBinary);
+      } catch (e) {
+        fastify.log.warn({ clientId }, `Invalid signaling frame: ${e.message}`);
+        return;
       }
+      dispatchMainWs(ctx, payload);
     });
 
     // Handle WebSocket connection close
     connection.on('close', () => {
-      fastify.log.info(`Connection closed: ${clientId}`);
+      fastify.log.debug({ clientId }, 'Signaling connection closed');
 
       // Clean up resources
       if (clientInfo.transport) {
@@ -1639,10 +2066,9 @@ async function registerMainWsRoutes(fastify) {
               }
               if (consumer.clientId && clients.has(consumer.clientId)) {
                 const listenerClient = clients.get(consumer.clientId);
-                listenerClient.consumers = listenerClient.consumers.filter(c => c.id !== consumerId);
-                listenerClient.socket.send(JSON.stringify({ action: 'producer-stopped', data: { producerId: prodId } }));
+                sendMessage(listenerClient.socket, { action: 'producer-stopped', data: { producerId: prodId } });
               }
-              channel.consumers.delete(consumerId);
+              removeChannelConsumer(channel, consumerId);
             }
           }
         }
@@ -1656,16 +2082,8 @@ async function registerMainWsRoutes(fastify) {
       if (clientInfo.isListener && clientInfo.channelId && channels.has(clientInfo.channelId)) {
         const channel = channels.get(clientInfo.channelId);
 
-        // Remove consumer from channel
-        for (const [consumerId, consumer] of channel.consumers) {
-          if (consumer.clientId === clientId) {
-            if (consumer.consumer) {
-              try { consumer.consumer.close(); } catch { }
-            }
-            channel.consumers.delete(consumerId);
-          }
-        }
-        clientInfo.consumers = [];
+        removeListenerConsumers(channel, clientInfo);
+        removeChannelListenerRouter(channel, clientInfo.router);
 
         // Notify tenant admins about the listener disconnect
         notifyTenantAdmins(clientInfo.channelId);
@@ -1678,12 +2096,77 @@ async function registerMainWsRoutes(fastify) {
   });
 }
 
+const replyToRoomSocket = (ctx, message) => sendMessage(ctx.connection, message);
+
+// /ws/room/:slug/* messages are keyed by `type`. get-config is sent after the client's
+// handlers are ready (fixes iOS Safari timing issue).
+const dispatchRoomListen = createDispatcher({
+  'get-config': {
+    hot: true,
+    handler: ({ log, connection, clientId, slug, config }) => {
+      sendMessage(connection, config);
+      log.debug({ clientId, roomSlug: slug }, 'Config sent to listener');
+    }
+  },
+  // In a full implementation, this would relay to the SFU. For now, we just log it
+  webrtc_signal: {
+    schema: { payload: 'object' },
+    handler: ({ log, clientId }, data) => log.info(`WebRTC signal from listener ${clientId}: ${data.payload.type}`)
+  }
+}, { key: 'type', reply: replyToRoomSocket });
+
+const dispatchRoomPublish = createDispatcher({
+  'get-config': {
+    handler: ({ log, connection, clientId, slug, config, publisher }) => {
+      sendMessage(connection, config);
+      log.info(`Config sent to publisher ${clientId} (${publisher.name}) for room ${slug}, channel: ${publisher.channel_name}`);
+    }
+  },
+  'publisher-chat-history-request': {
+    handler: ({ connection, publisher }) => sendMessage(connection, {
+      type: 'publisher-chat-history',
+      data: {
+        messages: publisherChatHistory.get(publisher.id)
+      }
+    })
+  },
+  'publisher-chat-send': {
+    handler: ({ connection, slug, publisher, room }, data) => {
+      const text = typeof data?.text === 'string' ? data.text.trim() : '';
+      if (!text) return;
+      const chatMessage = {
+        id: uuidv4(),
+        roomSlug: slug,
+        publisherId: publisher.id,
+        publisherName: publisher.name,
+        sender: 'publisher',
+        text: text.slice(0, 1000),
+        timestamp: new Date().toISOString()
+      };
+      publisherChatHistory.push(publisher.id, chatMessage);
+      sendMessage(connection, {
+        type: 'publisher-chat-message',
+        data: chatMessage
+      });
+      broadcastTenantAdminMessage(room.tenant_id, {
+        type: 'publisher-chat-message',
+        data: chatMessage
+      });
+    }
+  },
+  webrtc_signal: {
+    schema: { payload: 'object' },
+    handler: ({ log, clientId }, data) => log.info(`WebRTC signal from publisher ${clientId}: ${data.payload.type}`)
+  }
+}, { key: 'type', reply: replyToRoomSocket });
+
 // Room-based WebSocket endpoints for multi-tenant support
 async function registerRoomWsRoutes(fastify) {
   // Listener endpoint: /ws/room/:slug/listen
   fastify.get('/ws/room/:slug/listen', { websocket: true }, (connection, req) => {
     const { slug } = req.params;
     const clientId = uuidv4();
+    connection.signalingCodec = negotiateCodec(req.query?.codec);
 
     fastify.log.info(`New listener connection for room: ${slug}, client: ${clientId}`);
 
@@ -1692,10 +2175,10 @@ async function registerRoomWsRoutes(fastify) {
 
     if (!room) {
       fastify.log.warn(`Room not found: ${slug}`);
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Room not found' }
-      }));
+      });
       connection.close();
       return;
     }
@@ -1711,27 +2194,22 @@ async function registerRoomWsRoutes(fastify) {
       data: {
         iceServers: iceServers,
         channels: channels,
-        roomSlug: slug
+        roomSlug: slug,
+        audioProfile: getClientAudioProfile(room.audio_profile)
       }
     };
 
     // Handle messages (WebRTC signaling relay)
-    connection.on('message', async (message) => {
+    const ctx = { log: fastify.log, connection, clientId, slug, config };
+    connection.on('message', (message, isBinary) => {
+      let payload;
       try {
-        const payload = JSON.parse(message.toString());
-
-        if (payload.type === 'get-config') {
-          // Client requests config after handlers are ready (fixes iOS Safari timing issue)
-          connection.send(JSON.stringify(config));
-          fastify.log.info(`Config sent to listener ${clientId} for room ${slug}, channels: ${channels.join(', ')}`);
-        } else if (payload.type === 'webrtc_signal') {
-          // In a full implementation, this would relay to the SFU
-          // For now, we just log it
-          fastify.log.info(`WebRTC signal from listener ${clientId}: ${payload.data.payload.type}`);
-        }
+        payload = decodeFrame(message, isBinary);
       } catch (e) {
         fastify.log.error(`Invalid message from listener ${clientId}: ${e.message}`);
+        return;
       }
+      dispatchRoomListen(ctx, payload);
     });
 
     connection.on('close', () => {
@@ -1744,16 +2222,17 @@ async function registerRoomWsRoutes(fastify) {
     const { slug } = req.params;
     const token = req.query.token;
     const clientId = uuidv4();
+    connection.signalingCodec = negotiateCodec(req.query?.codec);
 
     fastify.log.info(`New publisher connection for room: ${slug}, client: ${clientId}`);
 
     // Verify token is provided
     if (!token) {
       fastify.log.warn(`Missing token for publisher connection to room ${slug}`);
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Missing token' }
-      }));
+      });
       connection.close();
       return;
     }
@@ -1763,10 +2242,10 @@ async function registerRoomWsRoutes(fastify) {
 
     if (!publisher) {
       fastify.log.warn(`Invalid token for publisher connection to room ${slug}`);
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Invalid token' }
-      }));
+      });
       connection.close();
       return;
     }
@@ -1776,20 +2255,20 @@ async function registerRoomWsRoutes(fastify) {
 
     if (!room) {
       fastify.log.warn(`Room not found: ${slug}`);
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Room not found' }
-      }));
+      });
       connection.close();
       return;
     }
 
     if (room.id !== publisher.room_id) {
       fastify.log.warn(`Publisher ${publisher.id} attempted to join wrong room ${slug}`);
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Token not valid for this room' }
-      }));
+      });
       connection.close();
       return;
     }
@@ -1823,55 +2302,23 @@ async function registerRoomWsRoutes(fastify) {
         sidecarMode: transcriptionStatus?.sidecarMode || null,
         sidecarInstanceCount: transcriptionStatus?.sidecarInstanceCount || 0,
         sidecarCapacity: transcriptionStatus?.sidecarCapacity || null,
-        sidecarOverflow: Boolean(transcriptionStatus?.sidecarOverflow)
+        sidecarOverflow: Boolean(transcriptionStatus?.sidecarOverflow),
+        audioProfile: getClientAudioProfile(room.audio_profile, publisher),
+        serverProcessingModes: audioProcessingEnabled ? PROCESSING_MODES : []
       }
     };
 
     // Handle messages (WebRTC signaling relay)
-    connection.on('message', async (message) => {
+    const ctx = { log: fastify.log, connection, clientId, slug, config, publisher, room };
+    connection.on('message', (message, isBinary) => {
+      let payload;
       try {
-        const payload = JSON.parse(message.toString());
-
-        if (payload.type === 'get-config') {
-          // Client requests config after handlers are ready (fixes iOS Safari timing issue)
-          connection.send(JSON.stringify(config));
-          fastify.log.info(`Config sent to publisher ${clientId} (${publisher.name}) for room ${slug}, channel: ${publisher.channel_name}`);
-        } else if (payload.type === 'publisher-chat-history-request') {
-          connection.send(JSON.stringify({
-            type: 'publisher-chat-history',
-            data: {
-              messages: getPublisherChatHistory(publisher.id)
-            }
-          }));
-        } else if (payload.type === 'publisher-chat-send') {
-          const text = typeof payload?.data?.text === 'string' ? payload.data.text.trim() : '';
-          if (!text) return;
-          const chatMessage = {
-            id: uuidv4(),
-            roomSlug: slug,
-            publisherId: publisher.id,
-            publisherName: publisher.name,
-            sender: 'publisher',
-            text: text.slice(0, 1000),
-            timestamp: new Date().toISOString()
-          };
-          pushPublisherChatMessage(publisher.id, chatMessage);
-          connection.send(JSON.stringify({
-            type: 'publisher-chat-message',
-            data: chatMessage
-          }));
-          broadcastTenantAdminMessage(room.tenant_id, {
-            type: 'publisher-chat-message',
-            data: chatMessage
-          });
-        } else if (payload.type === 'webrtc_signal') {
-          // In a full implementation, this would relay to the SFU
-          // For now, we just log it
-          fastify.log.info(`WebRTC signal from publisher ${clientId}: ${payload.data.payload.type}`);
-        }
+        payload = decodeFrame(message, isBinary);
       } catch (e) {
         fastify.log.error(`Invalid message from publisher ${clientId}: ${e.message}`);
+        return;
       }
+      dispatchRoomPublish(ctx, payload);
     });
 
     connection.on('close', () => {
@@ -1890,10 +2337,10 @@ async function registerAdminWsRoutes(fastify) {
     // Verify API key
     if (!apiKey) {
       fastify.log.warn('Missing API key for admin WebSocket connection');
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Missing API key' }
-      }));
+      });
       connection.close();
       return;
     }
@@ -1901,35 +2348,45 @@ async function registerAdminWsRoutes(fastify) {
     const tenant = verifyTenantApiKey(apiKey);
     if (!tenant) {
       fastify.log.warn('Invalid API key for admin WebSocket connection');
-      connection.send(JSON.stringify({
+      sendMessage(connection, {
         type: 'error',
         data: { message: 'Invalid API key' }
-      }));
+      });
       connection.close();
       return;
     }
 
     fastify.log.info(`Tenant admin connected: ${tenant.name} (ID: ${tenant.id})`);
 
-    // Add to tenantAdminClients Map
+    // Add to tenantAdminClients Map; past the per-tenant limit the oldest socket (usually a
+    // forgotten tab) is closed, and its close handler removes it
     if (!tenantAdminClients.has(tenant.id)) {
       tenantAdminClients.set(tenant.id, new Set());
     }
-    tenantAdminClients.get(tenant.id).add(connection);
+    const adminSockets = tenantAdminClients.get(tenant.id);
+    if (MAX_TENANT_ADMIN_SOCKETS > 0 && adminSockets.size >= MAX_TENANT_ADMIN_SOCKETS) {
+      const [oldest] = adminSockets;
+      adminSockets.delete(oldest);
+      fastify.log.info(`Closing oldest tenant admin socket for ${tenant.name} (limit ${MAX_TENANT_ADMIN_SOCKETS})`);
+      try {
+        oldest.close(1008, 'Too many admin connections');
+      } catch { }
+    }
+    adminSockets.add(connection);
 
     // Send initial channel stats
     const stats = getChannelStatsForTenant(tenant.id);
-    connection.send(JSON.stringify({
+    sendMessage(connection, {
       type: 'channel-stats',
       stats
-    }));
+    });
 
     // Send initial recording status for all rooms
     const recordingStats = getRecordingStatusForTenant(tenant.id);
-    connection.send(JSON.stringify({
+    sendMessage(connection, {
       type: 'recording-stats',
       stats: recordingStats
-    }));
+    });
 
     connection.on('message', async (message) => {
       try {
@@ -1938,16 +2395,16 @@ async function registerAdminWsRoutes(fastify) {
         if (payload.type === 'refresh') {
           // Send updated stats
           const stats = getChannelStatsForTenant(tenant.id);
-          connection.send(JSON.stringify({
+          sendMessage(connection, {
             type: 'channel-stats',
             stats
-          }));
+          });
           // Also send recording status
           const recordingStats = getRecordingStatusForTenant(tenant.id);
-          connection.send(JSON.stringify({
+          sendMessage(connection, {
             type: 'recording-stats',
             stats: recordingStats
-          }));
+          });
         } else if (payload.type === 'admin-chat-send') {
           const publisherId = Number(payload?.data?.publisherId);
           const roomSlug = typeof payload?.data?.roomSlug === 'string' ? payload.data.roomSlug : '';
@@ -1971,15 +2428,15 @@ async function registerAdminWsRoutes(fastify) {
             text: text.slice(0, 1000),
             timestamp: new Date().toISOString()
           };
-          pushPublisherChatMessage(publisher.id, chatMessage);
+          publisherChatHistory.push(publisher.id, chatMessage);
 
           const publisherClient = roomPublisherClients.get(publisher.id);
           if (publisherClient) {
             try {
-              publisherClient.socket.send(JSON.stringify({
+              sendMessage(publisherClient.socket, {
                 type: 'publisher-chat-message',
                 data: chatMessage
-              }));
+              });
             } catch (e) {
               fastify.log.error(`Failed sending admin chat message to publisher: ${e.message}`);
             }
@@ -2002,14 +2459,14 @@ async function registerAdminWsRoutes(fastify) {
           const publisher = pubStmt.get(publisherId);
           if (!publisher || publisher.room_id !== room.id) return;
 
-          connection.send(JSON.stringify({
+          sendMessage(connection, {
             type: 'publisher-chat-history',
             data: {
               roomSlug,
               publisherId,
-              messages: getPublisherChatHistory(publisherId)
+              messages: publisherChatHistory.get(publisherId)
             }
-          }));
+          });
         }
       } catch (e) {
         fastify.log.error(`Invalid message from tenant admin: ${e.message}`);
@@ -2031,10 +2488,54 @@ async function registerAdminWsRoutes(fastify) {
 }
 
 // Register all WebSocket routes on a Fastify instance
+async function registerSfuWsRoutes(fastify) {
+  // Edge SFU relay endpoint: /ws/relay?secretKey=xxx&name=edge-1
+  fastify.get('/ws/relay', { websocket: true }, (connection, req) => {
+    if (!SFU_RELAY_SECRET || req.query.secretKey !== SFU_RELAY_SECRET || !relayOrigin) {
+      fastify.log.warn('Rejected relay WebSocket connection');
+      sendMessage(connection, {
+        action: 'relay-error',
+        data: { message: SFU_RELAY_SECRET ? 'Invalid secret key' : 'Relaying is disabled' }
+      });
+      connection.close();
+      return;
+    }
+    relayOrigin.attach(connection, req.query.name || req.ip);
+  });
+
+  // Standalone SFU channel stats: /ws/sfu-stats?secretKey=xxx&sfuId=yyy
+  fastify.get('/ws/sfu-stats', { websocket: true }, (connection, req) => {
+    const sfuSecret = process.env.SFU_SECRET_KEY;
+    const node = sfuRegistry.get(req.query.sfuId);
+    if (!sfuSecret || req.query.secretKey !== sfuSecret || !node) {
+      fastify.log.warn('Rejected SFU stats WebSocket connection');
+      sendMessage(connection, {
+        type: 'error',
+        data: { message: node ? 'Invalid secret key' : 'Unknown SFU' }
+      });
+      connection.close();
+      return;
+    }
+
+    sendMessage(connection, { type: 'connected', sfuId: node.id });
+    connection.on('message', (message) => {
+      try {
+        const payload = JSON.parse(message.toString());
+        if (payload.type === 'stats-update') {
+          sfuRegistry.updateChannels(node.id, payload.channels, payload.listeners);
+        }
+      } catch (error) {
+        fastify.log.warn(`Invalid SFU stats message from ${node.name}: ${error.message}`);
+      }
+    });
+  });
+}
+
 function registerAllWsRoutes(fastifyInstance) {
   fastifyInstance.register(registerMainWsRoutes);
   fastifyInstance.register(registerRoomWsRoutes);
   fastifyInstance.register(registerAdminWsRoutes);
+  fastifyInstance.register(registerSfuWsRoutes);
   if (transcriptionRuntime) {
     transcriptionRuntime.registerWsRoute(fastifyInstance);
   }
@@ -2089,6 +2590,7 @@ function createHttpsServer() {
   fastifyHttps.decorate('transcriptionRuntime', transcriptionRuntime);
   fastifyHttps.decorate('notifyRecordingStatusChange', notifyRecordingStatusChange);
   fastifyHttps.register(registerApiRoutes);
+  fastifyHttps.register(registerSfuRoutes, { registry: sfuRegistry });
 
   // Register WebSocket routes on HTTPS server
   registerAllWsRoutes(fastifyHttps);
@@ -2166,7 +2668,9 @@ async function main() {
     } catch (error) {
       fastify.log.warn({ err: error }, 'Failed closing HTTP server');
     }
+    if (relayOrigin) relayOrigin.close();
     await waitForRecordingFinalization({ log: fastify.log });
+    await stopDbWriter();
     process.exit(0);
   };
 
@@ -2183,24 +2687,47 @@ async function main() {
     });
   });
 
-  // Create mediasoup Worker
-  worker = await mediasoup.createWorker({
+  // Create mediasoup workers, one router per worker
+  workerPool = new MediasoupWorkerPool({
+    numWorkers: mediasoupConfig.numWorkers,
     rtcMinPort: mediasoupConfig.rtcMinPort,
     rtcMaxPort: mediasoupConfig.rtcMaxPort,
+    maxListenersPerRouter: mediasoupConfig.maxListenersPerRouter,
     logLevel: 'warn',
-    logTags: ['info', 'ice', 'dtls', 'rtp', 'srtp', 'rtcp']
+    logTags: ['info', 'ice', 'dtls', 'rtp', 'srtp', 'rtcp'],
+    webRtcServer: mediasoupConfig.webRtcServerPort
+      ? {
+        listenIp: mediasoupConfig.listenIp,
+        announcedIp: mediasoupConfig.announcedIp,
+        port: mediasoupConfig.webRtcServerPort
+      }
+      : null,
+    log: fastify.log
   });
-  worker.on('died', () => {
-    fastify.log.error('mediasoup worker died, exiting...');
-    setTimeout(() => process.exit(1), 2000);
+  await workerPool.init({
+    mediaCodecs,
+    onWorkerDied: (worker) => {
+      fastify.log.error(`mediasoup worker ${worker.pid} died, exiting...`);
+      setTimeout(() => process.exit(1), 2000);
+    }
   });
 
-  // Create Router
-  router = await worker.createRouter({ mediaCodecs });
+  relayOrigin = new RelayOrigin({
+    workerPool,
+    getChannel: (channelId) => {
+      if (channels.has(channelId)) return channels.get(channelId);
+      const channel = ensureChannel(channelId);
+      if (channel) broadcastChannelList();
+      return channel;
+    },
+    listenIp: mediasoupConfig.listenIp,
+    announcedIp: mediasoupConfig.announcedIp,
+    log: fastify.log
+  });
 
   // Initialize recorder module with notification callback
   initRecorder({
-    router,
+    router: workerPool.defaultRouter,
     channels,
     fastify,
     onStatusChange: notifyRecordingStatusChange
@@ -2210,9 +2737,18 @@ async function main() {
   fastify.log.info({ ...recoveredRecordings }, 'Recording recovery summary');
   const recoveredTranscriptions = await transcriptionRuntime.recoverTranscriptionSessions();
   fastify.log.info({ ...recoveredTranscriptions }, 'Transcription recovery summary');
+  transcriptionRuntime.startWarmPool();
+
+  if (STATE_REPORT_INTERVAL_MS > 0) {
+    setInterval(() => {
+      const { rss, heapUsed, external } = process.memoryUsage();
+      fastify.log.info({ ...getStateSizes(), rss, heapUsed, external }, 'Signaling state report');
+    }, STATE_REPORT_INTERVAL_MS).unref();
+  }
 
   // Decorate fastify with router and channels for API routes
-  fastify.decorate('mediasoupRouter', router);
+  fastify.decorate('mediasoupRouter', workerPool.defaultRouter);
+  fastify.decorate('mediasoupWorkerPool', workerPool);
   fastify.decorate('mediasoupChannels', channels);
   fastify.decorate('transcriptionRuntime', transcriptionRuntime);
   fastify.decorate('notifyRecordingStatusChange', notifyRecordingStatusChange);
@@ -0,0 +1,346 @@
+/**
+ * Signaling wire codecs: JSON text frames (default) and MessagePack binary frames.
+ *
+ * A client opts into MessagePack by connecting with `?codec=msgpack`; the server then
+ * replies in binary frames. Binary frames from a client are always decoded as MessagePack,
+ * text frames as JSON, so either side can be switched independently.
+ *
+ * The MessagePack subset covers what JSON can express plus binary: nil, booleans, integers,
+ * float64, strings, bin, arrays and string-keyed maps. No Node APIs, so the benchmark's
+ * browser client reuses this file.
+ */
+
+export const CODEC_JSON = 'json';
+export const CODEC_MSGPACK = 'msgpack';
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+class Writer {
+  constructor(size = 256) {
+    this.bytes = new Uint8Array(size);
+    this.view = new DataView(this.bytes.buffer);
+    this.length = 0;
+  }
+
+  ensure(extra) {
+    if (this.length + extra <= this.bytes.length) return;
+    let size = this.bytes.length * 2;
+    while (size < this.length + extra) size *= 2;
+    const bytes = new Uint8Array(size);
+    bytes.set(this.bytes.subarray(0, this.length));
+    this.bytes = bytes;
+    this.view = new DataView(bytes.buffer);
+  }
+
+  u8(value) {
+    this.ensure(1);
+    this.bytes[this.length++] = value;
+  }
+
+  u8u8(tag, value) {
+    this.ensure(2);
+    this.bytes[this.length++] = tag;
+    this.bytes[this.length++] = value;
+  }
+
+  u8u16(tag, value) {
+    this.ensure(3);
+    this.bytes[this.length] = tag;
+    this.view.setUint16(this.length + 1, value);
+    this.length += 3;
+  }
+
+  u8u32(tag, value) {
+    this.ensure(5);
+    this.bytes[this.length] = tag;
+    this.view.setUint32(this.length + 1, value);
+    this.length += 5;
+  }
+
+  raw(bytes) {
+    this.ensure(bytes.length);
+    this.bytes.set(bytes, this.length);
+    this.length += bytes.length;
+  }
+}
+
+function writeLength(writer, length, fixTag, fixMax, tag8, tag16, tag32) {
+  if (length <= fixMax) writer.u8(fixTag | length);
+  else if (tag8 !== null && length < 0x100) writer.u8u8(tag8, length);
+  else if (length < 0x10000) writer.u8u16(tag16, length);
+  else writer.u8u32(tag32, length);
+}
+
+function writeNumber(writer, value) {
+  if (Number.isInteger(value) && Number.isSafeInteger(value)) {
+    if (value >= 0) {
+      if (value < 0x80) return writer.u8(value);
+      if (value < 0x100) return writer.u8u8(0xcc, value);
+      if (value < 0x10000) return writer.u8u16(0xcd, value);
+      if (value < 0x100000000) return writer.u8u32(0xce, value);
+      writer.ensure(9);
+      writer.bytes[writer.length] = 0xcf;
+      writer.view.setBigUint64(writer.length + 1, BigInt(value));
+      writer.length += 9;
+      return;
+    }
+    if (value >= -0x20) return writer.u8(value & 0xff);
+    if (value >= -0x80) return writer.u8u8(0xd0, value & 0xff);
+    if (value >= -0x8000) {
+      writer.ensure(3);
+      writer.bytes[writer.length] = 0xd1;
+      writer.view.setInt16(writer.length + 1, value);
+      writer.length += 3;
+      return;
+    }
+    if (value >= -0x80000000) {
+      writer.ensure(5);
+      writer.bytes[writer.length] = 0xd2;
+      writer.view.setInt32(writer.length + 1, value);
+      writer.length += 5;
+      return;
+    }
+    writer.ensure(9);
+    writer.bytes[writer.length] = 0xd3;
+    writer.view.setBigInt64(writer.length + 1, BigInt(value));
+    writer.length += 9;
+    return;
+  }
+  // JSON maps non-finite numbers to null; keep the two codecs equivalent
+  if (!Number.isFinite(value)) return writer.u8(0xc0);
+  writer.ensure(9);
+  writer.bytes[writer.length] = 0xcb;
+  writer.view.setFloat64(writer.length + 1, value);
+  writer.length += 9;
+}
+
+function writeString(writer, value) {
+  // Worst case 3 bytes per UTF-16 unit; encode in place after a max-size header
+  const maxBytes = value.length * 3;
+  const headerSize = maxBytes < 0x20 ? 1 : maxBytes < 0x100 ? 2 : maxBytes < 0x10000 ? 3 : 5;
+  writer.ensure(headerSize + maxBytes);
+  const start = writer.length + headerSize;
+  const { written } = textEncoder.encodeInto(value, writer.bytes.subarray(start));
+  const at = writer.length;
+  if (headerSize === 1) {
+    writer.bytes[at] = 0xa0 | written;
+  } else if (headerSize === 2) {
+    writer.bytes[at] = 0xd9;
+    writer.bytes[at + 1] = written;
+  } else if (headerSize === 3) {
+    writer.bytes[at] = 0xda;
+    writer.view.setUint16(at + 1, written);
+  } else {
+    writer.bytes[at] = 0xdb;
+    writer.view.setUint32(at + 1, written);
+  }
+  writer.length = start + written;
+}
+
+function writeValue(writer, value) {
+  switch (typeof value) {
+    case 'string':
+      return writeString(writer, value);
+    case 'number':
+      return writeNumber(writer, value);
+    case 'boolean':
+      return writer.u8(value ? 0xc3 : 0xc2);
+    case 'bigint':
+      return writeNumber(writer, Number(value));
+    case 'object':
+      break;
+    default:
+      return writer.u8(0xc0); // undefined, functions, symbols
+  }
+
+  if (value === null) return writer.u8(0xc0);
+  if (value instanceof Uint8Array || value instanceof ArrayBuffer) {
+    const bytes = value instanceof ArrayBuffer ? new Uint8Array(value) : value;
+    writeLength(writer, bytes.length, 0, -1, 0xc4, 0xc5, 0xc6);
+    return writer.raw(bytes);
+  }
+  if (typeof value.toJSON === 'function') return writeValue(writer, value.toJSON());
+  if (Array.isArray(value)) {
+    writeLength(writer, value.length, 0x90, 15, null, 0xdc, 0xdd);
+    for (const item of value) writeValue(writer, item);
+    return;
+  }
+
+  // Like JSON, drop keys whose value cannot be represented
+  const keys = Object.keys(value).filter(key => value[key] !== undefined && typeof value[key] !== 'function');
+  writeLength(writer, keys.length, 0x80, 15, null, 0xde, 0xdf);
+  for (const key of keys) {
+    writeString(writer, key);
+    writeValue(writer, value[key]);
+  }
+}
+
+/**
+ * @param {*} value - JSON-compatible value (Uint8Arrays become bin)
+ * @returns {Uint8Array}
+ */
+export function encodeMsgpack(value) {
+  const writer = new Writer();
+  writeValue(writer, value);
+  return writer.bytes.subarray(0, writer.length);
+}
+
+class Reader {
+  constructor(bytes) {
+    this.bytes = bytes;
+    this.view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    this.offset = 0;
+  }
+
+  take(length) {
+    if (this.offset + length > this.bytes.length) throw new Error('Truncated MessagePack data');
+    const start = this.offset;
+    this.offset += length;
+    return start;
+  }
+
+  str(length) {
+    const start = this.take(length);
+    return textDecoder.decode(this.bytes.subarray(start, start + length));
+  }
+
+  bin(length) {
+    const start = this.take(length);
+    return this.bytes.slice(start, start + length);
+  }
+
+  array(length) {
+    const items = new Array(length);
+    for (let i = 0; i < length; i++) items[i] = this.value();
+    return items;
+  }
+
+  map(length) {
+    const object = {};
+    for (let i = 0; i < length; i++) {
+      const key = this.value();
+      const value = this.value();
+      if (key === '__proto__') {
+        // An own property, as JSON.parse makes it; assigning would replace the prototype
+        Object.defineProperty(object, key, { value, writable: true, enumerable: true, configurable: true });
+      } else {
+        object[key] = value;
+      }
+    }
+    return object;
+  }
+
+  value() {
+    const tag = this.bytes[this.take(1)];
+    if (tag < 0x80) return tag;
+    if (tag < 0x90) return this.map(tag & 0x0f);
+    if (tag < 0xa0) return this.array(tag & 0x0f);
+    if (tag < 0xc0) return this.str(tag & 0x1f);
+    if (tag >= 0xe0) return tag - 0x100;
+
+    const { view } = this;
+    switch (tag) {
+      case 0xc0: return null;
+      case 0xc2: return false;
+      case 0xc3: return true;
+      case 0xc4: return this.bin(this.bytes[this.take(1)]);
+      case 0xc5: return this.bin(view.getUint16(this.take(2)));
+      case 0xc6: return this.bin(view.getUint32(this.take(4)));
+      case 0xca: return view.getFloat32(this.take(4));
+      case 0xcb: return view.getFloat64(this.take(8));
+      case 0xcc: return this.bytes[this.take(1)];
+      case 0xcd: return view.getUint16(this.take(2));
+      case 0xce: return view.getUint32(this.take(4));
+      case 0xcf: return Number(view.getBigUint64(this.take(8)));
+      case 0xd0: return view.getInt8(this.take(1));
+      case 0xd1: return view.getInt16(this.take(2));
+      case 0xd2: return view.getInt32(this.take(4));
+      case 0xd3: return Number(view.getBigInt64(this.take(8)));
+      case 0xd9: return this.str(this.bytes[this.take(1)]);
+      case 0xda: return this.str(view.getUint16(this.take(2)));
+      case 0xdb: return this.str(view.getUint32(this.take(4)));
+      case 0xdc: return this.array(view.getUint16(this.take(2)));
+      case 0xdd: return this.array(view.getUint32(this.take(4)));
+      case 0xde: return this.map(view.getUint16(this.take(2)));
+      case 0xdf: return this.map(view.getUint32(this.take(4)));
+      default:
+        throw new Error(`Unsupported MessagePack type 0x${tag.toString(16)}`);
+    }
+  }
+}
+
+/**
+ * @param {Uint8Array} bytes
+ * @returns {*}
+ */
+export function decodeMsgpack(bytes) {
+  const reader = new Reader(bytes);
+  const value = reader.value();
+  if (reader.offset !== bytes.length) throw new Error('Trailing bytes after MessagePack value');
+  return value;
+}
+
+/**
+ * @param {string} [requested] - `codec` query parameter
+ * @returns {string} CODEC_MSGPACK or CODEC_JSON
+ */
+export function negotiateCodec(requested) {
+  return requested === CODEC_MSGPACK ? CODEC_MSGPACK : CODEC_JSON;
+}
+
+/**
+ * Decode one incoming frame (ws 'message' event arguments).
+ * @throws On malformed frames
+ */
+export function decodeFrame(raw, isBinary) {
+  if (isBinary) {
+    const bytes = Array.isArray(raw) ? concatBytes(raw) : raw instanceof ArrayBuffer ? new Uint8Array(raw) : raw;
+    return decodeMsgpack(bytes);
+  }
+  return JSON.parse(typeof raw === 'string' ? raw : textDecoder.decode(raw));
+}
+
+function concatBytes(chunks) {
+  const total = chunks.reduce((sum, chunk) => sum + chunk.length, 0);
+  const bytes = new Uint8Array(total);
+  let offset = 0;
+  for (const chunk of chunks) {
+    bytes.set(chunk, offset);
+    offset += chunk.length;
+  }
+  return bytes;
+}
+
+/**
+ * @returns {string|Uint8Array} Frame for `codec`
+ */
+export function encodeFrame(message, codec = CODEC_JSON) {
+  return codec === CODEC_MSGPACK ? encodeMsgpack(message) : JSON.stringify(message);
+}
+
+/**
+ * Send `message` in the socket's negotiated codec (`socket.signalingCodec`, JSON by default).
+ * Pass the same `frames` object when sending one message to many sockets so each codec
+ * encodes it once.
+ */
+export function sendMessage(socket, message, frames = null) {
+  const codec = socket.signalingCodec || CODEC_JSON;
+  let frame = frames?.[codec];
+  if (frame === undefined) {
+    frame = encodeFrame(message, codec);
+    if (frames) frames[codec] = frame;
+  }
+  socket.send(frame);
+}
+
+export default {
+  CODEC_JSON,
+  CODEC_MSGPACK,
+  encodeMsgpack,
+  decodeMsgpack,
+  negotiateCodec,
+  decodeFrame,
+  encodeFrame,
+  sendMessage
+};
@@ -0,0 +1,88 @@
+/**
+ * Table-driven dispatch for signaling sockets.
+ *
+ * A route table maps a message's action (or `type`) to `{ handler, schema, hot }`. Schemas
+ * are compiled once into flat check lists, so validating a message is a few typeof checks
+ * rather than a walk over a schema object. Hot routes (the listener join path) skip the
+ * per-message debug log that other routes get, so join storms do not turn into log I/O;
+ * rejections and handler errors are still logged for every route.
+ *
+ * Schema: `{ field: 'string' | 'number' | 'boolean' | 'object' | 'array' }`; a trailing `?`
+ * marks the field optional. A route with a schema also requires `data` to be an object.
+ */
+
+function typeMatches(type, value) {
+  if (type === 'array') return Array.isArray(value);
+  if (type === 'object') return value !== null && typeof value === 'object' && !Array.isArray(value);
+  return typeof value === type;
+}
+
+/**
+ * @param {object} [schema]
+ * @returns {function(*): (string|null)} Returns an error message, or null when `data` is valid
+ */
+export function compileSchema(schema) {
+  if (!schema) return () => null;
+
+  const checks = Object.entries(schema).map(([rawField, type]) => {
+    const optional = rawField.endsWith('?');
+    return { field: optional ? rawField.slice(0, -1) : rawField, type, optional };
+  });
+
+  return (data) => {
+    if (data === null || typeof data !== 'object') return 'Missing message data';
+    for (const { field, type, optional } of checks) {
+      const value = data[field];
+      if (value === undefined || value === null) {
+        if (optional) continue;
+        return `Missing field: ${field}`;
+      }
+      if (!typeMatches(type, value)) return `Invalid field: ${field} must be ${type === 'array' || type === 'object' ? 'an' : 'a'} ${type}`;
+    }
+    return null;
+  };
+}
+
+/**
+ * @param {object} routes - action -> { handler(ctx, data), schema?, hot? }
+ * @param {object} options
+ * @param {string} [options.key] - Message field naming the route ('action' or 'type')
+ * @param {function} options.reply - (ctx, message) sends an error reply to the client
+ * @param {function} [options.errorReply] - message => reply payload
+ * @returns {function(object, object): Promise<void>} (ctx, payload) => dispatch; ctx.log is used for logging
+ */
+export function createDispatcher(routes, { key = 'action', reply, errorReply = (message) => ({ [key]: 'error', data: { message } }) } = {}) {
+  const table = new Map();
+  for (const [name, route] of Object.entries(routes)) {
+    table.set(name, { handler: route.handler, validate: compileSchema(route.schema), hot: Boolean(route.hot) });
+  }
+
+  return async function dispatch(ctx, payload) {
+    const name = payload?.[key];
+    const route = typeof name === 'string' ? table.get(name) : undefined;
+    if (!route) {
+      ctx.log.warn({ clientId: ctx.clientId, [key]: name }, 'Unknown signaling message');
+      return;
+    }
+    if (!route.hot) ctx.log.debug({ clientId: ctx.clientId, [key]: name }, 'Signaling message');
+
+    const { data } = payload;
+    const invalid = route.validate(data);
+    if (invalid) {
+      ctx.log.warn({ clientId: ctx.clientId, [key]: name }, `Rejected signaling message: ${invalid}`);
+      reply(ctx, errorReply(invalid));
+      return;
+    }
+
+    try {
+      await route.handler(ctx, data);
+    } catch (error) {
+      ctx.log.error({ clientId: ctx.clientId, [key]: name }, `Signaling handler failed: ${error.message}`);
+      try {
+        reply(ctx, errorReply(error.message));
+      } catch { }
+    }
+  };
+}
+
+export default createDispatcher;
@@ -0,0 +1,91 @@
+// Listener bookkeeping shared by a channel and its listeners' clientInfo objects. Each consumer
+// is one entry indexed by id from both the channel and its listener's clientInfo.consumers, so
+// closing a consumer never scans either side.
+
+/**
+ * @param {Map<string, object>} clients - clientId -> clientInfo
+ * @returns {object} Helpers bound to `clients`
+ */
+export function createListenerIndex(clients) {
+  function addChannelListenerRouter(channel, router) {
+    if (!channel || !router) return;
+    channel.listenersByRouter.set(router.id, (channel.listenersByRouter.get(router.id) || 0) + 1);
+  }
+
+  function removeChannelListenerRouter(channel, router) {
+    if (!channel || !router) return;
+    const count = (channel.listenersByRouter.get(router.id) || 0) - 1;
+    if (count > 0) {
+      channel.listenersByRouter.set(router.id, count);
+    } else {
+      channel.listenersByRouter.delete(router.id);
+    }
+  }
+
+  function addChannelConsumer(channel, consumerId, entry) {
+    if (channel.consumers.has(consumerId)) removeChannelConsumer(channel, consumerId);
+    channel.consumers.set(consumerId, entry);
+    if (entry.clientId) {
+      channel.listenerRefs.set(entry.clientId, (channel.listenerRefs.get(entry.clientId) || 0) + 1);
+      clients.get(entry.clientId)?.consumers.set(consumerId, entry);
+    }
+  }
+
+  function removeChannelConsumer(channel, consumerId) {
+    const entry = channel.consumers.get(consumerId);
+    if (!entry) return;
+    channel.consumers.delete(consumerId);
+    if (!entry.clientId) return;
+    clients.get(entry.clientId)?.consumers.delete(consumerId);
+    const count = (channel.listenerRefs.get(entry.clientId) || 0) - 1;
+    if (count > 0) {
+      channel.listenerRefs.set(entry.clientId, count);
+    } else {
+      channel.listenerRefs.delete(entry.clientId);
+    }
+  }
+
+  // Close every consumer of one listener; walks only that listener's own consumers
+  function removeListenerConsumers(channel, clientInfo) {
+    for (const [consumerId, entry] of [...clientInfo.consumers]) {
+      if (entry.consumer) {
+        try { entry.consumer.close(); } catch { }
+      }
+      if (channel) removeChannelConsumer(channel, consumerId);
+    }
+    clientInfo.consumers.clear();
+  }
+
+  /**
+   * Undo a listener join: close its consumers and transport and drop its channel refs.
+   * `channel` is null when the channel is already gone.
+   */
+  function releaseListener(channel, clientInfo) {
+    removeListenerConsumers(channel, clientInfo);
+    if (clientInfo.transport) {
+      try { clientInfo.transport.close(); } catch { }
+    }
+    removeChannelListenerRouter(channel, clientInfo.router);
+
+    clientInfo.isListener = false;
+    clientInfo.channelId = null;
+    clientInfo.transport = null;
+    clientInfo.router = null;
+  }
+
+  return {
+    addChannelListenerRouter,
+    removeChannelListenerRouter,
+    addChannelConsumer,
+    removeChannelConsumer,
+    removeListenerConsumers,
+    releaseListener
+  };
+}
+
+// Unique listeners (by clientId), matching what publishers see. O(1).
+export function countChannelListeners(channel) {
+  return channel?.listenerRefs ? channel.listenerRefs.size : 0;
+}
+
+export default createListenerIndex;
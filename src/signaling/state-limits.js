@@ -0,0 +1,121 @@
+// Capacity-bounded pieces of the in-memory signaling state, kept free of server wiring so the
+// limits can be exercised directly
+
+/**
+ * Chat history by publisher id. Each publisher keeps its latest `perPublisherLimit` messages and
+ * at most `maxPublishers` histories are held, dropping the least recently used first.
+ * A limit of 0 disables it.
+ */
+export class PublisherChatHistory {
+  /**
+   * @param {object} [options]
+   * @param {number} [options.perPublisherLimit]
+   * @param {number} [options.maxPublishers]
+   */
+  constructor({ perPublisherLimit = 0, maxPublishers = 0 } = {}) {
+    this.perPublisherLimit = perPublisherLimit;
+    this.maxPublishers = maxPublishers;
+    this.histories = new Map(); // publisherId -> messages, least recently used first
+    this.messageCount = 0;
+    this.textChars = 0;
+  }
+
+  get publisherCount() {
+    return this.histories.size;
+  }
+
+  /**
+   * @param {string} publisherId
+   * @param {{text: string}} message
+   */
+  push(publisherId, message) {
+    let history = this.histories.get(publisherId);
+    if (history) {
+      this.histories.delete(publisherId); // re-inserted below as most recently used
+    } else {
+      history = [];
+      if (this.maxPublishers > 0 && this.histories.size >= this.maxPublishers) {
+        const [oldestId, oldest] = this.histories.entries().next().value;
+        this.histories.delete(oldestId);
+        for (const dropped of oldest) this.forget(dropped);
+      }
+    }
+    this.histories.set(publisherId, history);
+
+    history.push(message);
+    this.messageCount += 1;
+    this.textChars += message.text.length;
+    while (this.perPublisherLimit > 0 && history.length > this.perPublisherLimit) {
+      this.forget(history.shift());
+    }
+  }
+
+  /**
+   * @param {string} publisherId
+   * @returns {Array<object>} Oldest first; empty when there is none
+   */
+  get(publisherId) {
+    return this.histories.get(publisherId) || [];
+  }
+
+  forget(message) {
+    this.messageCount -= 1;
+    this.textChars -= message.text.length;
+  }
+}
+
+/**
+ * Oldest channel with no producers, consumers, listener transports, edge relays or clients
+ * pointing at it. Walks every client, so only call it at the channel limit.
+ * @param {Map<string, object>} channels - channelId -> channel state, oldest first
+ * @param {Iterable<{channelId: ?string}>} clients
+ * @param {(channelId: string) => boolean} [isRelayed]
+ * @returns {?string}
+ */
+export function findIdleChannelId(channels, clients, isRelayed = () => false) {
+  const inUse = new Set();
+  for (const client of clients) {
+    if (client.channelId) inUse.add(client.channelId);
+  }
+  for (const [channelId, channel] of channels) {
+    if (inUse.has(channelId) || channel.producers.size > 0 || channel.consumers.size > 0 ||
+      channel.listenersByRouter.size > 0 || isRelayed(channelId)) {
+      continue;
+    }
+    return channelId;
+  }
+  return null;
+}
+
+/**
+ * Get or create a channel. At `maxChannels` (0 disables the limit) the oldest idle channel is
+ * evicted to make room.
+ * @param {Map<string, object>} channels
+ * @param {string} channelId
+ * @param {object} options
+ * @param {number} options.maxChannels
+ * @param {() => object} options.createChannel
+ * @param {Iterable<{channelId: ?string}>} options.clients
+ * @param {(channelId: string) => boolean} [options.isRelayed]
+ * @param {(channelId: string) => void} [options.onEvict]
+ * @returns {?object} null when every channel is in use
+ */
+export function getOrCreateChannel(channels, channelId, { maxChannels, createChannel, clients, isRelayed, onEvict }) {
+  let channel = channels.get(channelId);
+  if (channel) return channel;
+  if (maxChannels > 0 && channels.size >= maxChannels) {
+    const idleId = findIdleChannelId(channels, clients, isRelayed);
+    if (idleId === null) return null;
+    channels.delete(idleId);
+    onEvict?.(idleId);
+  }
+  channel = createChannel();
+  channels.set(channelId, channel);
+  return channel;
+}
+
+export default {
+  PublisherChatHistory,
+  findIdleChannelId,
+  getOrCreateChannel
+};
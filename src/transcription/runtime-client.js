@@ -0,0 +1,291 @@
+import { Worker } from 'worker_threads';
+import { metrics } from '../metrics.js';
+
+const RESTART_DELAY_MS = 1000;
+// Must match the runtime's limit: a relayed socket above it is reported back as backed up
+const DOC_SOCKET_MAX_BUFFERED_BYTES = parseInt(process.env.TRANSCRIPT_SOCKET_MAX_BUFFERED_BYTES || String(1024 * 1024), 10);
+const BUFFERED_RECHECK_MS = 100;
+
+// Runtime methods the main thread calls; each returns a Promise here
+const FORWARDED_METHODS = [
+  'checkAvailability',
+  'ensureAvailableOrThrow',
+  'recoverTranscriptionSessions',
+  'startWarmPool',
+  'startRoomSession',
+  'stopRoomSession',
+  'forceStopSession',
+  'registerProducerStream',
+  'unregisterProducerStream',
+  'restartChannel',
+  'getCurrentRoomDocs',
+  'getSessionDocs',
+  'getSessionChannelDoc',
+  'getChannelDoc'
+];
+// Called without awaiting by server.js (sync in the runtime), so failures are logged here
+const UNAWAITED_METHODS = new Set(['startWarmPool', 'unregisterProducerStream']);
+
+/**
+ * Main-thread handle for a TranscriptionRuntime running in runtime-worker.js.
+ *
+ * Exposes the runtime methods server.js and the API routes use. Calls are forwarded and
+ * return Promises; getRoomSession(), getRoomTranscriptionStatus() and getMetricsSnapshot()
+ * stay synchronous and answer from state the worker pushes every second and after each call.
+ * Recorder segment events and live track audio are forwarded in, and the transcript
+ * websocket route stays here with its sockets relayed to the worker.
+ *
+ * If the worker exits unexpectedly it is restarted and recovers sessions from their lock
+ * files, as after a process restart.
+ */
+export class TranscriptionRuntimeClient {
+  /**
+   * @param {object} options
+   * @param {object} options.fastify - For logging
+   * @param {string} options.dbPath - Database file (the worker opens its own connection)
+   * @param {EventEmitter} [options.segmentEvents] - recorder 'segment-closed' events
+   * @param {function} [options.subscribeTrackAudio] - recorder.subscribeTrackAudio
+   */
+  constructor({ fastify, dbPath, segmentEvents = null, subscribeTrackAudio = null }) {
+    this.fastify = fastify;
+    this.dbPath = dbPath;
+    this.segmentEvents = segmentEvents;
+    this.subscribeTrackAudio = subscribeTrackAudio;
+    this.worker = null;
+    this.nextCallId = 1;
+    this.pendingCalls = new Map(); // id -> { resolve, reject }
+    this.audioSubscriptions = new Map(); // subscriptionId -> unsubscribe
+    this.sockets = new Map(); // socketId -> ws socket
+    this.nextSocketId = 1;
+    this.roomStatuses = new Map(); // roomId -> status
+    this.metricsSnapshot = { sessions: 0, queueDepth: 0, inFlight: 0 };
+    this.shuttingDown = false;
+
+    if (segmentEvents) {
+      segmentEvents.on('segment-closed', (segment) => this.post({ type: 'segment-closed', segment }));
+    }
+    for (const method of FORWARDED_METHODS) {
+      this[method] = UNAWAITED_METHODS.has(method)
+        ? (...args) => this.call(method, args).catch((error) => {
+          this.fastify.log.error(`Transcription ${method} failed: ${error.message}`);
+        })
+        : (...args) => this.call(method, args);
+    }
+    this.startWorker();
+  }
+
+  startWorker() {
+    const worker = new Worker(new URL('./runtime-worker.js', import.meta.url), {
+      workerData: {
+        dbPath: this.dbPath,
+        segmentEvents: Boolean(this.segmentEvents),
+        trackAudio: Boolean(this.subscribeTrackAudio)
+      }
+    });
+    this.worker = worker;
+    worker.on('message', (message) => this.handleMessage(message));
+    worker.on('error', (error) => {
+      this.fastify.log.error(`Transcription worker failed: ${error.message}`);
+    });
+    worker.on('exit', (code) => {
+      if (this.worker !== worker) return;
+      this.worker = null;
+      this.resetWorkerState(new Error(`Transcription worker exited with code ${code}`));
+      if (this.shuttingDown) return;
+
+      this.fastify.log.error(`Transcription worker exited with code ${code}; restarting`);
+      setTimeout(() => {
+        if (this.shuttingDown) return;
+        this.startWorker();
+        this.recoverTranscriptionSessions()
+          .then((summary) => this.fastify.log.info({ ...summary }, 'Transcription recovery summary'))
+          .then(() => this.startWarmPool())
+          .catch((error) => this.fastify.log.error(`Transcription recovery after worker restart failed: ${error.message}`));
+      }, RESTART_DELAY_MS).unref();
+    });
+    worker.unref();
+  }
+
+  resetWorkerState(error) {
+    for (const { reject } of this.pendingCalls.values()) reject(error);
+    this.pendingCalls.clear();
+    for (const unsubscribe of this.audioSubscriptions.values()) unsubscribe();
+    this.audioSubscriptions.clear();
+    for (const socket of this.sockets.values()) {
+      try {
+        socket.close(1011, 'Transcription runtime restarting');
+      } catch { }
+    }
+    this.sockets.clear();
+    this.roomStatuses.clear();
+  }
+
+  post(message, transfer = []) {
+    if (this.worker) this.worker.postMessage(message, transfer);
+  }
+
+  call(method, args) {
+    if (!this.worker) return Promise.reject(new Error('Transcription worker is not running'));
+    const id = this.nextCallId++;
+    return new Promise((resolve, reject) => {
+      this.pendingCalls.set(id, { resolve, reject });
+      this.post({ type: 'call', id, method, args });
+    });
+  }
+
+  applyState({ rooms, metrics: snapshot }) {
+    this.roomStatuses = new Map(rooms);
+    this.metricsSnapshot = snapshot;
+  }
+
+  handleMessage(message) {
+    switch (message.type) {
+      case 'result': {
+        this.applyState(message.state);
+        const pending = this.pendingCalls.get(message.id);
+        this.pendingCalls.delete(message.id);
+        if (!pending) return;
+        if (message.error) {
+          const error = new Error(message.error.message);
+          if (message.error.code) error.code = message.error.code;
+          pending.reject(error);
+        } else {
+          pending.resolve(message.value);
+        }
+        return;
+      }
+      case 'state':
+        this.applyState(message.state);
+        return;
+      case 'log':
+        this.fastify.log[message.level]?.(...message.args);
+        return;
+      case 'metric':
+        metrics[message.name]?.[message.method]?.(...message.args);
+        return;
+      case 'subscribe-audio':
+        this.handleSubscribeAudio(message);
+        return;
+      case 'unsubscribe-audio': {
+        const unsubscribe = this.audioSubscriptions.get(message.subscriptionId);
+        this.audioSubscriptions.delete(message.subscriptionId);
+        if (unsubscribe) unsubscribe();
+        return;
+      }
+      case 'socket-send':
+        this.handleSocketSend(message);
+        return;
+      case 'socket-close':
+        try {
+          this.sockets.get(message.socketId)?.close();
+        } catch { }
+        return;
+      default:
+        this.fastify.log.warn(`Unknown transcription worker message ${message.type}`);
+    }
+  }
+
+  handleSubscribeAudio({ id, producerId }) {
+    const subscription = this.subscribeTrackAudio
+      ? this.subscribeTrackAudio(producerId, (packet, timestampMs) => {
+        const copy = new Uint8Array(packet);
+        this.post({ type: 'track-audio', subscriptionId: id, packet: copy, timestampMs }, [copy.buffer]);
+      })
+      : null;
+    if (subscription) this.audioSubscriptions.set(id, subscription.unsubscribe);
+    this.post({ type: 'audio-subscribed', id, channels: subscription ? subscription.channels : null });
+  }
+
+  handleSocketSend({ socketIds, data, binary }) {
+    for (const socketId of socketIds) {
+      const socket = this.sockets.get(socketId);
+      if (!socket || socket.readyState !== 1) continue;
+      if (socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) {
+        this.reportBuffered(socketId, socket);
+        continue;
+      }
+      try {
+        socket.send(data, { binary, compress: false });
+      } catch { }
+      if (socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) this.reportBuffered(socketId, socket);
+    }
+  }
+
+  // Let the worker see a backed-up socket (it skips it and resyncs later) until it drains
+  reportBuffered(socketId, socket) {
+    if (socket.bufferedWatch) return;
+    this.post({ type: 'socket-buffered', socketId, bufferedAmount: socket.bufferedAmount });
+    socket.bufferedWatch = setInterval(() => {
+      if (this.sockets.get(socketId) === socket && socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) return;
+      clearInterval(socket.bufferedWatch);
+      socket.bufferedWatch = null;
+      this.post({ type: 'socket-buffered', socketId, bufferedAmount: socket.bufferedAmount });
+    }, BUFFERED_RECHECK_MS);
+    socket.bufferedWatch.unref();
+  }
+
+  getRoomSession(roomId) {
+    return this.roomStatuses.get(roomId) || null;
+  }
+
+  getRoomTranscriptionStatus(roomId) {
+    return this.roomStatuses.get(roomId) || null;
+  }
+
+  getMetricsSnapshot() {
+    return this.metricsSnapshot;
+  }
+
+  registerWsRoute(fastifyInstance) {
+    fastifyInstance.register(async (app) => {
+      app.get('/ws/transcripts/:room_slug/:channel_name', { websocket: true }, (connection, req) => {
+        const socket = connection?.socket || connection;
+        if (!socket || typeof socket.send !== 'function' || typeof socket.on !== 'function') {
+          this.fastify.log.error('Transcript websocket connection is not a valid socket');
+          return;
+        }
+
+        const socketId = this.nextSocketId++;
+        this.sockets.set(socketId, socket);
+        socket.on('message', (message) => {
+          const data = new Uint8Array(Array.isArray(message) ? Buffer.concat(message) : message);
+          this.post({ type: 'socket-message', socketId, data }, [data.buffer]);
+        });
+        socket.on('close', () => {
+          if (this.sockets.get(socketId) !== socket) return;
+          this.sockets.delete(socketId);
+          this.post({ type: 'socket-closed', socketId });
+        });
+
+        // What parseTranscriptWsRequest() reads from the upgrade request
+        this.post({
+          type: 'socket-open',
+          socketId,
+          req: {
+            params: { ...req.params },
+            query: { ...req.query },
+            headers: { host: req.headers?.host },
+            url: req.url,
+            socket: { encrypted: Boolean(req.socket?.encrypted) }
+          }
+        });
+      });
+    });
+  }
+
+  async shutdown() {
+    this.shuttingDown = true;
+    if (!this.worker) return;
+    try {
+      await this.call('shutdown', []);
+    } catch (error) {
+      this.fastify.log.error(`Transcription worker shutdown failed: ${error.message}`);
+    }
+    const worker = this.worker;
+    this.worker = null;
+    this.resetWorkerState(new Error('Transcription worker stopped'));
+    await worker?.terminate();
+  }
+}
+
+export default TranscriptionRuntimeClient;
@@ -0,0 +1,222 @@
+import { parentPort, workerData } from 'worker_threads';
+import { EventEmitter } from 'events';
+import { attachDatabase } from '../db/database.js';
+import { verifyPublisherToken } from '../db/models/publisher.js';
+import { verifyTenantApiKey } from '../db/models/tenant.js';
+import { getRoomBySlug, getRoomById, listRoomsByTenant } from '../db/models/room.js';
+import { metrics } from '../metrics.js';
+import TranscriptionRuntime from './runtime.js';
+
+/**
+ * Transcription runtime thread (TRANSCRIPTION_RUNTIME=worker). Runs TranscriptionRuntime with
+ * its own DB connection, so segment scans, sidecar NDJSON parsing and Yjs transactions never
+ * run on the signaling event loop. runtime-client.js is the main-thread side.
+ *
+ * Messages in:
+ *   { type: 'call', id, method, args }
+ *   { type: 'segment-closed', segment }
+ *   { type: 'audio-subscribed', id, channels } | { type: 'track-audio', subscriptionId, packet, timestampMs }
+ *   { type: 'socket-open', socketId, req } | { type: 'socket-message', socketId, data }
+ *   { type: 'socket-buffered', socketId, bufferedAmount } | { type: 'socket-closed', socketId }
+ * Messages out:
+ *   { type: 'result', id, value, state } | { type: 'result', id, error: { message, code }, state }
+ *   { type: 'state', state } (STATE_INTERVAL_MS) | { type: 'log', level, args } | { type: 'metric', name, method, args }
+ *   { type: 'subscribe-audio', id, producerId } | { type: 'unsubscribe-audio', subscriptionId }
+ *   { type: 'socket-send', socketIds, data, binary } | { type: 'socket-close', socketId }
+ */
+const STATE_INTERVAL_MS = 1000;
+
+attachDatabase(workerData.dbPath);
+
+const log = {};
+for (const level of ['trace', 'debug', 'info', 'warn', 'error', 'fatal']) {
+  log[level] = (...args) => {
+    const message = { type: 'log', level, args: args.map((arg) => (arg instanceof Error ? arg.message : arg)) };
+    try {
+      parentPort.postMessage(message);
+    } catch {
+      // Not structured-cloneable (e.g. a socket in a log object); send it as text
+      parentPort.postMessage({ ...message, args: message.args.map((arg) => (typeof arg === 'string' ? arg : String(arg))) });
+    }
+  };
+}
+log.child = () => log;
+
+// Metrics live in the main thread's registry, which /metrics renders
+for (const [name, metric] of Object.entries(metrics)) {
+  for (const method of ['inc', 'set', 'observe']) {
+    if (typeof metric[method] !== 'function') continue;
+    metric[method] = (...args) => parentPort.postMessage({ type: 'metric', name, method, args });
+  }
+}
+
+const segmentEvents = workerData.segmentEvents ? new EventEmitter() : null;
+
+let nextRequestId = 1;
+const pendingAudioSubscriptions = new Map(); // id -> resolve
+const audioListeners = new Map(); // subscriptionId -> listener
+
+/**
+ * Same contract as recorder.subscribeTrackAudio(), answered by the main thread
+ * @returns {Promise<{ channels: number, unsubscribe: function }|null>}
+ */
+function subscribeTrackAudio(producerId, listener) {
+  const id = nextRequestId++;
+  return new Promise((resolve) => {
+    pendingAudioSubscriptions.set(id, resolve);
+    parentPort.postMessage({ type: 'subscribe-audio', id, producerId });
+  }).then(({ channels }) => {
+    if (channels === null) return null;
+    audioListeners.set(id, listener);
+    return {
+      channels,
+      unsubscribe: () => {
+        if (!audioListeners.delete(id)) return;
+        parentPort.postMessage({ type: 'unsubscribe-audio', subscriptionId: id });
+      }
+    };
+  });
+}
+
+/**
+ * Transcript websocket owned by the main thread. Sends made in one tick are grouped by frame,
+ * so a doc broadcast crosses the thread boundary once rather than once per viewer.
+ */
+class RelayedSocket extends EventEmitter {
+  constructor(id) {
+    super();
+    this.id = id;
+    this.readyState = 1;
+    this.bufferedAmount = 0; // reported by the main thread while its socket is backed up
+  }
+
+  send(data, options = {}) {
+    if (this.readyState !== 1) return;
+    queueSend(this, data, options.binary ?? typeof data !== 'string');
+  }
+
+  close() {
+    if (this.readyState >= 2) return;
+    this.readyState = 2;
+    parentPort.postMessage({ type: 'socket-close', socketId: this.id });
+  }
+}
+
+const sockets = new Map(); // socketId -> RelayedSocket
+let pendingSends = null; // frame -> { socketIds, binary }
+
+function queueSend(socket, data, binary) {
+  if (!pendingSends) {
+    pendingSends = new Map();
+    queueMicrotask(flushSends);
+  }
+  let entry = pendingSends.get(data);
+  if (!entry) {
+    entry = { socketIds: [], binary };
+    pendingSends.set(data, entry);
+  }
+  entry.socketIds.push(socket.id);
+}
+
+function flushSends() {
+  const sends = pendingSends;
+  pendingSends = null;
+  for (const [data, { socketIds, binary }] of sends) {
+    // Copy only the view: posting a Buffer slice would clone its whole backing pool
+    const frame = typeof data === 'string' ? data : new Uint8Array(data);
+    parentPort.postMessage({ type: 'socket-send', socketIds, data: frame, binary }, typeof frame === 'string' ? [] : [frame.buffer]);
+  }
+}
+
+const runtime = new TranscriptionRuntime({
+  fastify: { log },
+  verifyPublisherToken,
+  verifyTenantApiKey,
+  getRoomBySlug,
+  getRoomById,
+  listRoomsByTenant,
+  segmentEvents,
+  subscribeTrackAudio: workerData.trackAudio ? subscribeTrackAudio : null
+});
+
+// Mirrors what the main thread reads synchronously (getRoomTranscriptionStatus, getMetricsSnapshot)
+function snapshotState() {
+  const roomIds = new Set([...runtime.sessions.keys(), ...runtime.blockedSessions.keys()]);
+  const rooms = [];
+  for (const roomId of roomIds) {
+    const status = runtime.getRoomTranscriptionStatus(roomId);
+    if (status) rooms.push([roomId, status]);
+  }
+  return { rooms, metrics: runtime.getMetricsSnapshot() };
+}
+
+setInterval(() => {
+  parentPort.postMessage({ type: 'state', state: snapshotState() });
+}, STATE_INTERVAL_MS).unref();
+
+async function handleCall({ id, method, args }) {
+  try {
+    if (typeof runtime[method] !== 'function') throw new Error(`Unknown runtime method ${method}`);
+    const value = await runtime[method](...(args || []));
+    parentPort.postMessage({ type: 'result', id, value: value ?? null, state: snapshotState() });
+  } catch (error) {
+    parentPort.postMessage({
+      type: 'result',
+      id,
+      error: { message: error.message, code: error.code },
+      state: snapshotState()
+    });
+  }
+}
+
+parentPort.on('message', (message) => {
+  switch (message.type) {
+    case 'call':
+      handleCall(message);
+      break;
+    case 'segment-closed':
+      segmentEvents?.emit('segment-closed', message.segment);
+      break;
+    case 'audio-subscribed': {
+      const resolve = pendingAudioSubscriptions.get(message.id);
+      pendingAudioSubscriptions.delete(message.id);
+      if (resolve) resolve({ channels: message.channels });
+      break;
+    }
+    case 'track-audio': {
+      const listener = audioListeners.get(message.subscriptionId);
+      if (listener) listener(Buffer.from(message.packet.buffer, message.packet.byteOffset, message.packet.byteLength), message.timestampMs);
+      break;
+    }
+    case 'socket-open': {
+      const socket = new RelayedSocket(message.socketId);
+      sockets.set(message.socketId, socket);
+      runtime.handleTranscriptSocket(socket, message.req).catch((error) => {
+        log.error(`Transcript websocket failed: ${error.message}`);
+        socket.close();
+      });
+      break;
+    }
+    case 'socket-message': {
+      const socket = sockets.get(message.socketId);
+      if (socket) socket.emit('message', Buffer.from(message.data.buffer, message.data.byteOffset, message.data.byteLength));
+      break;
+    }
+    case 'socket-buffered': {
+      const socket = sockets.get(message.socketId);
+      if (socket) socket.bufferedAmount = message.bufferedAmount;
+      break;
+    }
+    case 'socket-closed': {
+      const socket = sockets.get(message.socketId);
+      sockets.delete(message.socketId);
+      if (socket) {
+        socket.readyState = 3;
+        socket.emit('close');
+      }
+      break;
+    }
+    default:
+      log.warn(`Unknown transcription worker message ${message.type}`);
+  }
+});
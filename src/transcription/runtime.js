@@ -13,15 +13,22 @@ import {
   getActiveTranscriptionStreamsBySession,
   stopTranscriptionStream,
   stopAllTranscriptionStreamsBySession,
-  createTranscriptSegment,
+  queueTranscriptSegment,
+  queueTranscriptDocUpdate,
+  compactTranscriptDoc,
+  listTranscriptDocUpdates,
+  flushTranscriptWrites,
   listTranscriptDocsByRoom,
   listTranscriptDocsBySession,
   getTranscriptDocByRoomChannel,
   getTranscriptDocBySessionChannel,
-  getLatestTranscriptDocByRoomEventChannel,
-  upsertTranscriptDoc
+  getLatestTranscriptDocByRoomEventChannel
 } from '../db/models/transcription.js';
 import { getRecordingById } from '../db/models/recording.js';
+import { flushDbWrites } from '../db/writer.js';
+import SidecarIngestProvider from './sidecar-ingest.js';
+import SidecarScheduler from './scheduler.js';
+import { metrics } from '../metrics.js';
 
 const DEFAULT_MODEL = process.env.TRANSCRIPTION_MODEL || 'mlx-community/Qwen3-ASR-0.6B-8bit';
 const SIDECAR_HOST = process.env.TRANSCRIPTION_SIDECAR_HOST || '127.0.0.1';
@@ -38,13 +45,39 @@ const FINALIZED_SEGMENT_MIN_AGE_MS = parseInt(
   process.env.TRANSCRIPTION_FINALIZED_SEGMENT_MIN_AGE_MS || String((RECORDING_SEGMENT_SECONDS + 1) * 1000),
   10
 );
+// Concurrent transcription requests per sidecar, and queued segments per stream before the oldest is dropped
+// Pooled sidecars batch concurrent requests, so they get more in flight by default
+const MAX_INFLIGHT_PER_SIDECAR = parseInt(
+  process.env.TRANSCRIPTION_MAX_INFLIGHT_PER_SIDECAR || (process.env.TRANSCRIPTION_SIDECAR_MODE === 'pooled' ? '8' : '1'),
+  10
+);
+const MAX_STREAM_BACKLOG = parseInt(process.env.TRANSCRIPTION_MAX_STREAM_BACKLOG || '3', 10);
 const SNAPSHOT_DEBOUNCE_MS = parseInt(process.env.TRANSCRIPTION_SNAPSHOT_DEBOUNCE_MS || '300', 10);
+// Doc edits are persisted as Yjs update deltas; the log is compacted into one state update
+// (plus a text snapshot) once it holds this many updates or bytes, and on session stop.
+const DOC_COMPACT_UPDATES = parseInt(process.env.TRANSCRIPTION_DOC_COMPACT_UPDATES || '500', 10);
+// Doc updates are merged over a short window and encoded once per window for all viewers. A
+// viewer whose socket buffers more than the limit is skipped and resynced with full state later.
+const DOC_BROADCAST_WINDOW_MS = parseInt(process.env.TRANSCRIPT_BROADCAST_WINDOW_MS || '50', 10);
+const DOC_SOCKET_MAX_BUFFERED_BYTES = parseInt(process.env.TRANSCRIPT_SOCKET_MAX_BUFFERED_BYTES || String(1024 * 1024), 10);
+// How often skipped viewers are checked for having drained, so they resync without waiting for an edit
+const DOC_RESYNC_RECHECK_MS = 100;
+const DOC_COMPACT_BYTES = parseInt(process.env.TRANSCRIPTION_DOC_COMPACT_BYTES || String(256 * 1024), 10);
 const RECORDING_DIR = process.env.RECORDING_DIR || path.join(process.cwd(), 'recordings');
 const AVAILABILITY_CACHE_MS = 15000;
 const TRANSCRIPTION_LOCK_VERSION = 1;
 const TRANSCRIPTION_LOCK_FILENAME = 'transcription.lock.json';
 const TRANSCRIPTION_LANGUAGE = (process.env.TRANSCRIPTION_LANGUAGE || '').trim();
-const SIDECAR_MODE = 'per-channel';
+// 'per-channel' spawns one sidecar (one model copy) per room channel; 'pooled' shares
+// TRANSCRIPTION_SIDECAR_POOL_SIZE batching sidecars across every channel and room
+const SIDECAR_MODE = process.env.TRANSCRIPTION_SIDECAR_MODE === 'pooled' ? 'pooled' : 'per-channel';
+// Preloaded sidecars kept ready with no channel assigned. While the pool is enabled, released
+// sidecars are parked too, and parked ones beyond the pool size are reclaimed after the idle timeout.
+const WARM_POOL_SIZE = Math.max(0, parseInt(process.env.TRANSCRIPTION_WARM_POOL_SIZE || '0', 10));
+const WARM_IDLE_TIMEOUT_MS = parseInt(process.env.TRANSCRIPTION_WARM_IDLE_TIMEOUT_MS || '300000', 10);
+const SIDECAR_POOL_SIZE = Math.max(1, parseInt(process.env.TRANSCRIPTION_SIDECAR_POOL_SIZE || '1', 10));
+// 'segments' transcribes closed Ogg segments; 'stream' feeds live Opus packets to the sidecar ingest socket
+const TRANSCRIPTION_INGEST_MODE = process.env.TRANSCRIPTION_INGEST_MODE === 'stream' ? 'stream' : 'segments';
 
 function nowIso() {
   return new Date().toISOString();
@@ -58,14 +91,29 @@ function buildSegmentMatcher(segmentPattern) {
   if (!segmentPattern) return null;
   const dir = path.dirname(segmentPattern);
   const filePattern = path.basename(segmentPattern);
-  const regexSource = '^' + escapeRegex(filePattern).replace('%03d', '(\\d{3})') + '$';
+  // %03d pads to 3 digits; segment 1000 and later are wider
+  const regexSource = '^' + escapeRegex(filePattern).replace('%03d', '(\\d{3,})') + '$';
   return { dir, regex: new RegExp(regexSource), pattern: segmentPattern };
 }
 
-function parseTimestampStartMs(filename) {
-  const match = filename.match(/_(\d{3})\.ogg$/);
+function parseSegmentIndex(filename) {
+  const match = filename.match(/_(\d{3,})\.ogg$/);
   if (!match) return null;
-  return parseInt(match[1], 10) * 1000;
+  return parseInt(match[1], 10);
+}
+
+// Segment order by index; names alone misorder once the index outgrows the %03d padding
+function compareSegmentFilenames(a, b) {
+  const indexA = parseSegmentIndex(a);
+  const indexB = parseSegmentIndex(b);
+  if (indexA === null || indexB === null || indexA === indexB) return a.localeCompare(b);
+  return indexA - indexB;
+}
+
+function parseTimestampStartMs(filename) {
+  const index = parseSegmentIndex(filename);
+  if (index === null) return null;
+  return index * RECORDING_SEGMENT_SECONDS * 1000;
 }
 
 function sanitizeTranscriptText(input) {
@@ -155,7 +203,7 @@ function atomicWriteJson(filePath, data) {
 }
 
 class TranscriptDocState {
-  constructor({ roomId, roomSlug, channelName, sessionId, initialText = '', initialRevision = 0 }) {
+  constructor({ roomId, roomSlug, channelName, sessionId, initialUpdates = [], initialText = '', initialRevision = 0 }) {
     this.roomId = roomId;
     this.roomSlug = roomSlug;
     this.channelName = channelName;
@@ -165,16 +213,59 @@ class TranscriptDocState {
     this.clients = new Set();
     this.persistTimer = null;
     this.persistInFlight = false;
+    this.updatesSinceCompaction = 0;
+    this.bytesSinceCompaction = 0;
+    this.pendingBroadcast = []; // { update, origin } merged on the next broadcast flush
+    this.broadcastTimer = null;
+    this.staleClients = new Set(); // sockets that skipped updates and need a full-state resync
+    this.resyncTimer = null; // rechecks staleClients until they have all drained
 
     this.ytext = this.ydoc.getText('transcript');
-    if (initialText) {
+    if (initialUpdates.length > 0) {
+      for (const update of initialUpdates) {
+        Y.applyUpdate(this.ydoc, update, 'load');
+      }
+    } else if (initialText) {
       this.ytext.insert(0, initialText);
     }
+    // Seeded from text (new session or pre-update-log row): the log must start from a snapshot
+    this.needsCompaction = initialUpdates.length === 0 && this.ytext.length > 0;
+
+    // Last character, kept current from each change's delta so appends never stringify the doc.
+    // null means unknown (text was deleted at the end) and is recomputed on demand.
+    const current = this.ytext.toString();
+    this.tail = current.slice(-1);
+    this.ytext.observe((event) => {
+      const length = this.ytext.length;
+      if (length === 0) {
+        this.tail = '';
+        return;
+      }
+      let index = 0;
+      for (const op of event.delta) {
+        if (op.retain) {
+          index += op.retain;
+        } else if (op.insert) {
+          const inserted = typeof op.insert === 'string' ? op.insert : '';
+          index += inserted.length;
+          if (index === length && inserted) this.tail = inserted.slice(-1);
+        } else if (op.delete && index === length) {
+          this.tail = null;
+        }
+      }
+    });
+  }
+
+  getTail() {
+    if (this.tail === null) {
+      this.tail = this.ytext.toString().slice(-1);
+    }
+    return this.tail;
   }
 }
 
 export class TranscriptionRuntime {
-  constructor({ fastify, verifyPublisherToken, verifyTenantApiKey, getRoomBySlug, getRoomById, listRoomsByTenant }) {
+  constructor({ fastify, verifyPublisherToken, verifyTenantApiKey, getRoomBySlug, getRoomById, listRoomsByTenant, segmentEvents = null, subscribeTrackAudio = null }) {
     this.fastify = fastify;
     this.verifyPublisherToken = verifyPublisherToken;
     this.verifyTenantApiKey = verifyTenantApiKey;
@@ -189,9 +280,26 @@ export class TranscriptionRuntime {
     this.channelAssignments = new Map(); // roomId::channelName -> instanceId
     this.channelUsageCounts = new Map(); // roomId::channelName -> active stream count
     this.nextInstanceId = 1;
+    this.pendingPoolSpawn = null; // in-flight pooled sidecar spawn
+    this.warmSpawning = null; // in-flight warm pool spawn
+    this.shuttingDown = false;
 
     this.lastAvailabilityCheckAt = 0;
     this.lastAvailability = null;
+    this.scheduler = new SidecarScheduler({ maxInFlightPerSidecar: MAX_INFLIGHT_PER_SIDECAR });
+
+    // With recorder 'segment-closed' events, segments are transcribed as soon as they are
+    // final; the directory is only scanned once per stream to catch up on older segments.
+    this.segmentEvents = segmentEvents;
+    if (segmentEvents) {
+      segmentEvents.on('segment-closed', (segment) => this.handleSegmentClosed(segment));
+    }
+
+    // Streaming ingest needs live packets from the recorder; streams fall back to segments without them
+    this.subscribeTrackAudio = subscribeTrackAudio;
+    this.ingestProvider = TRANSCRIPTION_INGEST_MODE === 'stream' && subscribeTrackAudio
+      ? new SidecarIngestProvider({ log: fastify.log })
+      : null;
   }
 
   get isMacAppleSilicon() {
@@ -207,12 +315,12 @@ export class TranscriptionRuntime {
   }
 
   countRoomSidecars(roomId) {
-    let count = 0;
+    const instanceIds = new Set();
     const prefix = `${roomId}::`;
-    for (const key of this.channelAssignments.keys()) {
-      if (key.startsWith(prefix)) count += 1;
+    for (const [key, instanceId] of this.channelAssignments) {
+      if (key.startsWith(prefix)) instanceIds.add(instanceId);
     }
-    return count;
+    return instanceIds.size;
   }
 
   getLockPathFromFolder(recordingFolderPath) {
@@ -370,7 +478,7 @@ export class TranscriptionRuntime {
     return null;
   }
 
-  async spawnSidecarInstance({ roomId, roomSlug, channelName, modelName, preferredPort = null }) {
+  async spawnSidecarInstance({ roomId, roomSlug, channelName, modelName, preferredPort = null, pooled = false, warm = false }) {
     const port = this.findFreePort(preferredPort);
     if (!port) {
       const error = new Error('ASR sidecar capacity exceeded');
@@ -379,8 +487,10 @@ export class TranscriptionRuntime {
     }
 
     const instanceId = `asr-${this.nextInstanceId++}`;
-    const roomLabel = sanitizeLabel(roomSlug || `room-${roomId}`, `room-${roomId}`);
-    const channelLabel = sanitizeLabel(channelName, 'channel');
+    const spawnStartedAt = Date.now();
+    const shared = pooled || warm;
+    const roomLabel = shared ? (pooled ? 'pool' : 'warm') : sanitizeLabel(roomSlug || `room-${roomId}`, `room-${roomId}`);
+    const channelLabel = shared ? instanceId : sanitizeLabel(channelName, 'channel');
     const logBase = `${SIDECAR_LOG_PREFIX}-${roomLabel}-${channelLabel}-${port}`;
     const outPath = `${logBase}.out.log`;
     const errPath = `${logBase}.err.log`;
@@ -393,6 +503,8 @@ export class TranscriptionRuntime {
         ...process.env,
         PORT: String(port),
         ASR_MODEL_ID: modelName || DEFAULT_MODEL,
+        ASR_BATCHING: pooled ? '1' : '0',
+        ASR_PRELOAD: '1',
         ...(process.env.TRANSCRIPTION_PYTHON_BIN ? { PYTHON_BIN: process.env.TRANSCRIPTION_PYTHON_BIN } : {})
       },
       stdio: ['ignore', outFd, errFd]
@@ -406,6 +518,11 @@ export class TranscriptionRuntime {
       roomSlug,
       channelName,
       modelName: modelName || DEFAULT_MODEL,
+      pooled,
+      warm,
+      ready: false,
+      readyLatencyMs: null,
+      idleTimer: null,
       port,
       url,
       process: child,
@@ -437,6 +554,8 @@ export class TranscriptionRuntime {
       this.shutdownSidecarInstance(instanceId, { force: true, removeAssignment: true });
       throw error;
     }
+    instance.ready = true;
+    instance.readyLatencyMs = Date.now() - spawnStartedAt;
 
     this.fastify.log.info({
       instanceId,
@@ -444,7 +563,9 @@ export class TranscriptionRuntime {
       roomSlug,
       channelName,
       port,
-      mode: SIDECAR_MODE
+      mode: SIDECAR_MODE,
+      warm,
+      readyLatencyMs: instance.readyLatencyMs
     }, 'ASR sidecar instance ready');
 
     return instance;
@@ -459,19 +580,40 @@ export class TranscriptionRuntime {
       this.channelAssignments.delete(channelKey);
     }
 
-    if (this.sidecarInstances.size >= MAX_SIDECAR_INSTANCES) {
-      const error = new Error('ASR sidecar capacity exceeded');
-      error.code = 'SIDECAR_CAPACITY_EXCEEDED';
-      throw error;
+    if (SIDECAR_MODE === 'pooled') {
+      const instance = await this.ensurePooledSidecar({ modelName, preferredPort });
+      this.channelAssignments.set(channelKey, instance.id);
+      this.fastify.log.info({
+        roomId,
+        roomSlug,
+        channelName,
+        instanceId: instance.id,
+        port: instance.port
+      }, 'Assigned pooled ASR sidecar to channel');
+      return instance;
     }
 
-    const instance = await this.spawnSidecarInstance({
-      roomId,
-      roomSlug,
-      channelName,
-      modelName,
-      preferredPort
-    });
+    let instance = this.takeWarmSidecar(modelName);
+    if (instance) {
+      instance.roomId = roomId;
+      instance.roomSlug = roomSlug;
+      instance.channelName = channelName;
+    } else {
+      this.evictWarmSidecarForCapacity();
+      if (this.sidecarInstances.size >= MAX_SIDECAR_INSTANCES) {
+        const error = new Error('ASR sidecar capacity exceeded');
+        error.code = 'SIDECAR_CAPACITY_EXCEEDED';
+        throw error;
+      }
+
+      instance = await this.spawnSidecarInstance({
+        roomId,
+        roomSlug,
+        channelName,
+        modelName,
+        preferredPort
+      });
+    }
     this.channelAssignments.set(channelKey, instance.id);
     this.fastify.log.info({
       roomId,
@@ -483,6 +625,48 @@ export class TranscriptionRuntime {
     return instance;
   }
 
+  /**
+   * Least-referenced pooled sidecar for `modelName`, spawning one while the pool is below
+   * SIDECAR_POOL_SIZE. Spawns are serialized so concurrent channels never overfill the pool.
+   */
+  async ensurePooledSidecar({ modelName, preferredPort = null }) {
+    const model = modelName || DEFAULT_MODEL;
+    while (this.pendingPoolSpawn) {
+      await this.pendingPoolSpawn.catch(() => {});
+    }
+
+    const members = Array.from(this.sidecarInstances.values())
+      .filter((instance) => instance.pooled && !instance.warm && instance.modelName === model);
+    if (members.length < SIDECAR_POOL_SIZE) {
+      // Warm sidecars are spawned with batching on in pooled mode, so they can join the pool as-is
+      const warmInstance = this.takeWarmSidecar(model);
+      if (warmInstance) return warmInstance;
+      this.evictWarmSidecarForCapacity();
+    }
+    if (members.length < SIDECAR_POOL_SIZE && this.sidecarInstances.size < MAX_SIDECAR_INSTANCES) {
+      this.pendingPoolSpawn = this.spawnSidecarInstance({
+        roomId: null,
+        roomSlug: null,
+        channelName: null,
+        modelName: model,
+        preferredPort,
+        pooled: true
+      });
+      try {
+        return await this.pendingPoolSpawn;
+      } finally {
+        this.pendingPoolSpawn = null;
+      }
+    }
+
+    if (members.length === 0) {
+      const error = new Error('ASR sidecar capacity exceeded');
+      error.code = 'SIDECAR_CAPACITY_EXCEEDED';
+      throw error;
+    }
+    return members.reduce((best, instance) => (instance.refs < best.refs ? instance : best));
+  }
+
   async acquireChannelAssignment(session, channelName, options = {}) {
     const channelKey = this.makeChannelKey(session.roomId, channelName);
     const instance = await this.ensureChannelSidecar({
@@ -521,6 +705,21 @@ export class TranscriptionRuntime {
 
     if (currentCount <= 1) {
       this.channelUsageCounts.delete(channelKey);
+      if (instance?.pooled) {
+        // Other channels may still share it; stop only once nothing references it
+        this.channelAssignments.delete(channelKey);
+        if (instance.refs === 0 && WARM_POOL_SIZE > 0) {
+          this.parkSidecar(instance);
+        } else {
+          this.shutdownSidecarInstance(instanceId);
+        }
+        return;
+      }
+      if (instance && WARM_POOL_SIZE > 0) {
+        this.channelAssignments.delete(channelKey);
+        this.parkSidecar(instance);
+        return;
+      }
       this.shutdownSidecarInstance(instanceId, { force: true, removeAssignment: true });
       return;
     }
@@ -538,24 +737,44 @@ export class TranscriptionRuntime {
     }
 
     const instance = this.sidecarInstances.get(instanceId) || null;
+    if (instance?.pooled) {
+      // Detach the channel without killing a sidecar other channels share
+      instance.refs = Math.max(0, instance.refs - (this.channelUsageCounts.get(channelKey) || 0));
+      this.channelAssignments.delete(channelKey);
+      this.channelUsageCounts.delete(channelKey);
+      return instance;
+    }
     this.shutdownSidecarInstance(instanceId, { force: true, removeAssignment: true });
     return instance;
   }
 
+  /**
+   * Channel keys (roomId::channelName) currently routed to a sidecar instance.
+   */
+  getInstanceChannelKeys(instanceId) {
+    const keys = [];
+    for (const [channelKey, mappedInstanceId] of this.channelAssignments) {
+      if (mappedInstanceId === instanceId) keys.push(channelKey);
+    }
+    return keys;
+  }
+
   shutdownSidecarInstance(instanceId, { force = false, removeAssignment = false } = {}) {
     const instance = this.sidecarInstances.get(instanceId);
     if (!instance) return;
 
     if (!force && instance.refs > 0) return;
 
+    if (instance.idleTimer) {
+      clearTimeout(instance.idleTimer);
+      instance.idleTimer = null;
+    }
     this.sidecarInstances.delete(instanceId);
     if (removeAssignment) {
-      const channelKey = this.makeChannelKey(instance.roomId, instance.channelName);
-      const mappedInstanceId = this.channelAssignments.get(channelKey);
-      if (mappedInstanceId === instanceId) {
+      for (const channelKey of this.getInstanceChannelKeys(instanceId)) {
         this.channelAssignments.delete(channelKey);
+        this.channelUsageCounts.delete(channelKey);
       }
-      this.channelUsageCounts.delete(channelKey);
     }
 
     if (instance.process && !instance.process.killed) {
@@ -574,27 +793,137 @@ export class TranscriptionRuntime {
   }
 
   handleSidecarCrash(instance) {
-    const channelKey = this.makeChannelKey(instance.roomId, instance.channelName);
-    const mappedInstance = this.channelAssignments.get(channelKey);
-    if (mappedInstance === instance.id) {
+    // A pooled sidecar serves many rooms; collect every channel it was routing
+    const affected = new Map(); // roomId -> Set(channelName)
+    for (const channelKey of this.getInstanceChannelKeys(instance.id)) {
+      const separator = channelKey.indexOf('::');
+      const roomId = parseInt(channelKey.slice(0, separator), 10);
+      const channelName = channelKey.slice(separator + 2);
+      if (!affected.has(roomId)) affected.set(roomId, new Set());
+      affected.get(roomId).add(channelName);
       this.channelAssignments.delete(channelKey);
       this.channelUsageCounts.delete(channelKey);
     }
     this.sidecarInstances.delete(instance.id);
 
-    const session = this.sessions.get(instance.roomId);
-    if (!session) return;
-    if (session.stopping) return;
+    for (const [roomId, channelNames] of affected) {
+      const session = this.sessions.get(roomId);
+      if (!session) continue;
+      if (session.stopping) continue;
+
+      const hasAffectedStream = Array.from(session.streams.values())
+        .some((stream) => channelNames.has(stream.channelName));
+      if (!hasAffectedStream) continue;
+
+      this.stopRoomSession(roomId, 'error', 'sidecar_instance_crashed').catch((error) => {
+        this.fastify.log.error(`Failed to stop transcription session after sidecar crash: ${error.message}`);
+      });
+    }
+    this.replenishWarmPool();
+  }
+
+  countWarmSidecars() {
+    let count = 0;
+    for (const instance of this.sidecarInstances.values()) {
+      if (instance.warm) count += 1;
+    }
+    return count;
+  }
 
-    const hasAffectedStream = Array.from(session.streams.values())
-      .some((stream) => stream.channelName === instance.channelName);
-    if (!hasAffectedStream) return;
+  /**
+   * Spawn preloaded sidecars until WARM_POOL_SIZE are idle and ready. One spawn at a time.
+   */
+  startWarmPool() {
+    if (WARM_POOL_SIZE <= 0) return;
+    this.checkAvailability().then((availability) => {
+      if (availability.ok) this.replenishWarmPool();
+    }).catch(() => {});
+  }
 
-    this.stopRoomSession(instance.roomId, 'error', 'sidecar_instance_crashed').catch((error) => {
-      this.fastify.log.error(`Failed to stop transcription session after sidecar crash: ${error.message}`);
+  replenishWarmPool() {
+    if (WARM_POOL_SIZE <= 0 || this.warmSpawning || this.shuttingDown) return;
+    if (this.countWarmSidecars() >= WARM_POOL_SIZE) return;
+    if (this.sidecarInstances.size >= MAX_SIDECAR_INSTANCES) return;
+
+    this.warmSpawning = this.spawnSidecarInstance({
+      roomId: null,
+      roomSlug: null,
+      channelName: null,
+      modelName: DEFAULT_MODEL,
+      pooled: SIDECAR_MODE === 'pooled',
+      warm: true
+    }).then((instance) => {
+      this.warmSpawning = null;
+      if (this.shuttingDown) {
+        this.shutdownSidecarInstance(instance.id, { force: true });
+        return;
+      }
+      this.replenishWarmPool();
+    }).catch((error) => {
+      // Not retried here; the next take, release or crash tops the pool up again
+      this.warmSpawning = null;
+      this.fastify.log.warn(`Failed to spawn warm ASR sidecar: ${error.message}`);
     });
   }
 
+  /**
+   * Claim a ready idle sidecar for `modelName`, then top the warm pool back up.
+   */
+  takeWarmSidecar(modelName) {
+    const model = modelName || DEFAULT_MODEL;
+    for (const instance of this.sidecarInstances.values()) {
+      if (!instance.warm || !instance.ready || instance.modelName !== model) continue;
+      if (instance.pooled !== (SIDECAR_MODE === 'pooled')) continue;
+      if (instance.idleTimer) {
+        clearTimeout(instance.idleTimer);
+        instance.idleTimer = null;
+      }
+      instance.warm = false;
+      this.fastify.log.info({ instanceId: instance.id, port: instance.port }, 'Using warm ASR sidecar');
+      setImmediate(() => this.replenishWarmPool());
+      return instance;
+    }
+    return null;
+  }
+
+  /**
+   * Keep a released sidecar loaded for reuse; reclaim it after WARM_IDLE_TIMEOUT_MS
+   * unless it is needed to keep the warm pool at WARM_POOL_SIZE.
+   */
+  parkSidecar(instance) {
+    instance.warm = true;
+    instance.refs = 0;
+    instance.roomId = null;
+    instance.roomSlug = null;
+    instance.channelName = null;
+    if (instance.idleTimer) clearTimeout(instance.idleTimer);
+    instance.idleTimer = null;
+    if (WARM_IDLE_TIMEOUT_MS > 0) {
+      instance.idleTimer = setTimeout(() => {
+        instance.idleTimer = null;
+        if (!instance.warm || !this.sidecarInstances.has(instance.id)) return;
+        if (this.countWarmSidecars() > WARM_POOL_SIZE) {
+          this.shutdownSidecarInstance(instance.id, { force: true });
+        }
+      }, WARM_IDLE_TIMEOUT_MS);
+      instance.idleTimer.unref?.();
+    }
+    this.fastify.log.info({ instanceId: instance.id, port: instance.port }, 'Parked ASR sidecar in warm pool');
+  }
+
+  /**
+   * Free a slot held by an idle warm sidecar when capacity is the only thing blocking a spawn.
+   */
+  evictWarmSidecarForCapacity() {
+    if (this.sidecarInstances.size < MAX_SIDECAR_INSTANCES) return;
+    for (const instance of this.sidecarInstances.values()) {
+      if (instance.warm) {
+        this.shutdownSidecarInstance(instance.id, { force: true });
+        return;
+      }
+    }
+  }
+
   getRoomSession(roomId) {
     return this.sessions.get(roomId) || null;
   }
@@ -697,17 +1026,55 @@ export class TranscriptionRuntime {
 
       this.sessions.set(room.id, sessionState);
       this.persistSessionLock(sessionState, 'active');
-      sessionState.pollTimer = setInterval(() => {
-        this.pollRoomSession(sessionState).catch((error) => {
-          this.fastify.log.error(`Transcription poll failed for room ${room.slug}: ${error.message}`);
-        });
-      }, POLL_INTERVAL_MS);
+      this.startSessionPolling(sessionState);
       result.recovered += 1;
       this.fastify.log.info({ transcriptionSessionId: dbSession.id, roomId: room.id, recovered: true }, 'Transcription session recovered');
     }
     return result;
   }
 
+  /**
+   * Totals across active sessions for the /metrics collector
+   */
+  getMetricsSnapshot() {
+    let queueDepth = 0;
+    for (const session of this.sessions.values()) {
+      for (const stream of session.streams.values()) {
+        queueDepth += stream.segmentQueue.length;
+      }
+    }
+    return { sessions: this.sessions.size, queueDepth, inFlight: this.scheduler.getStats().inFlight };
+  }
+
+  getSessionQueueStats(session) {
+    let queueDepth = 0;
+    let droppedSegments = 0;
+    const streamQueues = [];
+    for (const stream of session.streams.values()) {
+      queueDepth += stream.segmentQueue.length;
+      droppedSegments += stream.droppedSegments;
+      streamQueues.push({
+        producerId: stream.producerId,
+        channelName: stream.channelName,
+        queueDepth: stream.segmentQueue.length,
+        droppedSegments: stream.droppedSegments,
+        sidecarInFlight: this.scheduler.getInFlight(stream.sidecarInstanceId),
+        streaming: Boolean(stream.ingest)
+      });
+    }
+    return { queueDepth, droppedSegments, streamQueues };
+  }
+
+  startSessionPolling(session) {
+    // Push mode: registerProducerStream() already scheduled the catch-up scans
+    if (this.segmentEvents) return;
+    session.pollTimer = setInterval(() => {
+      this.pollRoomSession(session).catch((error) => {
+        this.fastify.log.error(`Transcription poll failed for room ${session.roomSlug}: ${error.message}`);
+      });
+    }, POLL_INTERVAL_MS);
+  }
+
   getRoomTranscriptionStatus(roomId) {
     const blocked = this.blockedSessions.get(roomId);
     if (blocked) {
@@ -748,6 +1115,9 @@ export class TranscriptionRuntime {
       sidecarInstanceCount: this.countRoomSidecars(roomId),
       sidecarCapacity: MAX_SIDECAR_INSTANCES,
       sidecarOverflow: Boolean(activeSession.sidecarOverflow),
+      startLatencyMs: activeSession.startLatencyMs ?? null,
+      warmSidecarCount: this.countWarmSidecars(),
+      ...this.getSessionQueueStats(activeSession),
       unavailable: false
     };
   }
@@ -765,13 +1135,15 @@ export class TranscriptionRuntime {
       return this.getRoomTranscriptionStatus(roomId);
     }
     this.blockedSessions.delete(roomId);
+    const startRequestedAt = Date.now();
 
     const channelSet = new Set();
     for (const track of initialTracks) {
       if (track?.channelName) channelSet.add(track.channelName);
     }
-    const availableSlots = Math.max(0, MAX_SIDECAR_INSTANCES - this.sidecarInstances.size);
-    if (channelSet.size > availableSlots) {
+    // Idle warm sidecars are handed out or evicted, so they count as free slots
+    const availableSlots = Math.max(0, MAX_SIDECAR_INSTANCES - this.sidecarInstances.size + this.countWarmSidecars());
+    if (SIDECAR_MODE === 'per-channel' && channelSet.size > availableSlots) {
       const error = new Error(`sidecar_capacity_exceeded: requires ${channelSet.size} channels, available ${availableSlots}, capacity ${MAX_SIDECAR_INSTANCES}`);
       error.code = 'SIDECAR_CAPACITY_EXCEEDED';
       throw error;
@@ -800,6 +1172,7 @@ export class TranscriptionRuntime {
       recovered: false,
       lockPersistTimer: null,
       sidecarOverflow: false,
+      startLatencyMs: null,
       streams: new Map() // producerId -> streamState
     };
 
@@ -808,6 +1181,13 @@ export class TranscriptionRuntime {
       for (const track of initialTracks) {
         await this.registerProducerStream(roomId, track, sessionState);
       }
+      // Time until every initial channel had a ready sidecar (warm pool hits are near zero)
+      sessionState.startLatencyMs = Date.now() - startRequestedAt;
+      this.fastify.log.info({
+        roomId,
+        transcriptionSessionId: sessionState.sessionId,
+        startLatencyMs: sessionState.startLatencyMs
+      }, 'Transcription session started');
       this.persistSessionLock(sessionState, 'active');
     } catch (error) {
       this.releaseSessionChannels(sessionState);
@@ -817,13 +1197,10 @@ export class TranscriptionRuntime {
       throw error;
     }
 
-    sessionState.pollTimer = setInterval(() => {
-      this.pollRoomSession(sessionState).catch((error) => {
-        this.fastify.log.error(`Transcription poll failed for room ${roomSlug}: ${error.message}`);
-      });
-    }, POLL_INTERVAL_MS);
-
-    await this.pollRoomSession(sessionState);
+    this.startSessionPolling(sessionState);
+    if (!this.segmentEvents) {
+      await this.pollRoomSession(sessionState);
+    }
     return this.getRoomTranscriptionStatus(roomId);
   }
 
@@ -842,6 +1219,8 @@ export class TranscriptionRuntime {
       session.lockPersistTimer = null;
     }
 
+    // Let the sidecar flush each stream's last utterance before docs are persisted
+    await Promise.all(Array.from(session.streams.values()).map((stream) => this.stopStreamIngest(stream)));
     for (const [producerId] of session.streams) {
       stopTranscriptionStream(session.sessionId, producerId, status);
     }
@@ -854,6 +1233,7 @@ export class TranscriptionRuntime {
       if (docState.roomId !== roomId) continue;
       if (docState.sessionId !== session.sessionId) continue;
       await this.persistDocSnapshot(docState);
+      this.flushDocBroadcast(docState);
       for (const socket of docState.clients) {
         try {
           socket.close();
@@ -861,6 +1241,9 @@ export class TranscriptionRuntime {
       }
       this.docs.delete(docKey);
     }
+    // A follow-up session for the same event seeds from these rows
+    this.flushPendingWrites();
+    await flushDbWrites();
     this.persistSessionLock(session, status);
     this.removeSessionLockByFolder(session.recordingFolderPath);
 
@@ -930,6 +1313,9 @@ export class TranscriptionRuntime {
     if (!session || !trackInfo) return null;
 
     const existingStream = session.streams.get(trackInfo.producerId);
+    if (existingStream) {
+      this.stopStreamIngest(existingStream);
+    }
     if (existingStream && !trackInfo.skipExistingRelease) {
       if (existingStream.channelName) {
         this.releaseChannelAssignment(session.roomId, existingStream.channelName);
@@ -971,12 +1357,29 @@ export class TranscriptionRuntime {
       segmentPattern: trackInfo.segmentPattern || null,
       matcher,
       processedFiles: new Set(Array.isArray(trackInfo.processedFiles) ? trackInfo.processedFiles : []),
+      segmentQueue: [], // [{ filename, startMs, durationMs }]
+      queuedFiles: new Set(), // queued or being transcribed
+      draining: false,
+      droppedSegments: 0,
+      ingest: null, // { sessionId, unsubscribe } while streaming to the sidecar
       sidecarInstanceId: sidecarAssignment.instanceId,
       sidecarPort: sidecarAssignment.sidecarPort,
       sidecarUrl: sidecarAssignment.sidecarUrl
     };
     session.streams.set(trackInfo.producerId, state);
     this.scheduleSessionLockPersist(session, 'active');
+    if (this.ingestProvider) {
+      try {
+        await this.startStreamIngest(session, state);
+      } catch (error) {
+        this.fastify.log.warn(`Streaming ingest unavailable for ${state.producerId}, using segments: ${error.message}`);
+      }
+    }
+    if (this.segmentEvents) {
+      this.pollProducerStream(session, state, { catchUp: true }).catch((error) => {
+        this.fastify.log.error(`Transcription catch-up scan failed for room ${session.roomSlug}: ${error.message}`);
+      });
+    }
     return state;
   }
 
@@ -1005,6 +1408,7 @@ export class TranscriptionRuntime {
     session.polling = false;
     for (const stream of channelStreams) {
       stream.paused = true;
+      this.stopStreamIngest(stream);
     }
 
     const trackInfos = channelStreams.map((stream) => ({
@@ -1063,6 +1467,7 @@ export class TranscriptionRuntime {
     if (!session) return;
     if (session.streams.has(producerId)) {
       const stream = session.streams.get(producerId);
+      this.stopStreamIngest(stream);
       stopTranscriptionStream(session.sessionId, producerId, 'stopped');
       session.streams.delete(producerId);
       if (stream?.channelName) {
@@ -1076,37 +1481,72 @@ export class TranscriptionRuntime {
     if (session.polling) return;
     session.polling = true;
     try {
-      for (const streamState of session.streams.values()) {
-        await this.pollProducerStream(session, streamState);
-      }
+      // Scans are cheap; transcription itself runs in each stream's drain loop
+      await Promise.all(Array.from(session.streams.values()).map((streamState) => (
+        this.pollProducerStream(session, streamState)
+      )));
     } finally {
       session.polling = false;
     }
   }
 
-  async pollProducerStream(session, streamState) {
+  /**
+   * Recorder push path: queue a segment the moment its file is closed.
+   */
+  handleSegmentClosed({ roomId, producerId, segmentPattern, filePath, startMs = null, durationMs = null }) {
+    const session = this.sessions.get(roomId);
+    if (!session || session.stopping) return;
+    const streamState = session.streams.get(producerId);
+    if (!streamState || streamState.segmentPattern !== segmentPattern) return;
+    if (streamState.ingest) {
+      // Already transcribed live from the packet stream
+      streamState.processedFiles.add(path.basename(filePath));
+      this.scheduleSessionLockPersist(session, 'active');
+      return;
+    }
+    this.enqueueSegment(session, streamState, { filename: path.basename(filePath), startMs, durationMs });
+  }
+
+  /**
+   * Scan a stream's segment directory and queue finished segments.
+   * Poll mode treats a segment as finished once its mtime is old enough. The push-mode
+   * catch-up scan also accepts every segment but the newest, which may still be open
+   * and will arrive through 'segment-closed'.
+   */
+  async pollProducerStream(session, streamState, { catchUp = false } = {}) {
     if (streamState.paused) return;
     if (!streamState.matcher) return;
 
     const { dir, regex } = streamState.matcher;
-    if (!fs.existsSync(dir)) return;
-
-    const entries = fs.readdirSync(dir)
-      .filter((file) => regex.test(file))
-      .sort();
+    let entries;
+    try {
+      entries = (await fs.promises.readdir(dir))
+        .filter((file) => regex.test(file))
+        .sort(compareSegmentFilenames);
+    } catch (error) {
+      if (error.code === 'ENOENT') return;
+      throw error;
+    }
+    const newestFile = entries[entries.length - 1];
 
     for (const filename of entries) {
-      if (streamState.processedFiles.has(filename)) continue;
+      if (streamState.processedFiles.has(filename) || streamState.queuedFiles.has(filename)) continue;
 
       const filePath = path.join(dir, filename);
-      const stat = fs.statSync(filePath);
+      let stat;
+      try {
+        stat = await fs.promises.stat(filePath);
+      } catch {
+        continue;
+      }
       const ageMs = Date.now() - stat.mtimeMs;
       const requiredAgeMs = Math.max(MIN_SEGMENT_AGE_MS, FINALIZED_SEGMENT_MIN_AGE_MS);
-      if (ageMs < requiredAgeMs) continue;
+      const closed = catchUp && filename !== newestFile;
+      if (!closed && ageMs < requiredAgeMs) continue;
 
       // Avoid prematurely marking still-open segment files as processed.
       if (stat.size <= 0) {
-        if (ageMs < requiredAgeMs * 3) {
+        if (!closed && ageMs < requiredAgeMs * 3) {
           continue;
         }
         streamState.processedFiles.add(filename);
@@ -1115,56 +1555,222 @@ export class TranscriptionRuntime {
         continue;
       }
 
-      try {
-        const finalText = sanitizeTranscriptText(
-          await this.transcribeFile(filePath, {
+      this.enqueueSegment(session, streamState, { filename });
+    }
+  }
+
+  enqueueSegment(session, streamState, segment) {
+    const { filename } = segment;
+    if (streamState.processedFiles.has(filename) || streamState.queuedFiles.has(filename)) return;
+    streamState.queuedFiles.add(filename);
+    streamState.segmentQueue.push({ ...segment, queuedAt: Date.now() });
+    streamState.segmentQueue.sort((a, b) => compareSegmentFilenames(a.filename, b.filename));
+
+    // Overload: drop the oldest backlog so the newest audio is always reached within
+    // a bounded lag (failure model: drop/defer transcription, never stall audio).
+    while (streamState.segmentQueue.length > MAX_STREAM_BACKLOG) {
+      const dropped = streamState.segmentQueue.shift();
+      streamState.queuedFiles.delete(dropped.filename);
+      streamState.processedFiles.add(dropped.filename);
+      streamState.droppedSegments += 1;
+      metrics.asrDroppedSegments.inc();
+      this.scheduleSessionLockPersist(session, 'active');
+      this.fastify.log.warn({
+        roomId: session.roomId,
+        transcriptionSessionId: session.sessionId,
+        producerId: streamState.producerId,
+        channelName: streamState.channelName,
+        segment: dropped.filename,
+        queueDepth: streamState.segmentQueue.length
+      }, 'Transcription backlog full, dropping oldest segment');
+    }
+
+    this.drainSegmentQueue(session, streamState).catch((error) => {
+      this.fastify.log.error(`Transcription failed for room ${session.roomSlug}: ${error.message}`);
+    });
+  }
+
+  isStreamCurrent(session, streamState) {
+    return !session.stopping
+      && !streamState.paused
+      && session.streams.get(streamState.producerId) === streamState;
+  }
+
+  async drainSegmentQueue(session, streamState) {
+    if (streamState.draining) return;
+    streamState.draining = true;
+    try {
+      while (streamState.segmentQueue.length > 0 && this.isStreamCurrent(session, streamState)) {
+        const segment = streamState.segmentQueue.shift();
+        // Stays in queuedFiles while in flight, so a poll scan cannot queue it again before
+        // transcribeSegment() marks it processed
+        try {
+          await this.transcribeSegment(session, streamState, segment);
+        } finally {
+          streamState.queuedFiles.delete(segment.filename);
+        }
+      }
+    } finally {
+      streamState.draining = false;
+    }
+  }
+
+  async transcribeSegment(session, streamState, { filename, startMs = null, durationMs = null, queuedAt = null }) {
+    if (streamState.processedFiles.has(filename)) return;
+    const filePath = path.join(streamState.matcher.dir, filename);
+
+    try {
+      const finalText = sanitizeTranscriptText(
+        await this.scheduler.run(streamState.sidecarInstanceId, () => {
+          // The stream may have been replaced while waiting for a slot
+          if (!this.isStreamCurrent(session, streamState)) return '';
+          return this.transcribeFile(filePath, {
             language: TRANSCRIPTION_LANGUAGE || null,
             sidecarUrl: streamState.sidecarUrl
-          })
-        );
-        if (session.streams.get(streamState.producerId) !== streamState || streamState.paused) {
-          return;
-        }
-        streamState.processedFiles.add(filename);
-        this.scheduleSessionLockPersist(session, 'active');
+          });
+        })
+      );
+      if (!this.isStreamCurrent(session, streamState)) {
+        return;
+      }
+      streamState.processedFiles.add(filename);
+      this.scheduleSessionLockPersist(session, 'active');
+      if (queuedAt) metrics.asrSegmentSeconds.observe((Date.now() - queuedAt) / 1000);
+
+      if (!finalText) return;
+
+      const timestampStart = startMs ?? parseTimestampStartMs(filename);
+      const timestampEnd = timestampStart === null
+        ? null
+        : timestampStart + (durationMs ?? RECORDING_SEGMENT_SECONDS * 1000);
+      await this.recordTranscriptText(session, streamState, {
+        text: finalText,
+        startMs: timestampStart,
+        endMs: timestampEnd,
+        segmentFile: path.relative(session.recordingFolderPath, filePath)
+      });
+    } catch (error) {
+      if (!this.isStreamCurrent(session, streamState)) {
+        return;
+      }
+      // No retry policy: mark the segment as processed after first failed send.
+      metrics.asrErrors.inc();
+      streamState.processedFiles.add(filename);
+      this.scheduleSessionLockPersist(session, 'active');
+      this.fastify.log.warn(`Skipping segment ${filePath} after failed transcription attempt: ${error.message}`);
+      await sleep(100);
+    }
+  }
 
-        if (!finalText) continue;
-
-        const timestampStart = parseTimestampStartMs(filename);
-        const timestampEnd = timestampStart === null ? null : timestampStart + POLL_INTERVAL_MS;
-        createTranscriptSegment({
-          session_id: session.sessionId,
-          stream_id: streamState.streamId,
-          room_id: session.roomId,
-          channel_name: streamState.channelName,
-          producer_id: streamState.producerId,
-          publisher_id: streamState.publisherId,
-          segment_file: path.relative(session.recordingFolderPath, filePath),
-          text_content: finalText,
-          timestamp_start_ms: timestampStart,
-          timestamp_end_ms: timestampEnd,
-          confidence_score: null,
-          language: TRANSCRIPTION_LANGUAGE || null
-        });
+  async recordTranscriptText(session, streamState, { text, startMs = null, endMs = null, segmentFile = null }) {
+    // Batched into the next periodic transaction rather than written inline
+    queueTranscriptSegment({
+      session_id: session.sessionId,
+      stream_id: streamState.streamId,
+      room_id: session.roomId,
+      channel_name: streamState.channelName,
+      producer_id: streamState.producerId,
+      publisher_id: streamState.publisherId,
+      segment_file: segmentFile,
+      text_content: text,
+      timestamp_start_ms: startMs,
+      timestamp_end_ms: endMs,
+      confidence_score: null,
+      language: TRANSCRIPTION_LANGUAGE || null
+    });
 
-        const docState = await this.getOrCreateDoc(
-          session.roomId,
-          session.roomSlug,
-          session.sessionId,
-          streamState.channelName,
-          session.eventName
-        );
-        this.appendAsrText(docState, finalText);
-      } catch (error) {
-        if (session.streams.get(streamState.producerId) !== streamState || streamState.paused) {
-          return;
+    const docState = await this.getOrCreateDoc(
+      session.roomId,
+      session.roomSlug,
+      session.sessionId,
+      streamState.channelName,
+      session.eventName
+    );
+    this.appendAsrText(docState, text);
+  }
+
+  /**
+   * Stream a producer's live Opus packets to its sidecar. Finals land in the DB and Yjs doc
+   * like segment results; partials are only relayed to connected transcript sockets.
+   */
+  async startStreamIngest(session, streamState) {
+    const ingest = { sessionId: null, unsubscribe: null };
+    // May resolve asynchronously when the runtime runs in a worker (runtime-worker.js)
+    const subscription = await this.subscribeTrackAudio(streamState.producerId, (packet, timestampMs) => {
+      if (!ingest.sessionId) return;
+      this.ingestProvider.ingestAudio(ingest.sessionId, { data: packet, timestampMs });
+    });
+    if (!subscription) {
+      throw new Error('no live audio for producer');
+    }
+    ingest.unsubscribe = subscription.unsubscribe;
+
+    try {
+      const providerSession = await this.ingestProvider.startSession({
+        sidecarUrl: streamState.sidecarUrl,
+        language: TRANSCRIPTION_LANGUAGE || null,
+        encoding: 'opus',
+        channels: subscription.channels,
+        onPartial: (result) => {
+          if (!this.isStreamCurrent(session, streamState)) return;
+          this.broadcastPartial(session, streamState, result);
+        },
+        onFinal: (result) => {
+          // Finals flushed by stopStreamIngest() still count while the session is live
+          const text = sanitizeTranscriptText(result.text);
+          if (!text || this.sessions.get(session.roomId) !== session) return;
+          this.recordTranscriptText(session, streamState, {
+            text,
+            startMs: result.startMs,
+            endMs: result.endMs
+          }).catch((error) => {
+            this.fastify.log.error(`Failed to store streamed transcript for ${streamState.producerId}: ${error.message}`);
+          });
+        },
+        onClose: (error) => {
+          if (!error || streamState.ingest !== ingest) return;
+          // Segments closed from now on are transcribed from disk instead
+          this.fastify.log.warn(`Streaming ingest for ${streamState.producerId} closed, falling back to segments: ${error.message}`);
+          this.stopStreamIngest(streamState);
         }
-        // No retry policy: mark the segment as processed after first failed send.
-        streamState.processedFiles.add(filename);
-        this.scheduleSessionLockPersist(session, 'active');
-        this.fastify.log.warn(`Skipping segment ${filePath} after failed transcription attempt: ${error.message}`);
-        await sleep(100);
-      }
+      });
+      ingest.sessionId = providerSession.id;
+    } catch (error) {
+      subscription.unsubscribe();
+      throw error;
+    }
+    streamState.ingest = ingest;
+  }
+
+  stopStreamIngest(streamState) {
+    const ingest = streamState?.ingest;
+    if (!ingest) return Promise.resolve();
+    streamState.ingest = null;
+    ingest.unsubscribe?.();
+    return this.ingestProvider.stopSession(ingest.sessionId).catch((error) => {
+      this.fastify.log.warn(`Failed to stop streaming ingest for ${streamState.producerId}: ${error.message}`);
+    });
+  }
+
+  broadcastPartial(session, streamState, { text, startMs, endMs }) {
+    const docState = this.docs.get(this.makeDocKey(session.roomSlug, streamState.channelName, session.sessionId));
+    if (!docState || docState.clients.size === 0) return;
+    // Partials are superseded by the next one, so backed-up sockets just miss this one
+    const message = JSON.stringify({
+      type: 'partial',
+      producerId: streamState.producerId,
+      producerName: streamState.producerName,
+      channelName: streamState.channelName,
+      text: sanitizeTranscriptText(text),
+      startMs,
+      endMs
+    });
+    for (const socket of docState.clients) {
+      if (socket.readyState !== 1) continue;
+      if (socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) continue;
+      try {
+        socket.send(message);
+      } catch { }
     }
   }
 
@@ -1172,7 +1778,7 @@ export class TranscriptionRuntime {
     if (!sidecarUrl) {
       throw new Error('Missing sidecar assignment for transcription stream');
     }
-    const payload = fs.readFileSync(filePath);
+    const payload = await fs.promises.readFile(filePath);
     const formData = new FormData();
     if (language) {
       formData.append('language', language);
@@ -1241,37 +1847,144 @@ export class TranscriptionRuntime {
   appendAsrText(docState, text) {
     if (!text) return;
     docState.ydoc.transact(() => {
-      const current = docState.ytext.toString();
-      const prefix = current.length > 0 && !current.endsWith('\n') ? '\n' : '';
-      docState.ytext.insert(current.length, `${prefix}${text}\n`);
+      const length = docState.ytext.length;
+      const prefix = length > 0 && docState.getTail() !== '\n' ? '\n' : '';
+      docState.ytext.insert(length, `${prefix}${text}\n`);
     }, 'asr');
   }
 
+  queueDocBroadcast(docState, update, origin) {
+    if (docState.clients.size === 0) return;
+    docState.pendingBroadcast.push({ update, origin });
+    if (docState.broadcastTimer) return;
+    docState.broadcastTimer = setTimeout(() => this.flushDocBroadcast(docState), DOC_BROADCAST_WINDOW_MS);
+  }
+
+  /**
+   * Send the window's updates as one merged frame, encoded once and shared by every socket.
+   * Editors don't get their own edits echoed back; backed-up sockets are skipped and resynced.
+   */
+  flushDocBroadcast(docState) {
+    if (docState.broadcastTimer) {
+      clearTimeout(docState.broadcastTimer);
+      docState.broadcastTimer = null;
+    }
+    const pending = docState.pendingBroadcast.splice(0);
+    if (pending.length === 0 || docState.clients.size === 0) return;
+
+    const toFrame = (updates) => {
+      const merged = updates.length === 1 ? updates[0] : Y.mergeUpdates(updates);
+      return Buffer.from(merged.buffer, merged.byteOffset, merged.byteLength);
+    };
+    const sharedFrame = toFrame(pending.map((entry) => entry.update));
+    const editors = new Set(pending.map((entry) => entry.origin).filter((origin) => docState.clients.has(origin)));
+    let resyncFrame = null;
+
+    for (const socket of docState.clients) {
+      if (socket.readyState !== 1) continue;
+      if (socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) {
+        docState.staleClients.add(socket);
+        this.scheduleDocResync(docState);
+        continue;
+      }
+
+      let frame = sharedFrame;
+      if (docState.staleClients.has(socket)) {
+        // Yjs updates are idempotent, so full state covers everything it skipped
+        resyncFrame = resyncFrame || toFrame([Y.encodeStateAsUpdate(docState.ydoc)]);
+        frame = resyncFrame;
+        docState.staleClients.delete(socket);
+      } else if (editors.has(socket)) {
+        const others = pending.filter((entry) => entry.origin !== socket).map((entry) => entry.update);
+        if (others.length === 0) continue;
+        frame = toFrame(others);
+      }
+      try {
+        // Frames are shared across sockets; per-socket deflate would reintroduce per-socket work
+        socket.send(frame, { binary: true, compress: false });
+      } catch { }
+    }
+  }
+
+  /**
+   * Resync skipped sockets with full state once they drain, even if no further update arrives
+   */
+  scheduleDocResync(docState) {
+    if (docState.resyncTimer) return;
+    docState.resyncTimer = setInterval(() => {
+      let resyncFrame = null;
+      for (const socket of docState.staleClients) {
+        if (socket.readyState !== 1 || !docState.clients.has(socket)) {
+          docState.staleClients.delete(socket);
+          continue;
+        }
+        if (socket.bufferedAmount > DOC_SOCKET_MAX_BUFFERED_BYTES) continue;
+        if (!resyncFrame) {
+          const state = Y.encodeStateAsUpdate(docState.ydoc);
+          resyncFrame = Buffer.from(state.buffer, state.byteOffset, state.byteLength);
+        }
+        docState.staleClients.delete(socket);
+        try {
+          socket.send(resyncFrame, { binary: true, compress: false });
+        } catch { }
+      }
+      if (docState.staleClients.size === 0) {
+        clearInterval(docState.resyncTimer);
+        docState.resyncTimer = null;
+      }
+    }, DOC_RESYNC_RECHECK_MS);
+    docState.resyncTimer.unref?.();
+  }
+
+  /**
+   * Log one Yjs update; compaction (O(doc size)) runs only once the log is large enough.
+   */
+  recordDocUpdate(docState, update) {
+    docState.revision += 1;
+    docState.updatesSinceCompaction += 1;
+    docState.bytesSinceCompaction += update.length;
+    queueTranscriptDocUpdate({
+      session_id: docState.sessionId,
+      channel_name: docState.channelName,
+      update_data: Buffer.from(update)
+    });
+    if (docState.updatesSinceCompaction >= DOC_COMPACT_UPDATES || docState.bytesSinceCompaction >= DOC_COMPACT_BYTES) {
+      this.schedulePersist(docState);
+    }
+  }
+
   schedulePersist(docState) {
     if (docState.persistTimer) {
       clearTimeout(docState.persistTimer);
       docState.persistTimer = null;
     }
     docState.persistTimer = setTimeout(() => {
+      docState.persistTimer = null;
       this.persistDocSnapshot(docState).catch((error) => {
         this.fastify.log.error(`Failed to persist transcript doc ${docState.roomSlug}/${docState.channelName}: ${error.message}`);
       });
     }, SNAPSHOT_DEBOUNCE_MS);
   }
 
+  /**
+   * Compact the doc's update log into one state update and refresh its text snapshot.
+   */
   async persistDocSnapshot(docState) {
     if (docState.persistInFlight) return;
+    if (!docState.needsCompaction && docState.updatesSinceCompaction === 0) return;
     docState.persistInFlight = true;
     try {
-      const text = docState.ytext.toString();
-      docState.revision += 1;
-      upsertTranscriptDoc({
+      compactTranscriptDoc({
         session_id: docState.sessionId,
         room_id: docState.roomId,
         channel_name: docState.channelName,
-        text_content: text,
-        revision: docState.revision
+        text_content: docState.ytext.toString(),
+        revision: docState.revision,
+        state: Y.encodeStateAsUpdate(docState.ydoc)
       });
+      docState.needsCompaction = false;
+      docState.updatesSinceCompaction = 0;
+      docState.bytesSinceCompaction = 0;
     } finally {
       docState.persistInFlight = false;
     }
@@ -1282,6 +1995,7 @@ export class TranscriptionRuntime {
     if (this.docs.has(key)) return this.docs.get(key);
 
     const existingDocForSession = getTranscriptDocBySessionChannel(roomId, sessionId, channelName);
+    const initialUpdates = listTranscriptDocUpdates(sessionId, channelName);
     const seedDoc = existingDocForSession || getLatestTranscriptDocByRoomEventChannel(roomId, eventName, channelName);
 
     const docState = new TranscriptDocState({
@@ -1289,22 +2003,20 @@ export class TranscriptionRuntime {
       roomSlug,
       channelName,
       sessionId,
+      initialUpdates,
       initialText: seedDoc?.text_content || '',
       initialRevision: seedDoc?.revision || 0
     });
 
     docState.ydoc.on('update', (update, origin) => {
-      for (const socket of docState.clients) {
-        if (origin && socket === origin) continue;
-        if (socket.readyState !== 1) continue;
-        try {
-          socket.send(Buffer.from(update), { binary: true });
-        } catch { }
-      }
-      this.schedulePersist(docState);
+      this.queueDocBroadcast(docState, update, origin);
+      this.recordDocUpdate(docState, update);
     });
 
     this.docs.set(key, docState);
+    if (docState.needsCompaction) {
+      await this.persistDocSnapshot(docState);
+    }
     return docState;
   }
 
@@ -1347,119 +2059,137 @@ export class TranscriptionRuntime {
           this.fastify.log.error('Transcript websocket connection is not a valid socket');
           return;
         }
+        await this.handleTranscriptSocket(socket, req);
+      });
+    });
+  }
 
-        const { roomSlug, channelName, apiKey, token, sessionId, hasSessionId, invalidSessionId } = parseTranscriptWsRequest(req);
-        if (!roomSlug || !channelName) {
-          socket.send(JSON.stringify({ type: 'error', message: 'Invalid transcript websocket path' }));
-          socket.close();
-          return;
-        }
-        if (invalidSessionId) {
-          socket.send(JSON.stringify({ type: 'error', message: 'Invalid sessionId' }));
-          socket.close();
-          return;
-        }
-        const auth = await this.authenticateTranscriptSocket(roomSlug, apiKey, token);
-        if (!auth.ok) {
-          socket.send(JSON.stringify({ type: 'error', message: auth.message }));
-          socket.close();
-          return;
-        }
+  /**
+   * Serve one transcript websocket: authenticate, send the doc state, then apply edits.
+   * @param {object} socket - ws socket, or a relayed socket with the same surface
+   * @param {object} req - Upgrade request ({ params, query, headers, url, socket })
+   */
+  async handleTranscriptSocket(socket, req) {
+    const { roomSlug, channelName, apiKey, token, sessionId, hasSessionId, invalidSessionId } = parseTranscriptWsRequest(req);
+    if (!roomSlug || !channelName) {
+      socket.send(JSON.stringify({ type: 'error', message: 'Invalid transcript websocket path' }));
+      socket.close();
+      return;
+    }
+    if (invalidSessionId) {
+      socket.send(JSON.stringify({ type: 'error', message: 'Invalid sessionId' }));
+      socket.close();
+      return;
+    }
+    const auth = await this.authenticateTranscriptSocket(roomSlug, apiKey, token);
+    if (!auth.ok) {
+      socket.send(JSON.stringify({ type: 'error', message: auth.message }));
+      socket.close();
+      return;
+    }
+
+    const room = auth.room;
+    const runtimeActiveSession = this.getRoomSession(room.id);
+    const activeSession = runtimeActiveSession || (() => {
+      const active = getActiveTranscriptionSessionByRoomId(room.id);
+      if (!active) return null;
+      return {
+        roomId: room.id,
+        roomSlug,
+        recordingId: active.recording_id,
+        folderName: null,
+        recordingFolderPath: null,
+        sessionId: active.id,
+        eventName: active.event_name,
+        modelName: active.model_name,
+        startedAt: active.started_at,
+        pollTimer: null,
+        polling: false,
+        streams: new Map()
+      };
+    })();
+
+    if (auth.authMode === 'publisher' && hasSessionId) {
+      socket.send(JSON.stringify({ type: 'error', message: 'Publishers can only edit the active transcription session' }));
+      socket.close();
+      return;
+    }
 
-        const room = auth.room;
-        const runtimeActiveSession = this.getRoomSession(room.id);
-        const activeSession = runtimeActiveSession || (() => {
-          const active = getActiveTranscriptionSessionByRoomId(room.id);
-          if (!active) return null;
-          return {
+    let session = activeSession;
+    if (auth.authMode === 'admin' && hasSessionId) {
+      if (activeSession?.sessionId === sessionId) {
+        session = activeSession;
+      } else {
+        const requestedSession = getTranscriptionSessionByRoomAndId(room.id, sessionId);
+        session = requestedSession
+          ? {
             roomId: room.id,
             roomSlug,
-            recordingId: active.recording_id,
+            recordingId: requestedSession.recording_id,
             folderName: null,
             recordingFolderPath: null,
-            sessionId: active.id,
-            eventName: active.event_name,
-            modelName: active.model_name,
-            startedAt: active.started_at,
+            sessionId: requestedSession.id,
+            eventName: requestedSession.event_name,
+            modelName: requestedSession.model_name,
+            startedAt: requestedSession.started_at,
             pollTimer: null,
             polling: false,
             streams: new Map()
-          };
-        })();
-
-        if (auth.authMode === 'publisher' && hasSessionId) {
-          socket.send(JSON.stringify({ type: 'error', message: 'Publishers can only edit the active transcription session' }));
-          socket.close();
-          return;
-        }
-
-        let session = activeSession;
-        if (auth.authMode === 'admin' && hasSessionId) {
-          if (activeSession?.sessionId === sessionId) {
-            session = activeSession;
-          } else {
-            const requestedSession = getTranscriptionSessionByRoomAndId(room.id, sessionId);
-            session = requestedSession
-              ? {
-                roomId: room.id,
-                roomSlug,
-                recordingId: requestedSession.recording_id,
-                folderName: null,
-                recordingFolderPath: null,
-                sessionId: requestedSession.id,
-                eventName: requestedSession.event_name,
-                modelName: requestedSession.model_name,
-                startedAt: requestedSession.started_at,
-                pollTimer: null,
-                polling: false,
-                streams: new Map()
-              }
-              : null;
           }
-        }
-
-        if (!session) {
-          socket.send(JSON.stringify({ type: 'error', message: 'Transcription session not found' }));
-          socket.close();
-          return;
-        }
+          : null;
+      }
+    }
 
-        const docState = await this.getOrCreateDoc(
-          room.id,
-          roomSlug,
-          session.sessionId,
-          channelName,
-          session.eventName || session.event_name
-        );
-        docState.clients.add(socket);
+    if (!session) {
+      socket.send(JSON.stringify({ type: 'error', message: 'Transcription session not found' }));
+      socket.close();
+      return;
+    }
 
-        const fullUpdate = Y.encodeStateAsUpdate(docState.ydoc);
-        socket.send(Buffer.from(fullUpdate), { binary: true });
+    const docState = await this.getOrCreateDoc(
+      room.id,
+      roomSlug,
+      session.sessionId,
+      channelName,
+      session.eventName || session.event_name
+    );
+    docState.clients.add(socket);
 
-        socket.on('message', (message) => {
-          try {
-            if (typeof message === 'string') {
-              const payload = JSON.parse(message);
-              if (payload?.type === 'ping') {
-                socket.send(JSON.stringify({ type: 'pong' }));
-              }
-              return;
-            }
+    const fullUpdate = Y.encodeStateAsUpdate(docState.ydoc);
+    socket.send(Buffer.from(fullUpdate), { binary: true });
 
-            const update = new Uint8Array(message);
-            Y.applyUpdate(docState.ydoc, update, socket);
-          } catch (error) {
-            this.fastify.log.error(`Invalid transcript websocket message: ${error.message}`);
+    socket.on('message', (message) => {
+      try {
+        if (typeof message === 'string') {
+          const payload = JSON.parse(message);
+          if (payload?.type === 'ping') {
+            socket.send(JSON.stringify({ type: 'pong' }));
           }
-        });
+          return;
+        }
 
-        socket.on('close', () => {
-          docState.clients.delete(socket);
-        });
-      });
+        const update = new Uint8Array(message);
+        Y.applyUpdate(docState.ydoc, update, socket);
+      } catch (error) {
+        this.fastify.log.error(`Invalid transcript websocket message: ${error.message}`);
+      }
+    });
+
+    socket.on('close', () => {
+      docState.clients.delete(socket);
+      docState.staleClients.delete(socket);
     });
   }
 
+  serializeLiveDoc(docState) {
+    return {
+      channel_name: docState.channelName,
+      text_content: docState.ytext.toString(),
+      revision: docState.revision,
+      updated_at: nowIso()
+    };
+  }
+
   getSessionDocs(roomId, roomSlug, sessionId) {
     const session = getTranscriptionSessionByRoomAndId(roomId, sessionId);
     if (!session) return null;
@@ -1469,12 +2199,7 @@ export class TranscriptionRuntime {
 
     for (const docState of this.docs.values()) {
       if (docState.roomId !== roomId || docState.sessionId !== sessionId) continue;
-      docsByChannel.set(docState.channelName, {
-        channel_name: docState.channelName,
-        text_content: docState.ytext.toString(),
-        revision: docState.revision,
-        updated_at: nowIso()
-      });
+      docsByChannel.set(docState.channelName, this.serializeLiveDoc(docState));
     }
 
     const resolvedDocs = Array.from(docsByChannel.values())
@@ -1503,12 +2228,7 @@ export class TranscriptionRuntime {
 
     const liveDoc = this.docs.get(this.makeDocKey(roomSlug, channelName, sessionId));
     const doc = liveDoc
-      ? {
-        channel_name: channelName,
-        text_content: liveDoc.ytext.toString(),
-        revision: liveDoc.revision,
-        updated_at: nowIso()
-      }
+      ? this.serializeLiveDoc(liveDoc)
       : getTranscriptDocBySessionChannel(roomId, sessionId, channelName);
 
     if (!doc) {
@@ -1543,9 +2263,16 @@ export class TranscriptionRuntime {
   getCurrentRoomDocs(roomId) {
     const session = this.sessions.get(roomId) || getActiveTranscriptionSessionByRoomId(roomId);
     if (!session) return null;
-    const docs = listTranscriptDocsByRoom(roomId);
+    // Stored text is refreshed on compaction only; live docs are authoritative
+    const sessionId = session.sessionId || session.id;
+    const docsByChannel = new Map(listTranscriptDocsByRoom(roomId).map((doc) => [doc.channel_name, doc]));
+    for (const docState of this.docs.values()) {
+      if (docState.roomId !== roomId || docState.sessionId !== sessionId) continue;
+      docsByChannel.set(docState.channelName, this.serializeLiveDoc(docState));
+    }
+    const docs = Array.from(docsByChannel.values()).sort((a, b) => a.channel_name.localeCompare(b.channel_name));
     return {
-      transcriptionSessionId: session.sessionId || session.id,
+      transcriptionSessionId: sessionId,
       eventName: session.eventName || session.event_name,
       modelName: session.modelName || session.model_name,
       docs: docs.map((doc) => ({
@@ -1561,7 +2288,10 @@ export class TranscriptionRuntime {
     const session = this.sessions.get(roomId) || getActiveTranscriptionSessionByRoomId(roomId);
     if (!session) return null;
 
-    const doc = getTranscriptDocByRoomChannel(roomId, channelName);
+    const sessionId = session.sessionId || session.id;
+    const liveDoc = Array.from(this.docs.values())
+      .find((docState) => docState.roomId === roomId && docState.sessionId === sessionId && docState.channelName === channelName);
+    const doc = liveDoc ? this.serializeLiveDoc(liveDoc) : getTranscriptDocByRoomChannel(roomId, channelName);
     if (!doc) {
       return {
         transcriptionSessionId: session.sessionId || session.id,
@@ -1586,7 +2316,11 @@ export class TranscriptionRuntime {
   }
 
   async shutdown() {
+    this.shuttingDown = true;
     for (const session of this.sessions.values()) {
+      for (const stream of session.streams.values()) {
+        this.stopStreamIngest(stream);
+      }
       if (session.pollTimer) {
         clearInterval(session.pollTimer);
         session.pollTimer = null;
@@ -1597,10 +2331,28 @@ export class TranscriptionRuntime {
       }
     }
 
+    for (const docState of this.docs.values()) {
+      if (docState.persistTimer) {
+        clearTimeout(docState.persistTimer);
+        docState.persistTimer = null;
+      }
+      await this.persistDocSnapshot(docState);
+    }
+    this.flushPendingWrites();
+    await flushDbWrites();
+
     for (const instanceId of [...this.sidecarInstances.keys()]) {
       this.shutdownSidecarInstance(instanceId, { force: true, removeAssignment: true });
     }
   }
+
+  flushPendingWrites() {
+    try {
+      flushTranscriptWrites();
+    } catch (error) {
+      this.fastify.log.error(`Failed to flush transcript writes: ${error.message}`);
+    }
+  }
 }
 
 export default TranscriptionRuntime;
@@ -0,0 +1,91 @@
+/**
+ * Bounds concurrent sidecar requests per sidecar instance.
+ *
+ * Streams drain their own segment queues concurrently; each request first takes a
+ * slot on its sidecar. A slow channel therefore only delays streams that share its
+ * sidecar, never the whole room. Waiters are served FIFO.
+ */
+export class SidecarScheduler {
+  constructor({ maxInFlightPerSidecar = 1 } = {}) {
+    this.maxInFlight = Math.max(1, maxInFlightPerSidecar);
+    this.slots = new Map(); // sidecarKey -> { inFlight, waiters: [] }
+    this.completed = 0;
+    this.failed = 0;
+  }
+
+  getSlot(sidecarKey) {
+    let slot = this.slots.get(sidecarKey);
+    if (!slot) {
+      slot = { inFlight: 0, waiters: [] };
+      this.slots.set(sidecarKey, slot);
+    }
+    return slot;
+  }
+
+  async acquire(sidecarKey) {
+    const slot = this.getSlot(sidecarKey);
+    if (slot.inFlight < this.maxInFlight) {
+      slot.inFlight += 1;
+      return;
+    }
+    await new Promise((resolve) => slot.waiters.push(resolve));
+  }
+
+  release(sidecarKey) {
+    const slot = this.slots.get(sidecarKey);
+    if (!slot) return;
+    const next = slot.waiters.shift();
+    if (next) {
+      // Hand the slot straight to the next waiter
+      next();
+      return;
+    }
+    slot.inFlight = Math.max(0, slot.inFlight - 1);
+    if (slot.inFlight === 0) {
+      this.slots.delete(sidecarKey);
+    }
+  }
+
+  /**
+   * Run `task` once a slot on `sidecarKey` is free.
+   */
+  async run(sidecarKey, task) {
+    await this.acquire(sidecarKey);
+    try {
+      const result = await task();
+      this.completed += 1;
+      return result;
+    } catch (error) {
+      this.failed += 1;
+      throw error;
+    } finally {
+      this.release(sidecarKey);
+    }
+  }
+
+  getInFlight(sidecarKey) {
+    return this.slots.get(sidecarKey)?.inFlight || 0;
+  }
+
+  getWaiting(sidecarKey) {
+    return this.slots.get(sidecarKey)?.waiters.length || 0;
+  }
+
+  getStats() {
+    let inFlight = 0;
+    let waiting = 0;
+    for (const slot of this.slots.values()) {
+      inFlight += slot.inFlight;
+      waiting += slot.waiters.length;
+    }
+    return {
+      maxInFlightPerSidecar: this.maxInFlight,
+      inFlight,
+      waiting,
+      completed: this.completed,
+      failed: this.failed
+    };
+  }
+}
+
+export default SidecarScheduler;
@@ -0,0 +1,153 @@
+import { randomUUID } from 'crypto';
+import WebSocket from 'ws';
+
+const INGEST_MAX_BUFFERED_BYTES = parseInt(process.env.TRANSCRIPTION_INGEST_MAX_BUFFERED_BYTES || String(256 * 1024), 10);
+const INGEST_CONNECT_TIMEOUT_MS = parseInt(process.env.TRANSCRIPTION_INGEST_CONNECT_TIMEOUT_MS || '10000', 10);
+
+/**
+ * AsrProvider backed by the sidecar's streaming ingest WebSocket (`/api/v1/ingest`).
+ * See the provider contract in docs/ARCHITECTURE_REBUILD.md.
+ *
+ * One WebSocket per session. Audio chunks are `{ data: Buffer, timestampMs }` holding one
+ * Opus packet (or 16 kHz s16le PCM with `encoding: 'pcm_s16le'`). When the socket cannot keep
+ * up, chunks are dropped rather than buffered so transcription never backs up into RTP intake.
+ * The provider does not write to the DB; results go to the session callbacks.
+ */
+export class SidecarIngestProvider {
+  constructor({ log = console } = {}) {
+    this.log = log;
+    this.sessions = new Map(); // sessionId -> { socket, droppedChunks, sentChunks }
+  }
+
+  /**
+   * @param {object} input
+   * @param {string} input.sidecarUrl - http(s) base URL of the sidecar
+   * @param {string|null} [input.language]
+   * @param {'opus'|'pcm_s16le'} [input.encoding]
+   * @param {number} [input.channels]
+   * @param {function} [input.onPartial] - ({ text, startMs, endMs })
+   * @param {function} [input.onFinal] - ({ text, startMs, endMs })
+   * @param {function} [input.onClose] - (error|null) when the socket ends
+   * @returns {Promise<{ id: string }>}
+   */
+  async startSession({ sidecarUrl, language = null, encoding = 'opus', channels = 2, onPartial = null, onFinal = null, onClose = null }) {
+    const id = randomUUID();
+    const wsUrl = `${sidecarUrl.replace(/^http/, 'ws')}/api/v1/ingest`;
+    const socket = new WebSocket(wsUrl);
+    const state = { socket, droppedChunks: 0, sentChunks: 0, stopped: null };
+    this.sessions.set(id, state);
+
+    await new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        reject(new Error('Sidecar ingest connection timed out'));
+        socket.terminate();
+      }, INGEST_CONNECT_TIMEOUT_MS);
+
+      socket.on('message', (raw, isBinary) => {
+        if (isBinary) return;
+        let message;
+        try {
+          message = JSON.parse(raw.toString());
+        } catch {
+          return;
+        }
+        const result = { text: message.text || '', startMs: message.start_ms ?? null, endMs: message.end_ms ?? null };
+        if (message.type === 'started') {
+          clearTimeout(timer);
+          resolve();
+        } else if (message.type === 'error') {
+          clearTimeout(timer);
+          reject(new Error(message.message || 'Sidecar ingest error'));
+          this.log.warn(`Sidecar ingest error: ${message.message}`);
+        } else if (message.type === 'partial' && onPartial) {
+          onPartial(result);
+        } else if (message.type === 'final' && onFinal) {
+          onFinal(result);
+        } else if (message.type === 'stopped' && state.stopped) {
+          state.stopped();
+        }
+      });
+
+      socket.on('open', () => {
+        socket.send(JSON.stringify({ type: 'start', session_id: id, language, encoding, channels }));
+      });
+
+      socket.on('error', (error) => {
+        clearTimeout(timer);
+        reject(error);
+      });
+
+      socket.on('close', () => {
+        clearTimeout(timer);
+        reject(new Error('Sidecar ingest socket closed'));
+        const wasActive = this.sessions.delete(id);
+        if (state.stopped) state.stopped();
+        if (onClose) onClose(wasActive ? new Error('Sidecar ingest socket closed') : null);
+      });
+    }).catch((error) => {
+      this.sessions.delete(id);
+      socket.terminate();
+      throw error;
+    });
+
+    return { id };
+  }
+
+  /**
+   * Send one chunk; silently drops it when the session is gone or the socket is backed up.
+   * @param {string} sessionId
+   * @param {{ data: Buffer, timestampMs: number }} chunk
+   */
+  async ingestAudio(sessionId, chunk) {
+    const state = this.sessions.get(sessionId);
+    if (!state || state.socket.readyState !== WebSocket.OPEN) return;
+    if (state.socket.bufferedAmount > INGEST_MAX_BUFFERED_BYTES) {
+      state.droppedChunks += 1;
+      return;
+    }
+    const frame = Buffer.allocUnsafe(8 + chunk.data.length);
+    frame.writeBigUInt64LE(BigInt(Math.max(0, Math.round(chunk.timestampMs || 0))), 0);
+    chunk.data.copy(frame, 8);
+    state.socket.send(frame, { binary: true });
+    state.sentChunks += 1;
+  }
+
+  /**
+   * Flush the last utterance and close. Resolves once the sidecar acknowledges or the socket closes.
+   */
+  async stopSession(sessionId) {
+    const state = this.sessions.get(sessionId);
+    if (!state) return;
+    this.sessions.delete(sessionId);
+    if (state.socket.readyState !== WebSocket.OPEN) {
+      state.socket.terminate();
+      return;
+    }
+    await new Promise((resolve) => {
+      const timer = setTimeout(resolve, INGEST_CONNECT_TIMEOUT_MS);
+      state.stopped = () => {
+        clearTimeout(timer);
+        resolve();
+      };
+      state.socket.send(JSON.stringify({ type: 'stop' }));
+    });
+    state.socket.close();
+  }
+
+  async health(sidecarUrl) {
+    try {
+      const response = await fetch(`${sidecarUrl}/health`);
+      return { ready: response.ok, sessions: this.sessions.size };
+    } catch (error) {
+      return { ready: false, reason: error.message, sessions: this.sessions.size };
+    }
+  }
+
+  getSessionStats(sessionId) {
+    const state = this.sessions.get(sessionId);
+    if (!state) return null;
+    return { sentChunks: state.sentChunks, droppedChunks: state.droppedChunks };
+  }
+}
+
+export default SidecarIngestProvider;
@@ -8,17 +8,21 @@
  *
  * Usage:
  *   sfu-server --url https://soundcast.example.com --key YOUR_SECRET_KEY --port 8080
+ *   sfu-server ... --webrtc-port 44444   (serve all transports from one UDP+TCP port)
+ *   sfu-server ... --origin https://soundcast.example.com   (edge: relay channels from the origin)
  *
  * Features:
  * - Auto-registers with the main Soundcast instance
  * - Provides WebRTC media routing for local networks
  * - Heartbeat mechanism to maintain connection
+ * - Edge mode: pulls one RTP copy of each channel from an origin over a PipeTransport
  */
 
 import mediasoup from 'mediasoup';
 import WebSocket, { WebSocketServer } from 'ws';
 import fetch from 'node-fetch';
 import os from 'os';
+import { execFile } from 'child_process';
 
 // Parse command-line arguments
 const args = process.argv.slice(2);
@@ -28,9 +32,26 @@ const config = {
   port: parseInt(getArg('--port') || process.env.SFU_PORT || '8080'),
   rtcMinPort: parseInt(getArg('--rtc-min') || process.env.RTC_MIN_PORT || '40000'),
   rtcMaxPort: parseInt(getArg('--rtc-max') || process.env.RTC_MAX_PORT || '49999'),
+  // When set, each worker's WebRtcServer (one UDP + one TCP port, port + worker index) serves its transports
+  webRtcServerPort: parseInt(getArg('--webrtc-port') || process.env.WEBRTC_SERVER_PORT || '0') || null,
+  // 0 = one mediasoup worker per CPU core
+  numWorkers: parseInt(getArg('--workers') || process.env.SFU_NUM_WORKERS || '0') || os.availableParallelism?.() || os.cpus().length,
+  // Listeners of one channel per worker before spilling onto another worker via pipeToRouter
+  maxListenersPerWorker: parseInt(getArg('--max-listeners-per-worker') || process.env.SFU_MAX_LISTENERS_PER_WORKER || '500'),
+  // Pin worker i to core i (Linux, via taskset)
+  pinWorkers: args.includes('--pin-workers') || process.env.SFU_PIN_WORKERS === 'true',
   announcedIp: getArg('--ip') || process.env.ANNOUNCED_IP || getLocalIp(),
-  name: getArg('--name') || process.env.SFU_NAME || `SFU-${os.hostname()}`
+  name: getArg('--name') || process.env.SFU_NAME || `SFU-${os.hostname()}`,
+  // Edge mode: channels without a local publisher are relayed from this origin (main server)
+  originUrl: getArg('--origin') || process.env.SFU_ORIGIN_URL || null,
+  originKey: getArg('--origin-key') || process.env.SFU_ORIGIN_KEY || null,
+  // Keep a relay open this long after its last listener leaves, so rejoins don't re-pipe
+  relayIdleMs: parseInt(getArg('--relay-idle-ms') || process.env.SFU_RELAY_IDLE_MS || '30000'),
+  heartbeatIntervalMs: parseInt(getArg('--heartbeat-ms') || process.env.SFU_HEARTBEAT_INTERVAL_MS || '30000'),
+  // On SIGTERM, stop taking new listeners and wait up to this long for current ones to leave (0 = exit now)
+  drainTimeoutMs: parseInt(getArg('--drain-timeout-ms') || process.env.SFU_DRAIN_TIMEOUT_MS || '0')
 };
+config.originKey = config.originKey || config.secretKey;
 
 function getArg(name) {
   const index = args.indexOf(name);
@@ -68,44 +89,204 @@ console.log(`Name: ${config.name}`);
 console.log(`Master URL: ${config.masterUrl}`);
 console.log(`WebSocket Port: ${config.port}`);
 console.log(`RTC Ports: ${config.rtcMinPort}-${config.rtcMaxPort}`);
+console.log(`Workers: ${config.numWorkers}${config.pinWorkers ? ' (pinned)' : ''}`);
+if (config.webRtcServerPort) {
+  console.log(`WebRtcServer Ports: ${config.webRtcServerPort}-${config.webRtcServerPort + config.numWorkers - 1} (udp+tcp)`);
+}
 console.log(`Announced IP: ${config.announcedIp}`);
+if (config.originUrl) {
+  console.log(`Origin URL: ${config.originUrl} (edge mode)`);
+}
 console.log('====================================\n');
 
-// SFU state
-let worker;
-let router;
+// SFU state: one router per worker. A channel lives on a home router (publishers, relay
+// pipe); its listeners stay there until it holds maxListenersPerWorker of them, then spill
+// onto the least-loaded other router, with producers piped over on demand (same ids).
+const workerEntries = []; // [{ worker, router, webRtcServer, load }]
+const entriesByRouterId = new Map();
+let router; // first router; all routers share codecs, so it answers capability requests
+
+const mediaCodecs = [
+  {
+    kind: 'audio',
+    mimeType: 'audio/opus',
+    clockRate: 48000,
+    channels: 2
+  }
+];
+
+// Split the RTC port range so each worker binds its own slice
+function splitPortRange(count) {
+  const totalPorts = config.rtcMaxPort - config.rtcMinPort + 1;
+  const workerCount = Math.max(1, Math.min(count, Math.floor(totalPorts / 2)));
+  const sliceSize = Math.floor(totalPorts / workerCount);
+  const ranges = [];
+  for (let i = 0; i < workerCount; i++) {
+    const min = config.rtcMinPort + i * sliceSize;
+    ranges.push({ min, max: i === workerCount - 1 ? config.rtcMaxPort : min + sliceSize - 1 });
+  }
+  return ranges;
+}
+
+function pinWorker(worker, core) {
+  if (process.platform !== 'linux') {
+    console.log(`⚠️  Worker pinning is only supported on Linux, skipping worker ${worker.pid}`);
+    return;
+  }
+  execFile('taskset', ['-cp', String(core), String(worker.pid)], (error) => {
+    if (error) {
+      console.error(`⚠️  Failed to pin worker ${worker.pid} to core ${core}:`, error.message);
+    }
+  });
+}
 
 // Initialize mediasoup
 async function initMediasoup() {
-  console.log('🔧 Initializing mediasoup worker...');
+  const ranges = splitPortRange(config.numWorkers);
+  console.log(`🔧 Initializing ${ranges.length} mediasoup worker(s)...`);
+  const cores = os.cpus().length;
+
+  for (const [index, range] of ranges.entries()) {
+    const worker = await mediasoup.createWorker({
+      rtcMinPort: range.min,
+      rtcMaxPort: range.max,
+      logLevel: 'warn',
+      logTags: ['info', 'ice', 'dtls', 'rtp', 'srtp', 'rtcp']
+    });
 
-  worker = await mediasoup.createWorker({
-    rtcMinPort: config.rtcMinPort,
-    rtcMaxPort: config.rtcMaxPort,
-    logLevel: 'warn',
-    logTags: ['info', 'ice', 'dtls', 'rtp', 'srtp', 'rtcp']
-  });
+    worker.on('died', () => {
+      console.error(`❌ mediasoup worker ${worker.pid} died, exiting...`);
+      process.exit(1);
+    });
 
-  worker.on('died', () => {
-    console.error('❌ mediasoup worker died, exiting...');
-    process.exit(1);
-  });
+    if (config.pinWorkers) {
+      pinWorker(worker, index % cores);
+    }
 
-  // Create router for audio
-  router = await worker.createRouter({
-    mediaCodecs: [
-      {
-        kind: 'audio',
-        mimeType: 'audio/opus',
-        clockRate: 48000,
-        channels: 2
-      }
-    ]
-  });
+    let webRtcServer = null;
+    if (config.webRtcServerPort) {
+      const port = config.webRtcServerPort + index;
+      const listenInfo = { ip: '0.0.0.0', announcedAddress: config.announcedIp, port };
+      webRtcServer = await worker.createWebRtcServer({
+        listenInfos: [
+          { ...listenInfo, protocol: 'udp' },
+          { ...listenInfo, protocol: 'tcp' }
+        ]
+      });
+      console.log(`✅ WebRtcServer listening on port ${port}`);
+    }
 
+    // Create router for audio
+    const workerRouter = await worker.createRouter({ mediaCodecs });
+    const entry = { worker, router: workerRouter, webRtcServer, load: 0 };
+    // Load = live transports + consumers, kept current by mediasoup observer events
+    workerRouter.observer.on('newtransport', (transport) => {
+      entry.load++;
+      transport.observer.once('close', () => entry.load--);
+      transport.observer.on('newconsumer', (consumer) => {
+        entry.load++;
+        consumer.observer.once('close', () => entry.load--);
+      });
+    });
+    workerEntries.push(entry);
+    entriesByRouterId.set(workerRouter.id, entry);
+  }
+
+  router = workerEntries[0].router;
   console.log('✅ mediasoup initialized');
 }
 
+function getLeastLoadedRouter(exclude = null) {
+  let best = null;
+  for (const entry of workerEntries) {
+    if (entry.router === exclude || entry.router.closed) continue;
+    if (!best || entry.load < best.load) best = entry;
+  }
+  return best?.router || exclude || router;
+}
+
+function createChannelState() {
+  return {
+    producers: new Map(),
+    consumers: new Map(),
+    router: getLeastLoadedRouter(),
+    listenersByRouter: new Map() // routerId -> listener transports
+  };
+}
+
+// Router for a new listener of `channel`: home until busy, then a router it already spilled onto
+function pickListenerRouter(channel) {
+  const home = channel.router;
+  if ((channel.listenersByRouter.get(home.id) || 0) < config.maxListenersPerWorker) return home;
+
+  let spill = null;
+  let spillCount = Infinity;
+  for (const [routerId, count] of channel.listenersByRouter) {
+    const entry = entriesByRouterId.get(routerId);
+    if (routerId === home.id || !entry || entry.router.closed) continue;
+    if (count < config.maxListenersPerWorker && count < spillCount) {
+      spill = entry.router;
+      spillCount = count;
+    }
+  }
+  return spill || getLeastLoadedRouter(home);
+}
+
+function addListenerRouter(channel, listenerRouter) {
+  if (!channel || !listenerRouter) return;
+  channel.listenersByRouter.set(listenerRouter.id, (channel.listenersByRouter.get(listenerRouter.id) || 0) + 1);
+}
+
+function removeListenerRouter(channel, listenerRouter) {
+  if (!channel?.listenersByRouter || !listenerRouter) return;
+  const count = (channel.listenersByRouter.get(listenerRouter.id) || 0) - 1;
+  if (count > 0) {
+    channel.listenersByRouter.set(listenerRouter.id, count);
+  } else {
+    channel.listenersByRouter.delete(listenerRouter.id);
+  }
+}
+
+// Make a producer consumable on `targetRouter`; the piped producer keeps its id
+async function ensureProducerOnRouter(producerInfo, targetRouter) {
+  const sourceRouter = producerInfo.router;
+  if (!sourceRouter || sourceRouter.id === targetRouter.id) return;
+  if (!producerInfo.pipes) producerInfo.pipes = new Map(); // routerId -> Promise
+
+  let pending = producerInfo.pipes.get(targetRouter.id);
+  if (!pending) {
+    pending = sourceRouter.pipeToRouter({ producerId: producerInfo.producer.id, router: targetRouter });
+    producerInfo.pipes.set(targetRouter.id, pending);
+    pending.catch(() => producerInfo.pipes.delete(targetRouter.id));
+  }
+  await pending;
+}
+
+// UDP ports taken from the RTC range (WebRTC transports without a WebRtcServer, relay pipes)
+let rtcPortsInUse = 0;
+
+function trackPortUse(transport) {
+  rtcPortsInUse++;
+  transport.observer.once('close', () => {
+    rtcPortsInUse = Math.max(0, rtcPortsInUse - 1);
+  });
+  return transport;
+}
+
+// Create a WebRTC transport on a router, sharing its worker's WebRtcServer socket when enabled
+async function createWebRtcTransport(transportRouter) {
+  const { webRtcServer } = entriesByRouterId.get(transportRouter.id);
+  const transport = await transportRouter.createWebRtcTransport({
+    ...(webRtcServer
+      ? { webRtcServer }
+      : { listenIps: [{ ip: '0.0.0.0', announcedIp: config.announcedIp }] }),
+    enableUdp: true,
+    enableTcp: true,
+    preferUdp: true
+  });
+  return webRtcServer ? transport : trackPortUse(transport);
+}
+
 // WebSocket server
 let wss;
 const clients = new Map();
@@ -121,6 +302,7 @@ function startWebSocketServer() {
     clients.set(clientId, {
       socket: ws,
       transport: null,
+      router: null,
       producer: null,
       consumers: [],
       isPublisher: false,
@@ -168,7 +350,7 @@ function connectToMainServerStats() {
 
   // Convert http(s) URL to ws(s) URL
   const wsUrl = config.masterUrl.replace(/^http/, 'ws');
-  const statsUrl = `${wsUrl}/ws/sfu-stats?secretKey=${encodeURIComponent(config.secretKey)}`;
+  const statsUrl = `${wsUrl}/ws/sfu-stats?secretKey=${encodeURIComponent(config.secretKey)}&sfuId=${encodeURIComponent(registeredSfuId)}`;
 
   console.log(`📊 Connecting to stats WebSocket: ${wsUrl}/ws/sfu-stats`);
 
@@ -230,9 +412,11 @@ function pushStatsUpdate() {
   }
 
   try {
+    // listeners lets the master count joins since the last heartbeat (see SfuRegistry.place)
     statsWs.send(JSON.stringify({
       type: 'stats-update',
-      channels: stats
+      channels: stats,
+      listeners: countListeners()
     }));
   } catch (error) {
     console.error('📊 Failed to push stats:', error.message);
@@ -243,7 +427,7 @@ function countActivePublishers(channel) {
   if (!channel?.producers) return 0;
   let count = 0;
   for (const [producerId, producerInfo] of channel.producers) {
-    const hasLiveClient = producerInfo.clientId && clients.has(producerInfo.clientId);
+    const hasLiveClient = producerInfo.relayed || (producerInfo.clientId && clients.has(producerInfo.clientId));
     const isOpen = producerInfo.producer && !producerInfo.producer.closed;
     if (hasLiveClient && isOpen) {
       count++;
@@ -308,6 +492,309 @@ function removeProducersForPublisher(channel, { clientId, publisherId = null } =
   return removed;
 }
 
+// Give a listener a transport for `channelId` on the channel's home router, or spill onto
+// another worker once home is busy. Channels are created on demand (listener waits).
+async function attachListener(clientInfo, { channelId, rtpCapabilities, displayName }) {
+  if (!channels.has(channelId)) {
+    channels.set(channelId, createChannelState());
+  }
+  const channel = channels.get(channelId);
+  const previousChannelId = clientInfo.isListener ? clientInfo.channelId : null;
+  detachListenerRouter(clientInfo);
+
+  const listenerRouter = pickListenerRouter(channel);
+  const transport = await createWebRtcTransport(listenerRouter);
+  addListenerRouter(channel, listenerRouter);
+
+  clientInfo.transport = transport;
+  clientInfo.router = listenerRouter;
+  clientInfo.isListener = true;
+  clientInfo.channelId = channelId;
+  clientInfo.rtpCapabilities = rtpCapabilities;
+  clientInfo.displayName = displayName || 'Anonymous';
+
+  if (previousChannelId && previousChannelId !== channelId) {
+    scheduleRelayRelease(previousChannelId);
+  }
+  return transport;
+}
+
+function detachListenerRouter(clientInfo) {
+  if (!clientInfo.isListener || !clientInfo.router) return;
+  removeListenerRouter(channels.get(clientInfo.channelId), clientInfo.router);
+  clientInfo.router = null;
+}
+
+// Consume every open producer of a channel on a listener's transport
+async function consumeChannelProducers(clientId, clientInfo, channel, rtpCapabilities) {
+  const consumersData = [];
+
+  for (const [prodId, prodInfo] of channel.producers) {
+    if (prodInfo.producer.closed) continue;
+
+    await ensureProducerOnRouter(prodInfo, clientInfo.router);
+    if (!clientInfo.router.canConsume({ producerId: prodInfo.producer.id, rtpCapabilities })) {
+      console.log(`Client ${clientId} cannot consume producer ${prodId}`);
+      continue;
+    }
+
+    const consumerObj = await clientInfo.transport.consume({
+      producerId: prodInfo.producer.id,
+      rtpCapabilities,
+      paused: false
+    });
+
+    // Use the actual mediasoup consumer ID
+    clientInfo.consumers.push({ id: consumerObj.id, consumer: consumerObj, producerId: prodId });
+    channel.consumers.set(consumerObj.id, {
+      transport: clientInfo.transport,
+      consumer: consumerObj,
+      clientId,
+      displayName: clientInfo.displayName,
+      producerId: prodId
+    });
+
+    consumersData.push({
+      id: consumerObj.id,
+      producerId: prodId,
+      kind: consumerObj.kind,
+      rtpParameters: consumerObj.rtpParameters
+    });
+  }
+
+  return consumersData;
+}
+
+// Create consumers of a new producer for every listener already in the channel
+async function consumeForChannelListeners(channelId, producer, producerId) {
+  for (const otherClient of clients.values()) {
+    if (otherClient.isListener &&
+        otherClient.channelId === channelId &&
+        otherClient.transport &&
+        otherClient.rtpCapabilities) {
+      await createConsumerForListener(otherClient, producer, producerId, channelId);
+    }
+  }
+}
+
+function channelHasListeners(channelId) {
+  for (const client of clients.values()) {
+    if (client.isListener && client.channelId === channelId && client.transport) return true;
+  }
+  return false;
+}
+
+// Edge relay: one signaling socket to the origin's /ws/relay and one PipeTransport per
+// relayed channel. The origin consumes each of the channel's producers into that pipe and
+// this node re-produces them locally (same producer ids), so N local listeners cost the
+// origin one RTP stream per producer.
+let relayWs = null;
+let relayReconnectTimer = null;
+const relays = new Map(); // channelId -> { transport, ready, producerIds: Set, idleTimer }
+
+function connectToOrigin() {
+  const wsUrl = config.originUrl.replace(/^http/, 'ws').replace(/\/+$/, '');
+  const relayUrl = `${wsUrl}/ws/relay?secretKey=${encodeURIComponent(config.originKey)}&name=${encodeURIComponent(config.name)}`;
+
+  console.log(`🔗 Connecting to origin: ${wsUrl}/ws/relay`);
+  relayWs = new WebSocket(relayUrl);
+
+  relayWs.on('open', () => {
+    console.log('✅ Connected to origin for relaying');
+    // Re-subscribe channels that still have listeners (e.g. after a reconnect)
+    const channelIds = new Set();
+    for (const client of clients.values()) {
+      if (client.isListener && client.channelId && client.transport) channelIds.add(client.channelId);
+    }
+    for (const channelId of channelIds) {
+      ensureRelay(channelId).catch((error) => console.error(`🔗 Relay for ${channelId} failed:`, error.message));
+    }
+  });
+
+  relayWs.on('message', async (message) => {
+    try {
+      await handleRelayMessage(JSON.parse(message.toString()));
+    } catch (error) {
+      console.error('🔗 Error handling relay message:', error.message);
+    }
+  });
+
+  relayWs.on('close', () => {
+    console.log('⚠️  Origin relay disconnected, reconnecting in 5s...');
+    relayWs = null;
+    for (const channelId of [...relays.keys()]) {
+      dropRelay(channelId, { notifyOrigin: false });
+    }
+    if (!relayReconnectTimer) {
+      relayReconnectTimer = setTimeout(() => {
+        relayReconnectTimer = null;
+        connectToOrigin();
+      }, 5000);
+    }
+  });
+
+  relayWs.on('error', (error) => {
+    console.error('🔗 Origin relay error:', error.message);
+  });
+}
+
+function sendToOrigin(action, data) {
+  if (!relayWs || relayWs.readyState !== WebSocket.OPEN) return false;
+  relayWs.send(JSON.stringify({ action, data }));
+  return true;
+}
+
+// Subscribe a channel from the origin, unless a local publisher already feeds it
+async function ensureRelay(channelId) {
+  if (!config.originUrl) return;
+
+  const existing = relays.get(channelId);
+  if (existing) {
+    clearTimeout(existing.idleTimer);
+    existing.idleTimer = null;
+    return;
+  }
+
+  if (!channels.has(channelId)) channels.set(channelId, createChannelState());
+  const channel = channels.get(channelId);
+  if (countActivePublishers(channel) > 0) return;
+  if (!relayWs || relayWs.readyState !== WebSocket.OPEN) return; // subscribed on (re)connect
+
+  const relay = { router: channel.router, transport: null, ready: false, producerIds: new Set(), idleTimer: null };
+  relays.set(channelId, relay);
+  try {
+    relay.transport = trackPortUse(await relay.router.createPipeTransport({
+      listenInfo: { protocol: 'udp', ip: '0.0.0.0', announcedAddress: config.announcedIp },
+      enableRtx: false,
+      enableSrtp: false
+    }));
+  } catch (error) {
+    relays.delete(channelId);
+    throw error;
+  }
+  if (relays.get(channelId) !== relay) {
+    relay.transport.close();
+    return;
+  }
+
+  sendToOrigin('relay-subscribe', {
+    channelId,
+    ip: config.announcedIp,
+    port: relay.transport.tuple.localPort
+  });
+  console.log(`🔗 Subscribing channel ${channelId} from origin`);
+}
+
+// Close a channel's relay and the local producers it fed
+function dropRelay(channelId, { notifyOrigin = true } = {}) {
+  const relay = relays.get(channelId);
+  if (!relay) return;
+  relays.delete(channelId);
+  clearTimeout(relay.idleTimer);
+
+  const channel = channels.get(channelId);
+  for (const producerId of relay.producerIds) {
+    removeChannelProducer(channel, producerId);
+  }
+  if (relay.transport && !relay.transport.closed) {
+    relay.transport.close();
+  }
+  if (notifyOrigin) {
+    sendToOrigin('relay-unsubscribe', { channelId });
+  }
+  console.log(`🔗 Relay closed for channel ${channelId}`);
+  pushStatsUpdate();
+}
+
+// Release a relay once its channel has had no listeners for relayIdleMs
+function scheduleRelayRelease(channelId) {
+  const relay = relays.get(channelId);
+  if (!relay || relay.idleTimer || channelHasListeners(channelId)) return;
+  relay.idleTimer = setTimeout(() => {
+    relay.idleTimer = null;
+    if (relays.get(channelId) === relay && !channelHasListeners(channelId)) {
+      dropRelay(channelId);
+    }
+  }, config.relayIdleMs);
+}
+
+async function addRelayProducer(channelId, { producerId, kind, rtpParameters, paused = false, publisherId = null }) {
+  const relay = relays.get(channelId);
+  if (!relay || !relay.ready || relay.producerIds.has(producerId)) return;
+
+  // Reuse the origin's producer id, so the local mediasoup producer and the channel entry
+  // carry the id listeners and the origin already use
+  const producer = await relay.transport.produce({ id: producerId, kind, rtpParameters, paused });
+  if (relays.get(channelId) !== relay) {
+    producer.close();
+    return;
+  }
+
+  if (!channels.has(channelId)) channels.set(channelId, createChannelState());
+  relay.producerIds.add(producerId);
+  channels.get(channelId).producers.set(producerId, {
+    transport: relay.transport,
+    producer,
+    router: relay.router,
+    clientId: null,
+    publisherId,
+    relayed: true
+  });
+  console.log(`🔗 Relayed producer ${producerId} into channel ${channelId}`);
+
+  pushStatsUpdate();
+  await consumeForChannelListeners(channelId, producer, producerId);
+}
+
+async function handleRelayMessage({ action, data = {} }) {
+  const { channelId } = data;
+  const relay = relays.get(channelId);
+
+  switch (action) {
+    case 'relay-subscribed': {
+      if (!relay || relay.ready) break;
+      await relay.transport.connect({ ip: data.ip, port: data.port });
+      relay.ready = true;
+      for (const producer of data.producers || []) {
+        await addRelayProducer(channelId, producer);
+      }
+      break;
+    }
+
+    case 'relay-producer-added':
+      await addRelayProducer(channelId, data.producer);
+      break;
+
+    case 'relay-producer-removed': {
+      if (!relay || !relay.producerIds.delete(data.producerId)) break;
+      removeChannelProducer(channels.get(channelId), data.producerId);
+      pushStatsUpdate();
+      break;
+    }
+
+    case 'relay-producer-paused':
+    case 'relay-producer-resumed': {
+      if (!relay || !relay.producerIds.has(data.producerId)) break;
+      const producerInfo = channels.get(channelId)?.producers.get(data.producerId);
+      if (!producerInfo || producerInfo.producer.closed) break;
+      if (action === 'relay-producer-paused') {
+        await producerInfo.producer.pause();
+      } else {
+        await producerInfo.producer.resume();
+      }
+      break;
+    }
+
+    case 'relay-error':
+      console.error(`🔗 Origin refused relay${channelId ? ` for ${channelId}` : ''}: ${data.message}`);
+      if (channelId) dropRelay(channelId, { notifyOrigin: false });
+      break;
+
+    default:
+      console.log(`Unknown relay action: ${action}`);
+  }
+}
+
 // Handle WebSocket messages
 async function handleMessage(ws, clientId, payload) {
   const { action, data } = payload;
@@ -334,21 +821,16 @@ async function handleMessage(ws, clientId, payload) {
 
       // Auto-create channel if it doesn't exist
       if (!channels.has(data.channelId)) {
-        channels.set(data.channelId, {
-          producers: new Map(),
-          consumers: new Map()
-        });
+        channels.set(data.channelId, createChannelState());
         console.log(`Auto-created channel: ${data.channelId}`);
       }
 
-      const transport = await router.createWebRtcTransport({
-        listenIps: [{ ip: '0.0.0.0', announcedIp: config.announcedIp }],
-        enableUdp: true,
-        enableTcp: true,
-        preferUdp: true
-      });
+      // Publishers produce on the channel's home router
+      const publishRouter = channels.get(data.channelId).router;
+      const transport = await createWebRtcTransport(publishRouter);
 
       clientInfo.transport = transport;
+      clientInfo.router = publishRouter;
       clientInfo.isPublisher = true;
       clientInfo.channelId = data.channelId;
       clientInfo.publisherId = data.publisherId || null;
@@ -416,6 +898,7 @@ async function handleMessage(ws, clientId, payload) {
       channel.producers.set(producerId, {
         transport: clientInfo.transport,
         producer,
+        router: clientInfo.router,
         clientId,
         publisherId: clientInfo.publisherId
       });
@@ -431,14 +914,7 @@ async function handleMessage(ws, clientId, payload) {
       pushStatsUpdate();
 
       // Create consumers for existing listeners
-      for (const [otherId, otherClient] of clients) {
-        if (otherClient.isListener &&
-            otherClient.channelId === clientInfo.channelId &&
-            otherClient.transport &&
-            otherClient.rtpCapabilities) {
-          await createConsumerForListener(otherClient, producer, producerId, clientInfo.channelId);
-        }
-      }
+      await consumeForChannelListeners(clientInfo.channelId, producer, producerId);
       break;
     }
 
@@ -451,27 +927,13 @@ async function handleMessage(ws, clientId, payload) {
         break;
       }
 
-      // Auto-create channel if it doesn't exist
-      if (!channels.has(data.channelId)) {
-        channels.set(data.channelId, {
-          producers: new Map(),
-          consumers: new Map()
-        });
-      }
+      const transport = await attachListener(clientInfo, data);
 
-      const transport = await router.createWebRtcTransport({
-        listenIps: [{ ip: '0.0.0.0', announcedIp: config.announcedIp }],
-        enableUdp: true,
-        enableTcp: true,
-        preferUdp: true
+      // Edge mode: start pulling the channel from the origin; consumers follow once it arrives
+      ensureRelay(data.channelId).catch((error) => {
+        console.error(`🔗 Relay for ${data.channelId} failed:`, error.message);
       });
 
-      clientInfo.transport = transport;
-      clientInfo.isListener = true;
-      clientInfo.channelId = data.channelId;
-      clientInfo.rtpCapabilities = data.rtpCapabilities;
-      clientInfo.displayName = data.displayName || 'Anonymous';
-
       ws.send(JSON.stringify({
         action: 'listener-transport-created',
         data: {
@@ -531,39 +993,7 @@ async function handleMessage(ws, clientId, payload) {
       }
 
       try {
-        const consumersData = [];
-
-        for (const [prodId, prodInfo] of consumerChannel.producers) {
-          if (prodInfo.producer.closed) continue;
-
-          if (!router.canConsume({ producerId: prodInfo.producer.id, rtpCapabilities: data.rtpCapabilities })) {
-            console.log(`Client ${clientId} cannot consume producer ${prodId}`);
-            continue;
-          }
-
-          const consumerObj = await clientInfo.transport.consume({
-            producerId: prodInfo.producer.id,
-            rtpCapabilities: data.rtpCapabilities,
-            paused: false
-          });
-
-          // Use the actual mediasoup consumer ID
-          clientInfo.consumers.push({ id: consumerObj.id, consumer: consumerObj, producerId: prodId });
-          consumerChannel.consumers.set(consumerObj.id, {
-            transport: clientInfo.transport,
-            consumer: consumerObj,
-            clientId,
-            displayName: clientInfo.displayName,
-            producerId: prodId
-          });
-
-          consumersData.push({
-            id: consumerObj.id,
-            producerId: prodId,
-            kind: consumerObj.kind,
-            rtpParameters: consumerObj.rtpParameters
-          });
-        }
+        const consumersData = await consumeChannelProducers(clientId, clientInfo, consumerChannel, data.rtpCapabilities);
 
         ws.send(JSON.stringify({
           action: 'consumer-created',
@@ -585,6 +1015,44 @@ async function handleMessage(ws, clientId, payload) {
       break;
     }
 
+    // Transport and consumers in one round trip (same reply as the main server's join-listener)
+    case 'join-listener': {
+      if (!data || !data.channelId || !data.rtpCapabilities) {
+        ws.send(JSON.stringify({
+          action: 'error',
+          data: { message: 'Channel ID and RTP capabilities required' }
+        }));
+        break;
+      }
+
+      const transport = await attachListener(clientInfo, data);
+
+      const joinConsumers = await consumeChannelProducers(clientId, clientInfo, channels.get(data.channelId), data.rtpCapabilities);
+      ws.send(JSON.stringify({
+        action: 'listener-joined',
+        data: {
+          channelId: data.channelId,
+          transport: {
+            id: transport.id,
+            iceParameters: transport.iceParameters,
+            iceCandidates: transport.iceCandidates,
+            dtlsParameters: transport.dtlsParameters
+          },
+          consumers: joinConsumers,
+          waitingForPublisher: joinConsumers.length === 0
+        }
+      }));
+
+      // Edge mode: consumers for relayed producers follow as they arrive
+      ensureRelay(data.channelId).catch((error) => {
+        console.error(`🔗 Relay for ${data.channelId} failed:`, error.message);
+      });
+      if (joinConsumers.length > 0) {
+        pushStatsUpdate();
+      }
+      break;
+    }
+
     case 'stop-broadcasting': {
       const channel = channels.get(clientInfo.channelId);
       if (channel) {
@@ -623,6 +1091,8 @@ async function handleMessage(ws, clientId, payload) {
         clientInfo.transport.close();
         clientInfo.transport = null;
       }
+      detachListenerRouter(clientInfo);
+      scheduleRelayRelease(clientInfo.channelId);
 
       // Push stats update to main server
       pushStatsUpdate();
@@ -647,7 +1117,11 @@ async function createConsumerForListener(listenerClient, producer, producerId, c
       return;
     }
 
-    if (!router.canConsume({ producerId: producer.id, rtpCapabilities: listenerClient.rtpCapabilities })) {
+    const producerInfo = channels.get(channelId)?.producers.get(producerId);
+    if (producerInfo) {
+      await ensureProducerOnRouter(producerInfo, listenerClient.router);
+    }
+    if (!listenerClient.router.canConsume({ producerId: producer.id, rtpCapabilities: listenerClient.rtpCapabilities })) {
       console.log(`Cannot consume producer ${producer.id} for listener`);
       return;
     }
@@ -715,9 +1189,11 @@ function cleanup(clientId) {
   if (clientInfo.transport) {
     clientInfo.transport.close();
   }
+  detachListenerRouter(clientInfo);
 
   // Remove client
   clients.delete(clientId);
+  if (clientInfo.isListener) scheduleRelayRelease(clientInfo.channelId);
 
   // Push stats update to main server
   pushStatsUpdate();
@@ -740,7 +1216,9 @@ async function registerWithMaster() {
         url: sfuUrl,
         announced_ip: config.announcedIp,
         port: config.port,
-        secret_key: config.secretKey
+        secret_key: config.secretKey,
+        heartbeat_interval_ms: config.heartbeatIntervalMs,
+        load: await getLoad()
       })
     });
 
@@ -760,20 +1238,90 @@ async function registerWithMaster() {
   }
 }
 
-// Send heartbeat to master
-async function sendHeartbeat(sfuId) {
+// CPU is measured between two load samples from the workers' cumulative rusage
+let lastCpuSample = null; // { at, cpuMs }
+let draining = false;
+
+// Average over workers, so 100 means every worker's core is busy
+async function sampleWorkerCpuPercent() {
+  const usages = await Promise.all(workerEntries.map(entry => entry.worker.getResourceUsage()));
+  const cpuMs = usages.reduce((sum, usage) => sum + usage.ru_utime + usage.ru_stime, 0) / workerEntries.length;
+  const sample = { at: Date.now(), cpuMs };
+  const previous = lastCpuSample;
+  lastCpuSample = sample;
+  if (!previous || sample.at <= previous.at) return 0;
+  return Math.round(((sample.cpuMs - previous.cpuMs) / (sample.at - previous.at)) * 1000) / 10;
+}
+
+// Current load, sent with each heartbeat so the master can place listeners
+async function getLoad() {
+  let listeners = 0;
+  const listenerTransports = [];
+  for (const client of clients.values()) {
+    if (client.isListener && client.transport) {
+      listeners++;
+      listenerTransports.push(client.transport);
+    }
+  }
+
+  const [cpuPercent, transportStats] = await Promise.all([
+    sampleWorkerCpuPercent().catch(() => 0),
+    Promise.all(listenerTransports.map(transport => transport.getStats().catch(() => [])))
+  ]);
+  let egressBitrate = 0;
+  for (const stats of transportStats) {
+    for (const stat of stats) egressBitrate += stat.sendBitrate || 0;
+  }
+
+  return {
+    cpuPercent,
+    egressBitrate,
+    freePorts: Math.max(0, config.rtcMaxPort - config.rtcMinPort + 1 - rtcPortsInUse),
+    listeners,
+    channels: channels.size,
+    relayedChannels: relays.size,
+    origin: config.originUrl,
+    draining
+  };
+}
+
+// Send heartbeat to master; re-register if the master no longer knows this SFU (e.g. it restarted)
+async function sendHeartbeat() {
   try {
-    await fetch(`${config.masterUrl}/api/sfu/${sfuId}/heartbeat`, {
+    const response = await fetch(`${config.masterUrl}/api/sfu/${registeredSfuId}/heartbeat`, {
       method: 'POST',
       headers: {
-        'Authorization': `Bearer ${config.secretKey}`
-      }
+        'Authorization': `Bearer ${config.secretKey}`,
+        'Content-Type': 'application/json'
+      },
+      body: JSON.stringify({ load: await getLoad() })
     });
+    if (response.status === 404) {
+      console.log('⚠️  Master lost this SFU, re-registering...');
+      registeredSfuId = (await registerWithMaster()) || registeredSfuId;
+      if (draining) await sendDrain(true);
+    }
   } catch (error) {
     console.error('⚠️  Heartbeat failed:', error.message);
   }
 }
 
+// Ask the master to stop (or resume) placing new listeners here
+async function sendDrain(enabled) {
+  try {
+    await fetch(`${config.masterUrl}/api/sfu/${registeredSfuId}/drain`, {
+      method: 'POST',
+      headers: {
+        'Authorization': `Bearer ${config.secretKey}`,
+        'Content-Type': 'application/json'
+      },
+      body: JSON.stringify({ draining: enabled })
+    });
+  } catch (error) {
+    console.error('⚠️  Failed to update drain mode:', error.message);
+  }
+}
+
 // Send disconnect signal to master
 async function sendDisconnect(sfuId) {
   try {
@@ -802,12 +1350,17 @@ async function main() {
     // Start WebSocket server
     startWebSocketServer();
 
+    // Edge mode: relay channels from the origin
+    if (config.originUrl) {
+      connectToOrigin();
+    }
+
     // Register with master (optional, will continue even if it fails)
     registeredSfuId = await registerWithMaster();
 
     // Start heartbeat if registered
     if (registeredSfuId) {
-      setInterval(() => sendHeartbeat(registeredSfuId), 30000); // Every 30 seconds
+      setInterval(sendHeartbeat, config.heartbeatIntervalMs);
 
       // Connect to stats WebSocket for real-time updates
       connectToMainServerStats();
@@ -823,6 +1376,28 @@ async function main() {
   }
 }
 
+function countListeners() {
+  let count = 0;
+  for (const client of clients.values()) {
+    if (client.isListener && client.transport) count++;
+  }
+  return count;
+}
+
+// Rolling restart: leave placement, then wait for listeners to finish (or the timeout)
+async function drainAndShutdown() {
+  if (draining || !config.drainTimeoutMs) return shutdown();
+  draining = true;
+  console.log(`\n🚰 Draining: no new listeners, waiting up to ${config.drainTimeoutMs}ms for ${countListeners()} listener(s)`);
+  if (registeredSfuId) await sendDrain(true);
+
+  const deadline = Date.now() + config.drainTimeoutMs;
+  while (countListeners() > 0 && Date.now() < deadline) {
+    await new Promise(resolve => setTimeout(resolve, 1000));
+  }
+  return shutdown();
+}
+
 // Handle shutdown gracefully
 async function shutdown() {
   console.log('\n🛑 Shutting down SFU server...');
@@ -835,18 +1410,27 @@ async function shutdown() {
     statsWs.close();
   }
 
+  // Close the origin relay without reconnecting
+  if (relayReconnectTimer) {
+    clearTimeout(relayReconnectTimer);
+  }
+  if (relayWs) {
+    relayWs.removeAllListeners('close');
+    relayWs.close();
+  }
+
   // Notify master of disconnect
   if (registeredSfuId) {
     await sendDisconnect(registeredSfuId);
   }
 
-  if (worker) worker.close();
+  for (const entry of workerEntries) entry.worker.close();
   if (wss) wss.close();
   process.exit(0);
 }
 
 process.on('SIGINT', shutdown);
-process.on('SIGTERM', shutdown);
+process.on('SIGTERM', drainAndShutdown);
 
 // Start the server
 main();
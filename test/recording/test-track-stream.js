@@ -0,0 +1,114 @@
+import { test, after } from 'node:test';
+import assert from 'node:assert/strict';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+
+process.env.RECORDING_FOLLOW_POLL_MS = '5';
+const { parseRangeHeader, createTrackReadStream, getTrackSize } = await import('../../src/recording/track-stream.js');
+
+const tempDirs = [];
+after(() => {
+  for (const dir of tempDirs) fs.rmSync(dir, { recursive: true, force: true });
+});
+
+function tempDir() {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'track-stream-'));
+  tempDirs.push(dir);
+  return dir;
+}
+
+// Source over segment files with bytes 0..n-1 (mod 256) laid out across them
+function segmentSource(dir, sizes) {
+  const files = [];
+  let offset = 0;
+  sizes.forEach((size, i) => {
+    const filePath = path.join(dir, `segment_${i}.webm`);
+    fs.writeFileSync(filePath, Uint8Array.from({ length: size }, (_, j) => (offset + j) & 0xff));
+    files.push(filePath);
+    offset += size;
+  });
+  return { isLive: () => false, listFiles: () => files };
+}
+
+function expectedBytes(start, end) {
+  return Buffer.from(Uint8Array.from({ length: end - start + 1 }, (_, i) => (start + i) & 0xff));
+}
+
+async function collect(stream) {
+  const chunks = [];
+  for await (const chunk of stream) chunks.push(chunk);
+  return Buffer.concat(chunks);
+}
+
+test('parseRangeHeader: absent or malformed headers serve the whole file', () => {
+  for (const header of [undefined, '', 'bytes=-', 'items=0-1', 'bytes=0-1,5-6', 'bytes=a-b']) {
+    assert.equal(parseRangeHeader(header, 100), null, `header ${header}`);
+  }
+});
+
+test('parseRangeHeader: closed, open-ended, suffix and clamped ranges', () => {
+  assert.deepEqual(parseRangeHeader('bytes=0-9', 100), { start: 0, end: 9 });
+  assert.deepEqual(parseRangeHeader(' bytes=10-10 ', 100), { start: 10, end: 10 });
+  assert.deepEqual(parseRangeHeader('bytes=40-', 100), { start: 40, end: 99 });
+  assert.deepEqual(parseRangeHeader('bytes=-10', 100), { start: 90, end: 99 });
+  assert.deepEqual(parseRangeHeader('bytes=-500', 100), { start: 0, end: 99 });
+  assert.deepEqual(parseRangeHeader('bytes=50-1000', 100), { start: 50, end: 99 });
+});
+
+test('parseRangeHeader: ranges outside the file are unsatisfiable', () => {
+  assert.equal(parseRangeHeader('bytes=100-', 100), 'unsatisfiable');
+  assert.equal(parseRangeHeader('bytes=100-200', 100), 'unsatisfiable');
+  assert.equal(parseRangeHeader('bytes=20-10', 100), 'unsatisfiable');
+  assert.equal(parseRangeHeader('bytes=-0', 100), 'unsatisfiable');
+  assert.equal(parseRangeHeader('bytes=0-', 0), 'unsatisfiable');
+});
+
+test('ranges are read across segment file boundaries', async () => {
+  const source = segmentSource(tempDir(), [1000, 70000, 10, 5000]);
+  const size = await getTrackSize(source);
+  assert.equal(size, 76010);
+
+  assert.deepEqual(await collect(createTrackReadStream(source)), expectedBytes(0, size - 1));
+  for (const [start, end] of [[0, 0], [990, 1010], [999, 71009], [71000, 71012], [71010, 76009], [500, 500]]) {
+    const bytes = await collect(createTrackReadStream(source, { start, end }));
+    assert.deepEqual(bytes, expectedBytes(start, end), `range ${start}-${end}`);
+  }
+});
+
+test('a missing file contributes no bytes to the size', async () => {
+  const source = segmentSource(tempDir(), [10]);
+  const files = [...source.listFiles(), '/nonexistent/segment.webm'];
+  assert.equal(await getTrackSize({ listFiles: () => files }), 10);
+});
+
+test('follow tails a growing file and new segments until recording stops', async () => {
+  const dir = tempDir();
+  const first = path.join(dir, 'segment_0.webm');
+  const second = path.join(dir, 'segment_1.webm');
+  let live = true;
+  const files = [first];
+  fs.writeFileSync(first, expectedBytes(0, 99));
+  const source = { isLive: () => live, listFiles: () => files };
+
+  const done = collect(createTrackReadStream(source, { follow: true }));
+  await new Promise((resolve) => setTimeout(resolve, 20));
+  fs.appendFileSync(first, expectedBytes(100, 149));
+  await new Promise((resolve) => setTimeout(resolve, 20));
+  fs.writeFileSync(second, expectedBytes(150, 199));
+  files.push(second);
+  await new Promise((resolve) => setTimeout(resolve, 20));
+  fs.appendFileSync(second, expectedBytes(200, 209));
+  live = false;
+
+  assert.deepEqual(await done, expectedBytes(0, 209));
+});
+
+test('follow stops when the signal aborts', async () => {
+  const source = segmentSource(tempDir(), [10]);
+  source.isLive = () => true;
+  const abort = new AbortController();
+  const done = collect(createTrackReadStream(source, { follow: true, signal: abort.signal }));
+  setTimeout(() => abort.abort(), 20);
+  assert.deepEqual(await done, expectedBytes(0, 9));
+});
@@ -0,0 +1,137 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { EventEmitter } from 'events';
+import { RelayOrigin } from '../../src/media/relay-origin.js';
+
+const quietLog = { info() {}, warn() {}, error() {} };
+
+function deferred() {
+  let resolve;
+  const promise = new Promise((r) => { resolve = r; });
+  return { promise, resolve };
+}
+
+function fakeProducer(id) {
+  return { id, closed: false };
+}
+
+function fakeConsumer(producerId) {
+  const consumer = new EventEmitter();
+  Object.assign(consumer, {
+    producerId,
+    kind: 'audio',
+    rtpParameters: { codecs: [] },
+    producerPaused: false,
+    closed: false,
+    close() { this.closed = true; }
+  });
+  return consumer;
+}
+
+// Router whose pipe transport connects only when the test releases it
+function fakeRouter(connectGate) {
+  return {
+    async createPipeTransport() {
+      return {
+        closed: false,
+        observer: new EventEmitter(),
+        tuple: { localAddress: '127.0.0.1', localPort: 40000 },
+        connect: () => connectGate.promise,
+        async consume({ producerId }) { return fakeConsumer(producerId); },
+        close() { this.closed = true; }
+      };
+    }
+  };
+}
+
+function setup({ consumeGate = null } = {}) {
+  const connectGate = deferred();
+  const channel = { router: fakeRouter(connectGate), producers: new Map() };
+  const workerPool = {
+    async ensureProducerOnRouter() {
+      if (consumeGate) await consumeGate.promise;
+    }
+  };
+  const origin = new RelayOrigin({ workerPool, getChannel: () => channel, listenIp: '127.0.0.1', log: quietLog });
+  const sent = [];
+  const edge = { socket: { send: (text) => sent.push(JSON.parse(text)) }, name: 'edge', relays: new Map() };
+  return { origin, channel, edge, sent, connectGate };
+}
+
+function addChannelProducer(origin, channel, producerId) {
+  const producerInfo = { producer: fakeProducer(`mediasoup-${producerId}`), publisherId: null };
+  channel.producers.set(producerId, producerInfo);
+  return origin.addProducer('room:main', producerId, producerInfo);
+}
+
+test('a producer added before the pipe connects is in the relay-subscribed snapshot', async () => {
+  const { origin, channel, edge, sent, connectGate } = setup();
+  await addChannelProducer(origin, channel, 'p1');
+
+  const subscribing = origin.subscribe(edge, { channelId: 'room:main', ip: '10.0.0.2', port: 5000 });
+  await new Promise((resolve) => setImmediate(resolve));
+  await addChannelProducer(origin, channel, 'p2'); // produced while the subscribe is in flight
+  assert.deepEqual(sent, []);
+
+  connectGate.resolve();
+  await subscribing;
+  assert.equal(sent.length, 1);
+  assert.equal(sent[0].action, 'relay-subscribed');
+  assert.deepEqual(sent[0].data.producers.map((p) => p.producerId), ['p1', 'p2']);
+
+  // Later producers are announced individually
+  await addChannelProducer(origin, channel, 'p3');
+  assert.equal(sent.length, 2);
+  assert.equal(sent[1].action, 'relay-producer-added');
+  assert.equal(sent[1].data.producer.producerId, 'p3');
+});
+
+test('producers added while the snapshot is being consumed are included', async () => {
+  const consumeGate = deferred();
+  const { origin, channel, edge, sent, connectGate } = setup({ consumeGate });
+  channel.producers.set('p1', { producer: fakeProducer('m1') });
+  connectGate.resolve();
+
+  const subscribing = origin.subscribe(edge, { channelId: 'room:main', ip: '10.0.0.2', port: 5000 });
+  await new Promise((resolve) => setImmediate(resolve));
+  const adding = addChannelProducer(origin, channel, 'p2');
+  consumeGate.resolve();
+  await Promise.all([subscribing, adding]);
+
+  assert.deepEqual(sent.map((m) => m.action), ['relay-subscribed']);
+  assert.deepEqual(sent[0].data.producers.map((p) => p.producerId), ['p1', 'p2']);
+  assert.equal(edge.relays.get('room:main').consumers.size, 2);
+});
+
+test('a producer that leaves the channel during subscribe is not announced', async () => {
+  const { origin, channel, edge, sent, connectGate } = setup();
+  channel.producers.set('p1', { producer: fakeProducer('m1') });
+  channel.producers.set('p2', { producer: fakeProducer('m2') });
+  const consumers = [];
+  const { consumeProducer } = origin;
+  origin.consumeProducer = async function (relay, producerId, producerInfo) {
+    const description = await consumeProducer.call(this, relay, producerId, producerInfo);
+    consumers.push(relay.consumers.get(producerId));
+    if (producerId === 'p1') channel.producers.delete('p1'); // e.g. moved to another channel
+    return description;
+  };
+  connectGate.resolve();
+  await origin.subscribe(edge, { channelId: 'room:main', ip: '10.0.0.2', port: 5000 });
+
+  assert.deepEqual(sent[0].data.producers.map((p) => p.producerId), ['p2']);
+  assert.ok(consumers[0].closed);
+  assert.deepEqual([...edge.relays.get('room:main').consumers.keys()], ['p2']);
+});
+
+test('an edge that unsubscribes mid-subscribe gets no snapshot and is not relayed to', async () => {
+  const { origin, channel, edge, sent, connectGate } = setup();
+  channel.producers.set('p1', { producer: fakeProducer('m1') });
+  const subscribing = origin.subscribe(edge, { channelId: 'room:main', ip: '10.0.0.2', port: 5000 });
+  await new Promise((resolve) => setImmediate(resolve));
+  origin.unsubscribe(edge, 'room:main');
+  connectGate.resolve();
+  await subscribing;
+
+  assert.deepEqual(sent, []);
+  assert.equal(origin.relaysByChannel.has('room:main'), false);
+});
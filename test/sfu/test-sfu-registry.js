@@ -0,0 +1,105 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { SfuRegistry } from '../../src/media/sfu-registry.js';
+
+const ORIGIN = 'http://origin.test:3000';
+
+function addEdge(registry, url, load = {}) {
+  return registry.register({
+    url,
+    heartbeat_interval_ms: 30000,
+    load: { origin: ORIGIN, cpuPercent: 10, listeners: 10, freePorts: 100, ...load }
+  });
+}
+
+test('place picks the least-loaded healthy edge', () => {
+  const registry = new SfuRegistry();
+  addEdge(registry, 'ws://a', { cpuPercent: 40 });
+  const b = addEdge(registry, 'ws://b', { cpuPercent: 20 });
+  assert.equal(registry.place('room:main').id, b.id);
+});
+
+test('place skips non-edges, draining, stale, full and overloaded nodes', () => {
+  const registry = new SfuRegistry({ maxCpuPercent: 85 });
+  registry.register({ url: 'ws://standalone', load: { cpuPercent: 0, freePorts: 10 } });
+  const draining = addEdge(registry, 'ws://draining', { cpuPercent: 0 });
+  registry.setDraining(draining.id, true);
+  const stale = addEdge(registry, 'ws://stale', { cpuPercent: 0 });
+  stale.lastHeartbeatAt = Date.now() - 30000 * 4;
+  addEdge(registry, 'ws://full', { cpuPercent: 0, freePorts: 0 });
+  addEdge(registry, 'ws://busy', { cpuPercent: 90 });
+  assert.equal(registry.place('room:main'), null);
+
+  const ok = addEdge(registry, 'ws://ok', { cpuPercent: 50 });
+  assert.equal(registry.place('room:main').id, ok.id);
+});
+
+test('place prefers an edge already relaying the channel', () => {
+  const registry = new SfuRegistry();
+  addEdge(registry, 'ws://idle', { cpuPercent: 10 });
+  const relaying = addEdge(registry, 'ws://relaying', { cpuPercent: 15 });
+  registry.updateChannels(relaying.id, { 'room:main': { publishers: 1, subscribers: 10 } }, 10);
+  assert.equal(registry.place('room:main').id, relaying.id);
+  // Other channels still go to the idle node
+  assert.notEqual(registry.place('room:other').id, relaying.id);
+});
+
+test('channel ids that name Object.prototype members are not treated as hosted', () => {
+  const registry = new SfuRegistry();
+  const hosting = addEdge(registry, 'ws://hosting', { cpuPercent: 15 });
+  addEdge(registry, 'ws://idle', { cpuPercent: 10 });
+  registry.updateChannels(hosting.id, { 'room:main': { publishers: 1, subscribers: 10 } }, 10);
+  for (const channelId of ['constructor', '__proto__', 'toString', 'hasOwnProperty']) {
+    assert.notEqual(registry.place(channelId).id, hosting.id, `channel ${channelId}`);
+  }
+  // Heartbeat data parsed from JSON can carry an own __proto__ key
+  registry.updateChannels(hosting.id, JSON.parse('{"__proto__": {"publishers": 1}}'), 10);
+  assert.equal(registry.place('__proto__').id, hosting.id);
+});
+
+test('placement lookups alone do not add load', () => {
+  const registry = new SfuRegistry();
+  const a = addEdge(registry, 'ws://a', { cpuPercent: 20 });
+  addEdge(registry, 'ws://b', { cpuPercent: 30 });
+  for (let i = 0; i < 1000; i++) {
+    assert.equal(registry.place('room:main').id, a.id);
+  }
+  assert.equal(a.joinedSinceHeartbeat, 0);
+});
+
+test('joins reported since the heartbeat spread a burst across edges', () => {
+  const registry = new SfuRegistry();
+  const a = addEdge(registry, 'ws://a', { cpuPercent: 20, listeners: 10 });
+  const b = addEdge(registry, 'ws://b', { cpuPercent: 30, listeners: 10 });
+
+  // 20 joins on a at 2 CPU points per listener: estimated 60, so b wins
+  registry.updateChannels(a.id, {}, 30);
+  assert.equal(a.joinedSinceHeartbeat, 20);
+  assert.equal(registry.place('room:main').id, b.id);
+
+  // The next heartbeat carries fresh load and resets the estimate
+  registry.heartbeat(a.id, { origin: ORIGIN, cpuPercent: 20, listeners: 30, freePorts: 100 });
+  assert.equal(a.joinedSinceHeartbeat, 0);
+  assert.equal(registry.place('room:main').id, a.id);
+});
+
+test('stats without a listener total keep the current estimate', () => {
+  const registry = new SfuRegistry();
+  const a = addEdge(registry, 'ws://a', { listeners: 10 });
+  registry.updateChannels(a.id, {}, 14);
+  registry.updateChannels(a.id, {});
+  assert.equal(a.joinedSinceHeartbeat, 4);
+  // Leaves below the heartbeat sample never go negative
+  registry.updateChannels(a.id, {}, 5);
+  assert.equal(a.joinedSinceHeartbeat, 0);
+});
+
+test('register refreshes an existing url and clears drain', () => {
+  const registry = new SfuRegistry();
+  const first = addEdge(registry, 'ws://a');
+  registry.setDraining(first.id, true);
+  const again = addEdge(registry, 'ws://a');
+  assert.equal(again.id, first.id);
+  assert.equal(again.draining, false);
+  assert.equal(registry.list().length, 1);
+});
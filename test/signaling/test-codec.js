@@ -0,0 +1,167 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import {
+  encodeMsgpack,
+  decodeMsgpack,
+  decodeFrame,
+  encodeFrame,
+  negotiateCodec,
+  CODEC_JSON,
+  CODEC_MSGPACK
+} from '../../src/signaling/codec.js';
+
+function roundTrip(value) {
+  return decodeMsgpack(encodeMsgpack(value));
+}
+
+function objectWithKeys(count) {
+  const object = {};
+  for (let i = 0; i < count; i++) object[`k${i}`] = i;
+  return object;
+}
+
+test('strings round-trip at each length class with the expected header', () => {
+  const cases = [
+    ['', 0xa0],
+    ['a'.repeat(10), 0xa0 | 10],
+    ['a'.repeat(31), 0xd9], // header is sized for the worst-case UTF-8 length
+    ['a'.repeat(200), 0xda],
+    ['a'.repeat(0x10000), 0xdb]
+  ];
+  for (const [value, tag] of cases) {
+    const bytes = encodeMsgpack(value);
+    assert.equal(bytes[0], tag, `tag for length ${value.length}`);
+    assert.equal(decodeMsgpack(bytes), value);
+  }
+});
+
+test('multi-byte UTF-8 strings round-trip', () => {
+  for (const value of ['héllo', '日本語テキスト', '🎙️ live', 'ü'.repeat(40000)]) {
+    assert.equal(roundTrip(value), value);
+  }
+});
+
+test('externally encoded str8/16/32 decode', () => {
+  assert.equal(decodeMsgpack(Uint8Array.of(0xd9, 2, 0x68, 0x69)), 'hi');
+  assert.equal(decodeMsgpack(Uint8Array.of(0xda, 0, 2, 0x68, 0x69)), 'hi');
+  assert.equal(decodeMsgpack(Uint8Array.of(0xdb, 0, 0, 0, 2, 0x68, 0x69)), 'hi');
+});
+
+test('maps round-trip as fixmap, map16 and map32', () => {
+  const cases = [[3, 0x83], [16, 0xde], [0x10000, 0xdf]];
+  for (const [count, tag] of cases) {
+    const value = objectWithKeys(count);
+    const bytes = encodeMsgpack(value);
+    assert.equal(bytes[0], tag, `tag for ${count} keys`);
+    assert.deepEqual(decodeMsgpack(bytes), value);
+  }
+});
+
+test('arrays round-trip as fixarray, array16 and array32', () => {
+  const cases = [[15, 0x9f], [16, 0xdc], [0x10000, 0xdd]];
+  for (const [length, tag] of cases) {
+    const value = Array.from({ length }, (_, i) => i % 7);
+    const bytes = encodeMsgpack(value);
+    assert.equal(bytes[0], tag, `tag for ${length} items`);
+    assert.deepEqual(decodeMsgpack(bytes), value);
+  }
+});
+
+test('integers round-trip at every width, including negatives', () => {
+  const values = [
+    0, 1, 127, 128, 255, 256, 65535, 65536, 0xffffffff, 0x100000000, Number.MAX_SAFE_INTEGER,
+    -1, -32, -33, -128, -129, -32768, -32769, -0x80000000, -0x80000001, Number.MIN_SAFE_INTEGER
+  ];
+  for (const value of values) {
+    assert.equal(roundTrip(value), value, `value ${value}`);
+  }
+  assert.equal(encodeMsgpack(-1)[0], 0xff); // negative fixint
+  assert.equal(encodeMsgpack(-33)[0], 0xd0);
+  assert.equal(encodeMsgpack(-129)[0], 0xd1);
+  assert.equal(encodeMsgpack(-32769)[0], 0xd2);
+  assert.equal(encodeMsgpack(-0x80000001)[0], 0xd3);
+});
+
+test('non-integers round-trip as float64; non-finite numbers become null like JSON', () => {
+  for (const value of [0.5, -1.25, Math.PI, 1e300, -5e-324]) {
+    const bytes = encodeMsgpack(value);
+    assert.equal(bytes[0], 0xcb);
+    assert.equal(bytes.length, 9);
+    assert.equal(decodeMsgpack(bytes), value);
+  }
+  assert.equal(roundTrip(NaN), null);
+  assert.equal(roundTrip(Infinity), null);
+  // float32 from other encoders
+  assert.equal(decodeMsgpack(Uint8Array.of(0xca, 0x3f, 0xc0, 0, 0)), 1.5);
+});
+
+test('bin round-trips as bin8, bin16 and bin32', () => {
+  const cases = [[0, 0xc4], [255, 0xc4], [256, 0xc5], [0x10000, 0xc6]];
+  for (const [length, tag] of cases) {
+    const value = Uint8Array.from({ length }, (_, i) => i & 0xff);
+    const bytes = encodeMsgpack(value);
+    assert.equal(bytes[0], tag, `tag for ${length} bytes`);
+    const decoded = decodeMsgpack(bytes);
+    assert.ok(decoded instanceof Uint8Array);
+    assert.deepEqual(decoded, value);
+  }
+  assert.deepEqual(roundTrip(Uint8Array.of(1, 2, 3).buffer), Uint8Array.of(1, 2, 3));
+});
+
+test('signaling messages round-trip like JSON', () => {
+  const message = {
+    action: 'join-listener',
+    data: {
+      channelId: 'room-1:main',
+      paused: false,
+      rtpCapabilities: { codecs: [{ mimeType: 'audio/opus', clockRate: 48000, channels: 2, parameters: {} }] },
+      nothing: null,
+      skipped: undefined,
+      when: new Date(0)
+    }
+  };
+  assert.deepEqual(roundTrip(message), JSON.parse(JSON.stringify(message)));
+});
+
+test('a __proto__ key decodes as an own property, as JSON.parse does', () => {
+  const bytes = encodeMsgpack(JSON.parse('{"__proto__": {"polluted": true}, "a": 1}'));
+  const decoded = decodeMsgpack(bytes);
+  assert.equal(Object.getPrototypeOf(decoded), Object.prototype);
+  assert.equal(decoded.polluted, undefined);
+  assert.deepEqual(Object.keys(decoded), ['__proto__', 'a']);
+  assert.deepEqual(decoded.__proto__, { polluted: true });
+  assert.equal({}.polluted, undefined);
+});
+
+test('truncated input throws at every cut point', () => {
+  const bytes = encodeMsgpack({
+    text: 'a'.repeat(300),
+    list: [1, -200, 70000, 0.25],
+    blob: Uint8Array.of(9, 8, 7)
+  });
+  for (let length = 0; length < bytes.length; length++) {
+    assert.throws(() => decodeMsgpack(bytes.subarray(0, length)), /Truncated MessagePack data/, `cut at ${length}`);
+  }
+  assert.throws(() => decodeMsgpack(Uint8Array.of(0xdb, 0xff, 0xff, 0xff, 0xff, 0x61)), /Truncated/);
+});
+
+test('trailing bytes and unsupported types are rejected', () => {
+  assert.throws(() => decodeMsgpack(Uint8Array.of(0x01, 0x02)), /Trailing bytes/);
+  assert.throws(() => decodeMsgpack(Uint8Array.of(0xc1)), /Unsupported MessagePack type 0xc1/);
+});
+
+test('frames: binary is MessagePack, text is JSON, codec is opt-in', () => {
+  const message = { action: 'ping', data: { n: 1 } };
+  assert.equal(negotiateCodec('msgpack'), CODEC_MSGPACK);
+  assert.equal(negotiateCodec('anything'), CODEC_JSON);
+  assert.equal(negotiateCodec(undefined), CODEC_JSON);
+
+  const binary = encodeFrame(message, CODEC_MSGPACK);
+  assert.deepEqual(decodeFrame(Buffer.from(binary), true), message);
+  // ws may deliver fragmented binary frames as an array of chunks
+  assert.deepEqual(decodeFrame([Buffer.from(binary.subarray(0, 3)), Buffer.from(binary.subarray(3))], true), message);
+
+  const text = encodeFrame(message);
+  assert.equal(typeof text, 'string');
+  assert.deepEqual(decodeFrame(Buffer.from(text), false), message);
+});
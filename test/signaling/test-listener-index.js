@@ -0,0 +1,116 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { createListenerIndex, countChannelListeners } from '../../src/signaling/listener-index.js';
+
+function channelState() {
+  return { producers: new Map(), consumers: new Map(), listenerRefs: new Map(), listenersByRouter: new Map() };
+}
+
+function closable(id) {
+  return { id, closed: false, close() { this.closed = true; } };
+}
+
+function listener(clientId) {
+  return { id: clientId, isListener: false, channelId: null, transport: null, router: null, consumers: new Map() };
+}
+
+// What a join does to the index: a transport on a router plus one consumer per producer
+function join(index, clientInfo, channelId, channel, router, producerIds) {
+  index.addChannelListenerRouter(channel, router);
+  Object.assign(clientInfo, { isListener: true, channelId, transport: closable(`t-${channelId}`), router });
+  for (const producerId of producerIds) {
+    const consumerId = `${clientInfo.id}-${producerId}`;
+    index.addChannelConsumer(channel, consumerId, { clientId: clientInfo.id, producerId, consumer: closable(consumerId) });
+  }
+}
+
+test('consumers are indexed from both the channel and the listener', () => {
+  const clients = new Map();
+  const index = createListenerIndex(clients);
+  const channel = channelState();
+  const a = listener('a');
+  const b = listener('b');
+  clients.set('a', a).set('b', b);
+  join(index, a, 'room:main', channel, { id: 'r1' }, ['p1', 'p2']);
+  join(index, b, 'room:main', channel, { id: 'r1' }, ['p1']);
+
+  assert.equal(channel.consumers.size, 3);
+  assert.equal(a.consumers.size, 2);
+  assert.equal(countChannelListeners(channel), 2);
+  assert.equal(channel.listenersByRouter.get('r1'), 2);
+
+  // Removing from the channel side (e.g. the producer closed) updates the listener too
+  index.removeChannelConsumer(channel, 'a-p1');
+  assert.equal(a.consumers.size, 1);
+  assert.equal(countChannelListeners(channel), 2);
+  index.removeChannelConsumer(channel, 'a-p2');
+  assert.equal(countChannelListeners(channel), 1);
+  assert.equal(countChannelListeners(null), 0);
+});
+
+test('releaseListener undoes a join: consumers, transport and router refs', () => {
+  const clients = new Map();
+  const index = createListenerIndex(clients);
+  const channel = channelState();
+  const a = listener('a');
+  const b = listener('b');
+  clients.set('a', a).set('b', b);
+  join(index, a, 'room:main', channel, { id: 'r1' }, ['p1', 'p2']);
+  join(index, b, 'room:main', channel, { id: 'r1' }, ['p1']);
+  const transport = a.transport;
+  const consumers = [...a.consumers.values()].map((entry) => entry.consumer);
+
+  index.releaseListener(channel, a);
+
+  assert.ok(transport.closed);
+  assert.ok(consumers.every((consumer) => consumer.closed));
+  assert.equal(a.consumers.size, 0);
+  assert.deepEqual([...channel.consumers.keys()], ['b-p1']);
+  assert.equal(countChannelListeners(channel), 1);
+  assert.equal(channel.listenersByRouter.get('r1'), 1);
+  assert.deepEqual(
+    { isListener: a.isListener, channelId: a.channelId, transport: a.transport, router: a.router },
+    { isListener: false, channelId: null, transport: null, router: null }
+  );
+});
+
+test('repeated joins on one socket leave only the latest join behind', () => {
+  const clients = new Map();
+  const index = createListenerIndex(clients);
+  const channels = { one: channelState(), two: channelState() };
+  const a = listener('a');
+  clients.set('a', a);
+  const transports = [];
+
+  for (let i = 0; i < 50; i++) {
+    const channelId = i % 2 ? 'one' : 'two';
+    // handleJoinListener: release the previous join first
+    if (a.isListener) index.releaseListener(channels[a.channelId], a);
+    join(index, a, channelId, channels[channelId], { id: `r${i % 3}` }, ['p1', 'p2']);
+    transports.push(a.transport);
+  }
+
+  assert.equal(transports.filter((transport) => !transport.closed).length, 1);
+  assert.equal(channels.two.consumers.size, 0);
+  assert.equal(countChannelListeners(channels.two), 0);
+  assert.equal(channels.two.listenersByRouter.size, 0);
+  assert.equal(channels.one.consumers.size, 2);
+  assert.equal(countChannelListeners(channels.one), 1);
+  assert.deepEqual([...channels.one.listenersByRouter.values()], [1]);
+});
+
+test('releaseListener closes everything when the channel is already gone', () => {
+  const clients = new Map();
+  const index = createListenerIndex(clients);
+  const a = listener('a');
+  clients.set('a', a);
+  join(index, a, 'room:gone', channelState(), { id: 'r1' }, ['p1']);
+  const transport = a.transport;
+  const [{ consumer }] = a.consumers.values();
+
+  index.releaseListener(null, a);
+  assert.ok(transport.closed);
+  assert.ok(consumer.closed);
+  assert.equal(a.consumers.size, 0);
+  assert.equal(a.isListener, false);
+});
@@ -0,0 +1,102 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { PublisherChatHistory, findIdleChannelId, getOrCreateChannel } from '../../src/signaling/state-limits.js';
+
+function message(text) {
+  return { text, at: Date.now() };
+}
+
+function channelState({ producers = 0, consumers = 0, listenerRouters = 0 } = {}) {
+  const fill = (count) => new Map(Array.from({ length: count }, (_, i) => [`id${i}`, {}]));
+  return {
+    producers: fill(producers),
+    consumers: fill(consumers),
+    listenerRefs: new Map(),
+    listenersByRouter: fill(listenerRouters)
+  };
+}
+
+test('chat history keeps the latest messages per publisher and tracks totals', () => {
+  const history = new PublisherChatHistory({ perPublisherLimit: 3, maxPublishers: 10 });
+  for (const text of ['a', 'bb', 'ccc', 'dddd', 'eeeee']) history.push('p1', message(text));
+  history.push('p2', message('xy'));
+
+  assert.deepEqual(history.get('p1').map((m) => m.text), ['ccc', 'dddd', 'eeeee']);
+  assert.deepEqual(history.get('missing'), []);
+  assert.equal(history.publisherCount, 2);
+  assert.equal(history.messageCount, 4);
+  assert.equal(history.textChars, 3 + 4 + 5 + 2);
+});
+
+test('chat history drops the least recently used publisher at the limit', () => {
+  const history = new PublisherChatHistory({ perPublisherLimit: 10, maxPublishers: 2 });
+  history.push('p1', message('one'));
+  history.push('p2', message('two'));
+  history.push('p1', message('again')); // p1 is now the most recently used
+  history.push('p3', message('three'));
+
+  assert.deepEqual(history.get('p2'), []);
+  assert.equal(history.get('p1').length, 2);
+  assert.equal(history.get('p3').length, 1);
+  assert.equal(history.publisherCount, 2);
+  assert.equal(history.messageCount, 3);
+  assert.equal(history.textChars, 'one'.length + 'again'.length + 'three'.length);
+});
+
+test('chat history limits of 0 are unbounded', () => {
+  const history = new PublisherChatHistory();
+  for (let i = 0; i < 500; i++) history.push(`p${i % 50}`, message('m'));
+  assert.equal(history.publisherCount, 50);
+  assert.equal(history.get('p0').length, 10);
+  assert.equal(history.messageCount, 500);
+});
+
+test('findIdleChannelId returns the oldest channel nothing uses', () => {
+  const channels = new Map([
+    ['joined', channelState()],
+    ['producing', channelState({ producers: 1 })],
+    ['consuming', channelState({ consumers: 1 })],
+    ['transports', channelState({ listenerRouters: 1 })],
+    ['relayed', channelState()],
+    ['idle-1', channelState()],
+    ['idle-2', channelState()]
+  ]);
+  const clients = [{ channelId: 'joined' }, { channelId: null }];
+  const isRelayed = (id) => id === 'relayed';
+  assert.equal(findIdleChannelId(channels, clients, isRelayed), 'idle-1');
+
+  channels.delete('idle-1');
+  channels.delete('idle-2');
+  assert.equal(findIdleChannelId(channels, clients, isRelayed), null);
+});
+
+test('getOrCreateChannel evicts an idle channel at the limit and refuses when all are busy', () => {
+  const channels = new Map();
+  const evicted = [];
+  const clients = [];
+  const options = {
+    maxChannels: 2,
+    createChannel: () => channelState(),
+    clients,
+    onEvict: (id) => evicted.push(id)
+  };
+
+  const a = getOrCreateChannel(channels, 'a', options);
+  assert.equal(getOrCreateChannel(channels, 'a', options), a);
+  getOrCreateChannel(channels, 'b', options).producers.set('p', {});
+  clients.push({ channelId: 'a' });
+  assert.equal(getOrCreateChannel(channels, 'c', options), null);
+  assert.deepEqual([...channels.keys()], ['a', 'b']);
+
+  clients.length = 0;
+  assert.ok(getOrCreateChannel(channels, 'c', options));
+  assert.deepEqual(evicted, ['a']);
+  assert.deepEqual([...channels.keys()], ['b', 'c']);
+});
+
+test('getOrCreateChannel with maxChannels 0 never evicts', () => {
+  const channels = new Map();
+  const options = { maxChannels: 0, createChannel: () => channelState(), clients: [] };
+  for (let i = 0; i < 100; i++) getOrCreateChannel(channels, `c${i}`, options);
+  assert.equal(channels.size, 100);
+});